@@ -0,0 +1,135 @@
+#include "corpus.hpp"
+#include <benchmark/benchmark.h>
+
+namespace mcp::bench {
+
+namespace {
+
+// 随机访问的id，每个基准独立的固定种子，保证不同构建之间可比
+int64_t random_id(std::mt19937_64& rng, int64_t rows) {
+    return static_cast<int64_t>(rng() % static_cast<uint64_t>(rows)) + 1;
+}
+
+// 不同选择性的FTS查询：高频词、中频词、两个词的组合
+std::vector<std::string> search_queries() {
+    const auto& words = vocabulary();
+    return {words[0], words[64], words[512], words[1] + " " + words[8]};
+}
+
+void BM_GetContent(benchmark::State& state) {
+    const int64_t rows = state.range(0);
+    auto db = open_corpus(rows);
+    std::mt19937_64 rng(1);
+    for (auto _ : state) {
+        auto item = db->get_content(random_id(rng, rows));
+        benchmark::DoNotOptimize(item);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GetContent)->Apply(corpus_sizes)->Unit(benchmark::kMicrosecond);
+
+void BM_UpdateContent(benchmark::State& state) {
+    const int64_t rows = state.range(0);
+    auto db = open_corpus(rows);
+    std::mt19937_64 rng(2);
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto item = db->get_content(random_id(rng, rows));
+        item->title += " updated";
+        state.ResumeTiming();
+        benchmark::DoNotOptimize(db->update_content(*item));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_UpdateContent)->Apply(corpus_sizes)->Unit(benchmark::kMicrosecond);
+
+// 创建后立即删除，语料库行数保持不变
+void BM_CreateDeleteContent(benchmark::State& state) {
+    auto db = open_corpus(state.range(0));
+    std::mt19937_64 rng(3);
+    const auto item = make_item(rng);
+    for (auto _ : state) {
+        auto id = db->create_content(item);
+        benchmark::DoNotOptimize(db->delete_content(*id));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CreateDeleteContent)->Apply(corpus_sizes)->Unit(benchmark::kMicrosecond);
+
+void BM_SearchContent(benchmark::State& state) {
+    auto db = open_corpus(state.range(0));
+    const auto queries = search_queries();
+    size_t next = 0;
+    for (auto _ : state) {
+        std::optional<PageCursor> cursor;
+        auto items = db->search_content_page(queries[next++ % queries.size()], std::nullopt, 20, cursor,
+                                             content_fields::kSummary);
+        benchmark::DoNotOptimize(items);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SearchContent)->Apply(corpus_sizes)->Unit(benchmark::kMicrosecond);
+
+// 搜索总数不经过计数缓存（每次查询前有写入时的情形）
+void BM_CountSearchResults(benchmark::State& state) {
+    auto db = open_corpus(state.range(0));
+    const auto queries = search_queries();
+    size_t next = 0;
+    for (auto _ : state) {
+        // 附加不同的OR子句使规范化后的查询各不相同，绕过计数缓存
+        const std::string query = queries[next % queries.size()] + " OR nosuchword" + std::to_string(next);
+        ++next;
+        benchmark::DoNotOptimize(db->count_search_results(query));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CountSearchResults)->Apply(corpus_sizes)->Unit(benchmark::kMicrosecond);
+
+void BM_GetContentByTag(benchmark::State& state) {
+    auto db = open_corpus(state.range(0));
+    std::mt19937_64 rng(4);
+    for (auto _ : state) {
+        std::optional<PageCursor> cursor;
+        auto items = db->get_content_by_tag_page(tag_name(skewed_index(rng, kTagCount)), std::nullopt, 20, cursor,
+                                                 content_fields::kSummary);
+        benchmark::DoNotOptimize(items);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GetContentByTag)->Apply(corpus_sizes)->Unit(benchmark::kMicrosecond);
+
+void BM_CountContentByTag(benchmark::State& state) {
+    auto db = open_corpus(state.range(0));
+    std::mt19937_64 rng(5);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(db->count_content_by_tag(tag_name(skewed_index(rng, kTagCount))));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CountContentByTag)->Apply(corpus_sizes)->Unit(benchmark::kMicrosecond);
+
+// 键集分页连续翻页，每次迭代读取一页
+void BM_ListContentPage(benchmark::State& state) {
+    auto db = open_corpus(state.range(0));
+    std::optional<PageCursor> cursor;
+    for (auto _ : state) {
+        std::optional<PageCursor> next;
+        auto items = db->list_content_page(cursor, 50, next, content_fields::kSummary);
+        benchmark::DoNotOptimize(items);
+        cursor = next;
+    }
+    state.SetItemsProcessed(state.iterations() * 50);
+}
+BENCHMARK(BM_ListContentPage)->Apply(corpus_sizes)->Unit(benchmark::kMicrosecond);
+
+void BM_GetContentStats(benchmark::State& state) {
+    auto db = open_corpus(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(db->get_content_stats());
+    }
+}
+BENCHMARK(BM_GetContentStats)->Apply(corpus_sizes)->Unit(benchmark::kMicrosecond);
+
+} // namespace
+
+} // namespace mcp::bench
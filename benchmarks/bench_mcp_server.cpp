@@ -0,0 +1,87 @@
+#include "corpus.hpp"
+#include "content_manager.hpp"
+#include "mcp_server.hpp"
+#include <benchmark/benchmark.h>
+
+namespace mcp::bench {
+
+namespace {
+
+constexpr int64_t kServerCorpusRows = 10000;
+
+// 请求分发的开销与语料规模关系不大，固定使用1万行的语料库
+MCPServer& server() {
+    static MCPServer instance(std::make_shared<ContentManager>(open_corpus(kServerCorpusRows)));
+    return instance;
+}
+
+nlohmann::json tool_call(const std::string& name, const nlohmann::json& arguments) {
+    return {{"jsonrpc", "2.0"}, {"id", 1}, {"method", "tools/call"},
+            {"params", {{"name", name}, {"arguments", arguments}}}};
+}
+
+void BM_HandleRequestPing(benchmark::State& state) {
+    auto& mcp = server();
+    const nlohmann::json request = {{"jsonrpc", "2.0"}, {"id", 1}, {"method", "ping"}};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(mcp.handle_request(request));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_HandleRequestPing);
+
+void BM_HandleRequestListTools(benchmark::State& state) {
+    auto& mcp = server();
+    const nlohmann::json request = {{"jsonrpc", "2.0"}, {"id", 1}, {"method", "tools/list"}};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(mcp.handle_request(request));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_HandleRequestListTools);
+
+// 热点内容命中ContentManager的响应缓存
+void BM_HandleRequestGetContent(benchmark::State& state) {
+    auto& mcp = server();
+    std::mt19937_64 rng(11);
+    std::vector<nlohmann::json> requests;
+    for (int i = 0; i < 64; ++i) {
+        requests.push_back(tool_call("get_content", {{"id", static_cast<int64_t>(rng() % kServerCorpusRows) + 1}}));
+    }
+    size_t next = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(mcp.handle_request(requests[next++ % requests.size()]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_HandleRequestGetContent)->Unit(benchmark::kMicrosecond);
+
+void BM_HandleRequestSearch(benchmark::State& state) {
+    auto& mcp = server();
+    const auto request = tool_call("search_content", {{"query", vocabulary()[64]}, {"fields", "summary"}});
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(mcp.handle_request(request));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_HandleRequestSearch)->Unit(benchmark::kMicrosecond);
+
+// JSON-RPC批量请求，批内调用并行执行
+void BM_HandleMessageBatch(benchmark::State& state) {
+    auto& mcp = server();
+    nlohmann::json batch = nlohmann::json::array();
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        auto request = tool_call("get_content", {{"id", i * 97 % kServerCorpusRows + 1}});
+        request["id"] = i;
+        batch.push_back(std::move(request));
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(mcp.handle_message(batch));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_HandleMessageBatch)->Arg(8)->Arg(64)->Unit(benchmark::kMicrosecond);
+
+} // namespace
+
+} // namespace mcp::bench
@@ -0,0 +1,74 @@
+#include "corpus.hpp"
+#include <benchmark/benchmark.h>
+
+namespace mcp::bench {
+
+namespace {
+
+// 约2KB正文的典型内容项
+ContentItem sample_item() {
+    std::mt19937_64 rng(7);
+    auto item = make_item(rng);
+    while (item.content.size() < 2048) {
+        item.content += make_item(rng).content;
+    }
+    item.id = 12345;
+    item.created_at = 1700000000;
+    item.updated_at = 1700000100;
+    item.preview = item.content.substr(0, 200);
+    return item;
+}
+
+void BM_ContentItemToJson(benchmark::State& state, uint32_t fields) {
+    const auto item = sample_item();
+    for (auto _ : state) {
+        auto json = item.to_json(fields);
+        benchmark::DoNotOptimize(json);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_CAPTURE(BM_ContentItemToJson, default_fields, content_fields::kDefault);
+BENCHMARK_CAPTURE(BM_ContentItemToJson, summary_fields, content_fields::kSummary);
+
+// 构造DOM后再序列化，即HTTP响应经nlohmann::json的完整开销
+void BM_ContentItemToJsonDump(benchmark::State& state, uint32_t fields) {
+    const auto item = sample_item();
+    int64_t bytes = 0;
+    for (auto _ : state) {
+        auto text = item.to_json(fields).dump();
+        bytes += static_cast<int64_t>(text.size());
+        benchmark::DoNotOptimize(text);
+    }
+    state.SetBytesProcessed(bytes);
+}
+BENCHMARK_CAPTURE(BM_ContentItemToJsonDump, default_fields, content_fields::kDefault);
+BENCHMARK_CAPTURE(BM_ContentItemToJsonDump, summary_fields, content_fields::kSummary);
+
+void BM_ContentItemAppendJson(benchmark::State& state, uint32_t fields) {
+    const auto item = sample_item();
+    std::string out;
+    int64_t bytes = 0;
+    for (auto _ : state) {
+        out.clear();
+        item.append_json(out, fields);
+        bytes += static_cast<int64_t>(out.size());
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetBytesProcessed(bytes);
+}
+BENCHMARK_CAPTURE(BM_ContentItemAppendJson, default_fields, content_fields::kDefault);
+BENCHMARK_CAPTURE(BM_ContentItemAppendJson, summary_fields, content_fields::kSummary);
+
+void BM_ContentItemFromJson(benchmark::State& state) {
+    const auto json = sample_item().to_json();
+    for (auto _ : state) {
+        auto item = ContentItem::from_json(json);
+        benchmark::DoNotOptimize(item);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ContentItemFromJson);
+
+} // namespace
+
+} // namespace mcp::bench
@@ -0,0 +1,143 @@
+#pragma once
+
+#include "database.hpp"
+#include <benchmark/benchmark.h>
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace mcp::bench {
+
+// 基准测试共用的合成语料：固定种子生成，词频和标签分布近似齐夫分布，
+// 少数高频词和标签覆盖大量行，接近真实笔记库的查询选择性
+
+constexpr size_t kVocabularySize = 4096;
+constexpr size_t kTagCount = 64;
+constexpr size_t kWordsPerItem = 96;
+
+inline const std::vector<std::string>& vocabulary() {
+    static const std::vector<std::string> words = [] {
+        static const char* syllables[] = {"ka", "lo", "mi", "ne", "ru", "sa", "ti", "vo",
+                                          "ze", "qu", "xi", "po", "da", "fe", "gu", "hy"};
+        std::vector<std::string> result;
+        result.reserve(kVocabularySize);
+        for (size_t i = 0; i < kVocabularySize; ++i) {
+            std::string word;
+            for (size_t n = i + 16; n > 0; n /= 16) {
+                word += syllables[n % 16];
+            }
+            result.push_back(std::move(word));
+        }
+        return result;
+    }();
+    return words;
+}
+
+inline std::string tag_name(size_t index) {
+    return "tag" + std::to_string(index);
+}
+
+// 偏斜抽样：返回[0, n)，小下标出现得更频繁
+inline size_t skewed_index(std::mt19937_64& rng, size_t n) {
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+    return std::min(n - 1, static_cast<size_t>(static_cast<double>(n) * std::pow(dist(rng), 3.0)));
+}
+
+inline ContentItem make_item(std::mt19937_64& rng) {
+    static const char* types[] = {"text", "markdown", "code"};
+    const auto& words = vocabulary();
+
+    ContentItem item{};
+    for (size_t i = 0; i < 6; ++i) {
+        item.title += (i ? " " : "") + words[skewed_index(rng, words.size())];
+    }
+    item.content.reserve(kWordsPerItem * 8);
+    for (size_t i = 0; i < kWordsPerItem; ++i) {
+        item.content += words[skewed_index(rng, words.size())];
+        item.content += (i % 16 == 15) ? ".\n" : " ";
+    }
+    item.content_type = types[rng() % 3];
+
+    const size_t tag_count = 1 + rng() % 3;
+    std::vector<size_t> tags;
+    while (tags.size() < tag_count) {
+        const size_t tag = skewed_index(rng, kTagCount);
+        if (std::find(tags.begin(), tags.end(), tag) == tags.end()) {
+            tags.push_back(tag);
+        }
+    }
+    for (size_t tag : tags) {
+        item.tags += (item.tags.empty() ? "" : ",") + tag_name(tag);
+    }
+    item.metadata = R"({"source":"benchmark","words":)" + std::to_string(kWordsPerItem) + "}";
+    return item;
+}
+
+// 语料库文件目录，默认在系统临时目录下；可用MCP_BENCH_DIR指定
+inline std::filesystem::path corpus_directory() {
+    const char* dir = std::getenv("MCP_BENCH_DIR");
+    return dir && *dir ? std::filesystem::path(dir) : std::filesystem::temp_directory_path() / "mcp_bench";
+}
+
+// 打开包含rows条内容的语料库；文件已存在且行数一致时直接复用，否则重新生成。
+// 同一进程内按行数共享实例，基准测试只做不改变行数的写入（更新、创建后删除）
+inline std::shared_ptr<Database> open_corpus(int64_t rows) {
+    static std::mutex mutex;
+    static std::map<int64_t, std::shared_ptr<Database>> corpora;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& db = corpora[rows];
+    if (db) {
+        return db;
+    }
+
+    std::error_code ec;
+    const auto dir = corpus_directory();
+    std::filesystem::create_directories(dir, ec);
+    const std::string path = (dir / ("corpus_" + std::to_string(rows) + ".db")).string();
+
+    db = std::make_shared<Database>(path);
+    if (db->initialize() && db->get_content_count() == rows) {
+        return db;
+    }
+
+    db.reset();
+    for (const char* suffix : {"", "-wal", "-shm"}) {
+        std::filesystem::remove(path + suffix, ec);
+    }
+    db = std::make_shared<Database>(path);
+    if (!db->initialize()) {
+        spdlog::error("Failed to create benchmark corpus at {}", path);
+        return db;
+    }
+
+    spdlog::info("Generating benchmark corpus with {} rows at {}", rows, path);
+    std::mt19937_64 rng(42);
+    constexpr int64_t kChunk = 10000;
+    std::vector<ContentItem> items;
+    for (int64_t done = 0; done < rows; done += kChunk) {
+        items.clear();
+        for (int64_t i = done; i < std::min(rows, done + kChunk); ++i) {
+            items.push_back(make_item(rng));
+        }
+        db->create_content_batch(items);
+    }
+    return db;
+}
+
+// 基准测试的语料规模：1万、10万、100万行
+inline void corpus_sizes(benchmark::internal::Benchmark* b) {
+    for (int64_t rows : {10000, 100000, 1000000}) {
+        b->Arg(rows);
+    }
+}
+
+} // namespace mcp::bench
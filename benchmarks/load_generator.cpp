@@ -0,0 +1,394 @@
+#include "http_client.hpp"
+#include "mcp_client.hpp"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <random>
+#include <regex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace mcp;
+
+// 多线程HTTP压测：每个线程独立的客户端按场景循环发请求，预热期之后的请求计入结果，
+// 结束时合并各线程的延迟样本计算吞吐和尾延迟，--json输出便于比较不同构建
+
+namespace {
+
+struct LoadTestArgs {
+    std::string server_url = "http://localhost:8086";
+    std::string scenario = "mixed";
+    int threads = 8;
+    int duration_seconds = 10;
+    int warmup_seconds = 2;
+    int64_t max_id = 0; // 0表示按列表接口读取现有的内容id
+    std::vector<int64_t> ids; // 非空时get请求只在其中随机选择
+    std::vector<std::string> queries;
+    bool json_output = false;
+    bool help = false;
+};
+
+LoadTestArgs parse_args(int argc, char* argv[]) {
+    LoadTestArgs args;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string { return i + 1 < argc ? argv[++i] : ""; };
+
+        if (arg == "--help" || arg == "-h") {
+            args.help = true;
+        } else if (arg == "--server" || arg == "-s") {
+            args.server_url = value();
+        } else if (arg == "--scenario" || arg == "-S") {
+            args.scenario = value();
+        } else if (arg == "--threads" || arg == "-t") {
+            args.threads = std::max(1, std::atoi(value().c_str()));
+        } else if (arg == "--duration" || arg == "-d") {
+            args.duration_seconds = std::max(1, std::atoi(value().c_str()));
+        } else if (arg == "--warmup" || arg == "-w") {
+            args.warmup_seconds = std::max(0, std::atoi(value().c_str()));
+        } else if (arg == "--max-id") {
+            args.max_id = std::atoll(value().c_str());
+        } else if (arg == "--query" || arg == "-q") {
+            args.queries.push_back(value());
+        } else if (arg == "--json") {
+            args.json_output = true;
+        } else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            args.help = true;
+        }
+    }
+
+    if (args.queries.empty()) {
+        args.queries = {"note", "test", "content"};
+    }
+    return args;
+}
+
+void print_help() {
+    std::cout << "Local Content MCP Load Test\n\n";
+    std::cout << "Usage: mcp_load_test [OPTIONS]\n\n";
+    std::cout << "Options:\n";
+    std::cout << "  -h, --help                 Show this help\n";
+    std::cout << "  -s, --server <url>         Server URL (default: http://localhost:8086)\n";
+    std::cout << "  -S, --scenario <name>      get, search, list, stats, mcp-get, mcp-search or mixed (default)\n";
+    std::cout << "  -t, --threads <n>          Concurrent client threads (default: 8)\n";
+    std::cout << "  -d, --duration <seconds>   Measured duration (default: 10)\n";
+    std::cout << "  -w, --warmup <seconds>     Unmeasured warm-up before the run (default: 2)\n";
+    std::cout << "  --max-id <n>               Pick get ids from 1..n instead of the existing ids\n";
+    std::cout << "  -q, --query <text>         Search query, may be repeated\n";
+    std::cout << "  --json                     Print the summary as JSON\n";
+    std::cout << "\nExamples:\n";
+    std::cout << "  mcp_load_test -S search -t 16 -d 30 -q keyword\n";
+    std::cout << "  mcp_load_test --json > before.json\n";
+}
+
+// 单个线程的客户端和随机数状态
+class Worker {
+public:
+    Worker(const LoadTestArgs& args, const std::string& host, int port, bool https, uint64_t seed)
+        : args_(args), rng_(seed) {
+        HttpRequestConfig http_config;
+        http_config.timeout = std::chrono::seconds(30);
+        http_config.user_agent = "MCP-Load-Test/1.0";
+        http_ = std::make_unique<HttpClient>(http_config);
+
+        MCPClientConfig mcp_config;
+        mcp_config.server_host = host;
+        mcp_config.server_port = port;
+        mcp_config.enable_ssl = https;
+        mcp_config.max_retries = 0; // 重试会掩盖错误和延迟
+        mcp_config.enable_logging = false;
+        mcp_ = std::make_unique<MCPClient>(mcp_config);
+    }
+
+    enum class Outcome { Ok, NotFound, Error };
+
+    // 执行一次请求；operation返回实际执行的操作名。内容已被删除的404单独统计，不算作错误
+    Outcome run_once(std::string& operation) {
+        operation = args_.scenario == "mixed" ? pick_mixed() : args_.scenario;
+
+        if (operation == "get") {
+            return http_outcome(http_->get(args_.server_url + "/api/content/" + std::to_string(random_id())));
+        }
+        if (operation == "search") {
+            return http_outcome(http_->get(args_.server_url + "/api/content/search",
+                                           {{"q", random_query()}, {"fields", "summary"}}));
+        }
+        if (operation == "list") {
+            return http_outcome(
+                http_->get(args_.server_url + "/api/content", {{"page_size", "20"}, {"fields", "summary"}}));
+        }
+        if (operation == "stats") {
+            return http_outcome(http_->get(args_.server_url + "/api/statistics"));
+        }
+        if (operation == "mcp-get") {
+            return tool_outcome(mcp_->call_tool("get_content", {{"id", random_id()}}));
+        }
+        if (operation == "mcp-search") {
+            return tool_outcome(mcp_->call_tool("search_content", {{"query", random_query()}, {"fields", "summary"}}));
+        }
+        return Outcome::Error;
+    }
+
+private:
+    const LoadTestArgs& args_;
+    std::mt19937_64 rng_;
+    std::unique_ptr<HttpClient> http_;
+    std::unique_ptr<MCPClient> mcp_;
+
+    // 读多写少的典型负载：以按id读取为主，其次是搜索和列表
+    std::string pick_mixed() {
+        const auto roll = rng_() % 100;
+        if (roll < 60) return "get";
+        if (roll < 85) return "search";
+        if (roll < 95) return "list";
+        return "mcp-search";
+    }
+
+    int64_t random_id() {
+        if (!args_.ids.empty()) {
+            return args_.ids[rng_() % args_.ids.size()];
+        }
+        return static_cast<int64_t>(rng_() % static_cast<uint64_t>(args_.max_id)) + 1;
+    }
+
+    static Outcome http_outcome(const HttpResponse& response) {
+        if (response.is_success()) return Outcome::Ok;
+        return response.success && response.status_code == 404 ? Outcome::NotFound : Outcome::Error;
+    }
+
+    // 工具的业务错误在result的文本里返回，JSON-RPC层仍是成功
+    static Outcome tool_outcome(const MCPResponse& response) {
+        if (!response.success) {
+            return Outcome::Error;
+        }
+        try {
+            const auto& content = response.data.at("content");
+            if (content.empty()) {
+                return Outcome::Ok;
+            }
+            auto result = nlohmann::json::parse(content[0].at("text").get<std::string>());
+            if (result.value("success", true)) {
+                return Outcome::Ok;
+            }
+            return result["error"].value("code", 0) == 404 ? Outcome::NotFound : Outcome::Error;
+        } catch (const std::exception&) {
+            return Outcome::Error;
+        }
+    }
+
+    const std::string& random_query() {
+        return args_.queries[rng_() % args_.queries.size()];
+    }
+};
+
+struct OperationResult {
+    std::vector<double> latencies_ms;
+    uint64_t not_found = 0;
+    uint64_t errors = 0;
+};
+
+double percentile(const std::vector<double>& sorted, double q) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    const size_t index = std::min(sorted.size() - 1, static_cast<size_t>(q * static_cast<double>(sorted.size())));
+    return sorted[index];
+}
+
+nlohmann::json summarize(OperationResult& result, double seconds) {
+    auto& latencies = result.latencies_ms;
+    std::sort(latencies.begin(), latencies.end());
+
+    double total = 0.0;
+    for (double value : latencies) {
+        total += value;
+    }
+
+    nlohmann::json summary;
+    summary["requests"] = latencies.size();
+    summary["not_found"] = result.not_found;
+    summary["errors"] = result.errors;
+    summary["throughput_rps"] = seconds > 0 ? static_cast<double>(latencies.size()) / seconds : 0.0;
+    summary["latency_ms"] = {
+        {"mean", latencies.empty() ? 0.0 : total / static_cast<double>(latencies.size())},
+        {"p50", percentile(latencies, 0.50)},
+        {"p90", percentile(latencies, 0.90)},
+        {"p99", percentile(latencies, 0.99)},
+        {"p999", percentile(latencies, 0.999)},
+        {"max", latencies.empty() ? 0.0 : latencies.back()}
+    };
+    return summary;
+}
+
+void print_summary(const std::string& name, const nlohmann::json& summary) {
+    const auto& latency = summary["latency_ms"];
+    std::printf("%-12s %10llu %9llu %8llu %12.1f %8.2f %8.2f %8.2f %8.2f %8.2f %9.2f\n", name.c_str(),
+                static_cast<unsigned long long>(summary["requests"].get<uint64_t>()),
+                static_cast<unsigned long long>(summary["not_found"].get<uint64_t>()),
+                static_cast<unsigned long long>(summary["errors"].get<uint64_t>()),
+                summary["throughput_rps"].get<double>(), latency["mean"].get<double>(),
+                latency["p50"].get<double>(), latency["p90"].get<double>(), latency["p99"].get<double>(),
+                latency["p999"].get<double>(), latency["max"].get<double>());
+}
+
+// 未指定--max-id时按游标翻页读取现有的内容id，删除过内容的库id不连续；
+// 只取前kMaxSampledIds个，足够让随机读取分散在整个库上
+constexpr size_t kMaxSampledIds = 100000;
+
+std::vector<int64_t> fetch_content_ids(const std::string& server_url) {
+    HttpClient client;
+    std::vector<int64_t> ids;
+    std::string cursor;
+    try {
+        do {
+            std::map<std::string, std::string> params = {{"page_size", "100"}, {"fields", "id"}};
+            if (!cursor.empty()) {
+                params["cursor"] = cursor;
+            }
+            auto response = client.get(server_url + "/api/content", params);
+            if (!response.is_success()) {
+                break;
+            }
+            auto json = response.get_json();
+            const auto& page = json.contains("data") ? json["data"] : json;
+            for (const auto& item : page.at("items")) {
+                ids.push_back(item.at("id").get<int64_t>());
+            }
+            const auto next = page.find("next_cursor");
+            cursor = next != page.end() && next->is_string() ? next->get<std::string>() : "";
+        } while (!cursor.empty() && ids.size() < kMaxSampledIds);
+    } catch (const std::exception& e) {
+        spdlog::warn("Failed to read content ids: {}", e.what());
+    }
+    return ids;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    auto args = parse_args(argc, argv);
+    if (args.help) {
+        print_help();
+        return 0;
+    }
+
+    static const std::vector<std::string> scenarios = {"get", "search", "list", "stats", "mcp-get",
+                                                       "mcp-search", "mixed"};
+    if (std::find(scenarios.begin(), scenarios.end(), args.scenario) == scenarios.end()) {
+        std::cerr << "Unknown scenario: " << args.scenario << "\n";
+        return 1;
+    }
+
+    std::smatch matches;
+    static const std::regex url_regex(R"(^(https?)://([^:/]+)(?::(\d+))?/?$)");
+    if (!std::regex_match(args.server_url, matches, url_regex)) {
+        std::cerr << "Invalid server URL: " << args.server_url << "\n";
+        return 1;
+    }
+    const bool https = matches[1] == "https";
+    const std::string host = matches[2];
+    const int port = matches[3].matched ? std::stoi(matches[3]) : (https ? 443 : 80);
+    if (args.server_url.back() == '/') {
+        args.server_url.pop_back();
+    }
+
+    if (args.max_id <= 0) {
+        args.ids = fetch_content_ids(args.server_url);
+        if (args.ids.empty()) {
+            std::cerr << "Server has no content (or is unreachable); seed it or pass --max-id\n";
+            return 1;
+        }
+    }
+
+    spdlog::set_level(spdlog::level::warn);
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto measure_start = start + std::chrono::seconds(args.warmup_seconds);
+    const auto deadline = measure_start + std::chrono::seconds(args.duration_seconds);
+
+    // 样本先写入各线程自己的结果，结束后再合并，测量期间线程之间不共享状态
+    std::vector<std::map<std::string, OperationResult>> thread_results(args.threads);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < args.threads; ++t) {
+        threads.emplace_back([&, t] {
+            Worker worker(args, host, port, https, 0x9E3779B97F4A7C15ULL * static_cast<uint64_t>(t + 1));
+            auto& results = thread_results[t];
+            std::string operation;
+
+            while (true) {
+                const auto request_start = std::chrono::steady_clock::now();
+                if (request_start >= deadline) {
+                    break;
+                }
+                const auto outcome = worker.run_once(operation);
+                const auto request_end = std::chrono::steady_clock::now();
+                if (request_start < measure_start || request_end > deadline) {
+                    continue;
+                }
+
+                auto& result = results[operation];
+                if (outcome == Worker::Outcome::Ok) {
+                    result.latencies_ms.push_back(
+                        std::chrono::duration<double, std::milli>(request_end - request_start).count());
+                } else if (outcome == Worker::Outcome::NotFound) {
+                    result.not_found++;
+                } else {
+                    result.errors++;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::map<std::string, OperationResult> merged;
+    OperationResult total;
+    for (auto& results : thread_results) {
+        for (auto& [operation, result] : results) {
+            auto& target = merged[operation];
+            target.latencies_ms.insert(target.latencies_ms.end(), result.latencies_ms.begin(),
+                                       result.latencies_ms.end());
+            target.not_found += result.not_found;
+            target.errors += result.errors;
+            total.not_found += result.not_found;
+            total.latencies_ms.insert(total.latencies_ms.end(), result.latencies_ms.begin(),
+                                      result.latencies_ms.end());
+            total.errors += result.errors;
+        }
+    }
+
+    const double seconds = static_cast<double>(args.duration_seconds);
+    nlohmann::json report;
+    report["server"] = args.server_url;
+    report["scenario"] = args.scenario;
+    report["threads"] = args.threads;
+    report["duration_seconds"] = args.duration_seconds;
+    report["total"] = summarize(total, seconds);
+    report["operations"] = nlohmann::json::object();
+    for (auto& [operation, result] : merged) {
+        report["operations"][operation] = summarize(result, seconds);
+    }
+
+    if (args.json_output) {
+        std::cout << report.dump(2) << std::endl;
+        return 0;
+    }
+
+    std::printf("Scenario %s, %d threads, %ds measured after %ds warm-up against %s\n\n", args.scenario.c_str(),
+                args.threads, args.duration_seconds, args.warmup_seconds, args.server_url.c_str());
+    std::printf("%-12s %10s %9s %8s %12s %8s %8s %8s %8s %8s %9s\n", "operation", "requests", "not found",
+                "errors", "req/s", "mean", "p50", "p90", "p99", "p99.9", "max (ms)");
+    for (const auto& [operation, summary] : report["operations"].items()) {
+        print_summary(operation, summary);
+    }
+    print_summary("total", report["total"]);
+    return 0;
+}
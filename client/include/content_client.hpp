@@ -133,8 +133,10 @@ public:
     ContentResponse<std::vector<std::string>> get_tags_rest();
     ContentResponse<ContentStatistics> get_statistics_rest();
     
-    // 批量操作
+    // 批量操作：MCP方式每批只发送一个JSON-RPC批量请求；任一条失败时success为false，
+    // data中仍包含成功的条目
     ContentResponse<std::vector<ContentItem>> create_content_batch(const std::vector<CreateContentRequest>& requests);
+    // 先从缓存取，未命中的id再合并成一个批量请求
     ContentResponse<std::vector<ContentItem>> get_content_batch(const std::vector<int64_t>& ids);
     ContentResponse<bool> delete_content_batch(const std::vector<int64_t>& ids);
     
@@ -155,10 +157,11 @@ public:
     using ProgressCallback = std::function<void(int current, int total, const std::string& operation)>;
     void set_progress_callback(ProgressCallback callback);
     
-    // 缓存管理
+    // 缓存管理：分片LRU缓存，可被多个线程同时使用
     void enable_cache(bool enable = true);
     void clear_cache();
     void set_cache_ttl(std::chrono::seconds ttl);
+    nlohmann::json get_cache_statistics() const;
     
     // 统计信息
     struct ClientStatistics {
@@ -173,7 +176,7 @@ public:
         void reset();
     };
     
-    const ClientStatistics& get_client_statistics() const;
+    ClientStatistics get_client_statistics() const;
     void reset_client_statistics();
     
 private:
@@ -189,6 +192,7 @@ private:
     
     void handle_error(const std::string& error);
     void update_statistics(bool success, std::chrono::milliseconds response_time);
+    void record_cache_lookup(bool hit);
     
     // 缓存相关
     template<typename T>
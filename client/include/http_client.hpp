@@ -49,9 +49,13 @@ struct HttpRequestConfig {
     
     // 压缩
     bool enable_compression = true;
+    
+    // 连接复用：每个origin最多保留的空闲keep-alive连接数，并发超出时临时建立新连接
+    bool keep_alive = true;
+    size_t max_connections_per_host = 8;
 };
 
-// HTTP客户端类
+// HTTP客户端类，可被多个线程同时使用
 class HttpClient {
 public:
     explicit HttpClient(const HttpRequestConfig& config = HttpRequestConfig{});
@@ -108,6 +112,10 @@ public:
     // SSL设置
     void set_ssl_verification(bool verify);
     
+    // 连接池
+    void close_idle_connections();
+    size_t idle_connection_count() const;
+    
     // 错误处理
     std::string get_last_error() const;
     void clear_error();
@@ -125,7 +133,7 @@ public:
         nlohmann::json to_json() const;
     };
     
-    const Statistics& get_statistics() const;
+    Statistics get_statistics() const;
     void reset_statistics();
     
 private:
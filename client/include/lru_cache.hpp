@@ -0,0 +1,154 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace mcp {
+
+// 线程安全的分片LRU缓存：按键的哈希分到各分片，每个分片独立加锁和淘汰；
+// 条目写入后ttl到期即失效，ttl为0表示不过期
+template <typename Value>
+class ShardedLruCache {
+public:
+    explicit ShardedLruCache(size_t capacity, std::chrono::milliseconds ttl = std::chrono::milliseconds{0},
+                             size_t shards = 16)
+        : ttl_ms_(ttl.count()) {
+        shards = std::max<size_t>(1, shards);
+        shard_capacity_ = std::max<size_t>(1, (capacity + shards - 1) / shards);
+        for (size_t i = 0; i < shards; ++i) {
+            shards_.push_back(std::make_unique<Shard>());
+        }
+    }
+
+    std::optional<Value> get(const std::string& key) {
+        auto& shard = shard_for(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(key);
+        if (it == shard.index.end()) {
+            misses_.fetch_add(1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+        if (expired(*it->second)) {
+            shard.lru.erase(it->second);
+            shard.index.erase(it);
+            expirations_.fetch_add(1, std::memory_order_relaxed);
+            misses_.fetch_add(1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        hits_.fetch_add(1, std::memory_order_relaxed);
+        return it->second->value;
+    }
+
+    void put(const std::string& key, Value value) {
+        auto& shard = shard_for(key);
+        const auto inserted_at = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(key);
+        if (it != shard.index.end()) {
+            it->second->value = std::move(value);
+            it->second->inserted_at = inserted_at;
+            shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+            return;
+        }
+        shard.lru.push_front(Entry{key, std::move(value), inserted_at});
+        shard.index.emplace(key, shard.lru.begin());
+        while (shard.lru.size() > shard_capacity_) {
+            shard.index.erase(shard.lru.back().key);
+            shard.lru.pop_back();
+            evictions_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    bool erase(const std::string& key) {
+        auto& shard = shard_for(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(key);
+        if (it == shard.index.end()) {
+            return false;
+        }
+        shard.lru.erase(it->second);
+        shard.index.erase(it);
+        return true;
+    }
+
+    void clear() {
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            shard->lru.clear();
+            shard->index.clear();
+        }
+    }
+
+    // 新的ttl对已缓存的条目同样生效（按写入时间计算）
+    void set_ttl(std::chrono::milliseconds ttl) { ttl_ms_.store(ttl.count(), std::memory_order_relaxed); }
+
+    size_t size() const {
+        size_t total = 0;
+        for (const auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            total += shard->lru.size();
+        }
+        return total;
+    }
+
+    uint64_t hits() const { return hits_.load(std::memory_order_relaxed); }
+    uint64_t misses() const { return misses_.load(std::memory_order_relaxed); }
+
+    nlohmann::json get_statistics() const {
+        const uint64_t hits = this->hits();
+        const uint64_t misses = this->misses();
+        nlohmann::json stats;
+        stats["entries"] = size();
+        stats["capacity"] = shard_capacity_ * shards_.size();
+        stats["shards"] = shards_.size();
+        stats["hits"] = hits;
+        stats["misses"] = misses;
+        stats["evictions"] = evictions_.load(std::memory_order_relaxed);
+        stats["expirations"] = expirations_.load(std::memory_order_relaxed);
+        stats["hit_rate"] = hits + misses > 0 ? static_cast<double>(hits) / static_cast<double>(hits + misses) : 0.0;
+        return stats;
+    }
+
+private:
+    struct Entry {
+        std::string key;
+        Value value;
+        std::chrono::steady_clock::time_point inserted_at;
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::list<Entry> lru; // 头部为最近使用
+        std::unordered_map<std::string, typename std::list<Entry>::iterator> index;
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+    size_t shard_capacity_ = 1;
+    std::atomic<int64_t> ttl_ms_;
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> evictions_{0};
+    std::atomic<uint64_t> expirations_{0};
+
+    Shard& shard_for(const std::string& key) {
+        return *shards_[std::hash<std::string>{}(key) % shards_.size()];
+    }
+
+    bool expired(const Entry& entry) const {
+        const int64_t ttl = ttl_ms_.load(std::memory_order_relaxed);
+        return ttl > 0 && std::chrono::steady_clock::now() - entry.inserted_at >= std::chrono::milliseconds(ttl);
+    }
+};
+
+} // namespace mcp
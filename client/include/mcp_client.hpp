@@ -3,6 +3,8 @@
 #include <string>
 #include <memory>
 #include <functional>
+#include <future>
+#include <vector>
 #include <nlohmann/json.hpp>
 
 namespace mcp {
@@ -39,6 +41,10 @@ struct MCPClientConfig {
     // 日志配置
     bool enable_logging = true;
     std::string log_level = "info";
+    
+    // 并发配置：异步请求共用的线程数，以及保留的空闲keep-alive连接数
+    int async_threads = 4;
+    int max_connections = 8;
 };
 
 // MCP客户端类
@@ -69,6 +75,9 @@ public:
     
     // 通用请求方法
     MCPResponse send_request(const nlohmann::json& request);
+    // 把多个请求作为一个JSON-RPC批量请求发送，结果按requests的顺序返回；
+    // 请求id会被重新分配以保证批内唯一
+    std::vector<MCPResponse> send_batch(const std::vector<nlohmann::json>& requests);
     
     // 配置管理
     void set_config(const MCPClientConfig& config);
@@ -86,8 +95,9 @@ public:
     void set_error_callback(ErrorCallback callback);
     void set_response_callback(ResponseCallback callback);
     
-    // 异步请求（如果需要）
+    // 异步请求：在固定大小的线程池中执行，回调在线程池线程上调用
     void send_request_async(const nlohmann::json& request, ResponseCallback callback);
+    std::future<MCPResponse> send_request_async(const nlohmann::json& request);
     
     // 工具方法
     static std::string build_server_url(const std::string& host, int port, bool ssl = false);
@@ -1,7 +1,10 @@
 #include "content_client.hpp"
+#include "lru_cache.hpp"
 #include <spdlog/spdlog.h>
+#include <atomic>
 #include <fstream>
 #include <chrono>
+#include <mutex>
 #include <unordered_map>
 #include <algorithm>
 #include <type_traits>
@@ -169,6 +172,9 @@ nlohmann::json ContentStatistics::to_json() const {
 void ContentStatistics::from_json(const nlohmann::json& j) {
     if (j.contains("total_items")) {
         total_items = j["total_items"].get<int>();
+    } else if (j.contains("total_content")) {
+        // 服务端统计接口的字段名
+        total_items = j["total_content"].get<int>();
     }
     if (j.contains("total_tags")) {
         total_tags = j["total_tags"].get<int>();
@@ -208,6 +214,106 @@ void ContentClient::ClientStatistics::reset() {
     total_response_time = std::chrono::milliseconds{0};
 }
 
+namespace {
+
+// 一个JSON-RPC批量请求中最多包含的调用数，超出时分多批发送
+constexpr size_t kMaxBatchRequests = 256;
+constexpr size_t kDefaultCacheCapacity = 1024;
+
+// 服务端业务结果为{"success":true,"data":...}或{"success":false,"error":{...}}
+bool unwrap_result_payload(const nlohmann::json& payload, nlohmann::json& data, std::string& error) {
+    if (!payload.is_object() || !payload.contains("success") || !payload["success"].is_boolean()) {
+        data = payload;
+        return true;
+    }
+    if (!payload["success"].get<bool>()) {
+        const auto& err = payload.contains("error") ? payload["error"] : nlohmann::json();
+        if (err.is_object() && err.contains("message") && err["message"].is_string()) {
+            error = err["message"].get<std::string>();
+        } else if (err.is_string()) {
+            error = err.get<std::string>();
+        } else {
+            error = "Operation failed";
+        }
+        return false;
+    }
+    data = payload.contains("data") ? payload["data"] : nlohmann::json::object();
+    return true;
+}
+
+// 工具调用结果以文本形式放在content[0].text中；不是这种格式时按原样处理
+bool unwrap_tool_result(const MCPResponse& response, nlohmann::json& data, std::string& error) {
+    if (!response.success) {
+        error = response.error_message;
+        return false;
+    }
+    const auto& result = response.data;
+    if (!result.is_object() || !result.contains("content") || !result["content"].is_array() ||
+        result["content"].empty() || !result["content"][0].is_object() ||
+        !result["content"][0].contains("text") || !result["content"][0]["text"].is_string()) {
+        data = result;
+        return true;
+    }
+    auto payload = nlohmann::json::parse(result["content"][0]["text"].get<std::string>(), nullptr, false);
+    if (payload.is_discarded()) {
+        error = "Invalid tool result";
+        return false;
+    }
+    return unwrap_result_payload(payload, data, error);
+}
+
+bool unwrap_http_result(const HttpResponse& response, nlohmann::json& data, std::string& error) {
+    auto payload = nlohmann::json::parse(response.body, nullptr, false);
+    if (!response.is_success()) {
+        if (payload.is_discarded() || unwrap_result_payload(payload, data, error)) {
+            error = response.error_message.empty() ? "HTTP " + std::to_string(response.status_code) : response.error_message;
+        }
+        return false;
+    }
+    if (payload.is_discarded()) {
+        error = "Invalid JSON response";
+        return false;
+    }
+    return unwrap_result_payload(payload, data, error);
+}
+
+// 批量操作中失败条目的计数，只保留第一条错误信息
+struct BatchErrors {
+    size_t count = 0;
+    std::string first;
+    
+    void add(std::string message) {
+        if (count++ == 0) {
+            first = std::move(message);
+        }
+    }
+    std::string summary(size_t total) const {
+        return std::to_string(count) + " of " + std::to_string(total) + " operations failed: " + first;
+    }
+};
+
+// 对每组参数调用同一个工具，每kMaxBatchRequests个调用合并为一个批量请求
+void call_tool_batches(MCPClient& client, const std::string& tool_name,
+                       const std::vector<nlohmann::json>& arguments,
+                       const std::function<void(size_t index, const MCPResponse& response)>& on_result,
+                       const std::function<void(size_t done, size_t total)>& on_progress) {
+    for (size_t begin = 0; begin < arguments.size(); begin += kMaxBatchRequests) {
+        const size_t end = std::min(arguments.size(), begin + kMaxBatchRequests);
+        std::vector<nlohmann::json> requests;
+        requests.reserve(end - begin);
+        for (size_t i = begin; i < end; ++i) {
+            requests.push_back(client_utils::create_call_tool_request(tool_name, arguments[i]));
+        }
+        auto responses = client.send_batch(requests);
+        for (size_t i = begin; i < end; ++i) {
+            on_result(i, responses[i - begin]);
+        }
+        on_progress(end, arguments.size());
+    }
+}
+
+} // namespace
+
 // ContentClient::Impl类
 class ContentClient::Impl {
 public:
@@ -217,16 +323,12 @@ public:
     std::string preferred_protocol = "mcp"; // "mcp" or "rest"
     std::string last_error;
     ProgressCallback progress_callback;
+    mutable std::mutex stats_mutex;
     ClientStatistics stats;
     
-    // 缓存相关
-    bool cache_enabled = false;
-    std::chrono::seconds cache_ttl{300}; // 5分钟
-    struct CacheEntry {
-        nlohmann::json data;
-        std::chrono::steady_clock::time_point timestamp;
-    };
-    std::unordered_map<std::string, CacheEntry> cache;
+    // 缓存相关：按键分片加锁的LRU缓存，默认5分钟过期
+    std::atomic<bool> cache_enabled{false};
+    ShardedLruCache<nlohmann::json> cache{kDefaultCacheCapacity, std::chrono::seconds(300)};
     
     explicit Impl(const MCPClientConfig& config) {
         mcp_client = std::make_shared<MCPClient>(config);
@@ -240,12 +342,6 @@ public:
         : http_client(std::move(client)), http_base_url(base_url), preferred_protocol("rest") {
     }
     
-    bool is_cache_valid(const CacheEntry& entry) const {
-        auto now = std::chrono::steady_clock::now();
-        auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - entry.timestamp);
-        return elapsed < cache_ttl;
-    }
-    
     void update_progress(int current, int total, const std::string& operation) {
         if (progress_callback) {
             progress_callback(current, total, operation);
@@ -306,8 +402,11 @@ ContentResponse<ContentItem> ContentClient::create_content(const CreateContentRe
         auto mcp_response = pimpl_->mcp_client->call_tool("create_content", request.to_json());
         response = handle_mcp_response<ContentItem>(mcp_response);
         
-        if (response.success) {
-            response.data.from_json(mcp_response.data);
+        nlohmann::json data;
+        if (response.success && !unwrap_tool_result(mcp_response, data, response.error_message)) {
+            response.success = false;
+        } else if (response.success) {
+            response.data = ContentItem::from_json(data);
         }
         
     } catch (const std::exception& e) {
@@ -333,10 +432,10 @@ ContentResponse<ContentItem> ContentClient::get_content(int64_t id) {
         if (auto cached = get_from_cache<ContentItem>(cache_key)) {
             response.success = true;
             response.data = cached.value();
-            pimpl_->stats.cache_hits++;
+            record_cache_lookup(true);
             return response;
         }
-        pimpl_->stats.cache_misses++;
+        record_cache_lookup(false);
         
         if (!pimpl_->mcp_client) {
             response.success = false;
@@ -350,8 +449,11 @@ ContentResponse<ContentItem> ContentClient::get_content(int64_t id) {
         auto mcp_response = pimpl_->mcp_client->call_tool("get_content", args);
         response = handle_mcp_response<ContentItem>(mcp_response);
         
-        if (response.success) {
-            response.data.from_json(mcp_response.data);
+        nlohmann::json data;
+        if (response.success && !unwrap_tool_result(mcp_response, data, response.error_message)) {
+            response.success = false;
+        } else if (response.success) {
+            response.data = ContentItem::from_json(data);
             
             // 缓存结果
             put_to_cache(cache_key, response.data);
@@ -387,14 +489,16 @@ ContentResponse<ContentItem> ContentClient::update_content(int64_t id, const Upd
         auto mcp_response = pimpl_->mcp_client->call_tool("update_content", args);
         response = handle_mcp_response<ContentItem>(mcp_response);
         
-        if (response.success) {
-            response.data.from_json(mcp_response.data);
-            
-            // 清除相关缓存
-            std::string cache_key = build_cache_key("get_content", std::to_string(id));
-            pimpl_->cache.erase(cache_key);
+        nlohmann::json data;
+        if (response.success && !unwrap_tool_result(mcp_response, data, response.error_message)) {
+            response.success = false;
+        } else if (response.success) {
+            response.data = ContentItem::from_json(data);
         }
         
+        // 清除相关缓存
+        pimpl_->cache.erase(build_cache_key("get_content", std::to_string(id)));
+        
     } catch (const std::exception& e) {
         response.success = false;
         response.error_message = "Update content failed: " + std::string(e.what());
@@ -602,6 +706,230 @@ ContentResponse<ContentItem> ContentClient::create_content_rest(const CreateCont
     return response;
 }
 
+// 批量操作
+ContentResponse<std::vector<ContentItem>> ContentClient::create_content_batch(const std::vector<CreateContentRequest>& requests) {
+    auto start_time = std::chrono::steady_clock::now();
+    ContentResponse<std::vector<ContentItem>> response;
+    
+    try {
+        BatchErrors errors;
+        
+        if (pimpl_->mcp_client) {
+            std::vector<nlohmann::json> arguments;
+            arguments.reserve(requests.size());
+            for (const auto& request : requests) {
+                arguments.push_back(request.to_json());
+            }
+            
+            response.data.reserve(requests.size());
+            call_tool_batches(*pimpl_->mcp_client, "create_content", arguments,
+                [&](size_t index, const MCPResponse& result) {
+                    nlohmann::json data;
+                    std::string error;
+                    if (unwrap_tool_result(result, data, error)) {
+                        response.data.push_back(ContentItem::from_json(data));
+                    } else {
+                        errors.add("item " + std::to_string(index) + ": " + error);
+                    }
+                },
+                [this](size_t done, size_t total) { pimpl_->update_progress(static_cast<int>(done), static_cast<int>(total), "create_content_batch"); });
+        } else if (pimpl_->http_client) {
+            // REST方式通过导入接口一次提交全部记录；导入接口只返回计数，不返回新内容，data为空
+            std::string body;
+            for (const auto& request : requests) {
+                body += request.to_json().dump();
+                body += '\n';
+            }
+            
+            auto http_response = pimpl_->http_client->post(pimpl_->http_base_url + "/api/content/import",
+                                                          body, "application/x-ndjson");
+            nlohmann::json summary;
+            std::string error;
+            if (!unwrap_http_result(http_response, summary, error)) {
+                errors.count = requests.size();
+                errors.first = error;
+            } else {
+                const size_t created = summary.value("created_count", static_cast<size_t>(0));
+                if (created < requests.size()) {
+                    errors.count = requests.size() - created;
+                    errors.first = summary.contains("errors") && summary["errors"].is_array() && !summary["errors"].empty()
+                        ? summary["errors"][0].get<std::string>() : "Import rejected records";
+                }
+            }
+            pimpl_->update_progress(static_cast<int>(requests.size()), static_cast<int>(requests.size()), "create_content_batch");
+        } else {
+            errors.count = requests.size();
+            errors.first = "No client available";
+        }
+        
+        response.success = errors.count == 0;
+        if (!response.success) {
+            response.error_message = errors.summary(requests.size());
+            handle_error(response.error_message);
+        }
+        
+    } catch (const std::exception& e) {
+        response.success = false;
+        response.error_message = "Create content batch failed: " + std::string(e.what());
+        handle_error(response.error_message);
+    }
+    
+    auto end_time = std::chrono::steady_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+    update_statistics(response.success, duration);
+    
+    return response;
+}
+
+ContentResponse<std::vector<ContentItem>> ContentClient::get_content_batch(const std::vector<int64_t>& ids) {
+    auto start_time = std::chrono::steady_clock::now();
+    ContentResponse<std::vector<ContentItem>> response;
+    
+    try {
+        std::vector<std::optional<ContentItem>> items(ids.size());
+        std::vector<size_t> missing;
+        for (size_t i = 0; i < ids.size(); ++i) {
+            items[i] = get_from_cache<ContentItem>(build_cache_key("get_content", std::to_string(ids[i])));
+            record_cache_lookup(items[i].has_value());
+            if (!items[i]) {
+                missing.push_back(i);
+            }
+        }
+        
+        BatchErrors errors;
+        auto store = [&](size_t index, const nlohmann::json& data) {
+            items[index] = ContentItem::from_json(data);
+            put_to_cache(build_cache_key("get_content", std::to_string(ids[index])), *items[index]);
+        };
+        
+        if (missing.empty()) {
+            // 全部命中缓存
+        } else if (pimpl_->mcp_client) {
+            std::vector<nlohmann::json> arguments;
+            arguments.reserve(missing.size());
+            for (size_t index : missing) {
+                arguments.push_back({{"id", ids[index]}});
+            }
+            
+            call_tool_batches(*pimpl_->mcp_client, "get_content", arguments,
+                [&](size_t k, const MCPResponse& result) {
+                    nlohmann::json data;
+                    std::string error;
+                    if (unwrap_tool_result(result, data, error)) {
+                        store(missing[k], data);
+                    } else {
+                        errors.add("id " + std::to_string(ids[missing[k]]) + ": " + error);
+                    }
+                },
+                [this](size_t done, size_t total) { pimpl_->update_progress(static_cast<int>(done), static_cast<int>(total), "get_content_batch"); });
+        } else if (pimpl_->http_client) {
+            // REST没有批量读取接口，逐个请求，连接由HttpClient复用
+            for (size_t k = 0; k < missing.size(); ++k) {
+                const int64_t id = ids[missing[k]];
+                auto http_response = pimpl_->http_client->get(pimpl_->http_base_url + "/api/content/" + std::to_string(id));
+                nlohmann::json data;
+                std::string error;
+                if (unwrap_http_result(http_response, data, error)) {
+                    store(missing[k], data);
+                } else {
+                    errors.add("id " + std::to_string(id) + ": " + error);
+                }
+                pimpl_->update_progress(static_cast<int>(k + 1), static_cast<int>(missing.size()), "get_content_batch");
+            }
+        } else {
+            errors.count = missing.size();
+            errors.first = "No client available";
+        }
+        
+        response.data.reserve(ids.size());
+        for (auto& item : items) {
+            if (item) {
+                response.data.push_back(std::move(*item));
+            }
+        }
+        
+        response.success = errors.count == 0;
+        if (!response.success) {
+            response.error_message = errors.summary(ids.size());
+            handle_error(response.error_message);
+        }
+        
+    } catch (const std::exception& e) {
+        response.success = false;
+        response.error_message = "Get content batch failed: " + std::string(e.what());
+        handle_error(response.error_message);
+    }
+    
+    auto end_time = std::chrono::steady_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+    update_statistics(response.success, duration);
+    
+    return response;
+}
+
+ContentResponse<bool> ContentClient::delete_content_batch(const std::vector<int64_t>& ids) {
+    auto start_time = std::chrono::steady_clock::now();
+    ContentResponse<bool> response;
+    
+    try {
+        BatchErrors errors;
+        
+        if (pimpl_->mcp_client) {
+            std::vector<nlohmann::json> arguments;
+            arguments.reserve(ids.size());
+            for (int64_t id : ids) {
+                arguments.push_back({{"id", id}});
+            }
+            
+            call_tool_batches(*pimpl_->mcp_client, "delete_content", arguments,
+                [&](size_t index, const MCPResponse& result) {
+                    nlohmann::json data;
+                    std::string error;
+                    if (!unwrap_tool_result(result, data, error)) {
+                        errors.add("id " + std::to_string(ids[index]) + ": " + error);
+                    }
+                },
+                [this](size_t done, size_t total) { pimpl_->update_progress(static_cast<int>(done), static_cast<int>(total), "delete_content_batch"); });
+        } else if (pimpl_->http_client) {
+            for (size_t i = 0; i < ids.size(); ++i) {
+                auto http_response = pimpl_->http_client->delete_request(pimpl_->http_base_url + "/api/content/" + std::to_string(ids[i]));
+                nlohmann::json data;
+                std::string error;
+                if (!unwrap_http_result(http_response, data, error)) {
+                    errors.add("id " + std::to_string(ids[i]) + ": " + error);
+                }
+                pimpl_->update_progress(static_cast<int>(i + 1), static_cast<int>(ids.size()), "delete_content_batch");
+            }
+        } else {
+            errors.count = ids.size();
+            errors.first = "No client available";
+        }
+        
+        // 部分失败时无法确定哪些已删除，统一清除缓存
+        for (int64_t id : ids) {
+            pimpl_->cache.erase(build_cache_key("get_content", std::to_string(id)));
+        }
+        
+        response.success = errors.count == 0;
+        response.data = response.success;
+        if (!response.success) {
+            response.error_message = errors.summary(ids.size());
+            handle_error(response.error_message);
+        }
+        
+    } catch (const std::exception& e) {
+        response.success = false;
+        response.error_message = "Delete content batch failed: " + std::string(e.what());
+        handle_error(response.error_message);
+    }
+    
+    auto end_time = std::chrono::steady_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+    update_statistics(response.success, duration);
+    
+    return response;
+}
+
 // 其他REST API方法的实现类似...
 
 // 配置管理
@@ -643,14 +971,22 @@ void ContentClient::clear_cache() {
 }
 
 void ContentClient::set_cache_ttl(std::chrono::seconds ttl) {
-    pimpl_->cache_ttl = ttl;
+    pimpl_->cache.set_ttl(ttl);
+}
+
+nlohmann::json ContentClient::get_cache_statistics() const {
+    auto stats = pimpl_->cache.get_statistics();
+    stats["enabled"] = pimpl_->cache_enabled.load();
+    return stats;
 }
 
-const ContentClient::ClientStatistics& ContentClient::get_client_statistics() const {
+ContentClient::ClientStatistics ContentClient::get_client_statistics() const {
+    std::lock_guard<std::mutex> lock(pimpl_->stats_mutex);
     return pimpl_->stats;
 }
 
 void ContentClient::reset_client_statistics() {
+    std::lock_guard<std::mutex> lock(pimpl_->stats_mutex);
     pimpl_->stats.reset();
 }
 
@@ -679,6 +1015,7 @@ void ContentClient::handle_error(const std::string& error) {
 }
 
 void ContentClient::update_statistics(bool success, std::chrono::milliseconds response_time) {
+    std::lock_guard<std::mutex> lock(pimpl_->stats_mutex);
     pimpl_->stats.total_requests++;
     if (success) {
         pimpl_->stats.successful_requests++;
@@ -688,22 +1025,38 @@ void ContentClient::update_statistics(bool success, std::chrono::milliseconds re
     pimpl_->stats.total_response_time += response_time;
 }
 
+void ContentClient::record_cache_lookup(bool hit) {
+    std::lock_guard<std::mutex> lock(pimpl_->stats_mutex);
+    if (hit) {
+        pimpl_->stats.cache_hits++;
+    } else {
+        pimpl_->stats.cache_misses++;
+    }
+}
+
 template<typename T>
 std::optional<T> ContentClient::get_from_cache(const std::string& key) {
     if (!pimpl_->cache_enabled) {
         return std::nullopt;
     }
     
-    auto it = pimpl_->cache.find(key);
-    if (it != pimpl_->cache.end() && pimpl_->is_cache_valid(it->second)) {
-        try {
+    auto cached = pimpl_->cache.get(key);
+    if (!cached) {
+        return std::nullopt;
+    }
+    
+    try {
+        if constexpr (std::is_same_v<T, nlohmann::json>) {
+            return cached;
+        } else if constexpr (std::is_same_v<T, ContentItem>) {
+            return ContentItem::from_json(*cached);
+        } else {
             T value;
-            // 这里需要根据T的类型进行适当的反序列化
-            // 简化实现，假设T有from_json方法
+            value.from_json(*cached);
             return value;
-        } catch (const std::exception&) {
-            pimpl_->cache.erase(it);
         }
+    } catch (const std::exception&) {
+        pimpl_->cache.erase(key);
     }
     
     return std::nullopt;
@@ -716,12 +1069,11 @@ void ContentClient::put_to_cache(const std::string& key, const T& value) {
     }
     
     try {
-        Impl::CacheEntry entry;
-        // 这里需要根据T的类型进行适当的序列化
-        // 简化实现，假设T有to_json方法
-        (void)value; // 避免未使用参数警告
-        entry.timestamp = std::chrono::steady_clock::now();
-        pimpl_->cache[key] = entry;
+        if constexpr (std::is_same_v<T, nlohmann::json>) {
+            pimpl_->cache.put(key, value);
+        } else {
+            pimpl_->cache.put(key, value.to_json());
+        }
     } catch (const std::exception& e) {
         spdlog::warn("Failed to cache value: {}", e.what());
     }
@@ -6,6 +6,8 @@
 #include <regex>
 #include <sstream>
 #include <iomanip>
+#include <mutex>
+#include <vector>
 
 namespace mcp {
 
@@ -70,82 +72,139 @@ nlohmann::json HttpClient::Statistics::to_json() const {
 // HttpClient::Impl类
 class HttpClient::Impl {
 public:
+    struct Target {
+        std::string scheme;
+        std::string host;
+        int port = 80;
+        std::string origin; // scheme://host:port，连接池按此分组
+        std::string path;
+    };
+    
+    // 保护config、stats、last_error和空闲连接池；请求本身在锁外执行
+    mutable std::mutex mutex;
     HttpRequestConfig config;
-    std::unique_ptr<httplib::Client> client;
     std::string last_error;
     Statistics stats;
     
+    // 按origin缓存的空闲keep-alive连接，每个连接同一时刻只被一个请求使用
+    std::map<std::string, std::vector<std::unique_ptr<httplib::Client>>> idle_clients;
+    // 配置变化时递增，旧配置创建的连接归还时直接丢弃
+    uint64_t pool_generation = 0;
+    
     explicit Impl(const HttpRequestConfig& cfg) : config(cfg) {
-        // httplib客户端将在第一次请求时创建
+        // httplib客户端在第一次请求对应origin时创建
     }
     
-    std::unique_ptr<httplib::Client> create_client(const std::string& url) {
-        // 解析URL
-        std::regex url_regex(R"(^(https?)://([^:/]+)(?::(\d+))?(.*)$)");
+    static Target parse_url(const std::string& url) {
+        static const std::regex url_regex(R"(^(https?)://([^:/?#]+)(?::(\d+))?([^#]*)$)");
         std::smatch matches;
         
         if (!std::regex_match(url, matches, url_regex)) {
             throw std::runtime_error("Invalid URL: " + url);
         }
         
-        std::string scheme = matches[1].str();
-        std::string host = matches[2].str();
-        std::string port_str = matches[3].str();
-        
-        int port = 80;
-        if (scheme == "https") {
-            port = 443;
+        Target target;
+        target.scheme = matches[1].str();
+        target.host = matches[2].str();
+        target.port = target.scheme == "https" ? 443 : 80;
+        if (matches[3].matched) {
+            target.port = std::stoi(matches[3].str());
         }
-        if (!port_str.empty()) {
-            port = std::stoi(port_str);
+        target.path = matches[4].str();
+        if (target.path.empty() || target.path[0] != '/') {
+            target.path = "/" + target.path;
         }
-        
-        auto client = std::make_unique<httplib::Client>(host, port);
+        target.origin = target.scheme + "://" + target.host + ":" + std::to_string(target.port);
+        return target;
+    }
+    
+    // 配置变化后调用，清空空闲连接
+    void clear_pool_locked() {
+        idle_clients.clear();
+        pool_generation++;
+    }
+    
+    std::unique_ptr<httplib::Client> acquire_client(const Target& target, const HttpRequestConfig& cfg,
+                                                    uint64_t& generation) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            generation = pool_generation;
+            auto it = idle_clients.find(target.origin);
+            if (it != idle_clients.end() && !it->second.empty()) {
+                auto client = std::move(it->second.back());
+                it->second.pop_back();
+                return client;
+            }
+        }
+        return create_client(target, cfg);
+    }
+    
+    void release_client(const Target& target, std::unique_ptr<httplib::Client> client,
+                        uint64_t generation, size_t max_idle) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (generation != pool_generation) {
+            return;
+        }
+        auto& idle = idle_clients[target.origin];
+        if (idle.size() < max_idle) {
+            idle.push_back(std::move(client));
+        }
+    }
+    
+    std::unique_ptr<httplib::Client> create_client(const Target& target, const HttpRequestConfig& cfg) const {
+        auto client = std::make_unique<httplib::Client>(target.host, target.port);
         
         // 配置客户端
-        client->set_connection_timeout(config.timeout);
-        client->set_read_timeout(config.timeout);
-        client->set_write_timeout(config.timeout);
+        client->set_connection_timeout(cfg.timeout);
+        client->set_read_timeout(cfg.timeout);
+        client->set_write_timeout(cfg.timeout);
+        client->set_keep_alive(cfg.keep_alive);
         
-        if (scheme == "https") {
-            client->enable_server_certificate_verification(config.verify_ssl);
+        if (target.scheme == "https") {
+            client->enable_server_certificate_verification(cfg.verify_ssl);
         }
         
-        if (config.follow_redirects) {
+        if (cfg.follow_redirects) {
             client->set_follow_location(true);
         }
         
-        if (config.enable_compression) {
+        if (cfg.enable_compression) {
             client->set_compress(true);
         }
         
         // 设置代理
-        if (!config.proxy_host.empty() && config.proxy_port > 0) {
-            client->set_proxy(config.proxy_host, config.proxy_port);
-            if (!config.proxy_username.empty()) {
-                client->set_proxy_basic_auth(config.proxy_username, config.proxy_password);
+        if (!cfg.proxy_host.empty() && cfg.proxy_port > 0) {
+            client->set_proxy(cfg.proxy_host, cfg.proxy_port);
+            if (!cfg.proxy_username.empty()) {
+                client->set_proxy_basic_auth(cfg.proxy_username, cfg.proxy_password);
             }
         }
         
         return client;
     }
     
+    HttpRequestConfig config_snapshot() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return config;
+    }
+    
     HttpResponse execute_with_retry(std::function<HttpResponse()> request_func) {
+        const auto cfg = config_snapshot();
         HttpResponse response;
         int attempts = 0;
         
         do {
             response = request_func();
             
-            if (response.success || attempts >= config.max_retries) {
+            if (response.success || attempts >= cfg.max_retries) {
                 break;
             }
             
             attempts++;
-            spdlog::warn("HTTP request failed, retrying... ({}/{})", attempts, config.max_retries);
-            std::this_thread::sleep_for(config.retry_delay);
+            spdlog::warn("HTTP request failed, retrying... ({}/{})", attempts, cfg.max_retries);
+            std::this_thread::sleep_for(cfg.retry_delay);
             
-        } while (attempts <= config.max_retries);
+        } while (attempts <= cfg.max_retries);
         
         return response;
     }
@@ -221,7 +280,9 @@ HttpResponse HttpClient::request(const std::string& method, const std::string& u
 }
 
 void HttpClient::set_config(const HttpRequestConfig& config) {
+    std::lock_guard<std::mutex> lock(pimpl_->mutex);
     pimpl_->config = config;
+    pimpl_->clear_pool_locked();
 }
 
 const HttpRequestConfig& HttpClient::get_config() const {
@@ -229,20 +290,26 @@ const HttpRequestConfig& HttpClient::get_config() const {
 }
 
 void HttpClient::set_header(const std::string& name, const std::string& value) {
+    std::lock_guard<std::mutex> lock(pimpl_->mutex);
     pimpl_->config.headers[name] = value;
 }
 
 void HttpClient::remove_header(const std::string& name) {
+    std::lock_guard<std::mutex> lock(pimpl_->mutex);
     pimpl_->config.headers.erase(name);
 }
 
 void HttpClient::clear_headers() {
+    std::lock_guard<std::mutex> lock(pimpl_->mutex);
     pimpl_->config.headers.clear();
 }
 
 void HttpClient::set_bearer_token(const std::string& token) {
-    pimpl_->config.auth_token = token;
-    pimpl_->config.auth_type = "Bearer";
+    {
+        std::lock_guard<std::mutex> lock(pimpl_->mutex);
+        pimpl_->config.auth_token = token;
+        pimpl_->config.auth_type = "Bearer";
+    }
     set_header("Authorization", "Bearer " + token);
 }
 
@@ -253,47 +320,77 @@ void HttpClient::set_basic_auth(const std::string& username, const std::string&
 }
 
 void HttpClient::clear_auth() {
-    pimpl_->config.auth_token.clear();
+    {
+        std::lock_guard<std::mutex> lock(pimpl_->mutex);
+        pimpl_->config.auth_token.clear();
+    }
     remove_header("Authorization");
 }
 
+// 以下设置作用于连接本身，修改后丢弃已建立的连接
 void HttpClient::set_timeout(std::chrono::seconds timeout) {
+    std::lock_guard<std::mutex> lock(pimpl_->mutex);
     pimpl_->config.timeout = timeout;
+    pimpl_->clear_pool_locked();
 }
 
 void HttpClient::set_proxy(const std::string& host, int port, 
                           const std::string& username, 
                           const std::string& password) {
+    std::lock_guard<std::mutex> lock(pimpl_->mutex);
     pimpl_->config.proxy_host = host;
     pimpl_->config.proxy_port = port;
     pimpl_->config.proxy_username = username;
     pimpl_->config.proxy_password = password;
+    pimpl_->clear_pool_locked();
 }
 
 void HttpClient::clear_proxy() {
+    std::lock_guard<std::mutex> lock(pimpl_->mutex);
     pimpl_->config.proxy_host.clear();
     pimpl_->config.proxy_port = 0;
     pimpl_->config.proxy_username.clear();
     pimpl_->config.proxy_password.clear();
+    pimpl_->clear_pool_locked();
 }
 
 void HttpClient::set_ssl_verification(bool verify) {
+    std::lock_guard<std::mutex> lock(pimpl_->mutex);
     pimpl_->config.verify_ssl = verify;
+    pimpl_->clear_pool_locked();
+}
+
+void HttpClient::close_idle_connections() {
+    std::lock_guard<std::mutex> lock(pimpl_->mutex);
+    pimpl_->clear_pool_locked();
+}
+
+size_t HttpClient::idle_connection_count() const {
+    std::lock_guard<std::mutex> lock(pimpl_->mutex);
+    size_t count = 0;
+    for (const auto& [origin, clients] : pimpl_->idle_clients) {
+        count += clients.size();
+    }
+    return count;
 }
 
 std::string HttpClient::get_last_error() const {
+    std::lock_guard<std::mutex> lock(pimpl_->mutex);
     return pimpl_->last_error;
 }
 
 void HttpClient::clear_error() {
+    std::lock_guard<std::mutex> lock(pimpl_->mutex);
     pimpl_->last_error.clear();
 }
 
-const HttpClient::Statistics& HttpClient::get_statistics() const {
+HttpClient::Statistics HttpClient::get_statistics() const {
+    std::lock_guard<std::mutex> lock(pimpl_->mutex);
     return pimpl_->stats;
 }
 
 void HttpClient::reset_statistics() {
+    std::lock_guard<std::mutex> lock(pimpl_->mutex);
     pimpl_->stats.reset();
 }
 
@@ -304,28 +401,21 @@ HttpResponse HttpClient::execute_request(const std::string& method, const std::s
     auto start_time = std::chrono::steady_clock::now();
     
     try {
-        auto client = pimpl_->create_client(url);
-        
-        // 解析URL路径
-        std::regex url_regex(R"(^https?://[^/]+(.*)$)");
-        std::smatch matches;
-        std::string path = "/";
+        const auto target = Impl::parse_url(url);
+        const auto config = pimpl_->config_snapshot();
+        const std::string& path = target.path;
         
-        if (std::regex_match(url, matches, url_regex)) {
-            path = matches[1].str();
-            if (path.empty()) {
-                path = "/";
-            }
-        }
+        uint64_t generation = 0;
+        auto client = pimpl_->acquire_client(target, config, generation);
         
         // 准备头部
         httplib::Headers http_headers;
         
         // 添加默认头部
-        http_headers.emplace("User-Agent", pimpl_->config.user_agent);
+        http_headers.emplace("User-Agent", config.user_agent);
         
         // 添加配置中的头部
-        for (const auto& [key, value] : pimpl_->config.headers) {
+        for (const auto& [key, value] : config.headers) {
             http_headers.emplace(key, value);
         }
         
@@ -367,6 +457,9 @@ HttpResponse HttpClient::execute_request(const std::string& method, const std::s
             for (const auto& [key, value] : result->headers) {
                 response.headers[key] = value;
             }
+            
+            // 只有成功完成的连接放回连接池，出错的连接状态不确定，直接丢弃
+            pimpl_->release_client(target, std::move(client), generation, config.max_connections_per_host);
         } else {
             response.success = false;
             response.error_message = "HTTP request failed: " + httplib::to_string(result.error());
@@ -383,7 +476,10 @@ HttpResponse HttpClient::execute_request(const std::string& method, const std::s
     }
     
     // 更新统计信息
-    pimpl_->stats.update(response);
+    {
+        std::lock_guard<std::mutex> lock(pimpl_->mutex);
+        pimpl_->stats.update(response);
+    }
     
     return response;
 }
@@ -404,7 +500,10 @@ HttpResponse HttpClient::handle_response(int status_code, const std::string& bod
 }
 
 void HttpClient::handle_error(const std::string& error) {
-    pimpl_->last_error = error;
+    {
+        std::lock_guard<std::mutex> lock(pimpl_->mutex);
+        pimpl_->last_error = error;
+    }
     spdlog::error("HTTP Client Error: {}", error);
 }
 
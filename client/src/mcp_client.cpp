@@ -1,10 +1,14 @@
 #include "mcp_client.hpp"
 #include "http_client.hpp"
+#include "task_executor.hpp"
 #include <spdlog/spdlog.h>
+#include <atomic>
+#include <mutex>
 #include <random>
 #include <thread>
 #include <future>
 #include <fstream>
+#include <unordered_map>
 
 namespace mcp {
 
@@ -55,30 +59,71 @@ class MCPClient::Impl {
 public:
     MCPClientConfig config;
     std::unique_ptr<HttpClient> http_client;
+    mutable std::mutex error_mutex;
     std::string last_error;
-    bool connected = false;
+    std::atomic<bool> connected{false};
     ErrorCallback error_callback;
     ResponseCallback response_callback;
     
-    // 请求ID生成
-    std::random_device rd;
-    std::mt19937 gen;
+    // 批量请求的id从随机起点递增，保证批内唯一
+    std::atomic<int64_t> next_batch_id;
+    
+    // 异步请求的执行器，首次使用时创建；最后声明，析构时先等待未完成的任务
+    std::once_flag executor_once;
+    std::unique_ptr<TaskExecutor> executor;
     
-    Impl(const MCPClientConfig& cfg) : config(cfg), gen(rd()) {
+    Impl(const MCPClientConfig& cfg) : config(cfg) {
+        std::random_device rd;
+        next_batch_id = std::uniform_int_distribution<int64_t>(1000000, 9999999)(rd);
+        http_client = std::make_unique<HttpClient>(make_http_config(config));
+    }
+    
+    static HttpRequestConfig make_http_config(const MCPClientConfig& config) {
         HttpRequestConfig http_config;
         http_config.timeout = std::chrono::seconds(config.timeout_seconds);
         http_config.user_agent = config.user_agent;
+        http_config.max_connections_per_host = static_cast<size_t>(std::max(1, config.max_connections));
         
         if (!config.auth_token.empty()) {
             http_config.headers[config.auth_header] = config.auth_token;
         }
-        
-        http_client = std::make_unique<HttpClient>(http_config);
+        return http_config;
+    }
+    
+    TaskExecutor& get_executor() {
+        std::call_once(executor_once, [this]() {
+            executor = std::make_unique<TaskExecutor>(static_cast<size_t>(std::max(1, config.async_threads)));
+        });
+        return *executor;
+    }
+    
+    void set_last_error(const std::string& error) {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        last_error = error;
     }
     
-    std::string generate_request_id() {
-        std::uniform_int_distribution<> dis(1000000, 9999999);
-        return std::to_string(dis(gen));
+    // POST到MCP端点，失败时按配置重试
+    HttpResponse post_with_retry(const std::string& body) {
+        const std::string url = build_url();
+        HttpResponse http_response;
+        int retries = 0;
+        
+        do {
+            http_response = http_client->post(url, body, "application/json");
+            
+            if (http_response.is_success()) {
+                break;
+            }
+            
+            if (retries < config.max_retries) {
+                spdlog::warn("Request failed, retrying... ({}/{})", retries + 1, config.max_retries);
+                std::this_thread::sleep_for(std::chrono::milliseconds(config.retry_delay_ms));
+            }
+            
+            retries++;
+        } while (retries <= config.max_retries);
+        
+        return http_response;
     }
     
     std::string build_url(const std::string& endpoint = "") const {
@@ -111,7 +156,12 @@ MCPClient::MCPClient(const MCPClientConfig& config)
     }
 }
 
-MCPClient::~MCPClient() = default;
+MCPClient::~MCPClient() {
+    // 先等待进行中的异步请求结束，它们仍会访问http_client和回调
+    if (pimpl_) {
+        pimpl_->executor.reset();
+    }
+}
 
 MCPClient::MCPClient(MCPClient&&) noexcept = default;
 MCPClient& MCPClient::operator=(MCPClient&&) noexcept = default;
@@ -126,15 +176,13 @@ bool MCPClient::connect() {
             spdlog::info("Connected to MCP server at {}:{}", 
                         pimpl_->config.server_host, pimpl_->config.server_port);
         } else {
-            pimpl_->last_error = "Failed to connect to server: " + response.error_message;
-            handle_error(pimpl_->last_error);
+            handle_error("Failed to connect to server: " + response.error_message);
         }
         
         return pimpl_->connected;
         
     } catch (const std::exception& e) {
-        pimpl_->last_error = "Connection error: " + std::string(e.what());
-        handle_error(pimpl_->last_error);
+        handle_error("Connection error: " + std::string(e.what()));
         return false;
     }
 }
@@ -177,26 +225,8 @@ MCPResponse MCPClient::send_request(const nlohmann::json& request) {
     MCPResponse mcp_response;
     
     try {
-        std::string url = pimpl_->build_url();
-        
         // 执行HTTP请求，支持重试
-        HttpResponse http_response;
-        int retries = 0;
-        
-        do {
-            http_response = pimpl_->http_client->post(url, request);
-            
-            if (http_response.is_success()) {
-                break;
-            }
-            
-            if (retries < pimpl_->config.max_retries) {
-                spdlog::warn("Request failed, retrying... ({}/{})", retries + 1, pimpl_->config.max_retries);
-                std::this_thread::sleep_for(std::chrono::milliseconds(pimpl_->config.retry_delay_ms));
-            }
-            
-            retries++;
-        } while (retries <= pimpl_->config.max_retries);
+        auto http_response = pimpl_->post_with_retry(request.dump());
         
         mcp_response = parse_response(http_response.body);
         
@@ -218,19 +248,88 @@ MCPResponse MCPClient::send_request(const nlohmann::json& request) {
     return mcp_response;
 }
 
-void MCPClient::set_config(const MCPClientConfig& config) {
-    pimpl_->config = config;
+std::vector<MCPResponse> MCPClient::send_batch(const std::vector<nlohmann::json>& requests) {
+    std::vector<MCPResponse> responses(requests.size());
+    if (requests.empty()) {
+        return responses;
+    }
     
-    // 更新HTTP客户端配置
-    HttpRequestConfig http_config;
-    http_config.timeout = std::chrono::seconds(config.timeout_seconds);
-    http_config.user_agent = config.user_agent;
+    auto fail_all = [&responses](int code, const std::string& message) {
+        for (auto& response : responses) {
+            response.success = false;
+            response.error_code = code;
+            response.error_message = message;
+        }
+    };
     
-    if (!config.auth_token.empty()) {
-        http_config.headers[config.auth_header] = config.auth_token;
+    try {
+        // 服务端可能按完成顺序返回，按id对应回原请求
+        nlohmann::json batch = nlohmann::json::array();
+        std::unordered_map<int64_t, size_t> index_by_id;
+        const int64_t first_id = pimpl_->next_batch_id.fetch_add(static_cast<int64_t>(requests.size()));
+        for (size_t i = 0; i < requests.size(); ++i) {
+            nlohmann::json request = requests[i];
+            const int64_t id = first_id + static_cast<int64_t>(i);
+            request["jsonrpc"] = "2.0";
+            request["id"] = id;
+            index_by_id[id] = i;
+            batch.push_back(std::move(request));
+        }
+        
+        auto http_response = pimpl_->post_with_retry(batch.dump());
+        if (!http_response.is_success()) {
+            const std::string message = "HTTP Error: " + std::to_string(http_response.status_code) + " - " + http_response.error_message;
+            fail_all(http_response.status_code, message);
+            handle_error(message);
+            return responses;
+        }
+        
+        auto json = nlohmann::json::parse(http_response.body);
+        if (!json.is_array()) {
+            // 整个批量请求被拒绝时服务端返回单个错误对象
+            MCPResponse error;
+            error.from_json(json);
+            fail_all(error.error_code != 0 ? error.error_code : -1,
+                     error.error_message.empty() ? "Invalid batch response" : error.error_message);
+            handle_error(responses.front().error_message);
+            return responses;
+        }
+        
+        std::vector<bool> answered(requests.size(), false);
+        for (const auto& item : json) {
+            if (!item.is_object() || !item.contains("id") || !item["id"].is_number_integer()) {
+                continue;
+            }
+            auto it = index_by_id.find(item["id"].get<int64_t>());
+            if (it == index_by_id.end()) {
+                continue;
+            }
+            responses[it->second].from_json(item);
+            answered[it->second] = true;
+        }
+        
+        for (size_t i = 0; i < responses.size(); ++i) {
+            if (!answered[i]) {
+                responses[i].success = false;
+                responses[i].error_code = -1;
+                responses[i].error_message = "No response for batch request";
+            }
+            handle_response(responses[i]);
+        }
+        
+    } catch (const std::exception& e) {
+        fail_all(-1, "Batch request failed: " + std::string(e.what()));
+        handle_error(responses.front().error_message);
     }
     
-    pimpl_->http_client->set_config(http_config);
+    return responses;
+}
+
+void MCPClient::set_config(const MCPClientConfig& config) {
+    pimpl_->config = config;
+    
+    // 更新HTTP客户端配置；异步线程数只在执行器创建前生效
+    pimpl_->http_client->set_config(Impl::make_http_config(config));
 }
 
 const MCPClientConfig& MCPClient::get_config() const {
@@ -238,10 +337,12 @@ const MCPClientConfig& MCPClient::get_config() const {
 }
 
 std::string MCPClient::get_last_error() const {
+    std::lock_guard<std::mutex> lock(pimpl_->error_mutex);
     return pimpl_->last_error;
 }
 
 void MCPClient::clear_error() {
+    std::lock_guard<std::mutex> lock(pimpl_->error_mutex);
     pimpl_->last_error.clear();
 }
 
@@ -254,12 +355,16 @@ void MCPClient::set_response_callback(ResponseCallback callback) {
 }
 
 void MCPClient::send_request_async(const nlohmann::json& request, ResponseCallback callback) {
-    std::thread([this, request, callback]() {
+    pimpl_->get_executor().submit([this, request, callback = std::move(callback)]() {
         auto response = send_request(request);
         if (callback) {
             callback(response);
         }
-    }).detach();
+    });
+}
+
+std::future<MCPResponse> MCPClient::send_request_async(const nlohmann::json& request) {
+    return pimpl_->get_executor().run([this, request]() { return send_request(request); });
 }
 
 std::string MCPClient::build_server_url(const std::string& host, int port, bool ssl) {
@@ -283,7 +388,7 @@ nlohmann::json MCPClient::create_mcp_request(const std::string& method, const nl
 }
 
 void MCPClient::handle_error(const std::string& error) {
-    pimpl_->last_error = error;
+    pimpl_->set_last_error(error);
     spdlog::error("MCP Client Error: {}", error);
     
     if (pimpl_->error_callback) {
@@ -437,6 +542,12 @@ MCPClientConfig load_config_from_json(const nlohmann::json& json) {
         if (json.contains("log_level")) {
             config.log_level = json["log_level"].get<std::string>();
         }
+        if (json.contains("async_threads")) {
+            config.async_threads = json["async_threads"].get<int>();
+        }
+        if (json.contains("max_connections")) {
+            config.max_connections = json["max_connections"].get<int>();
+        }
     } catch (const std::exception& e) {
         spdlog::error("Failed to parse config JSON: {}", e.what());
     }
@@ -459,6 +570,8 @@ bool save_config_to_file(const MCPClientConfig& config, const std::string& file_
         json["retry_delay_ms"] = config.retry_delay_ms;
         json["enable_logging"] = config.enable_logging;
         json["log_level"] = config.log_level;
+        json["async_threads"] = config.async_threads;
+        json["max_connections"] = config.max_connections;
         
         std::ofstream file(file_path);
         if (file.is_open()) {
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+namespace mcp {
+
+// 响应体编码；各编码只在构建时找到对应的库才可用
+enum class ContentEncoding {
+    Identity,
+    Gzip,
+    Brotli,
+    Zstd
+};
+
+// 按Accept-Encoding选择本构建支持且客户端接受的编码：q=0视为拒绝，
+// 未列出的编码取*的q值，q值相同时依次优先zstd、br、gzip
+ContentEncoding negotiate_encoding(const std::string& accept_encoding);
+
+// Content-Encoding头使用的名称，Identity返回空串
+const char* encoding_name(ContentEncoding encoding);
+
+// 一次性压缩整个响应体并写入out；编码不可用或压缩失败时返回false
+// level为对应编码的压缩级别（gzip 1-9、brotli 0-11、zstd 1-22），0表示适合动态响应的默认级别
+bool compress_body(ContentEncoding encoding, const std::string& input, std::string& out, int level = 0);
+
+// 流式gzip压缩器，用于分块响应；构建时未启用zlib支持则available()返回false
+class GzipCompressor {
+public:
+    explicit GzipCompressor(int level = 6);
+    ~GzipCompressor();
+    
+    GzipCompressor(const GzipCompressor&) = delete;
+    GzipCompressor& operator=(const GzipCompressor&) = delete;
+    
+    static bool available();
+    
+    // 压缩一段数据并追加到out；finish为true时写出gzip尾部
+    bool compress(const char* data, size_t length, bool finish, std::string& out);
+    
+private:
+    class Impl;
+    std::unique_ptr<Impl> pimpl_;
+};
+
+} // namespace mcp
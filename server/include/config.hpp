@@ -19,9 +19,17 @@ public:
     // 服务器配置
     std::string get_host() const { return host_; }
     int get_port() const { return port_; }
+    int get_mcp_batch_workers() const { return mcp_batch_workers_; }
     
     // 数据库配置
     std::string get_database_path() const { return database_path_; }
+    int get_database_reader_connections() const { return database_reader_connections_; }
+    int get_database_busy_timeout_ms() const { return database_busy_timeout_ms_; }
+    int64_t get_database_mmap_size() const { return database_mmap_size_; }
+    int get_database_search_count_cache_size() const { return database_search_count_cache_size_; }
+    int get_database_write_batch_size() const { return database_write_batch_size_; }
+    int get_content_cache_mb() const { return content_cache_mb_; }
+    int get_content_cache_shards() const { return content_cache_shards_; }
     
     // 日志配置
     std::string get_log_level() const { return log_level_; }
@@ -39,12 +47,22 @@ public:
     // 静态文件配置
     std::string get_static_files_path() const { return static_files_path_; }
     bool is_static_files_enabled() const { return enable_static_files_; }
+    int get_static_files_cache_mb() const { return static_files_cache_mb_; }
+    
+    // 响应压缩配置
+    bool is_compression_enabled() const { return enable_compression_; }
+    int get_compression_min_bytes() const { return compression_min_bytes_; }
     
     // 文件上传配置
     std::string get_upload_path() const { return upload_path_; }
     int get_max_file_size() const { return max_file_size_; }
     std::vector<std::string> get_allowed_file_types() const { return allowed_file_types_; }
     bool is_file_upload_enabled() const { return enable_file_upload_; }
+    int get_parse_chunk_size() const { return parse_chunk_size_; }
+    
+    // 后台任务配置
+    int get_jobs_worker_threads() const { return jobs_worker_threads_; }
+    int get_jobs_queue_capacity() const { return jobs_queue_capacity_; }
     
     // LLaMA.cpp配置
     std::string get_llama_model_path() const { return llama_model_path_; }
@@ -53,6 +71,17 @@ public:
     int get_llama_threads() const { return llama_threads_; }
     float get_llama_temperature() const { return llama_temperature_; }
     int get_llama_max_tokens() const { return llama_max_tokens_; }
+    std::string get_llama_server_url() const { return llama_server_url_; }
+    int get_llama_server_port() const { return llama_server_port_; }
+    int get_llama_startup_timeout() const { return llama_startup_timeout_; }
+    int get_llama_request_timeout() const { return llama_request_timeout_; }
+    int get_llama_parallel_slots() const { return llama_parallel_slots_; }
+    int get_llama_queue_capacity() const { return llama_queue_capacity_; }
+    bool is_llama_cache_enabled() const { return llama_cache_enabled_; }
+    int get_llama_cache_memory_mb() const { return llama_cache_memory_mb_; }
+    std::string get_llama_cache_disk_path() const { return llama_cache_disk_path_; }
+    int get_llama_cache_disk_mb() const { return llama_cache_disk_mb_; }
+    int get_llama_cache_ttl() const { return llama_cache_ttl_; }
     bool is_llama_enabled() const { return enable_llama_; }
     
     // Ollama配置
@@ -62,8 +91,15 @@ public:
     float get_ollama_temperature() const { return ollama_temperature_; }
     int get_ollama_max_tokens() const { return ollama_max_tokens_; }
     int get_ollama_timeout() const { return ollama_timeout_; }
+    int get_ollama_models_cache_ttl() const { return ollama_models_cache_ttl_; }
     bool is_ollama_enabled() const { return enable_ollama_; }
     
+    // 语义检索配置
+    std::string get_embedding_provider() const { return embedding_provider_; }
+    std::string get_embedding_model() const { return embedding_model_; }
+    std::string get_embedding_format() const { return embedding_format_; }
+    int get_embedding_max_chars() const { return embedding_max_chars_; }
+    
     // 服务端配置管理
     bool update_config(const nlohmann::json& new_config);
     bool save_config_to_file(const std::string& config_path) const;
@@ -85,9 +121,17 @@ private:
     // 服务器配置
     std::string host_ = "127.0.0.1";
     int port_ = 8086;
+    int mcp_batch_workers_ = 4; // 并行执行JSON-RPC批量请求的线程数
     
     // 数据库配置
     std::string database_path_ = "./data/content.db";
+    int database_reader_connections_ = 0; // 0表示按CPU核数自动设置
+    int database_busy_timeout_ms_ = 5000;
+    int64_t database_mmap_size_ = 256LL * 1024 * 1024; // 256MB
+    int database_search_count_cache_size_ = 256;
+    int database_write_batch_size_ = 500; // 批量导入时每个事务的条目数
+    int content_cache_mb_ = 32;           // get_content响应缓存容量，0表示禁用
+    int content_cache_shards_ = 16;
     
     // 日志配置
     std::string log_level_ = "info";
@@ -103,22 +147,44 @@ private:
     std::string cors_origin_ = "*";
     
     // 静态文件配置
-    std::string static_files_path_ = "./web";
+    std::string static_files_path_ = "./web/build";
     bool enable_static_files_ = true;
+    int static_files_cache_mb_ = 64; // 启动时预加载到内存的静态文件总大小上限
+    
+    // 响应压缩配置
+    bool enable_compression_ = true;
+    int compression_min_bytes_ = 1024; // 小于该字节数的响应不压缩
     
     // 文件上传配置
     std::string upload_path_ = "./uploads";
     int max_file_size_ = 10 * 1024 * 1024; // 10MB
     std::vector<std::string> allowed_file_types_ = {".txt", ".md", ".pdf", ".doc", ".docx", ".jpg", ".png", ".gif"};
     bool enable_file_upload_ = true;
+    int parse_chunk_size_ = 0; // 文档解析分块字节数，0表示按llama_context_size估算
+    
+    // 后台任务配置
+    int jobs_worker_threads_ = 2;   // 后台任务工作线程数，与HTTP线程池相互独立
+    int jobs_queue_capacity_ = 100; // 排队中的任务上限，超出时拒绝提交
     
     // LLaMA.cpp配置
     std::string llama_model_path_ = "";
-    std::string llama_executable_path_ = "./llama.cpp/main";
+    std::string llama_executable_path_ = "./llama.cpp/llama-server";
     int llama_context_size_ = 2048;
     int llama_threads_ = 4;
     float llama_temperature_ = 0.7f;
     int llama_max_tokens_ = 512;
+    std::string llama_server_url_ = ""; // 非空时连接已运行的llama-server，不再自行启动
+    int llama_server_port_ = 8090;      // 自行启动llama-server时监听的本地端口
+    int llama_startup_timeout_ = 120;   // 等待模型加载完成的秒数
+    int llama_request_timeout_ = 300;
+    int llama_parallel_slots_ = 2;       // 并发生成的槽位数，对应llama-server的-np
+    int llama_queue_capacity_ = 64;      // 等待中的生成请求上限，超出时直接拒绝
+    // 生成结果缓存，只用于确定性（temperature<=0）或显式声明cache的请求
+    bool llama_cache_enabled_ = true;
+    int llama_cache_memory_mb_ = 64;
+    std::string llama_cache_disk_path_ = "./cache/llama"; // 为空时只使用内存缓存
+    int llama_cache_disk_mb_ = 256;
+    int llama_cache_ttl_ = 86400;        // 秒
     bool enable_llama_ = false;
     
     // Ollama配置
@@ -128,8 +194,15 @@ private:
     float ollama_temperature_ = 0.7f;
     int ollama_max_tokens_ = 512;
     int ollama_timeout_ = 30;
+    int ollama_models_cache_ttl_ = 30; // 模型列表缓存秒数，0表示不缓存
     bool enable_ollama_ = false;
     
+    // 语义检索配置
+    std::string embedding_provider_ = "";           // ollama或llama，为空时不计算向量
+    std::string embedding_model_ = "nomic-embed-text"; // Ollama嵌入模型，llama时使用已加载的模型
+    std::string embedding_format_ = "int8";         // 向量存储格式：int8或f16
+    int embedding_max_chars_ = 8000;                // 计算向量时截取的最大字符数
+    
     // 辅助方法
     void load_defaults();
     void apply_config(const nlohmann::json& config);
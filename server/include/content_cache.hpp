@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace mcp {
+
+// 缓存的单条内容：已序列化的get_content响应和资源读取使用的正文
+struct CachedContent {
+    std::string response;
+    std::string content;
+
+    size_t size() const { return response.size() + content.size(); }
+};
+
+// 按内容ID分片的LRU缓存，容量按字节计算（平均分配到各分片）
+// 值为不可变的shared_ptr，命中时调用方无需复制即可持有
+class ContentCache {
+public:
+    ContentCache(size_t capacity_bytes, size_t shards);
+
+    ContentCache(const ContentCache&) = delete;
+    ContentCache& operator=(const ContentCache&) = delete;
+
+    // 未命中时返回nullptr，并通过version返回所在分片的失效版本号，
+    // 调用方读库后连同version一起put，期间发生过失效则丢弃，避免写回过期数据
+    std::shared_ptr<const CachedContent> get(int64_t id, uint64_t& version);
+    void put(int64_t id, std::shared_ptr<const CachedContent> value, uint64_t version);
+    void invalidate(int64_t id);
+    void clear();
+
+    nlohmann::json get_statistics() const;
+
+private:
+    struct Shard {
+        using Entry = std::pair<int64_t, std::shared_ptr<const CachedContent>>;
+
+        mutable std::mutex mutex;
+        std::list<Entry> lru; // 表头为最近使用
+        std::unordered_map<int64_t, std::list<Entry>::iterator> index;
+        size_t bytes = 0;
+        uint64_t version = 0;
+
+        // 统计信息
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+    };
+
+    size_t shard_capacity_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+
+    Shard& shard_for(int64_t id) const;
+    static void erase_locked(Shard& shard, std::unordered_map<int64_t, std::list<Shard::Entry>::iterator>::iterator it);
+};
+
+} // namespace mcp
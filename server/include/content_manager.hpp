@@ -1,7 +1,12 @@
 #pragma once
 
+#include "content_cache.hpp"
 #include "database.hpp"
+#include "semantic_index.hpp"
+#include <chrono>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 #include <nlohmann/json.hpp>
@@ -14,41 +19,142 @@ struct SearchResult {
     int total_count;
     int page;
     int page_size;
+    std::string next_cursor;  // 为空表示没有下一页
+    uint32_t fields = content_fields::kDefault;
     
     nlohmann::json to_json() const;
+    // 与to_json相同结构的紧凑JSON，直接追加到out
+    void append_json(std::string& out) const;
+};
+
+class ContentManager;
+
+// 增量导入会话：累积记录到一批后通过批量写入路径落库，用于NDJSON流式导入
+class ContentImportSession {
+public:
+    ContentImportSession(ContentManager& manager, size_t batch_size);
+    
+    // record_no用于错误报告（如NDJSON行号）
+    void add(size_t record_no, nlohmann::json record);
+    void add_error(size_t record_no, const std::string& message);
+    void flush();
+    
+    size_t processed() const { return processed_; }
+    size_t created() const { return created_; }
+    nlohmann::json summary() const;
+    
+private:
+    static constexpr size_t kMaxReportedErrors = 100;
+    
+    ContentManager& manager_;
+    size_t batch_size_;
+    nlohmann::json pending_ = nlohmann::json::array();
+    std::vector<size_t> pending_numbers_;
+    size_t processed_ = 0;
+    size_t created_ = 0;
+    size_t error_count_ = 0;
+    std::vector<std::string> errors_;
 };
 
 // 内容管理器
 class ContentManager {
 public:
-    explicit ContentManager(std::shared_ptr<Database> db);
+    // cache_bytes为get_content响应缓存的容量，0表示禁用
+    explicit ContentManager(std::shared_ptr<Database> db, size_t cache_bytes = 32 * 1024 * 1024,
+                            size_t cache_shards = 16);
+    
+    std::shared_ptr<Database> get_database() const { return db_; }
+    
+    // 启用语义检索；设置后内容写入会排队计算向量，应在开始处理请求前调用
+    void set_semantic_index(std::shared_ptr<SemanticIndex> index) { semantic_index_ = std::move(index); }
+    
+    // 字段投影：fields为逗号分隔的字段名（id,title,content,content_type,tags,metadata,
+    // created_at,updated_at,preview）或预设summary，为空时输出默认字段；id总是包含
+    static bool parse_fields(const std::string& spec, uint32_t& fields, std::string& error_msg);
     
     // 内容操作
     nlohmann::json create_content(const nlohmann::json& request);
-    nlohmann::json get_content(int64_t id);
+    nlohmann::json get_content(int64_t id, const std::string& fields = "");
+    // 返回缓存的序列化响应（与get_content的dump(2)一致），内容不存在时返回nullptr
+    std::shared_ptr<const CachedContent> get_cached_content(int64_t id);
     nlohmann::json update_content(int64_t id, const nlohmann::json& request);
     nlohmann::json delete_content(int64_t id);
     
     // 搜索和查询
-    nlohmann::json search_content(const std::string& query, int page = 1, int page_size = 20);
-    nlohmann::json get_content_by_tag(const std::string& tag, int page = 1, int page_size = 20);
-    nlohmann::json get_recent_content(int limit = 20);
-    nlohmann::json list_content(int page = 1, int page_size = 20);
+    // cursor非空时使用游标分页（忽略page），游标取自上一页结果的next_cursor
+    // 搜索结果的preview为匹配片段，其余列表为正文开头
+    nlohmann::json search_content(const std::string& query, int page = 1, int page_size = 20,
+                                  const std::string& cursor = "", const std::string& fields = "");
+    nlohmann::json get_content_by_tag(const std::string& tag, int page = 1, int page_size = 20,
+                                      const std::string& cursor = "", const std::string& fields = "");
+    nlohmann::json get_recent_content(int limit = 20, const std::string& fields = "");
+    nlohmann::json list_content(int page = 1, int page_size = 20,
+                                const std::string& cursor = "", const std::string& fields = "");
+    // 与上面的列表接口参数相同，但把响应直接序列化为紧凑JSON写入body，
+    // 不构造中间的nlohmann::json树；返回HTTP状态码
+    int search_content_serialized(const std::string& query, int page, int page_size,
+                                  const std::string& cursor, const std::string& fields, std::string& body);
+    int get_content_by_tag_serialized(const std::string& tag, int page, int page_size,
+                                      const std::string& cursor, const std::string& fields, std::string& body);
+    int list_content_serialized(int page, int page_size, const std::string& cursor,
+                                const std::string& fields, std::string& body);
+    // mode为vector时只按向量相似度排序，hybrid时与FTS关键词排名做倒数排名融合
+    nlohmann::json semantic_search(const std::string& query, int limit = 10,
+                                   const std::string& mode = "hybrid");
     
     // 统计和元数据
     nlohmann::json get_statistics();
+    // get_content响应缓存的命中统计，缓存禁用时返回null
+    nlohmann::json get_cache_statistics() const;
     nlohmann::json get_tags();
     
     // 批量操作
-    nlohmann::json bulk_create(const nlohmann::json& items);
+    // first_number为错误信息中第一条的序号，分批导入时保持序号连续
+    nlohmann::json bulk_create(const nlohmann::json& items, size_t first_number = 0);
     nlohmann::json bulk_delete(const std::vector<int64_t>& ids);
     
     // 导入导出
     nlohmann::json export_content(const std::string& format = "json");
+    // 流式导出：返回id大于after_id的下一批内容，为空表示已导出完毕
+    std::vector<ContentItem> export_content_chunk(int64_t after_id, int limit = 500);
+    // 按id升序返回摘要，用于资源列表分页
+    std::vector<ContentSummary> list_content_summaries(int64_t after_id, int limit);
+    
+    // 内容集合的变更版本号：每次创建、修改或删除后递增
+    uint64_t get_change_version() const;
+    // 等待版本号超过version，返回最新版本号；超时返回时可能等于version
+    uint64_t wait_for_change(uint64_t version, std::chrono::milliseconds timeout) const;
     nlohmann::json import_content(const nlohmann::json& data);
     
 private:
+    friend class ContentImportSession;
+    
     std::shared_ptr<Database> db_;
+    std::shared_ptr<SemanticIndex> semantic_index_;
+    std::unique_ptr<ContentCache> cache_;
+    
+    void invalidate_cached(int64_t id);
+    
+    mutable std::mutex change_mutex_;
+    mutable std::condition_variable change_cv_;
+    uint64_t change_version_ = 0;
+    
+    void notify_changed();
+    
+    // 校验并批量创建JSON数组中的条目，numbers为各条目对外报告的编号
+    void create_items(const nlohmann::json& items, const std::vector<size_t>& numbers,
+                      const std::string& label, std::vector<int64_t>& created_ids,
+                      std::vector<std::string>& errors);
+    
+    // 列表类查询的公共实现：成功时填充result，失败时error为错误响应
+    bool run_search(const std::string& query, int page, int page_size, const std::string& cursor,
+                    const std::string& fields, SearchResult& result, nlohmann::json& error);
+    bool run_tag_query(const std::string& tag, int page, int page_size, const std::string& cursor,
+                       const std::string& fields, SearchResult& result, nlohmann::json& error);
+    bool run_list(int page, int page_size, const std::string& cursor, const std::string& fields,
+                  SearchResult& result, nlohmann::json& error);
+    // 把查询结果或错误写成响应文本，返回HTTP状态码
+    int serialize_result(bool ok, const SearchResult& result, const nlohmann::json& error, std::string& body);
     
     // 辅助方法
     nlohmann::json create_error_response(const std::string& message, int code = 400);
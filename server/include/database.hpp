@@ -4,11 +4,36 @@
 #include <vector>
 #include <memory>
 #include <optional>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <unordered_map>
+#include <list>
+#include <utility>
+#include <cstdint>
 #include <sqlite3.h>
 #include <nlohmann/json.hpp>
 
 namespace mcp {
 
+// 内容字段投影，按位组合；列表查询只读取选中的大字段（正文、元数据、预览）
+namespace content_fields {
+constexpr uint32_t kId = 1u << 0;
+constexpr uint32_t kTitle = 1u << 1;
+constexpr uint32_t kContent = 1u << 2;
+constexpr uint32_t kContentType = 1u << 3;
+constexpr uint32_t kTags = 1u << 4;
+constexpr uint32_t kMetadata = 1u << 5;
+constexpr uint32_t kCreatedAt = 1u << 6;
+constexpr uint32_t kUpdatedAt = 1u << 7;
+constexpr uint32_t kPreview = 1u << 8; // 正文开头的预览，搜索结果中为匹配片段
+
+// 未指定字段时的输出
+constexpr uint32_t kDefault = kId | kTitle | kContent | kContentType | kTags | kMetadata | kCreatedAt | kUpdatedAt;
+// 列表摘要，不含正文和元数据
+constexpr uint32_t kSummary = kId | kTitle | kContentType | kTags | kUpdatedAt | kPreview;
+} // namespace content_fields
+
 // 内容项结构
 struct ContentItem {
     int64_t id;
@@ -19,15 +44,280 @@ struct ContentItem {
     std::string metadata; // JSON格式的元数据
     int64_t created_at;
     int64_t updated_at;
+    std::string preview;  // 只在投影包含kPreview时填充
     
-    nlohmann::json to_json() const;
+    // metadata保持原始字符串，只在fields包含kMetadata时才解析
+    nlohmann::json to_json(uint32_t fields = content_fields::kDefault) const;
+    // 与to_json输出相同的字段，直接以紧凑JSON追加到out；metadata原样写出，不解析
+    void append_json(std::string& out, uint32_t fields = content_fields::kDefault) const;
     static ContentItem from_json(const nlohmann::json& j);
 };
 
+// 内容摘要：只包含列表展示需要的列，不读取正文
+struct ContentSummary {
+    int64_t id = 0;
+    std::string title;
+    int64_t updated_at = 0;
+};
+
+// 预计算的内容统计，读取content_stats表，不扫描内容行
+struct ContentStats {
+    int64_t total_count = 0;
+    int64_t total_bytes = 0;
+    std::vector<std::pair<std::string, int64_t>> type_counts; // 按content_type排序
+    std::vector<std::pair<std::string, int64_t>> tag_counts;  // 按标签排序
+};
+
+// 上传文件信息
+struct FileInfo {
+    std::string id;
+    std::string filename;
+    std::string original_name;
+    std::string file_path;
+    std::string mime_type;
+    size_t file_size = 0;
+    std::string upload_time;
+    std::string description;
+    std::vector<std::string> tags;
+    std::string content_hash; // SHA-256十六进制摘要，旧数据可能为空
+    
+    nlohmann::json to_json() const;
+    void from_json(const nlohmann::json& j);
+};
+
+// 后台任务记录，status为queued/running/succeeded/failed/cancelled
+struct JobRecord {
+    std::string id;
+    std::string type;
+    std::string status;
+    double progress = 0.0; // 0~1
+    std::string message;
+    nlohmann::json params = nlohmann::json::object();
+    nlohmann::json result;
+    std::string error;
+    int64_t created_at = 0;
+    int64_t updated_at = 0;
+    
+    nlohmann::json to_json() const;
+};
+
+// 内容的嵌入向量；data按format（int8/f16）紧凑存储，int8需乘以scale还原
+struct ContentEmbedding {
+    int64_t content_id = 0;
+    std::string model;
+    std::string format;
+    int dimensions = 0;
+    float scale = 1.0f;
+    std::vector<uint8_t> data;
+    int64_t updated_at = 0; // 计算向量时内容的updated_at
+};
+
+// 键集分页游标：列表/标签按(updated_at, id)倒序，搜索按(rank, id)正序
+struct PageCursor {
+    int64_t updated_at = 0;
+    double rank = 0.0;
+    int64_t id = 0;
+};
+
+// 数据库选项
+struct DatabaseOptions {
+    size_t reader_connections = 4;    // 只读连接数量
+    int busy_timeout_ms = 5000;       // SQLITE_BUSY等待时间
+    int64_t mmap_size = 256LL * 1024 * 1024; // 内存映射大小
+    size_t search_count_cache_size = 256;     // 搜索结果计数缓存条目数，0表示禁用
+    size_t write_batch_size = 500;            // 批量写入时每个事务包含的条目数
+};
+
+class ConnectionPool;
+class StatementCache;
+
+// 预编译语句句柄，析构时重置并归还给缓存（未缓存的语句直接finalize）
+class Statement {
+public:
+    Statement() = default;
+    Statement(StatementCache* cache, sqlite3_stmt* stmt, bool cached);
+    ~Statement();
+    
+    Statement(const Statement&) = delete;
+    Statement& operator=(const Statement&) = delete;
+    Statement(Statement&& other) noexcept;
+    Statement& operator=(Statement&& other) noexcept;
+    
+    sqlite3_stmt* get() const { return stmt_; }
+    explicit operator bool() const { return stmt_ != nullptr; }
+    
+private:
+    StatementCache* cache_ = nullptr;
+    sqlite3_stmt* stmt_ = nullptr;
+    bool cached_ = false;
+    
+    void release();
+};
+
+// 写事务RAII封装：连接处于自动提交模式时开启BEGIN IMMEDIATE，
+// 已在事务中时使用SAVEPOINT嵌套；未commit即析构时回滚
+class Transaction {
+public:
+    explicit Transaction(sqlite3* db);
+    ~Transaction();
+    
+    Transaction(const Transaction&) = delete;
+    Transaction& operator=(const Transaction&) = delete;
+    
+    bool active() const { return active_; }
+    bool commit();
+    void rollback();
+    
+private:
+    sqlite3* db_;
+    bool nested_ = false;
+    bool active_ = false;
+};
+
+// 每个连接独享的预编译语句缓存，以SQL文本为键
+// 连接同一时刻只被一个线程持有，因此无需加锁
+class StatementCache {
+public:
+    explicit StatementCache(sqlite3* db, size_t capacity = 64);
+    ~StatementCache();
+    
+    StatementCache(const StatementCache&) = delete;
+    StatementCache& operator=(const StatementCache&) = delete;
+    
+    Statement prepare(const std::string& sql);
+    void finalize_all();
+    
+    uint64_t hits() const { return hits_.load(std::memory_order_relaxed); }
+    uint64_t misses() const { return misses_.load(std::memory_order_relaxed); }
+    size_t size() const { return size_.load(std::memory_order_relaxed); }
+    
+private:
+    friend class Statement;
+    
+    struct Entry {
+        sqlite3_stmt* stmt = nullptr;
+        bool in_use = false;
+    };
+    
+    sqlite3* db_;
+    size_t capacity_;
+    std::unordered_map<std::string, Entry> entries_;
+    std::unordered_map<sqlite3_stmt*, Entry*> by_stmt_;
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<size_t> size_{0};
+    
+    void release(sqlite3_stmt* stmt, bool cached);
+};
+
+// 连接池中的单个连接
+struct Connection {
+    sqlite3* db = nullptr;
+    std::unique_ptr<StatementCache> statements;
+};
+
+// 连接租约，析构时将连接归还给连接池
+class PooledConnection {
+public:
+    PooledConnection() = default;
+    PooledConnection(ConnectionPool* pool, Connection* conn, bool writer, bool owned);
+    ~PooledConnection();
+    
+    PooledConnection(const PooledConnection&) = delete;
+    PooledConnection& operator=(const PooledConnection&) = delete;
+    PooledConnection(PooledConnection&& other) noexcept;
+    PooledConnection& operator=(PooledConnection&& other) noexcept;
+    
+    sqlite3* get() const { return conn_ ? conn_->db : nullptr; }
+    explicit operator bool() const { return conn_ != nullptr; }
+    
+    // 从该连接的语句缓存获取预编译语句
+    Statement prepare(const std::string& sql);
+    
+private:
+    ConnectionPool* pool_ = nullptr;
+    Connection* conn_ = nullptr;
+    bool writer_ = false;
+    bool owned_ = false;
+    
+    void release();
+};
+
+// SQLite连接池：一个写连接 + N个只读连接（WAL模式）
+// 同一线程内的嵌套获取会复用该线程已持有的连接
+class ConnectionPool {
+public:
+    ConnectionPool(const std::string& db_path, const DatabaseOptions& options);
+    ~ConnectionPool();
+    
+    ConnectionPool(const ConnectionPool&) = delete;
+    ConnectionPool& operator=(const ConnectionPool&) = delete;
+    
+    // 打开写连接（负责建表）
+    bool open_writer();
+    // 打开只读连接（需在建表之后调用）
+    bool open_readers();
+    void close();
+    
+    PooledConnection acquire_writer();
+    PooledConnection acquire_reader();
+    
+    nlohmann::json get_statistics() const;
+    nlohmann::json get_statement_cache_statistics() const;
+    
+private:
+    friend class PooledConnection;
+    
+    std::string db_path_;
+    DatabaseOptions options_;
+    
+    std::unique_ptr<Connection> writer_;
+    std::mutex writer_mutex_;
+    
+    std::vector<std::unique_ptr<Connection>> readers_;
+    std::vector<Connection*> idle_readers_;
+    std::mutex reader_mutex_;
+    std::condition_variable reader_cv_;
+    
+    // 统计信息
+    std::atomic<uint64_t> writer_acquisitions_{0};
+    std::atomic<uint64_t> reader_acquisitions_{0};
+    std::atomic<uint64_t> reader_waits_{0};
+    std::atomic<uint64_t> total_wait_us_{0};
+    
+    std::unique_ptr<Connection> open_connection(bool read_only);
+    bool apply_pragmas(sqlite3* db, bool read_only);
+    void release(Connection* conn, bool writer);
+};
+
+// 搜索计数LRU缓存：条目携带写入代数，代数变化后自动失效
+class SearchCountCache {
+public:
+    explicit SearchCountCache(size_t capacity);
+    
+    std::optional<int64_t> get(const std::string& query, uint64_t generation);
+    void put(const std::string& query, uint64_t generation, int64_t count);
+    nlohmann::json get_statistics() const;
+    
+private:
+    struct Entry {
+        std::string query;
+        uint64_t generation;
+        int64_t count;
+    };
+    
+    size_t capacity_;
+    mutable std::mutex mutex_;
+    std::list<Entry> lru_;
+    std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+};
+
 // 数据库管理类
 class Database {
 public:
-    explicit Database(const std::string& db_path);
+    explicit Database(const std::string& db_path, const DatabaseOptions& options = DatabaseOptions{});
     ~Database();
     
     // 禁用拷贝
@@ -43,23 +333,113 @@ public:
     bool update_content(const ContentItem& item);
     bool delete_content(int64_t id);
     
+    // 批量创建：按write_batch_size分块，每块一个事务；返回与输入一一对应的ID，失败项为nullopt
+    std::vector<std::optional<int64_t>> create_content_batch(const std::vector<ContentItem>& items);
+    
     // 查询功能
-    std::vector<ContentItem> search_content(const std::string& query, int limit = 50);
-    std::vector<ContentItem> get_content_by_tag(const std::string& tag, int limit = 50);
-    std::vector<ContentItem> get_recent_content(int limit = 20);
-    std::vector<ContentItem> list_all_content(int offset = 0, int limit = 50);
+    // fields为content_fields投影，未选中的正文和元数据不从数据库读出
+    std::vector<ContentItem> search_content(const std::string& query, int limit = 50, int offset = 0,
+                                            uint32_t fields = content_fields::kDefault);
+    std::vector<ContentItem> get_content_by_tag(const std::string& tag, int limit = 50, int offset = 0,
+                                                uint32_t fields = content_fields::kDefault);
+    std::vector<ContentItem> get_recent_content(int limit = 20, uint32_t fields = content_fields::kDefault);
+    std::vector<ContentItem> list_all_content(int offset = 0, int limit = 50,
+                                              uint32_t fields = content_fields::kDefault);
     
-    // 统计信息
+    // 键集分页：从after之后取limit条，还有更多数据时设置next；
+    // 没有after时跳过offset条（按页码翻页），排序和next的含义与游标翻页相同
+    std::vector<ContentItem> search_content_page(const std::string& query, const std::optional<PageCursor>& after,
+                                                 int limit, std::optional<PageCursor>& next,
+                                                 uint32_t fields = content_fields::kDefault, int offset = 0);
+    std::vector<ContentItem> get_content_by_tag_page(const std::string& tag, const std::optional<PageCursor>& after,
+                                                     int limit, std::optional<PageCursor>& next,
+                                                     uint32_t fields = content_fields::kDefault, int offset = 0);
+    std::vector<ContentItem> list_content_page(const std::optional<PageCursor>& after,
+                                               int limit, std::optional<PageCursor>& next,
+                                               uint32_t fields = content_fields::kDefault, int offset = 0);
+    
+    // 按id升序遍历，用于导出等全量扫描
+    std::vector<ContentItem> list_content_after_id(int64_t after_id, int limit);
+    std::vector<ContentSummary> list_content_summaries(int64_t after_id, int limit);
+    
+    // 上传文件元数据
+    bool insert_file(const FileInfo& info);
+    bool insert_files(const std::vector<FileInfo>& files);
+    std::optional<FileInfo> get_file(const std::string& id);
+    bool update_file(const FileInfo& info);
+    // orphaned_path返回已无引用、可以删除的物理文件路径；blob仍被其他文件引用时为空
+    bool delete_file(const std::string& id, std::string* orphaned_path = nullptr);
+    // 按内容哈希查找已存储的blob路径
+    std::optional<std::string> find_blob(const std::string& hash);
+    std::vector<FileInfo> list_files(int offset = 0, int limit = 20);
+    // query匹配文件名或描述（不区分大小写的子串匹配），并要求包含全部tags；limit为-1表示不限制
+    std::vector<FileInfo> search_files(const std::string& query, const std::vector<std::string>& tags = {},
+                                       int limit = -1);
+    nlohmann::json get_file_statistics();
+    
+    // 文档解析结果缓存，键包含文件内容哈希
+    std::optional<nlohmann::json> get_parse_result(const std::string& key);
+    bool put_parse_result(const std::string& key, const nlohmann::json& result);
+    
+    // 嵌入向量，每条内容只保留一个模型的向量，内容删除时级联删除
+    bool put_embedding(const ContentEmbedding& embedding);
+    std::vector<ContentEmbedding> load_embeddings(const std::string& model);
+    // 没有该模型向量、或内容在计算向量后又被修改的内容id
+    std::vector<int64_t> list_stale_embeddings(const std::string& model, int limit = 10000);
+    
+    // 后台任务状态
+    bool save_job(const JobRecord& job);
+    std::optional<JobRecord> get_job(const std::string& id);
+    // status为空时不过滤，按创建时间倒序
+    std::vector<JobRecord> list_jobs(const std::string& status = "", int limit = 50);
+    // 启动时把上次未完成的任务标记为失败，返回受影响的条数
+    int fail_interrupted_jobs();
+    
+    // 匹配总数：搜索结果按规范化查询缓存，任意写入后失效
+    int64_t count_search_results(const std::string& query);
+    int64_t count_content_by_tag(const std::string& tag);
+    
+    // 写入代数，每次内容写入后递增
+    uint64_t get_write_generation() const { return write_generation_.load(std::memory_order_acquire); }
+    
+    // 统计信息：计数均来自触发器维护的content_stats表
+    ContentStats get_content_stats();
     int64_t get_content_count();
     std::vector<std::string> get_all_tags();
+    std::vector<std::pair<std::string, int64_t>> get_tag_counts();
+    nlohmann::json get_database_statistics() const;
     
 private:
-    sqlite3* db_;
     std::string db_path_;
+    std::unique_ptr<ConnectionPool> pool_;
+    SearchCountCache search_count_cache_;
+    size_t write_batch_size_;
+    std::atomic<uint64_t> write_generation_{0};
+    
+    void bump_write_generation() { write_generation_.fetch_add(1, std::memory_order_acq_rel); }
     
-    bool execute_sql(const std::string& sql);
-    bool create_tables();
+    bool execute_sql(sqlite3* db, const std::string& sql);
+    bool create_tables(sqlite3* db);
+    bool migrate_schema(PooledConnection& conn);
     ContentItem row_to_content_item(sqlite3_stmt* stmt);
+    // 读取content_select_list生成的投影行，第9列为预览
+    ContentItem row_to_projected_item(sqlite3_stmt* stmt, uint32_t fields);
+    
+    // 写路径辅助方法，需在writer连接的事务内调用
+    std::optional<int64_t> insert_content(PooledConnection& conn, const ContentItem& item);
+    bool fts_insert(PooledConnection& conn, int64_t id, const std::string& title,
+                    const std::string& content, const std::string& tags);
+    bool fts_delete(PooledConnection& conn, int64_t id, const std::string& title,
+                    const std::string& content, const std::string& tags);
+    bool replace_tags(PooledConnection& conn, int64_t id, const std::string& tags);
+    bool write_file(PooledConnection& conn, const FileInfo& info);
+    bool remove_file(PooledConnection& conn, const std::string& id, std::string& orphaned_path);
+    bool write_file_index(PooledConnection& conn, int64_t seq, const std::string& id,
+                          const std::string& filename, const std::string& description,
+                          const std::vector<std::string>& tags);
+    bool delete_file_index(PooledConnection& conn, int64_t seq, const std::string& id,
+                           const std::string& filename, const std::string& description);
+    FileInfo row_to_file_info(sqlite3_stmt* stmt);
 };
 
 } // namespace mcp
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace mcp {
+
+// 分块map-reduce文档解析：按上下文大小切分文档，各分块并行提取后合并标题/标签/摘要
+class DocumentParser {
+public:
+    // 调用一次LLM，返回模型输出文本；失败时返回nullopt
+    using Generator = std::function<std::optional<std::string>(const std::string& prompt, int max_tokens)>;
+    // 每完成一个分块回调一次，可能在多个线程中并发调用
+    using Progress = std::function<void(size_t done, size_t total)>;
+    
+    DocumentParser(Generator generator, size_t chunk_size, size_t parallelism);
+    
+    // fallback为不使用AI时的默认结果（提供标题和content）；所有分块都失败时原样返回fallback
+    nlohmann::json parse(const std::string& content, const nlohmann::json& fallback,
+                         const Progress& progress = nullptr) const;
+    
+    // 按段落/行/空白边界切分，单块不超过chunk_size字节且不切断UTF-8字符
+    static std::vector<std::string> split_chunks(const std::string& content, size_t chunk_size);
+    
+    // 根据LLM上下文长度（token）估算分块大小（字节）
+    static size_t chunk_size_for_context(int context_tokens);
+    
+    // 从模型输出中提取第一个JSON对象
+    static std::optional<nlohmann::json> extract_json(const std::string& text);
+    
+private:
+    Generator generator_;
+    size_t chunk_size_;
+    size_t parallelism_;
+    
+    nlohmann::json merge(const std::vector<std::optional<nlohmann::json>>& partials,
+                         const nlohmann::json& fallback) const;
+};
+
+} // namespace mcp
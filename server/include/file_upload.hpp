@@ -1,5 +1,6 @@
 #pragma once
 
+#include "database.hpp"
 #include <string>
 #include <vector>
 #include <memory>
@@ -8,27 +9,13 @@
 
 namespace mcp {
 
-// 文件信息结构
-struct FileInfo {
-    std::string id;
-    std::string filename;
-    std::string original_name;
-    std::string file_path;
-    std::string mime_type;
-    size_t file_size;
-    std::string upload_time;
-    std::string description;
-    std::vector<std::string> tags;
-    
-    nlohmann::json to_json() const;
-    void from_json(const nlohmann::json& j);
-};
-
 // 文件上传结果
 struct UploadResult {
     bool success;
     std::string message;
     FileInfo file_info;
+    int status = 400; // 失败时建议的HTTP状态码
+    bool deduplicated = false; // 内容已存在，复用已有blob
     
     nlohmann::json to_json() const;
 };
@@ -39,12 +26,17 @@ public:
     FileUploadManager();
     ~FileUploadManager();
     
-    // 初始化上传目录
-    bool initialize(const std::string& upload_path);
+    // 初始化上传目录，文件元数据保存在db中
+    bool initialize(const std::string& upload_path, std::shared_ptr<Database> db);
     
     // 处理文件上传
     UploadResult handle_upload(const httplib::Request& req, const std::string& field_name = "file");
     
+    // 流式处理multipart上传：文件部分边接收边写入临时文件并计算SHA-256，
+    // 超出大小限制时立即中止；description/tags取自表单字段或查询参数
+    UploadResult handle_upload_stream(const httplib::Request& req, const httplib::ContentReader& content_reader,
+                                      const std::string& field_name = "file");
+    
     // 文件管理
     std::vector<FileInfo> list_files(int page = 1, int page_size = 20);
     FileInfo get_file_info(const std::string& file_id);
@@ -57,7 +49,8 @@ public:
     
     // 获取文件内容
     std::string get_file_content(const std::string& file_id);
-    bool serve_file(const std::string& file_id, httplib::Response& res);
+    // 流式返回文件，支持Range、ETag/Last-Modified和If-None-Match条件请求
+    bool serve_file(const std::string& file_id, const httplib::Request& req, httplib::Response& res);
     
     // 搜索文件
     std::vector<FileInfo> search_files(const std::string& query, const std::vector<std::string>& tags = {});
@@ -75,6 +68,11 @@ private:
     std::string get_file_extension(const std::string& filename) const;
     bool create_upload_directory(const std::string& path);
     std::string sanitize_filename(const std::string& filename);
+    
+    // 将已写完的临时文件改名到最终位置并写入元数据
+    UploadResult store_upload(const std::string& temp_path, const std::string& original_name, size_t file_size,
+                              const std::string& content_hash, const std::string& description,
+                              const std::vector<std::string>& tags);
 };
 
 } // namespace mcp
\ No newline at end of file
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace mcp {
+
+// 生成请求优先级，数值越小越先执行
+enum class GenerationPriority {
+    Interactive = 0, // 交互式请求（MCP/HTTP生成接口）
+    Normal = 1,
+    Bulk = 2         // 批量任务（文档解析等）
+};
+
+// 有界的生成任务队列：固定数量的执行槽位，按优先级调度，同优先级先进先出
+class GenerationQueue {
+public:
+    // job的参数为false表示队列关闭、任务未执行
+    using Job = std::function<void(bool run)>;
+    
+    GenerationQueue(size_t slots, size_t capacity);
+    ~GenerationQueue();
+    
+    GenerationQueue(const GenerationQueue&) = delete;
+    GenerationQueue& operator=(const GenerationQueue&) = delete;
+    
+    // 队列已满或已关闭时返回false，job不会被调用
+    bool submit(GenerationPriority priority, Job job);
+    
+    // 停止接收新任务，未开始的任务以run=false回调，等待执行中的任务结束
+    void shutdown();
+    
+    nlohmann::json get_statistics() const;
+    
+private:
+    struct Entry {
+        GenerationPriority priority;
+        uint64_t sequence;
+        std::chrono::steady_clock::time_point enqueued;
+        Job job;
+        
+        bool operator<(const Entry& other) const {
+            // priority_queue是大顶堆，反转比较使高优先级、较早提交的任务在堆顶
+            if (priority != other.priority) {
+                return priority > other.priority;
+            }
+            return sequence > other.sequence;
+        }
+    };
+    
+    void worker_loop();
+    
+    const size_t slots_;
+    const size_t capacity_;
+    
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::priority_queue<Entry> pending_;
+    std::vector<std::thread> workers_;
+    bool stopping_ = false;
+    uint64_t next_sequence_ = 0;
+    
+    // 统计信息
+    size_t active_ = 0;
+    size_t max_queue_depth_ = 0;
+    size_t pending_by_priority_[3] = {0, 0, 0};
+    uint64_t submitted_ = 0;
+    uint64_t completed_ = 0;
+    uint64_t rejected_ = 0;
+    double total_wait_ms_ = 0.0;
+    double max_wait_ms_ = 0.0;
+};
+
+} // namespace mcp
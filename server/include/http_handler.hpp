@@ -3,9 +3,15 @@
 #include "mcp_server.hpp"
 #include "file_upload.hpp"
 #include "llama_client.hpp"
+#include "ollama_client.hpp"
+#include "job_manager.hpp"
+#include "document_parser.hpp"
+#include "semantic_index.hpp"
+#include "static_assets.hpp"
 #include <httplib.h>
 #include <nlohmann/json.hpp>
 #include <memory>
+#include <optional>
 #include <string>
 
 namespace mcp {
@@ -30,6 +36,14 @@ private:
     std::unique_ptr<httplib::Server> server_;
     std::unique_ptr<FileUploadManager> file_upload_manager_;
     LlamaService* llama_service_;
+    // 所有Ollama调用共用的连接池客户端
+    std::unique_ptr<OllamaClient> ollama_client_;
+    // 文档解析、批量导入等后台任务
+    std::shared_ptr<JobManager> job_manager_;
+    // 语义检索索引，未配置embedding_provider时为空
+    std::shared_ptr<SemanticIndex> semantic_index_;
+    // 预加载的Web界面静态文件，静态目录不存在时为空并返回内置说明页
+    std::unique_ptr<StaticAssetCache> static_assets_;
     
     // 路由处理函数
     void setup_routes();
@@ -44,15 +58,20 @@ private:
     void handle_update_content(const httplib::Request& req, httplib::Response& res);
     void handle_delete_content(const httplib::Request& req, httplib::Response& res);
     void handle_search_content(const httplib::Request& req, httplib::Response& res);
+    void handle_semantic_search(const httplib::Request& req, httplib::Response& res);
     void handle_list_content(const httplib::Request& req, httplib::Response& res);
     void handle_get_tags(const httplib::Request& req, httplib::Response& res);
     void handle_get_statistics(const httplib::Request& req, httplib::Response& res);
     void handle_export_content(const httplib::Request& req, httplib::Response& res);
     void handle_export_all_content(const httplib::Request& req, httplib::Response& res);
+    void handle_import_content(const httplib::Request& req, httplib::Response& res,
+                               const httplib::ContentReader& content_reader);
     
     // 健康检查和信息端点
     void handle_health_check(const httplib::Request& req, httplib::Response& res);
     void handle_server_info(const httplib::Request& req, httplib::Response& res);
+    // Prometheus文本格式的指标：路由和数据库耗时直方图，以及抓取时从各模块统计生成的gauge
+    void handle_metrics(const httplib::Request& req, httplib::Response& res);
     
     // 配置管理端点
     void handle_get_config(const httplib::Request& req, httplib::Response& res);
@@ -60,7 +79,8 @@ private:
     void handle_save_config(const httplib::Request& req, httplib::Response& res);
     
     // 文件上传端点
-    void handle_upload_file(const httplib::Request& req, httplib::Response& res);
+    void handle_upload_file(const httplib::Request& req, httplib::Response& res,
+                            const httplib::ContentReader& content_reader);
     void handle_list_files(const httplib::Request& req, httplib::Response& res);
     void handle_get_file(const httplib::Request& req, httplib::Response& res);
     void handle_delete_file(const httplib::Request& req, httplib::Response& res);
@@ -71,6 +91,13 @@ private:
     void handle_get_upload_stats(const httplib::Request& req, httplib::Response& res);
     void handle_parse_document(const httplib::Request& req, httplib::Response& res);
     
+    // 后台任务端点
+    void handle_submit_job(const httplib::Request& req, httplib::Response& res);
+    void handle_list_jobs(const httplib::Request& req, httplib::Response& res);
+    void handle_get_job(const httplib::Request& req, httplib::Response& res);
+    void handle_mcp_events(const httplib::Request& req, httplib::Response& res);
+    void handle_job_events(const httplib::Request& req, httplib::Response& res);
+    
     // LLaMA端点
     void handle_llama_generate(const httplib::Request& req, httplib::Response& res);
     void handle_llama_generate_stream(const httplib::Request& req, httplib::Response& res);
@@ -91,12 +118,33 @@ private:
     
     // 辅助方法
     void set_cors_headers(httplib::Response& res);
-    void send_json_response(httplib::Response& res, const nlohmann::json& json, int status = 200);
+    void send_json_response(const httplib::Request& req, httplib::Response& res, const nlohmann::json& json,
+                            int status = 200);
+    // body为已序列化的JSON；超过压缩阈值时按Accept-Encoding协商gzip/br/zstd
+    void send_json_body(const httplib::Request& req, httplib::Response& res, std::string body, int status = 200);
+    // 按Accept-Encoding选择预压缩版本，处理If-None-Match并设置缓存头
+    void send_static_asset(const httplib::Request& req, httplib::Response& res,
+                           std::shared_ptr<const StaticAsset> asset);
     void send_error_response(httplib::Response& res, const std::string& message, int status = 500);
     bool parse_json_body(const std::string& body, nlohmann::json& json, std::string& error_msg);
     int parse_int_param(const httplib::Request& req, const std::string& param, int default_value = 0);
     std::string get_param(const httplib::Request& req, const std::string& param, const std::string& default_value = "");
-    nlohmann::json create_default_parse_result(const std::string& content, const std::string& file_path);
+    // file_info为空时，uploads目录下以文件ID命名的旧文件按ID从数据库查原始文件名
+    nlohmann::json create_default_parse_result(const std::string& content, const std::string& file_path,
+                                               const std::optional<FileInfo>& file_info);
+    
+    // 文档解析的同步实现，HTTP接口和后台任务共用；失败时设置error_msg和HTTP状态码
+    bool parse_document(const nlohmann::json& request_json, nlohmann::json& parse_result,
+                        std::string& error_msg, int& status, const DocumentParser::Progress& progress = nullptr);
+    void register_job_handlers();
+    bool initialize_semantic_index();
+    void submit_job(const httplib::Request& req, httplib::Response& res, const std::string& type,
+                    const nlohmann::json& params);
+    // import?async=true：请求体暂存到上传目录后提交bulk_import任务，进度通过/api/jobs查询
+    void submit_import_job(const httplib::Request& req, httplib::Response& res,
+                           const httplib::ContentReader& content_reader);
+    nlohmann::json import_spooled_content(const std::string& spool_name,
+                                          const JobManager::ProgressCallback& progress);
 };
 
 } // namespace mcp
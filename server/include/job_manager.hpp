@@ -0,0 +1,58 @@
+#pragma once
+
+#include "database.hpp"
+#include "generation_queue.hpp"
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace mcp {
+
+// 后台任务管理器：提交后立即返回任务id，由独立于HTTP线程池的有界工作线程执行
+// 任务状态在每次变化时写入数据库，客户端可轮询或等待状态更新
+class JobManager {
+public:
+    // progress取值0~1，可在任务执行线程中多次调用
+    using ProgressCallback = std::function<void(double progress, const std::string& message)>;
+    // 返回任务结果；抛出异常时任务标记为失败，异常信息作为error
+    using Handler = std::function<nlohmann::json(const nlohmann::json& params, const ProgressCallback& progress)>;
+
+    JobManager(std::shared_ptr<Database> database, size_t workers, size_t capacity);
+    ~JobManager();
+
+    JobManager(const JobManager&) = delete;
+    JobManager& operator=(const JobManager&) = delete;
+
+    // 注册任务类型，应在提交任务前完成
+    void register_handler(const std::string& type, Handler handler,
+                          GenerationPriority priority = GenerationPriority::Normal);
+    bool has_handler(const std::string& type) const;
+
+    // 类型未注册、队列已满或已关闭时返回nullopt并设置error
+    std::optional<JobRecord> submit(const std::string& type, const nlohmann::json& params, std::string& error);
+
+    std::optional<JobRecord> get_job(const std::string& id);
+    std::vector<JobRecord> list_jobs(const std::string& status = "", int limit = 50);
+
+    // 等待任务版本号超过version或超时，返回最新记录并更新version；任务不存在时返回nullopt
+    std::optional<JobRecord> wait_for_update(const std::string& id, uint64_t& version,
+                                             std::chrono::milliseconds timeout);
+
+    // 停止接收新任务，排队中的任务标记为cancelled，等待执行中的任务结束
+    void shutdown();
+
+    nlohmann::json get_statistics() const;
+
+    static bool is_terminal(const std::string& status);
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pimpl_;
+};
+
+} // namespace mcp
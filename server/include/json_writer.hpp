@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace mcp {
+
+// 直接追加紧凑JSON文本的辅助函数，大结果集序列化时不构造nlohmann::json树
+
+// 追加带引号的JSON字符串；非法UTF-8字节替换为U+FFFD
+void append_json_string(std::string& out, std::string_view value);
+
+// 追加"key":前缀，key须为无需转义的ASCII
+inline void append_json_key(std::string& out, std::string_view key) {
+    out += '"';
+    out.append(key.data(), key.size());
+    out += "\":";
+}
+
+inline void append_json_int(std::string& out, int64_t value) {
+    out += std::to_string(value);
+}
+
+// 追加已经是JSON文本的值（如数据库中的metadata）；不合法时追加fallback
+void append_json_raw(std::string& out, std::string_view json, std::string_view fallback);
+
+} // namespace mcp
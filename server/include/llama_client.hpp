@@ -4,7 +4,12 @@
 #include <vector>
 #include <memory>
 #include <nlohmann/json.hpp>
+#include "generation_queue.hpp"
+#include "response_cache.hpp"
 #include <future>
+#include <functional>
+#include <mutex>
+#include <optional>
 
 namespace mcp {
 
@@ -17,6 +22,8 @@ struct LlamaRequest {
     int top_k = 40;
     std::vector<std::string> stop_sequences;
     bool stream = false;
+    GenerationPriority priority = GenerationPriority::Interactive;
+    bool cache = false; // 允许复用相同参数的缓存结果；temperature<=0的请求总是可缓存
     
     nlohmann::json to_json() const;
     void from_json(const nlohmann::json& j);
@@ -29,6 +36,8 @@ struct LlamaResponse {
     std::string error_message;
     int tokens_generated;
     double generation_time;
+    double time_to_first_token = 0.0; // 流式生成时首个token的延迟（秒）
+    bool cached = false;              // 结果来自响应缓存
     
     nlohmann::json to_json() const;
 };
@@ -61,9 +70,12 @@ public:
     LlamaResponse generate(const LlamaRequest& request);
     std::future<LlamaResponse> generate_async(const LlamaRequest& request);
     
-    // 流式生成（回调函数接收每个token）
-    bool generate_stream(const LlamaRequest& request, 
-                        std::function<bool(const std::string& token)> callback);
+    // 流式生成（回调函数接收每个token，返回false时取消生成）
+    LlamaResponse generate_stream(const LlamaRequest& request,
+                                  std::function<bool(const std::string& token)> callback);
+    
+    // 计算文本的嵌入向量（llama-server以--embedding启动时可用）
+    std::optional<std::vector<float>> embed(const std::string& text);
     
     // 模型信息
     ModelInfo get_model_info() const;
@@ -84,9 +96,8 @@ private:
     std::unique_ptr<Impl> pimpl_;
     
     // 辅助方法
-    std::string escape_shell_arg(const std::string& arg);
-    std::vector<std::string> build_command_args(const LlamaRequest& request);
-    LlamaResponse parse_output(const std::string& output, double generation_time);
+    std::vector<std::string> build_server_args(const std::string& model_path);
+    LlamaResponse parse_completion(const nlohmann::json& body, double generation_time);
 };
 
 // LLaMA 服务管理器
@@ -100,17 +111,33 @@ public:
     bool restart();
     bool is_running() const;
     
+    // 模型管理
+    bool load_model(const std::string& model_path);
+    bool unload_model();
+    
     // 请求处理
     LlamaResponse process_request(const LlamaRequest& request);
     std::future<LlamaResponse> process_request_async(const LlamaRequest& request);
+    LlamaResponse process_stream_request(const LlamaRequest& request,
+                                         std::function<bool(const std::string& token)> callback);
+    // 嵌入请求不经过生成队列
+    std::optional<std::vector<float>> embed(const std::string& text);
+    std::string get_model_path() const;
     
     // 配置
     bool update_config(const nlohmann::json& config);
     nlohmann::json get_status();
+    // 请求统计及生成队列、响应缓存状态，不访问llama-server
+    nlohmann::json get_statistics();
     
 private:
     LlamaService() = default;
-    std::unique_ptr<LlamaClient> client_;
+    // 生成请求持有shared_ptr副本，不在mutex_内执行，stop()时也不会被提前析构
+    std::shared_ptr<LlamaClient> client_;
+    // 所有生成请求经有界队列调度，并发数不超过配置的槽位数
+    std::shared_ptr<GenerationQueue> queue_;
+    // 确定性或显式可缓存请求的生成结果缓存，配置禁用时为空
+    std::shared_ptr<ResponseCache> cache_;
     bool running_ = false;
     mutable std::mutex mutex_;
     
@@ -121,11 +148,19 @@ private:
         size_t failed_requests = 0;
         double total_generation_time = 0.0;
         size_t total_tokens_generated = 0;
+        size_t streaming_requests = 0;
+        double total_time_to_first_token = 0.0;
+        size_t cache_hits = 0;
+        size_t cache_misses = 0;
         
         nlohmann::json to_json() const;
         void update(const LlamaResponse& response);
         void reset();
     } stats_;
+    
+    // 提交到队列；callback非空时为流式生成
+    std::future<LlamaResponse> submit(const LlamaRequest& request,
+                                      std::function<bool(const std::string& token)> callback);
 };
 
 } // namespace mcp
\ No newline at end of file
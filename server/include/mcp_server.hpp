@@ -2,7 +2,13 @@
 
 #include "content_manager.hpp"
 #include "config.hpp"
+#include "task_executor.hpp"
+#include "job_manager.hpp"
+#include <chrono>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <functional>
@@ -32,25 +38,62 @@ struct MCPResource {
 // MCP服务器类
 class MCPServer {
 public:
-    explicit MCPServer(std::shared_ptr<ContentManager> content_manager);
+    // batch_workers为并行执行批量请求的线程数
+    explicit MCPServer(std::shared_ptr<ContentManager> content_manager, size_t batch_workers = 4);
     
     // MCP协议方法
     nlohmann::json handle_initialize(const nlohmann::json& params);
     nlohmann::json handle_list_tools();
     nlohmann::json handle_call_tool(const std::string& tool_name, const nlohmann::json& arguments);
-    nlohmann::json handle_list_resources();
+    // params.cursor取自上一页的nextCursor
+    nlohmann::json handle_list_resources(const nlohmann::json& params = nlohmann::json::object());
     nlohmann::json handle_read_resource(const std::string& uri);
     
-    // 通用请求处理
+    // 通用请求处理，返回未封装的结果或{"error": ...}
     nlohmann::json handle_request(const nlohmann::json& request);
     
+    // JSON-RPC消息处理：message为单个请求或批量数组，应答带jsonrpc/id封装；
+    // 通知（无id）不产生应答，没有任何应答时返回null
+    nlohmann::json handle_message(const nlohmann::json& message);
+    // 同上，批量中的调用并行执行，每完成一个即在调用线程上以完成顺序回调emit
+    void dispatch_message(const nlohmann::json& message,
+                          const std::function<void(const nlohmann::json&)>& emit);
+    
+    // 各方法（tools/call按工具名区分）的调用次数、错误数和耗时
+    nlohmann::json get_method_statistics() const;
+    
+    // 等待内容集合变化，返回notifications/resources/list_changed消息；
+    // 超时返回nullopt。version初始取ContentManager::get_change_version()，由调用方在多次调用间保存
+    std::optional<nlohmann::json> wait_for_notification(uint64_t& version, std::chrono::milliseconds timeout);
+    
     // 获取服务器信息
     nlohmann::json get_server_info() const;
     
+    // 供HTTP层的流式接口直接访问内容管理器
+    std::shared_ptr<ContentManager> get_content_manager() const { return content_manager_; }
+    
+    // 后台任务由HTTP层创建后注入，未设置时任务工具返回错误
+    void set_job_manager(std::shared_ptr<JobManager> job_manager) { job_manager_ = std::move(job_manager); }
+    
 private:
     std::shared_ptr<ContentManager> content_manager_;
+    std::shared_ptr<JobManager> job_manager_;
     std::unordered_map<std::string, MCPTool> tools_;
     std::unordered_map<std::string, std::function<nlohmann::json(const nlohmann::json&)>> tool_handlers_;
+    // 批量请求专用的执行器，不占用LLM生成队列
+    std::unique_ptr<TaskExecutor> batch_executor_;
+    
+    struct MethodStats {
+        uint64_t calls = 0;
+        uint64_t errors = 0;
+        double total_ms = 0.0;
+        double max_ms = 0.0;
+    };
+    mutable std::mutex stats_mutex_;
+    std::map<std::string, MethodStats> method_stats_;
+    
+    nlohmann::json route_request(const nlohmann::json& request);
+    nlohmann::json handle_envelope(const nlohmann::json& request);
     
     // 初始化工具
     void initialize_tools();
@@ -61,10 +104,14 @@ private:
     nlohmann::json tool_update_content(const nlohmann::json& args);
     nlohmann::json tool_delete_content(const nlohmann::json& args);
     nlohmann::json tool_search_content(const nlohmann::json& args);
+    nlohmann::json tool_semantic_search(const nlohmann::json& args);
     nlohmann::json tool_list_content(const nlohmann::json& args);
     nlohmann::json tool_get_tags(const nlohmann::json& args);
     nlohmann::json tool_get_statistics(const nlohmann::json& args);
     nlohmann::json tool_export_content(const nlohmann::json& args);
+    nlohmann::json tool_submit_job(const nlohmann::json& args);
+    nlohmann::json tool_get_job(const nlohmann::json& args);
+    nlohmann::json tool_list_jobs(const nlohmann::json& args);
     
     // 辅助方法
     nlohmann::json create_error_response(int code, const std::string& message);
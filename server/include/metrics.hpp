@@ -0,0 +1,124 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace mcp {
+
+using MetricLabels = std::vector<std::pair<std::string, std::string>>;
+
+// 按线程分片的原子计数，写入只做一次relaxed fetch_add，读取时合并各分片
+constexpr size_t kMetricShards = 8;
+
+size_t metric_shard_index();
+
+class Counter {
+public:
+    void add(uint64_t value = 1) {
+        shards_[metric_shard_index()].value.fetch_add(value, std::memory_order_relaxed);
+    }
+    uint64_t value() const;
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> value{0};
+    };
+    std::array<Shard, kMetricShards> shards_;
+};
+
+// 固定桶的延迟直方图，桶边界从25us到10s
+class LatencyHistogram {
+public:
+    static constexpr size_t kBucketCount = 19; // 18个有限边界加+Inf
+    static const std::array<double, kBucketCount - 1> kBounds; // 单位秒
+
+    void observe(std::chrono::nanoseconds duration);
+
+    struct Snapshot {
+        std::array<uint64_t, kBucketCount> buckets{}; // 非累计
+        uint64_t count = 0;
+        double sum_seconds = 0.0;
+
+        // 按桶内线性插值估计分位数，与PromQL的histogram_quantile一致
+        double quantile(double q) const;
+    };
+    Snapshot snapshot() const;
+
+private:
+    struct alignas(64) Shard {
+        std::array<std::atomic<uint64_t>, kBucketCount> buckets{};
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> sum_ns{0};
+    };
+    std::array<Shard, kMetricShards> shards_;
+};
+
+// 离开作用域时把耗时记入直方图
+class ScopedLatency {
+public:
+    explicit ScopedLatency(LatencyHistogram& histogram)
+        : histogram_(histogram), start_(std::chrono::steady_clock::now()) {}
+    ~ScopedLatency() { histogram_.observe(std::chrono::steady_clock::now() - start_); }
+
+    ScopedLatency(const ScopedLatency&) = delete;
+    ScopedLatency& operator=(const ScopedLatency&) = delete;
+
+private:
+    LatencyHistogram& histogram_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+// 抓取时按Prometheus文本格式输出的辅助类，用于从各模块的统计JSON生成gauge/counter
+class MetricsWriter {
+public:
+    void family(const std::string& name, const std::string& type, const std::string& help);
+    void sample(const std::string& name, const MetricLabels& labels, double value);
+    void sample(const std::string& name, double value) { sample(name, {}, value); }
+
+    std::string& text() { return out_; }
+
+private:
+    std::string out_;
+};
+
+// 进程内指标注册表：指标在首次使用时注册并返回稳定的引用，热路径上不再查找
+class Metrics {
+public:
+    static Metrics& instance();
+
+    Counter& counter(const std::string& family, const MetricLabels& labels = {});
+    LatencyHistogram& histogram(const std::string& family, const MetricLabels& labels = {});
+    // 设置指标族的说明，未设置时HELP为空
+    void describe(const std::string& family, const std::string& help);
+
+    // 输出所有已注册的计数器和直方图，直方图额外输出p50/p99估计值
+    void render(MetricsWriter& writer) const;
+
+private:
+    Metrics() = default;
+
+    struct Family {
+        std::string help;
+        std::map<std::string, std::unique_ptr<Counter>> counters;          // 键为渲染后的标签
+        std::map<std::string, std::unique_ptr<LatencyHistogram>> histograms;
+    };
+
+    mutable std::mutex mutex_;
+    std::map<std::string, Family> families_;
+};
+
+// 统计所在函数的耗时，按函数名归入family直方图的method标签；直方图只在首次调用时查找
+#define MCP_SCOPED_LATENCY(family)                                                              \
+    static ::mcp::LatencyHistogram& mcp_scoped_histogram_ =                                     \
+        ::mcp::Metrics::instance().histogram(family, {{"method", __func__}});                   \
+    ::mcp::ScopedLatency mcp_scoped_latency_(mcp_scoped_histogram_)
+
+} // namespace mcp
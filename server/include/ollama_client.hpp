@@ -0,0 +1,48 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <nlohmann/json.hpp>
+
+namespace mcp {
+
+// Ollama调用结果
+struct OllamaResult {
+    bool success = false;
+    int status = 0; // HTTP状态码，连接失败时为0
+    nlohmann::json body;
+    std::string error;
+};
+
+// Ollama客户端：复用keep-alive连接，缓存模型列表，并记录各接口的延迟分布
+// 地址和超时每次调用时从Config读取，配置变更后自动丢弃旧连接
+class OllamaClient {
+public:
+    OllamaClient();
+    ~OllamaClient();
+    
+    OllamaClient(const OllamaClient&) = delete;
+    OllamaClient& operator=(const OllamaClient&) = delete;
+    
+    // GET /api/tags，在缓存有效期内直接返回上次的结果
+    OllamaResult list_models(bool force_refresh = false);
+    
+    // POST /api/generate（stream=false）
+    OllamaResult generate(const nlohmann::json& request);
+    
+    // POST /api/generate（stream=true），on_chunk收到原始NDJSON数据，返回false时取消请求
+    OllamaResult generate_stream(const nlohmann::json& request,
+                                 std::function<bool(const char* data, size_t length)> on_chunk);
+    
+    // POST /api/embeddings，响应体中的embedding为浮点数组
+    OllamaResult embeddings(const nlohmann::json& request);
+    
+    nlohmann::json get_statistics() const;
+    
+private:
+    class Impl;
+    std::unique_ptr<Impl> pimpl_;
+};
+
+} // namespace mcp
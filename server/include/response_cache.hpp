@@ -0,0 +1,80 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <nlohmann/json.hpp>
+
+namespace mcp {
+
+// 响应缓存选项；memory_bytes为0时不使用内存层，disk_path为空时不使用磁盘层
+struct ResponseCacheOptions {
+    size_t memory_bytes = 64 * 1024 * 1024;
+    std::string disk_path;
+    size_t disk_bytes = 256 * 1024 * 1024;
+    std::chrono::seconds ttl{24 * 3600};
+};
+
+// 两级键值缓存：内存层按字节数LRU淘汰，磁盘层每个键一个文件、按写入顺序淘汰
+// 键应为定长摘要（用作文件名），值为任意字符串
+class ResponseCache {
+public:
+    explicit ResponseCache(ResponseCacheOptions options);
+
+    ResponseCache(const ResponseCache&) = delete;
+    ResponseCache& operator=(const ResponseCache&) = delete;
+
+    // 未命中或已过期时返回nullopt；磁盘层命中后提升到内存层
+    std::optional<std::string> get(const std::string& key);
+    void put(const std::string& key, const std::string& value);
+    void clear();
+
+    nlohmann::json get_statistics() const;
+
+private:
+    struct MemoryEntry {
+        std::string key;
+        std::string value;
+        int64_t expires_at;
+    };
+
+    struct DiskEntry {
+        size_t size;
+        int64_t expires_at;
+        std::list<std::string>::iterator order; // 在disk_order_中的位置
+    };
+
+    const ResponseCacheOptions options_;
+
+    // 内存层：表头为最近使用
+    mutable std::mutex memory_mutex_;
+    std::list<MemoryEntry> memory_lru_;
+    std::unordered_map<std::string, std::list<MemoryEntry>::iterator> memory_index_;
+    size_t memory_used_ = 0;
+
+    // 磁盘层：表头为最早写入，文件读写也在disk_mutex_内进行
+    mutable std::mutex disk_mutex_;
+    std::list<std::string> disk_order_;
+    std::unordered_map<std::string, DiskEntry> disk_index_;
+    size_t disk_used_ = 0;
+
+    // 统计信息，分别受所在层的mutex保护
+    uint64_t memory_hits_ = 0;
+    uint64_t misses_ = 0;
+    uint64_t expired_ = 0;
+    uint64_t memory_evictions_ = 0;
+    uint64_t disk_hits_ = 0;
+    uint64_t disk_evictions_ = 0;
+
+    void put_memory(const std::string& key, const std::string& value, int64_t expires_at);
+    void put_disk(const std::string& key, const std::string& value, int64_t expires_at);
+    void erase_disk_locked(const std::string& key);
+    void load_disk_index();
+    std::string disk_file(const std::string& key) const;
+};
+
+} // namespace mcp
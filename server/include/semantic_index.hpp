@@ -0,0 +1,56 @@
+#pragma once
+
+#include "database.hpp"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace mcp {
+
+struct SemanticIndexOptions {
+    std::string model;                  // 嵌入模型标识，用于区分数据库中的向量
+    std::string storage_format = "int8"; // 数据库存储格式：int8或f16
+    size_t max_chars = 8000;            // 计算向量时截取的最大字符数
+};
+
+// 内容语义索引：后台线程为新建/修改的内容计算嵌入向量并落库，
+// 内存中以int8量化的连续矩阵保存全部向量，查询时暴力计算余弦相似度
+class SemanticIndex {
+public:
+    // 计算一段文本的嵌入向量，失败时返回nullopt
+    using Embedder = std::function<std::optional<std::vector<float>>(const std::string& text)>;
+
+    SemanticIndex(std::shared_ptr<Database> db, Embedder embedder, SemanticIndexOptions options);
+    ~SemanticIndex();
+
+    SemanticIndex(const SemanticIndex&) = delete;
+    SemanticIndex& operator=(const SemanticIndex&) = delete;
+
+    // 加载数据库中已有的向量，启动后台线程并为缺失或过期的内容排队
+    void start();
+    void stop();
+
+    // 只入队，不阻塞调用方的写入路径
+    void enqueue(int64_t content_id);
+    void remove(int64_t content_id);
+
+    // 按余弦相似度降序返回(content_id, score)；查询向量计算失败时返回nullopt
+    std::optional<std::vector<std::pair<int64_t, float>>> search(const std::string& query, size_t k);
+
+    nlohmann::json get_statistics() const;
+
+    // 向量量化：先归一化为单位向量，int8按最大绝对值缩放，f16为IEEE半精度
+    static ContentEmbedding encode(const std::vector<float>& vector, const std::string& format);
+    static std::vector<float> decode(const ContentEmbedding& embedding);
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pimpl_;
+};
+
+} // namespace mcp
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace mcp {
+
+// 增量SHA-256，用于上传时边接收边计算内容哈希
+class Sha256 {
+public:
+    Sha256();
+    
+    void update(const void* data, size_t length);
+    // 结束计算并返回64位十六进制摘要；调用后对象需reset才能复用
+    std::string hex_digest();
+    void reset();
+    
+private:
+    std::array<uint32_t, 8> state_;
+    std::array<uint8_t, 64> buffer_;
+    uint64_t total_length_ = 0;
+    size_t buffer_length_ = 0;
+    
+    void transform(const uint8_t* block);
+};
+
+} // namespace mcp
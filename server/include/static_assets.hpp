@@ -0,0 +1,50 @@
+#pragma once
+
+#include "compression.hpp"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <nlohmann/json.hpp>
+
+namespace mcp {
+
+// 预加载的静态文件及其预压缩版本；压缩后没有变小的版本为空
+struct StaticAsset {
+    std::string mime_type;
+    std::string etag;       // 原始内容的强ETag，压缩版本在引号内追加编码后缀
+    bool immutable = false; // 文件名带内容哈希，可长期缓存
+    std::string identity;
+    std::string gzip;
+    std::string brotli;
+    std::string zstd;
+
+    // 按编码取对应版本，没有该版本时返回nullptr
+    const std::string* variant(ContentEncoding encoding) const;
+    std::string variant_etag(ContentEncoding encoding) const;
+    // If-None-Match是否与任一版本的ETag匹配（按弱比较，*总是匹配）
+    bool matches(const std::string& if_none_match) const;
+};
+
+// 启动时把静态文件目录整体读入内存，请求时不再访问磁盘
+class StaticAssetCache {
+public:
+    // 加载root下的所有文件，总大小超过max_bytes后的文件被跳过；目录不存在时返回false
+    bool load(const std::string& root, size_t max_bytes);
+
+    // path为请求路径（以/开头），/映射到/index.html；未找到时返回nullptr
+    std::shared_ptr<const StaticAsset> find(const std::string& path) const;
+
+    bool empty() const { return assets_.empty(); }
+    nlohmann::json get_statistics() const;
+
+    // 文件名中是否带有构建工具生成的内容哈希，如main.3f9a1b2c.js或index-BqR3x9aF.js
+    static bool is_hashed_filename(const std::string& filename);
+
+private:
+    std::unordered_map<std::string, std::shared_ptr<const StaticAsset>> assets_;
+    size_t identity_bytes_ = 0;
+    size_t compressed_bytes_ = 0;
+};
+
+} // namespace mcp
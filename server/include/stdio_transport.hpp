@@ -0,0 +1,31 @@
+#pragma once
+
+#include "mcp_server.hpp"
+#include <iosfwd>
+#include <memory>
+
+namespace mcp {
+
+// 标准输入输出上的MCP传输：每行一条JSON-RPC消息（单个对象或批量数组），
+// 应答和服务端通知同样按行写出。日志必须输出到stderr，避免混入协议数据
+class StdioTransport {
+public:
+    StdioTransport(std::shared_ptr<MCPServer> server, std::istream& in, std::ostream& out);
+    ~StdioTransport();
+
+    StdioTransport(const StdioTransport&) = delete;
+    StdioTransport& operator=(const StdioTransport&) = delete;
+
+    // 启动读取线程和通知线程
+    void start();
+    // 客户端关闭输入后返回true
+    bool finished() const;
+    // 停止通知线程；阻塞在读取上的线程被分离，进程退出时结束
+    void stop();
+
+private:
+    struct State;
+    std::shared_ptr<State> state_;
+};
+
+} // namespace mcp
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mcp {
+
+// 固定线程数的任务执行器，异步请求共用这些线程，不再为每次调用创建线程；
+// 客户端的异步调用和服务端的JSON-RPC批量请求共用
+class TaskExecutor {
+public:
+    explicit TaskExecutor(size_t threads);
+    // 执行完已提交的任务后再退出
+    ~TaskExecutor();
+
+    TaskExecutor(const TaskExecutor&) = delete;
+    TaskExecutor& operator=(const TaskExecutor&) = delete;
+
+    void submit(std::function<void()> task);
+
+    // 提交并返回结果的future，任务抛出的异常经future传递
+    template <typename F>
+    auto run(F&& func) -> std::future<decltype(func())> {
+        using Result = decltype(func());
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(func));
+        auto future = task->get_future();
+        submit([task]() { (*task)(); });
+        return future;
+    }
+
+    size_t pending() const;
+    size_t thread_count() const { return workers_.size(); }
+
+private:
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::function<void()>> tasks_;
+    bool stopping_ = false;
+    std::vector<std::thread> workers_;
+
+    void worker_loop();
+};
+
+} // namespace mcp
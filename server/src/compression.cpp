@@ -0,0 +1,252 @@
+#include "compression.hpp"
+#include <spdlog/spdlog.h>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+
+#ifdef CPPHTTPLIB_ZLIB_SUPPORT
+#include <zlib.h>
+#endif
+
+#ifdef CPPHTTPLIB_BROTLI_SUPPORT
+#include <brotli/encode.h>
+#endif
+
+#ifdef MCP_ZSTD_SUPPORT
+#include <zstd.h>
+#endif
+
+namespace mcp {
+
+#ifdef CPPHTTPLIB_ZLIB_SUPPORT
+
+class GzipCompressor::Impl {
+public:
+    explicit Impl(int level) {
+        // windowBits 15 + 16 输出gzip格式
+        ok = deflateInit2(&stream, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+        if (!ok) {
+            spdlog::error("Failed to initialize gzip compressor");
+        }
+    }
+    
+    ~Impl() {
+        if (ok) {
+            deflateEnd(&stream);
+        }
+    }
+    
+    bool compress(const char* data, size_t length, bool finish, std::string& out) {
+        if (!ok) {
+            return false;
+        }
+        
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+        stream.avail_in = static_cast<uInt>(length);
+        
+        // 非结束块使用Z_SYNC_FLUSH，保证每个分块都能被客户端及时解码
+        int flush = finish ? Z_FINISH : Z_SYNC_FLUSH;
+        char buffer[16384];
+        int rc;
+        do {
+            stream.next_out = reinterpret_cast<Bytef*>(buffer);
+            stream.avail_out = sizeof(buffer);
+            rc = deflate(&stream, flush);
+            if (rc == Z_STREAM_ERROR) {
+                ok = false;
+                return false;
+            }
+            out.append(buffer, sizeof(buffer) - stream.avail_out);
+        } while (stream.avail_out == 0);
+        
+        return !finish || rc == Z_STREAM_END;
+    }
+    
+    z_stream stream{};
+    bool ok = false;
+};
+
+GzipCompressor::GzipCompressor(int level) : pimpl_(std::make_unique<Impl>(level)) {}
+
+bool GzipCompressor::available() {
+    return true;
+}
+
+bool GzipCompressor::compress(const char* data, size_t length, bool finish, std::string& out) {
+    return pimpl_->compress(data, length, finish, out);
+}
+
+#else
+
+class GzipCompressor::Impl {};
+
+GzipCompressor::GzipCompressor(int /* level */) {}
+
+bool GzipCompressor::available() {
+    return false;
+}
+
+bool GzipCompressor::compress(const char* /* data */, size_t /* length */, bool /* finish */,
+                              std::string& /* out */) {
+    return false;
+}
+
+#endif
+
+GzipCompressor::~GzipCompressor() = default;
+
+namespace {
+
+#ifdef CPPHTTPLIB_BROTLI_SUPPORT
+constexpr bool kBrotliAvailable = true;
+// 动态响应每次都要压缩，取中等质量兼顾速度和压缩率
+constexpr int kBrotliQuality = 5;
+#else
+constexpr bool kBrotliAvailable = false;
+#endif
+
+#ifdef MCP_ZSTD_SUPPORT
+constexpr bool kZstdAvailable = true;
+constexpr int kZstdLevel = 3;
+#else
+constexpr bool kZstdAvailable = false;
+#endif
+
+std::string trim_lower(const std::string& value) {
+    size_t begin = 0;
+    size_t end = value.size();
+    while (begin < end && std::isspace(static_cast<unsigned char>(value[begin]))) {
+        ++begin;
+    }
+    while (end > begin && std::isspace(static_cast<unsigned char>(value[end - 1]))) {
+        --end;
+    }
+    std::string result = value.substr(begin, end - begin);
+    for (auto& ch : result) {
+        ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+    }
+    return result;
+}
+
+} // namespace
+
+ContentEncoding negotiate_encoding(const std::string& accept_encoding) {
+    // 未出现的编码记为-1，之后取*的q值
+    double gzip = -1.0;
+    double brotli = -1.0;
+    double zstd = -1.0;
+    double wildcard = -1.0;
+    
+    size_t pos = 0;
+    while (pos <= accept_encoding.size()) {
+        size_t end = accept_encoding.find(',', pos);
+        if (end == std::string::npos) {
+            end = accept_encoding.size();
+        }
+        const std::string item = accept_encoding.substr(pos, end - pos);
+        pos = end + 1;
+        
+        double q = 1.0;
+        const size_t semicolon = item.find(';');
+        const std::string name = trim_lower(item.substr(0, semicolon));
+        if (semicolon != std::string::npos) {
+            const std::string param = trim_lower(item.substr(semicolon + 1));
+            if (param.size() > 2 && param[0] == 'q' && param[1] == '=') {
+                q = std::strtod(param.c_str() + 2, nullptr);
+            }
+        }
+        
+        if (name == "gzip" || name == "x-gzip") {
+            gzip = q;
+        } else if (name == "br") {
+            brotli = q;
+        } else if (name == "zstd") {
+            zstd = q;
+        } else if (name == "*") {
+            wildcard = q;
+        }
+    }
+    
+    ContentEncoding best = ContentEncoding::Identity;
+    double best_q = 0.0;
+    auto consider = [&](ContentEncoding encoding, bool available, double q) {
+        if (q < 0.0) {
+            q = wildcard;
+        }
+        if (available && q > best_q) {
+            best = encoding;
+            best_q = q;
+        }
+    };
+    consider(ContentEncoding::Zstd, kZstdAvailable, zstd);
+    consider(ContentEncoding::Brotli, kBrotliAvailable, brotli);
+    consider(ContentEncoding::Gzip, GzipCompressor::available(), gzip);
+    return best;
+}
+
+const char* encoding_name(ContentEncoding encoding) {
+    switch (encoding) {
+    case ContentEncoding::Gzip:
+        return "gzip";
+    case ContentEncoding::Brotli:
+        return "br";
+    case ContentEncoding::Zstd:
+        return "zstd";
+    default:
+        return "";
+    }
+}
+
+bool compress_body(ContentEncoding encoding, const std::string& input, std::string& out, int level) {
+    out.clear();
+    switch (encoding) {
+    case ContentEncoding::Gzip: {
+        if (!GzipCompressor::available()) {
+            return false;
+        }
+        GzipCompressor gzip(level > 0 ? level : 6);
+        return gzip.compress(input.data(), input.size(), true, out);
+    }
+    case ContentEncoding::Brotli: {
+#ifdef CPPHTTPLIB_BROTLI_SUPPORT
+        size_t size = BrotliEncoderMaxCompressedSize(input.size());
+        if (size == 0) {
+            return false;
+        }
+        out.resize(size);
+        const int quality = level > 0 ? level : kBrotliQuality;
+        if (!BrotliEncoderCompress(quality, BROTLI_DEFAULT_WINDOW, BROTLI_MODE_TEXT, input.size(),
+                                   reinterpret_cast<const uint8_t*>(input.data()), &size,
+                                   reinterpret_cast<uint8_t*>(out.data()))) {
+            spdlog::error("Brotli compression failed");
+            out.clear();
+            return false;
+        }
+        out.resize(size);
+        return true;
+#else
+        return false;
+#endif
+    }
+    case ContentEncoding::Zstd: {
+#ifdef MCP_ZSTD_SUPPORT
+        out.resize(ZSTD_compressBound(input.size()));
+        const size_t size = ZSTD_compress(out.data(), out.size(), input.data(), input.size(),
+                                         level > 0 ? level : kZstdLevel);
+        if (ZSTD_isError(size)) {
+            spdlog::error("Zstd compression failed: {}", ZSTD_getErrorName(size));
+            out.clear();
+            return false;
+        }
+        out.resize(size);
+        return true;
+#else
+        return false;
+#endif
+    }
+    default:
+        return false;
+    }
+}
+
+} // namespace mcp
@@ -51,6 +51,11 @@ bool Config::validate() const {
         return false;
     }
     
+    if (mcp_batch_workers_ <= 0) {
+        spdlog::error("MCP batch workers must be positive");
+        return false;
+    }
+    
     // 验证主机地址
     if (host_.empty()) {
         spdlog::error("Host cannot be empty");
@@ -63,6 +68,77 @@ bool Config::validate() const {
         return false;
     }
     
+    if (database_reader_connections_ < 0 || database_busy_timeout_ms_ < 0 || database_mmap_size_ < 0 ||
+        database_search_count_cache_size_ < 0) {
+        spdlog::error("Database pool settings cannot be negative");
+        return false;
+    }
+    
+    if (database_write_batch_size_ <= 0) {
+        spdlog::error("Database write batch size must be positive");
+        return false;
+    }
+    
+    if (content_cache_mb_ < 0 || content_cache_shards_ <= 0) {
+        spdlog::error("Invalid content cache settings");
+        return false;
+    }
+    
+    if (compression_min_bytes_ < 0) {
+        spdlog::error("Compression threshold cannot be negative");
+        return false;
+    }
+    
+    if (static_files_cache_mb_ < 0) {
+        spdlog::error("Static files cache size cannot be negative");
+        return false;
+    }
+    
+    if (llama_server_port_ < 1 || llama_server_port_ > 65535) {
+        spdlog::error("Invalid llama server port: {}", llama_server_port_);
+        return false;
+    }
+    
+    if (llama_startup_timeout_ <= 0 || llama_request_timeout_ <= 0) {
+        spdlog::error("LLaMA timeouts must be positive");
+        return false;
+    }
+    
+    if (parse_chunk_size_ < 0) {
+        spdlog::error("Parse chunk size cannot be negative");
+        return false;
+    }
+    
+    if (jobs_worker_threads_ <= 0 || jobs_queue_capacity_ <= 0) {
+        spdlog::error("Job worker threads and queue capacity must be positive");
+        return false;
+    }
+    
+    if (!embedding_provider_.empty() && embedding_provider_ != "ollama" && embedding_provider_ != "llama") {
+        spdlog::error("Embedding provider must be 'ollama', 'llama' or empty");
+        return false;
+    }
+    
+    if ((embedding_format_ != "int8" && embedding_format_ != "f16") || embedding_max_chars_ <= 0) {
+        spdlog::error("Invalid embedding settings");
+        return false;
+    }
+    
+    if (ollama_timeout_ <= 0 || ollama_models_cache_ttl_ < 0) {
+        spdlog::error("Invalid Ollama timeout settings");
+        return false;
+    }
+    
+    if (llama_parallel_slots_ <= 0 || llama_queue_capacity_ <= 0) {
+        spdlog::error("LLaMA parallel slots and queue capacity must be positive");
+        return false;
+    }
+    
+    if (llama_cache_memory_mb_ < 0 || llama_cache_disk_mb_ < 0 || llama_cache_ttl_ <= 0) {
+        spdlog::error("Invalid LLaMA response cache settings");
+        return false;
+    }
+    
     // 验证内容大小限制
     if (max_content_size_ <= 0) {
         spdlog::error("Max content size must be positive");
@@ -88,7 +164,15 @@ nlohmann::json Config::to_json() const {
     
     config["host"] = host_;
     config["port"] = port_;
+    config["mcp_batch_workers"] = mcp_batch_workers_;
     config["database_path"] = database_path_;
+    config["database_reader_connections"] = database_reader_connections_;
+    config["database_busy_timeout_ms"] = database_busy_timeout_ms_;
+    config["database_mmap_size"] = database_mmap_size_;
+    config["database_search_count_cache_size"] = database_search_count_cache_size_;
+    config["database_write_batch_size"] = database_write_batch_size_;
+    config["content_cache_mb"] = content_cache_mb_;
+    config["content_cache_shards"] = content_cache_shards_;
     config["log_level"] = log_level_;
     config["log_file"] = log_file_;
     config["max_content_size"] = max_content_size_;
@@ -98,12 +182,20 @@ nlohmann::json Config::to_json() const {
     config["cors_origin"] = cors_origin_;
     config["static_files_path"] = static_files_path_;
     config["enable_static_files"] = enable_static_files_;
+    config["static_files_cache_mb"] = static_files_cache_mb_;
+    config["enable_compression"] = enable_compression_;
+    config["compression_min_bytes"] = compression_min_bytes_;
     
     // 文件上传配置
     config["upload_path"] = upload_path_;
     config["max_file_size"] = max_file_size_;
     config["allowed_file_types"] = allowed_file_types_;
     config["enable_file_upload"] = enable_file_upload_;
+    config["parse_chunk_size"] = parse_chunk_size_;
+    
+    // 后台任务配置
+    config["jobs_worker_threads"] = jobs_worker_threads_;
+    config["jobs_queue_capacity"] = jobs_queue_capacity_;
     
     // LLaMA.cpp配置
     config["llama_model_path"] = llama_model_path_;
@@ -112,6 +204,17 @@ nlohmann::json Config::to_json() const {
     config["llama_threads"] = llama_threads_;
     config["llama_temperature"] = llama_temperature_;
     config["llama_max_tokens"] = llama_max_tokens_;
+    config["llama_server_url"] = llama_server_url_;
+    config["llama_server_port"] = llama_server_port_;
+    config["llama_startup_timeout"] = llama_startup_timeout_;
+    config["llama_request_timeout"] = llama_request_timeout_;
+    config["llama_parallel_slots"] = llama_parallel_slots_;
+    config["llama_queue_capacity"] = llama_queue_capacity_;
+    config["llama_cache_enabled"] = llama_cache_enabled_;
+    config["llama_cache_memory_mb"] = llama_cache_memory_mb_;
+    config["llama_cache_disk_path"] = llama_cache_disk_path_;
+    config["llama_cache_disk_mb"] = llama_cache_disk_mb_;
+    config["llama_cache_ttl"] = llama_cache_ttl_;
     config["enable_llama"] = enable_llama_;
     
     // Ollama配置
@@ -121,15 +224,30 @@ nlohmann::json Config::to_json() const {
     config["ollama_temperature"] = ollama_temperature_;
     config["ollama_max_tokens"] = ollama_max_tokens_;
     config["ollama_timeout"] = ollama_timeout_;
+    config["ollama_models_cache_ttl"] = ollama_models_cache_ttl_;
     config["enable_ollama"] = enable_ollama_;
     
+    // 语义检索配置
+    config["embedding_provider"] = embedding_provider_;
+    config["embedding_model"] = embedding_model_;
+    config["embedding_format"] = embedding_format_;
+    config["embedding_max_chars"] = embedding_max_chars_;
+    
     return config;
 }
 
 void Config::load_defaults() {
     host_ = "127.0.0.1";
     port_ = 8086;
+    mcp_batch_workers_ = 4;
     database_path_ = "./data/content.db";
+    database_reader_connections_ = 0;
+    database_busy_timeout_ms_ = 5000;
+    database_mmap_size_ = 256LL * 1024 * 1024; // 256MB
+    database_search_count_cache_size_ = 256;
+    database_write_batch_size_ = 500;
+    content_cache_mb_ = 32;
+    content_cache_shards_ = 16;
     log_level_ = "info";
     log_file_ = "";
     max_content_size_ = 1024 * 1024; // 1MB
@@ -137,22 +255,41 @@ void Config::load_defaults() {
     max_page_size_ = 100;
     enable_cors_ = true;
     cors_origin_ = "*";
-    static_files_path_ = "./web";
+    static_files_path_ = "./web/build";
     enable_static_files_ = true;
+    static_files_cache_mb_ = 64;
+    enable_compression_ = true;
+    compression_min_bytes_ = 1024;
     
     // 文件上传默认配置
     upload_path_ = "./uploads";
     max_file_size_ = 10 * 1024 * 1024; // 10MB
     allowed_file_types_ = {".txt", ".md", ".pdf", ".doc", ".docx", ".jpg", ".png", ".gif"};
     enable_file_upload_ = true;
+    parse_chunk_size_ = 0;
+    
+    // 后台任务默认配置
+    jobs_worker_threads_ = 2;
+    jobs_queue_capacity_ = 100;
     
     // LLaMA.cpp默认配置
     llama_model_path_ = "";
-    llama_executable_path_ = "./llama.cpp/main";
+    llama_executable_path_ = "./llama.cpp/llama-server";
     llama_context_size_ = 2048;
     llama_threads_ = 4;
     llama_temperature_ = 0.7f;
     llama_max_tokens_ = 512;
+    llama_server_url_ = "";
+    llama_server_port_ = 8090;
+    llama_startup_timeout_ = 120;
+    llama_request_timeout_ = 300;
+    llama_parallel_slots_ = 2;
+    llama_queue_capacity_ = 64;
+    llama_cache_enabled_ = true;
+    llama_cache_memory_mb_ = 64;
+    llama_cache_disk_path_ = "./cache/llama";
+    llama_cache_disk_mb_ = 256;
+    llama_cache_ttl_ = 86400;
     enable_llama_ = false;
     
     // Ollama默认配置
@@ -162,7 +299,14 @@ void Config::load_defaults() {
     ollama_temperature_ = 0.7f;
     ollama_max_tokens_ = 512;
     ollama_timeout_ = 30;
+    ollama_models_cache_ttl_ = 30;
     enable_ollama_ = false;
+    
+    // 语义检索默认配置
+    embedding_provider_ = "";
+    embedding_model_ = "nomic-embed-text";
+    embedding_format_ = "int8";
+    embedding_max_chars_ = 8000;
 }
 
 void Config::apply_config(const nlohmann::json& config) {
@@ -172,9 +316,33 @@ void Config::apply_config(const nlohmann::json& config) {
     if (config.contains("port")) {
         port_ = config["port"].get<int>();
     }
+    if (config.contains("mcp_batch_workers")) {
+        mcp_batch_workers_ = config["mcp_batch_workers"].get<int>();
+    }
     if (config.contains("database_path")) {
         database_path_ = config["database_path"].get<std::string>();
     }
+    if (config.contains("database_reader_connections")) {
+        database_reader_connections_ = config["database_reader_connections"].get<int>();
+    }
+    if (config.contains("database_busy_timeout_ms")) {
+        database_busy_timeout_ms_ = config["database_busy_timeout_ms"].get<int>();
+    }
+    if (config.contains("database_mmap_size")) {
+        database_mmap_size_ = config["database_mmap_size"].get<int64_t>();
+    }
+    if (config.contains("database_search_count_cache_size")) {
+        database_search_count_cache_size_ = config["database_search_count_cache_size"].get<int>();
+    }
+    if (config.contains("database_write_batch_size")) {
+        database_write_batch_size_ = config["database_write_batch_size"].get<int>();
+    }
+    if (config.contains("content_cache_mb")) {
+        content_cache_mb_ = config["content_cache_mb"].get<int>();
+    }
+    if (config.contains("content_cache_shards")) {
+        content_cache_shards_ = config["content_cache_shards"].get<int>();
+    }
     if (config.contains("log_level")) {
         log_level_ = config["log_level"].get<std::string>();
     }
@@ -202,6 +370,15 @@ void Config::apply_config(const nlohmann::json& config) {
     if (config.contains("enable_static_files")) {
         enable_static_files_ = config["enable_static_files"].get<bool>();
     }
+    if (config.contains("static_files_cache_mb")) {
+        static_files_cache_mb_ = config["static_files_cache_mb"].get<int>();
+    }
+    if (config.contains("enable_compression")) {
+        enable_compression_ = config["enable_compression"].get<bool>();
+    }
+    if (config.contains("compression_min_bytes")) {
+        compression_min_bytes_ = config["compression_min_bytes"].get<int>();
+    }
     
     // 文件上传配置
     if (config.contains("upload_path")) {
@@ -216,6 +393,17 @@ void Config::apply_config(const nlohmann::json& config) {
     if (config.contains("enable_file_upload")) {
         enable_file_upload_ = config["enable_file_upload"].get<bool>();
     }
+    if (config.contains("parse_chunk_size")) {
+        parse_chunk_size_ = config["parse_chunk_size"].get<int>();
+    }
+    
+    // 后台任务配置
+    if (config.contains("jobs_worker_threads")) {
+        jobs_worker_threads_ = config["jobs_worker_threads"].get<int>();
+    }
+    if (config.contains("jobs_queue_capacity")) {
+        jobs_queue_capacity_ = config["jobs_queue_capacity"].get<int>();
+    }
     
     // LLaMA.cpp配置
     if (config.contains("llama_model_path")) {
@@ -236,6 +424,39 @@ void Config::apply_config(const nlohmann::json& config) {
     if (config.contains("llama_max_tokens")) {
         llama_max_tokens_ = config["llama_max_tokens"].get<int>();
     }
+    if (config.contains("llama_server_url")) {
+        llama_server_url_ = config["llama_server_url"].get<std::string>();
+    }
+    if (config.contains("llama_server_port")) {
+        llama_server_port_ = config["llama_server_port"].get<int>();
+    }
+    if (config.contains("llama_startup_timeout")) {
+        llama_startup_timeout_ = config["llama_startup_timeout"].get<int>();
+    }
+    if (config.contains("llama_request_timeout")) {
+        llama_request_timeout_ = config["llama_request_timeout"].get<int>();
+    }
+    if (config.contains("llama_parallel_slots")) {
+        llama_parallel_slots_ = config["llama_parallel_slots"].get<int>();
+    }
+    if (config.contains("llama_queue_capacity")) {
+        llama_queue_capacity_ = config["llama_queue_capacity"].get<int>();
+    }
+    if (config.contains("llama_cache_enabled")) {
+        llama_cache_enabled_ = config["llama_cache_enabled"].get<bool>();
+    }
+    if (config.contains("llama_cache_memory_mb")) {
+        llama_cache_memory_mb_ = config["llama_cache_memory_mb"].get<int>();
+    }
+    if (config.contains("llama_cache_disk_path")) {
+        llama_cache_disk_path_ = config["llama_cache_disk_path"].get<std::string>();
+    }
+    if (config.contains("llama_cache_disk_mb")) {
+        llama_cache_disk_mb_ = config["llama_cache_disk_mb"].get<int>();
+    }
+    if (config.contains("llama_cache_ttl")) {
+        llama_cache_ttl_ = config["llama_cache_ttl"].get<int>();
+    }
     if (config.contains("enable_llama")) {
         enable_llama_ = config["enable_llama"].get<bool>();
     }
@@ -259,9 +480,26 @@ void Config::apply_config(const nlohmann::json& config) {
     if (config.contains("ollama_timeout")) {
         ollama_timeout_ = config["ollama_timeout"].get<int>();
     }
+    if (config.contains("ollama_models_cache_ttl")) {
+        ollama_models_cache_ttl_ = config["ollama_models_cache_ttl"].get<int>();
+    }
     if (config.contains("enable_ollama")) {
         enable_ollama_ = config["enable_ollama"].get<bool>();
     }
+    
+    // 语义检索配置
+    if (config.contains("embedding_provider")) {
+        embedding_provider_ = config["embedding_provider"].get<std::string>();
+    }
+    if (config.contains("embedding_model")) {
+        embedding_model_ = config["embedding_model"].get<std::string>();
+    }
+    if (config.contains("embedding_format")) {
+        embedding_format_ = config["embedding_format"].get<std::string>();
+    }
+    if (config.contains("embedding_max_chars")) {
+        embedding_max_chars_ = config["embedding_max_chars"].get<int>();
+    }
 }
 
 bool Config::update_config(const nlohmann::json& new_config) {
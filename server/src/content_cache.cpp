@@ -0,0 +1,128 @@
+#include "content_cache.hpp"
+#include <algorithm>
+
+namespace mcp {
+
+namespace {
+
+// 每个条目除正文外的簿记开销估算（链表节点、哈希桶、控制块）
+constexpr size_t kEntryOverhead = 96;
+
+size_t entry_bytes(const CachedContent& value) {
+    return value.size() + kEntryOverhead;
+}
+
+} // namespace
+
+ContentCache::ContentCache(size_t capacity_bytes, size_t shards) {
+    shards = std::max<size_t>(shards, 1);
+    shard_capacity_ = capacity_bytes / shards;
+    shards_.reserve(shards);
+    for (size_t i = 0; i < shards; ++i) {
+        shards_.push_back(std::make_unique<Shard>());
+    }
+}
+
+ContentCache::Shard& ContentCache::shard_for(int64_t id) const {
+    // 自增ID相邻，取模即可均匀分布
+    return *shards_[static_cast<uint64_t>(id) % shards_.size()];
+}
+
+std::shared_ptr<const CachedContent> ContentCache::get(int64_t id, uint64_t& version) {
+    Shard& shard = shard_for(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(id);
+    if (it == shard.index.end()) {
+        shard.misses++;
+        version = shard.version;
+        return nullptr;
+    }
+    shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+    shard.hits++;
+    return it->second->second;
+}
+
+void ContentCache::put(int64_t id, std::shared_ptr<const CachedContent> value, uint64_t version) {
+    if (!value) {
+        return;
+    }
+    const size_t size = entry_bytes(*value);
+    if (size > shard_capacity_) {
+        return;
+    }
+
+    Shard& shard = shard_for(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (shard.version != version) {
+        return;
+    }
+
+    auto it = shard.index.find(id);
+    if (it != shard.index.end()) {
+        erase_locked(shard, it);
+    }
+    while (!shard.lru.empty() && shard.bytes + size > shard_capacity_) {
+        erase_locked(shard, shard.index.find(shard.lru.back().first));
+        shard.evictions++;
+    }
+
+    shard.lru.emplace_front(id, std::move(value));
+    shard.index[id] = shard.lru.begin();
+    shard.bytes += size;
+}
+
+void ContentCache::invalidate(int64_t id) {
+    Shard& shard = shard_for(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.version++;
+    auto it = shard.index.find(id);
+    if (it != shard.index.end()) {
+        erase_locked(shard, it);
+    }
+}
+
+void ContentCache::clear() {
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->version++;
+        shard->lru.clear();
+        shard->index.clear();
+        shard->bytes = 0;
+    }
+}
+
+void ContentCache::erase_locked(Shard& shard,
+                                std::unordered_map<int64_t, std::list<Shard::Entry>::iterator>::iterator it) {
+    shard.bytes -= entry_bytes(*it->second->second);
+    shard.lru.erase(it->second);
+    shard.index.erase(it);
+}
+
+nlohmann::json ContentCache::get_statistics() const {
+    size_t entries = 0;
+    size_t bytes = 0;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        entries += shard->index.size();
+        bytes += shard->bytes;
+        hits += shard->hits;
+        misses += shard->misses;
+        evictions += shard->evictions;
+    }
+
+    nlohmann::json stats;
+    stats["entries"] = entries;
+    stats["bytes"] = bytes;
+    stats["capacity_bytes"] = shard_capacity_ * shards_.size();
+    stats["shards"] = shards_.size();
+    stats["hits"] = hits;
+    stats["misses"] = misses;
+    stats["evictions"] = evictions;
+    stats["hit_rate"] = hits + misses > 0 ? static_cast<double>(hits) / static_cast<double>(hits + misses) : 0.0;
+    return stats;
+}
+
+} // namespace mcp
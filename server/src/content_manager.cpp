@@ -1,27 +1,259 @@
 #include "content_manager.hpp"
+#include "json_writer.hpp"
 #include <algorithm>
 #include <spdlog/spdlog.h>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <sstream>
+#include <unordered_map>
 
 namespace mcp {
 
+namespace {
+
+const char kBase64UrlChars[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+std::string base64url_encode(const std::string &input) {
+  std::string out;
+  out.reserve((input.size() + 2) / 3 * 4);
+  uint32_t buffer = 0;
+  int bits = 0;
+  for (unsigned char c : input) {
+    buffer = (buffer << 8) | c;
+    bits += 8;
+    while (bits >= 6) {
+      bits -= 6;
+      out.push_back(kBase64UrlChars[(buffer >> bits) & 0x3F]);
+    }
+  }
+  if (bits > 0) {
+    out.push_back(kBase64UrlChars[(buffer << (6 - bits)) & 0x3F]);
+  }
+  return out;
+}
+
+bool base64url_decode(const std::string &input, std::string &out) {
+  out.clear();
+  uint32_t buffer = 0;
+  int bits = 0;
+  for (char c : input) {
+    const char *pos = std::strchr(kBase64UrlChars, c);
+    if (c == '\0' || pos == nullptr) {
+      return false;
+    }
+    buffer = (buffer << 6) | static_cast<uint32_t>(pos - kBase64UrlChars);
+    bits += 6;
+    if (bits >= 8) {
+      bits -= 8;
+      out.push_back(static_cast<char>((buffer >> bits) & 0xFF));
+    }
+  }
+  return true;
+}
+
+// 游标格式: base64url("<kind>|<key>|<id>")
+// kind: l=列表, t=标签, s=搜索（key为FTS rank）
+std::string encode_cursor(char kind, const PageCursor &cursor) {
+  char buf[96];
+  if (kind == 's') {
+    std::snprintf(buf, sizeof(buf), "s|%.17g|%lld", cursor.rank,
+                  static_cast<long long>(cursor.id));
+  } else {
+    std::snprintf(buf, sizeof(buf), "%c|%lld|%lld", kind,
+                  static_cast<long long>(cursor.updated_at),
+                  static_cast<long long>(cursor.id));
+  }
+  return base64url_encode(buf);
+}
+
+bool decode_cursor(char kind, const std::string &token, PageCursor &cursor) {
+  std::string raw;
+  if (token.size() > 128 || !base64url_decode(token, raw)) {
+    return false;
+  }
+  if (raw.size() < 5 || raw[0] != kind || raw[1] != '|') {
+    return false;
+  }
+  auto sep = raw.find('|', 2);
+  if (sep == std::string::npos) {
+    return false;
+  }
+  std::string key = raw.substr(2, sep - 2);
+  std::string id = raw.substr(sep + 1);
+  if (key.empty() || id.empty()) {
+    return false;
+  }
+
+  char *end = nullptr;
+  if (kind == 's') {
+    cursor.rank = std::strtod(key.c_str(), &end);
+  } else {
+    cursor.updated_at = std::strtoll(key.c_str(), &end, 10);
+  }
+  if (*end != '\0') {
+    return false;
+  }
+  cursor.id = std::strtoll(id.c_str(), &end, 10);
+  return *end == '\0';
+}
+
+// 把自然语言查询转成FTS5的OR查询，每个词加引号以避免语法错误
+std::string to_fts_any_query(const std::string &text) {
+  std::string query;
+  std::string word;
+  auto flush = [&]() {
+    if (word.size() >= 2) {
+      if (!query.empty()) {
+        query += " OR ";
+      }
+      query += "\"" + word + "\"";
+    }
+    word.clear();
+  };
+  for (unsigned char c : text) {
+    // 非ASCII字节（UTF-8多字节字符）视为词的一部分
+    if (std::isalnum(c) || c >= 0x80) {
+      word.push_back(static_cast<char>(c));
+    } else {
+      flush();
+    }
+  }
+  flush();
+  return query;
+}
+
+// 单条内容没有经过SQL投影，预览在这里截取；按UTF-8字符计数，与SQLite的substr一致
+std::string make_preview(const std::string &content, size_t max_chars = 200) {
+  size_t chars = 0;
+  size_t i = 0;
+  while (i < content.size()) {
+    if ((static_cast<unsigned char>(content[i]) & 0xC0) != 0x80) {
+      if (chars == max_chars) {
+        break;
+      }
+      chars++;
+    }
+    i++;
+  }
+  return content.substr(0, i);
+}
+
+} // namespace
+
 // SearchResult JSON转换
 nlohmann::json SearchResult::to_json() const {
   nlohmann::json j;
   j["items"] = nlohmann::json::array();
   for (const auto &item : items) {
-    j["items"].push_back(item.to_json());
+    j["items"].push_back(item.to_json(fields));
   }
   j["total_count"] = total_count;
   j["page"] = page;
   j["page_size"] = page_size;
   j["total_pages"] = (total_count + page_size - 1) / page_size;
+  j["has_more"] = !next_cursor.empty();
+  j["next_cursor"] =
+      next_cursor.empty() ? nlohmann::json(nullptr) : nlohmann::json(next_cursor);
   return j;
 }
 
+void SearchResult::append_json(std::string &out) const {
+  out += "{\"items\":[";
+  for (size_t i = 0; i < items.size(); ++i) {
+    if (i > 0) {
+      out += ',';
+    }
+    items[i].append_json(out, fields);
+  }
+  out += "],\"total_count\":";
+  append_json_int(out, total_count);
+  out += ",\"page\":";
+  append_json_int(out, page);
+  out += ",\"page_size\":";
+  append_json_int(out, page_size);
+  out += ",\"total_pages\":";
+  append_json_int(out, (total_count + page_size - 1) / page_size);
+  out += ",\"has_more\":";
+  out += next_cursor.empty() ? "false" : "true";
+  out += ",\"next_cursor\":";
+  if (next_cursor.empty()) {
+    out += "null";
+  } else {
+    append_json_string(out, next_cursor);
+  }
+  out += '}';
+}
+
+// ContentImportSession实现
+ContentImportSession::ContentImportSession(ContentManager &manager,
+                                           size_t batch_size)
+    : manager_(manager), batch_size_(std::max<size_t>(1, batch_size)) {
+  pending_numbers_.reserve(batch_size_);
+}
+
+void ContentImportSession::add(size_t record_no, nlohmann::json record) {
+  pending_.push_back(std::move(record));
+  pending_numbers_.push_back(record_no);
+  if (pending_.size() >= batch_size_) {
+    flush();
+  }
+}
+
+void ContentImportSession::add_error(size_t record_no,
+                                     const std::string &message) {
+  processed_++;
+  error_count_++;
+  if (errors_.size() < kMaxReportedErrors) {
+    errors_.push_back("Line " + std::to_string(record_no) + ": " + message);
+  }
+}
+
+void ContentImportSession::flush() {
+  if (pending_.empty()) {
+    return;
+  }
+
+  std::vector<int64_t> created_ids;
+  std::vector<std::string> errors;
+  manager_.create_items(pending_, pending_numbers_, "Line", created_ids, errors);
+
+  processed_ += pending_.size();
+  created_ += created_ids.size();
+  error_count_ += errors.size();
+  for (auto &error : errors) {
+    if (errors_.size() >= kMaxReportedErrors) {
+      break;
+    }
+    errors_.push_back(std::move(error));
+  }
+
+  pending_ = nlohmann::json::array();
+  pending_numbers_.clear();
+}
+
+nlohmann::json ContentImportSession::summary() const {
+  nlohmann::json result;
+  result["processed_count"] = processed_;
+  result["created_count"] = created_;
+  result["error_count"] = error_count_;
+  if (!errors_.empty()) {
+    result["errors"] = errors_;
+    result["errors_truncated"] = error_count_ > errors_.size();
+  }
+  return result;
+}
+
 // ContentManager实现
-ContentManager::ContentManager(std::shared_ptr<Database> db)
-    : db_(std::move(db)) {}
+ContentManager::ContentManager(std::shared_ptr<Database> db,
+                               size_t cache_bytes, size_t cache_shards)
+    : db_(std::move(db)) {
+  if (cache_bytes > 0) {
+    cache_ = std::make_unique<ContentCache>(cache_bytes, cache_shards);
+  }
+}
 
 nlohmann::json ContentManager::create_content(const nlohmann::json &request) {
   try {
@@ -36,6 +268,10 @@ nlohmann::json ContentManager::create_content(const nlohmann::json &request) {
     if (!id) {
       return create_error_response("Failed to create content", 500);
     }
+    if (semantic_index_) {
+      semantic_index_->enqueue(*id);
+    }
+    notify_changed();
 
     // 返回创建的内容
     auto created_item = db_->get_content(*id);
@@ -53,14 +289,63 @@ nlohmann::json ContentManager::create_content(const nlohmann::json &request) {
   }
 }
 
-nlohmann::json ContentManager::get_content(int64_t id) {
+bool ContentManager::parse_fields(const std::string &spec, uint32_t &fields,
+                                  std::string &error_msg) {
+  static const std::unordered_map<std::string, uint32_t> kFieldNames = {
+      {"id", content_fields::kId},
+      {"title", content_fields::kTitle},
+      {"content", content_fields::kContent},
+      {"content_type", content_fields::kContentType},
+      {"tags", content_fields::kTags},
+      {"metadata", content_fields::kMetadata},
+      {"created_at", content_fields::kCreatedAt},
+      {"updated_at", content_fields::kUpdatedAt},
+      {"preview", content_fields::kPreview},
+      {"summary", content_fields::kSummary},
+  };
+
+  fields = content_fields::kId;
+  bool any = false;
+  std::stringstream ss(spec);
+  std::string name;
+  while (std::getline(ss, name, ',')) {
+    name.erase(0, name.find_first_not_of(" \t"));
+    name.erase(name.find_last_not_of(" \t") + 1);
+    if (name.empty()) {
+      continue;
+    }
+    auto it = kFieldNames.find(name);
+    if (it == kFieldNames.end()) {
+      error_msg = "Unknown field: " + name;
+      return false;
+    }
+    fields |= it->second;
+    any = true;
+  }
+  if (!any) {
+    fields = content_fields::kDefault;
+  }
+  return true;
+}
+
+nlohmann::json ContentManager::get_content(int64_t id,
+                                           const std::string &fields) {
   try {
+    uint32_t projection = content_fields::kDefault;
+    std::string error_msg;
+    if (!parse_fields(fields, projection, error_msg)) {
+      return create_error_response(error_msg, 400);
+    }
+
     auto item = db_->get_content(id);
     if (!item) {
       return create_error_response("Content not found", 404);
     }
+    if (projection & content_fields::kPreview) {
+      item->preview = make_preview(item->content);
+    }
 
-    return create_success_response(item->to_json());
+    return create_success_response(item->to_json(projection));
 
   } catch (const std::exception &e) {
     spdlog::error("Error getting content: {}", e.what());
@@ -68,6 +353,62 @@ nlohmann::json ContentManager::get_content(int64_t id) {
   }
 }
 
+std::shared_ptr<const CachedContent>
+ContentManager::get_cached_content(int64_t id) {
+  uint64_t version = 0;
+  if (cache_) {
+    auto cached = cache_->get(id, version);
+    if (cached) {
+      return cached;
+    }
+  }
+
+  auto item = db_->get_content(id);
+  if (!item) {
+    return nullptr;
+  }
+
+  auto value = std::make_shared<CachedContent>();
+  value->response = create_success_response(item->to_json()).dump(2);
+  value->content = std::move(item->content);
+  if (cache_) {
+    cache_->put(id, value, version);
+  }
+  return value;
+}
+
+void ContentManager::invalidate_cached(int64_t id) {
+  if (cache_) {
+    cache_->invalidate(id);
+  }
+}
+
+std::vector<ContentSummary>
+ContentManager::list_content_summaries(int64_t after_id, int limit) {
+  return db_->list_content_summaries(after_id, limit);
+}
+
+uint64_t ContentManager::get_change_version() const {
+  std::lock_guard<std::mutex> lock(change_mutex_);
+  return change_version_;
+}
+
+uint64_t ContentManager::wait_for_change(uint64_t version,
+                                         std::chrono::milliseconds timeout) const {
+  std::unique_lock<std::mutex> lock(change_mutex_);
+  change_cv_.wait_for(lock, timeout,
+                      [&]() { return change_version_ > version; });
+  return change_version_;
+}
+
+void ContentManager::notify_changed() {
+  {
+    std::lock_guard<std::mutex> lock(change_mutex_);
+    change_version_++;
+  }
+  change_cv_.notify_all();
+}
+
 nlohmann::json ContentManager::update_content(int64_t id,
                                               const nlohmann::json &request) {
   try {
@@ -86,9 +427,16 @@ nlohmann::json ContentManager::update_content(int64_t id,
     item.id = id;
     item.created_at = existing->created_at; // 保持原创建时间
 
+    // 写库前后各失效一次，配合版本号保证并发读到的旧值不会被写回缓存
+    invalidate_cached(id);
     if (!db_->update_content(item)) {
       return create_error_response("Failed to update content", 500);
     }
+    invalidate_cached(id);
+    if (semantic_index_) {
+      semantic_index_->enqueue(id);
+    }
+    notify_changed();
 
     // 返回更新后的内容
     auto updated_item = db_->get_content(id);
@@ -112,9 +460,15 @@ nlohmann::json ContentManager::delete_content(int64_t id) {
       return create_error_response("Content not found", 404);
     }
 
+    invalidate_cached(id);
     if (!db_->delete_content(id)) {
       return create_error_response("Failed to delete content", 500);
     }
+    invalidate_cached(id);
+    if (semantic_index_) {
+      semantic_index_->remove(id);
+    }
+    notify_changed();
 
     return create_success_response();
 
@@ -125,75 +479,292 @@ nlohmann::json ContentManager::delete_content(int64_t id) {
 }
 
 nlohmann::json ContentManager::search_content(const std::string &query,
-                                              int page, int page_size) {
+                                              int page, int page_size,
+                                              const std::string &cursor,
+                                              const std::string &fields) {
+  try {
+    SearchResult result;
+    nlohmann::json error;
+    if (!run_search(query, page, page_size, cursor, fields, result, error)) {
+      return error;
+    }
+    return create_success_response(result.to_json());
+
+  } catch (const std::exception &e) {
+    spdlog::error("Error searching content: {}", e.what());
+    return create_error_response("Internal server error", 500);
+  }
+}
+
+int ContentManager::search_content_serialized(const std::string &query,
+                                              int page, int page_size,
+                                              const std::string &cursor,
+                                              const std::string &fields,
+                                              std::string &body) {
+  try {
+    SearchResult result;
+    nlohmann::json error;
+    const bool ok =
+        run_search(query, page, page_size, cursor, fields, result, error);
+    return serialize_result(ok, result, error, body);
+
+  } catch (const std::exception &e) {
+    spdlog::error("Error searching content: {}", e.what());
+    body = create_error_response("Internal server error", 500).dump();
+    return 500;
+  }
+}
+
+bool ContentManager::run_search(const std::string &query, int page,
+                                int page_size, const std::string &cursor,
+                                const std::string &fields,
+                                SearchResult &result, nlohmann::json &error) {
+  if (query.empty()) {
+    error = create_error_response("Search query cannot be empty", 400);
+    return false;
+  }
+
+  uint32_t projection = content_fields::kDefault;
+  std::string error_msg;
+  if (!parse_fields(fields, projection, error_msg)) {
+    error = create_error_response(error_msg, 400);
+    return false;
+  }
+
+  if (page < 1)
+    page = 1;
+  if (page_size < 1 || page_size > 100)
+    page_size = 20;
+
+  std::optional<PageCursor> after;
+  if (!cursor.empty()) {
+    PageCursor decoded;
+    if (!decode_cursor('s', cursor, decoded)) {
+      error = create_error_response("Invalid cursor", 400);
+      return false;
+    }
+    after = decoded;
+  }
+
+  // 游标翻页走keyset查询；没有游标时按页码跳过前面的行，同样返回下一页游标
+  std::optional<PageCursor> next;
+  const int offset = after ? 0 : (page - 1) * page_size;
+  result.items = db_->search_content_page(query, after, page_size, next,
+                                          projection, offset);
+  if (next) {
+    result.next_cursor = encode_cursor('s', *next);
+  }
+  result.fields = projection;
+
+  result.total_count = static_cast<int>(db_->count_search_results(query));
+  result.page = page;
+  result.page_size = page_size;
+  return true;
+}
+
+nlohmann::json ContentManager::semantic_search(const std::string &query,
+                                               int limit,
+                                               const std::string &mode) {
   try {
     if (query.empty()) {
       return create_error_response("Search query cannot be empty", 400);
     }
+    if (!semantic_index_) {
+      return create_error_response("Semantic search is not enabled", 503);
+    }
+    if (mode != "hybrid" && mode != "vector") {
+      return create_error_response("Mode must be 'hybrid' or 'vector'", 400);
+    }
+    if (limit < 1 || limit > 100)
+      limit = 10;
+
+    // 多取候选再融合，向量与关键词结果重叠较少时仍能填满limit
+    const size_t candidates = static_cast<size_t>(limit) * 4;
+    auto vector_hits = semantic_index_->search(query, candidates);
+    if (!vector_hits) {
+      return create_error_response("Failed to compute query embedding", 502);
+    }
 
-    if (page < 1)
-      page = 1;
-    if (page_size < 1 || page_size > 100)
-      page_size = 20;
+    struct Ranked {
+      double score = 0.0;
+      std::optional<float> similarity;
+      std::optional<int> keyword_rank;
+    };
+    std::unordered_map<int64_t, Ranked> ranked;
+
+    // 倒数排名融合：score = Σ 1/(k + rank)，k取常用的60
+    constexpr double kRrfK = 60.0;
+    for (size_t i = 0; i < vector_hits->size(); ++i) {
+      const auto &[id, similarity] = (*vector_hits)[i];
+      auto &entry = ranked[id];
+      entry.similarity = similarity;
+      entry.score += mode == "hybrid" ? 1.0 / (kRrfK + i + 1) : similarity;
+    }
 
-    // 计算偏移量
-    int limit = page_size;
+    std::unordered_map<int64_t, ContentItem> items;
+    if (mode == "hybrid") {
+      const std::string fts_query = to_fts_any_query(query);
+      if (!fts_query.empty()) {
+        std::optional<PageCursor> next;
+        auto keyword_hits = db_->search_content_page(
+            fts_query, std::nullopt, static_cast<int>(candidates), next);
+        for (size_t i = 0; i < keyword_hits.size(); ++i) {
+          auto &entry = ranked[keyword_hits[i].id];
+          entry.keyword_rank = static_cast<int>(i + 1);
+          entry.score += 1.0 / (kRrfK + i + 1);
+          items.emplace(keyword_hits[i].id, std::move(keyword_hits[i]));
+        }
+      }
+    }
 
-    auto items = db_->search_content(query, limit);
+    std::vector<std::pair<int64_t, Ranked>> ordered(ranked.begin(),
+                                                    ranked.end());
+    std::sort(ordered.begin(), ordered.end(), [](const auto &a, const auto &b) {
+      return a.second.score != b.second.score ? a.second.score > b.second.score
+                                              : a.first < b.first;
+    });
+
+    nlohmann::json results = nlohmann::json::array();
+    for (const auto &[id, entry] : ordered) {
+      if (results.size() >= static_cast<size_t>(limit)) {
+        break;
+      }
+      auto it = items.find(id);
+      std::optional<ContentItem> item;
+      if (it != items.end()) {
+        item = std::move(it->second);
+      } else {
+        // 向量索引中可能残留刚删除的内容，取不到时跳过
+        item = db_->get_content(id);
+      }
+      if (!item) {
+        continue;
+      }
 
-    SearchResult result;
-    result.items = items;
-    result.total_count =
-        static_cast<int>(items.size()); // 简化实现，实际应该查询总数
-    result.page = page;
-    result.page_size = page_size;
+      nlohmann::json j = item->to_json();
+      j["score"] = entry.score;
+      if (entry.similarity) {
+        j["similarity"] = *entry.similarity;
+      }
+      if (entry.keyword_rank) {
+        j["keyword_rank"] = *entry.keyword_rank;
+      }
+      results.push_back(std::move(j));
+    }
 
-    return create_success_response(result.to_json());
+    nlohmann::json result;
+    result["items"] = results;
+    result["mode"] = mode;
+    result["count"] = results.size();
+    return create_success_response(result);
 
   } catch (const std::exception &e) {
-    spdlog::error("Error searching content: {}", e.what());
+    spdlog::error("Error in semantic search: {}", e.what());
     return create_error_response("Internal server error", 500);
   }
 }
 
 nlohmann::json ContentManager::get_content_by_tag(const std::string &tag,
-                                                  int page, int page_size) {
+                                                  int page, int page_size,
+                                                  const std::string &cursor,
+                                                  const std::string &fields) {
   try {
-    if (tag.empty()) {
-      return create_error_response("Tag cannot be empty", 400);
+    SearchResult result;
+    nlohmann::json error;
+    if (!run_tag_query(tag, page, page_size, cursor, fields, result, error)) {
+      return error;
     }
+    return create_success_response(result.to_json());
 
-    if (page < 1)
-      page = 1;
-    if (page_size < 1 || page_size > 100)
-      page_size = 20;
-
-    auto items = db_->get_content_by_tag(tag, page_size);
+  } catch (const std::exception &e) {
+    spdlog::error("Error getting content by tag: {}", e.what());
+    return create_error_response("Internal server error", 500);
+  }
+}
 
+int ContentManager::get_content_by_tag_serialized(const std::string &tag,
+                                                  int page, int page_size,
+                                                  const std::string &cursor,
+                                                  const std::string &fields,
+                                                  std::string &body) {
+  try {
     SearchResult result;
-    result.items = items;
-    result.total_count = static_cast<int>(items.size());
-    result.page = page;
-    result.page_size = page_size;
-
-    return create_success_response(result.to_json());
+    nlohmann::json error;
+    const bool ok =
+        run_tag_query(tag, page, page_size, cursor, fields, result, error);
+    return serialize_result(ok, result, error, body);
 
   } catch (const std::exception &e) {
     spdlog::error("Error getting content by tag: {}", e.what());
-    return create_error_response("Internal server error", 500);
+    body = create_error_response("Internal server error", 500).dump();
+    return 500;
+  }
+}
+
+bool ContentManager::run_tag_query(const std::string &tag, int page,
+                                   int page_size, const std::string &cursor,
+                                   const std::string &fields,
+                                   SearchResult &result,
+                                   nlohmann::json &error) {
+  if (tag.empty()) {
+    error = create_error_response("Tag cannot be empty", 400);
+    return false;
   }
+
+  uint32_t projection = content_fields::kDefault;
+  std::string error_msg;
+  if (!parse_fields(fields, projection, error_msg)) {
+    error = create_error_response(error_msg, 400);
+    return false;
+  }
+
+  if (page < 1)
+    page = 1;
+  if (page_size < 1 || page_size > 100)
+    page_size = 20;
+
+  std::optional<PageCursor> after;
+  if (!cursor.empty()) {
+    PageCursor decoded;
+    if (!decode_cursor('t', cursor, decoded)) {
+      error = create_error_response("Invalid cursor", 400);
+      return false;
+    }
+    after = decoded;
+  }
+
+  std::optional<PageCursor> next;
+  const int offset = after ? 0 : (page - 1) * page_size;
+  result.items = db_->get_content_by_tag_page(tag, after, page_size, next,
+                                              projection, offset);
+  if (next) {
+    result.next_cursor = encode_cursor('t', *next);
+  }
+  result.fields = projection;
+
+  result.total_count = static_cast<int>(db_->count_content_by_tag(tag));
+  result.page = page;
+  result.page_size = page_size;
+  return true;
 }
 
-nlohmann::json ContentManager::get_recent_content(int limit) {
+nlohmann::json ContentManager::get_recent_content(int limit,
+                                                  const std::string &fields) {
   try {
     if (limit < 1 || limit > 100)
       limit = 20;
 
-    auto items = db_->get_recent_content(limit);
+    uint32_t projection = content_fields::kDefault;
+    std::string error_msg;
+    if (!parse_fields(fields, projection, error_msg)) {
+      return create_error_response(error_msg, 400);
+    }
+
+    auto items = db_->get_recent_content(limit, projection);
 
     nlohmann::json result = nlohmann::json::array();
     for (const auto &item : items) {
-      result.push_back(item.to_json());
+      result.push_back(item.to_json(projection));
     }
 
     return create_success_response(result);
@@ -204,23 +775,15 @@ nlohmann::json ContentManager::get_recent_content(int limit) {
   }
 }
 
-nlohmann::json ContentManager::list_content(int page, int page_size) {
+nlohmann::json ContentManager::list_content(int page, int page_size,
+                                            const std::string &cursor,
+                                            const std::string &fields) {
   try {
-    if (page < 1)
-      page = 1;
-    if (page_size < 1 || page_size > 100)
-      page_size = 20;
-
-    int offset = (page - 1) * page_size;
-    auto items = db_->list_all_content(offset, page_size);
-    auto total_count = db_->get_content_count();
-
     SearchResult result;
-    result.items = items;
-    result.total_count = static_cast<int>(total_count);
-    result.page = page;
-    result.page_size = page_size;
-
+    nlohmann::json error;
+    if (!run_list(page, page_size, cursor, fields, result, error)) {
+      return error;
+    }
     return create_success_response(result.to_json());
 
   } catch (const std::exception &e) {
@@ -229,15 +792,87 @@ nlohmann::json ContentManager::list_content(int page, int page_size) {
   }
 }
 
+int ContentManager::list_content_serialized(int page, int page_size,
+                                            const std::string &cursor,
+                                            const std::string &fields,
+                                            std::string &body) {
+  try {
+    SearchResult result;
+    nlohmann::json error;
+    const bool ok = run_list(page, page_size, cursor, fields, result, error);
+    return serialize_result(ok, result, error, body);
+
+  } catch (const std::exception &e) {
+    spdlog::error("Error listing content: {}", e.what());
+    body = create_error_response("Internal server error", 500).dump();
+    return 500;
+  }
+}
+
+bool ContentManager::run_list(int page, int page_size,
+                              const std::string &cursor,
+                              const std::string &fields, SearchResult &result,
+                              nlohmann::json &error) {
+  if (page < 1)
+    page = 1;
+  if (page_size < 1 || page_size > 100)
+    page_size = 20;
+
+  uint32_t projection = content_fields::kDefault;
+  std::string error_msg;
+  if (!parse_fields(fields, projection, error_msg)) {
+    error = create_error_response(error_msg, 400);
+    return false;
+  }
+
+  std::optional<PageCursor> after;
+  if (!cursor.empty()) {
+    PageCursor decoded;
+    if (!decode_cursor('l', cursor, decoded)) {
+      error = create_error_response("Invalid cursor", 400);
+      return false;
+    }
+    after = decoded;
+  }
+
+  std::optional<PageCursor> next;
+  const int offset = after ? 0 : (page - 1) * page_size;
+  result.items =
+      db_->list_content_page(after, page_size, next, projection, offset);
+  if (next) {
+    result.next_cursor = encode_cursor('l', *next);
+  }
+  result.fields = projection;
+
+  result.total_count = static_cast<int>(db_->get_content_count());
+  result.page = page;
+  result.page_size = page_size;
+  return true;
+}
+
 nlohmann::json ContentManager::get_statistics() {
   try {
-    auto total_count = db_->get_content_count();
-    auto tags = db_->get_all_tags();
+    // 计数由写入事务内的触发器维护，这里只读取统计表
+    auto counts = db_->get_content_stats();
 
     nlohmann::json stats;
-    stats["total_content"] = total_count;
-    stats["total_tags"] = tags.size();
-    stats["tags"] = tags;
+    stats["total_content"] = counts.total_count;
+    stats["total_bytes"] = counts.total_bytes;
+    stats["total_tags"] = counts.tag_counts.size();
+    stats["tags"] = nlohmann::json::array();
+    stats["tag_counts"] = nlohmann::json::object();
+    for (const auto &[tag, count] : counts.tag_counts) {
+      stats["tags"].push_back(tag);
+      stats["tag_counts"][tag] = count;
+    }
+    stats["content_type_counts"] = nlohmann::json::object();
+    for (const auto &[type, count] : counts.type_counts) {
+      stats["content_type_counts"][type] = count;
+    }
+    stats["database"] = db_->get_database_statistics();
+    if (cache_) {
+      stats["content_cache"] = cache_->get_statistics();
+    }
 
     return create_success_response(stats);
 
@@ -247,6 +882,10 @@ nlohmann::json ContentManager::get_statistics() {
   }
 }
 
+nlohmann::json ContentManager::get_cache_statistics() const {
+  return cache_ ? cache_->get_statistics() : nlohmann::json();
+}
+
 nlohmann::json ContentManager::get_tags() {
   try {
     auto tags = db_->get_all_tags();
@@ -258,7 +897,8 @@ nlohmann::json ContentManager::get_tags() {
   }
 }
 
-nlohmann::json ContentManager::bulk_create(const nlohmann::json &items) {
+nlohmann::json ContentManager::bulk_create(const nlohmann::json &items,
+                                           size_t first_number) {
   try {
     if (!items.is_array()) {
       return create_error_response("Items must be an array", 400);
@@ -267,27 +907,11 @@ nlohmann::json ContentManager::bulk_create(const nlohmann::json &items) {
     std::vector<int64_t> created_ids;
     std::vector<std::string> errors;
 
-    for (size_t i = 0; i < items.size(); ++i) {
-      try {
-        std::string error_msg;
-        if (!validate_content_item(items[i], error_msg)) {
-          errors.push_back("Item " + std::to_string(i) + ": " + error_msg);
-          continue;
-        }
-
-        ContentItem item = ContentItem::from_json(items[i]);
-        auto id = db_->create_content(item);
-
-        if (id) {
-          created_ids.push_back(*id);
-        } else {
-          errors.push_back("Item " + std::to_string(i) + ": Failed to create");
-        }
-
-      } catch (const std::exception &e) {
-        errors.push_back("Item " + std::to_string(i) + ": " + e.what());
-      }
+    std::vector<size_t> numbers(items.size());
+    for (size_t i = 0; i < numbers.size(); ++i) {
+      numbers[i] = first_number + i;
     }
+    create_items(items, numbers, "Item", created_ids, errors);
 
     nlohmann::json result;
     result["created_ids"] = created_ids;
@@ -306,6 +930,56 @@ nlohmann::json ContentManager::bulk_create(const nlohmann::json &items) {
   }
 }
 
+void ContentManager::create_items(const nlohmann::json &items,
+                                  const std::vector<size_t> &numbers,
+                                  const std::string &label,
+                                  std::vector<int64_t> &created_ids,
+                                  std::vector<std::string> &errors) {
+  // 先校验全部条目，再通过批量路径按块写入
+  std::vector<ContentItem> valid_items;
+  std::vector<size_t> valid_numbers;
+  valid_items.reserve(items.size());
+  valid_numbers.reserve(items.size());
+
+  for (size_t i = 0; i < items.size(); ++i) {
+    try {
+      std::string error_msg;
+      if (!validate_content_item(items[i], error_msg)) {
+        errors.push_back(label + " " + std::to_string(numbers[i]) + ": " +
+                         error_msg);
+        continue;
+      }
+
+      valid_items.push_back(ContentItem::from_json(items[i]));
+      valid_numbers.push_back(numbers[i]);
+
+    } catch (const std::exception &e) {
+      errors.push_back(label + " " + std::to_string(numbers[i]) + ": " +
+                       e.what());
+    }
+  }
+
+  auto ids = db_->create_content_batch(valid_items);
+  created_ids.reserve(created_ids.size() + ids.size());
+  bool created = false;
+  for (size_t k = 0; k < ids.size(); ++k) {
+    if (ids[k]) {
+      created_ids.push_back(*ids[k]);
+      created = true;
+      if (semantic_index_) {
+        semantic_index_->enqueue(*ids[k]);
+      }
+    } else {
+      errors.push_back(label + " " + std::to_string(valid_numbers[k]) +
+                       ": Failed to create");
+    }
+  }
+  // 整批只通知一次
+  if (created) {
+    notify_changed();
+  }
+}
+
 nlohmann::json ContentManager::bulk_delete(const std::vector<int64_t> &ids) {
   try {
     if (ids.empty()) {
@@ -317,8 +991,13 @@ nlohmann::json ContentManager::bulk_delete(const std::vector<int64_t> &ids) {
 
     for (int64_t id : ids) {
       try {
+        invalidate_cached(id);
         if (db_->delete_content(id)) {
+          invalidate_cached(id);
           deleted_count++;
+          if (semantic_index_) {
+            semantic_index_->remove(id);
+          }
         } else {
           errors.push_back("Failed to delete ID: " + std::to_string(id));
         }
@@ -327,6 +1006,10 @@ nlohmann::json ContentManager::bulk_delete(const std::vector<int64_t> &ids) {
       }
     }
 
+    if (deleted_count > 0) {
+      notify_changed();
+    }
+
     nlohmann::json result;
     result["deleted_count"] = deleted_count;
     result["total_count"] = ids.size();
@@ -349,15 +1032,22 @@ nlohmann::json ContentManager::export_content(const std::string &format) {
       return create_error_response("Only JSON format is supported", 400);
     }
 
-    auto items = db_->list_all_content(0, 10000); // 导出所有内容
-
     nlohmann::json export_data;
     export_data["version"] = "1.0";
     export_data["exported_at"] = std::time(nullptr);
     export_data["content"] = nlohmann::json::array();
 
-    for (const auto &item : items) {
-      export_data["content"].push_back(item.to_json());
+    // 按id分批遍历全部内容；大数据量请使用HTTP流式导出
+    int64_t after_id = 0;
+    for (;;) {
+      auto items = export_content_chunk(after_id);
+      if (items.empty()) {
+        break;
+      }
+      for (const auto &item : items) {
+        export_data["content"].push_back(item.to_json());
+      }
+      after_id = items.back().id;
     }
 
     return create_success_response(export_data);
@@ -368,6 +1058,13 @@ nlohmann::json ContentManager::export_content(const std::string &format) {
   }
 }
 
+std::vector<ContentItem> ContentManager::export_content_chunk(int64_t after_id,
+                                                             int limit) {
+  if (limit < 1 || limit > 5000)
+    limit = 500;
+  return db_->list_content_after_id(after_id, limit);
+}
+
 nlohmann::json ContentManager::import_content(const nlohmann::json &data) {
   try {
     if (!data.contains("content") || !data["content"].is_array()) {
@@ -400,6 +1097,21 @@ ContentManager::create_success_response(const nlohmann::json &data) {
   return response;
 }
 
+int ContentManager::serialize_result(bool ok, const SearchResult &result,
+                                     const nlohmann::json &error,
+                                     std::string &body) {
+  if (!ok) {
+    body = error.dump();
+    return error["error"].value("code", 500);
+  }
+  // 与create_success_response(result.to_json())的结构一致
+  body.clear();
+  body += "{\"success\":true,\"data\":";
+  result.append_json(body);
+  body += '}';
+  return 200;
+}
+
 bool ContentManager::validate_content_item(const nlohmann::json &item,
                                            std::string &error_msg) {
   if (!item.is_object()) {
@@ -1,21 +1,43 @@
 #include "database.hpp"
+#include "json_writer.hpp"
+#include "metrics.hpp"
 #include <spdlog/spdlog.h>
 #include <filesystem>
 #include <ctime>
 #include <sstream>
+#include <chrono>
+#include <algorithm>
 
 namespace mcp {
 
 // ContentItem JSON转换
-nlohmann::json ContentItem::to_json() const {
+nlohmann::json ContentItem::to_json(uint32_t fields) const {
     nlohmann::json j;
     j["id"] = id;
-    j["title"] = title;
-    j["content"] = content;
-    j["content_type"] = content_type;
-    j["tags"] = tags;
-    j["created_at"] = created_at;
-    j["updated_at"] = updated_at;
+    if (fields & content_fields::kTitle) {
+        j["title"] = title;
+    }
+    if (fields & content_fields::kContent) {
+        j["content"] = content;
+    }
+    if (fields & content_fields::kPreview) {
+        j["preview"] = preview;
+    }
+    if (fields & content_fields::kContentType) {
+        j["content_type"] = content_type;
+    }
+    if (fields & content_fields::kTags) {
+        j["tags"] = tags;
+    }
+    if (fields & content_fields::kCreatedAt) {
+        j["created_at"] = created_at;
+    }
+    if (fields & content_fields::kUpdatedAt) {
+        j["updated_at"] = updated_at;
+    }
+    if (!(fields & content_fields::kMetadata)) {
+        return j;
+    }
     
     // 解析metadata JSON字符串
     if (!metadata.empty()) {
@@ -27,435 +49,2549 @@ nlohmann::json ContentItem::to_json() const {
     } else {
         j["metadata"] = nlohmann::json::object();
     }
-    
-    return j;
+    
+    return j;
+}
+
+void ContentItem::append_json(std::string& out, uint32_t fields) const {
+    out += '{';
+    append_json_key(out, "id");
+    append_json_int(out, id);
+    if (fields & content_fields::kTitle) {
+        out += ',';
+        append_json_key(out, "title");
+        append_json_string(out, title);
+    }
+    if (fields & content_fields::kContent) {
+        out += ',';
+        append_json_key(out, "content");
+        append_json_string(out, content);
+    }
+    if (fields & content_fields::kPreview) {
+        out += ',';
+        append_json_key(out, "preview");
+        append_json_string(out, preview);
+    }
+    if (fields & content_fields::kContentType) {
+        out += ',';
+        append_json_key(out, "content_type");
+        append_json_string(out, content_type);
+    }
+    if (fields & content_fields::kTags) {
+        out += ',';
+        append_json_key(out, "tags");
+        append_json_string(out, tags);
+    }
+    if (fields & content_fields::kCreatedAt) {
+        out += ',';
+        append_json_key(out, "created_at");
+        append_json_int(out, created_at);
+    }
+    if (fields & content_fields::kUpdatedAt) {
+        out += ',';
+        append_json_key(out, "updated_at");
+        append_json_int(out, updated_at);
+    }
+    if (fields & content_fields::kMetadata) {
+        out += ',';
+        append_json_key(out, "metadata");
+        append_json_raw(out, metadata, "{}");
+    }
+    out += '}';
+}
+
+ContentItem ContentItem::from_json(const nlohmann::json& j) {
+    ContentItem item;
+    item.id = j.value("id", 0);
+    item.title = j.value("title", "");
+    item.content = j.value("content", "");
+    item.content_type = j.value("content_type", "text");
+    if (item.content_type == "document") {
+        item.content_type = "text";
+    }
+    item.tags = j.value("tags", "");
+    
+    // 处理metadata
+    if (j.contains("metadata") && j["metadata"].is_object()) {
+        item.metadata = j["metadata"].dump();
+    } else {
+        item.metadata = "{}";
+    }
+    
+    auto now = std::time(nullptr);
+    item.created_at = j.value("created_at", now);
+    item.updated_at = j.value("updated_at", now);
+    
+    return item;
+}
+
+// FileInfo JSON转换
+nlohmann::json FileInfo::to_json() const {
+    nlohmann::json j;
+    j["id"] = id;
+    j["filename"] = filename;
+    j["original_name"] = original_name;
+    j["file_path"] = file_path;
+    j["mime_type"] = mime_type;
+    j["file_size"] = file_size;
+    j["upload_time"] = upload_time;
+    j["description"] = description;
+    j["tags"] = tags;
+    j["content_hash"] = content_hash;
+    return j;
+}
+
+nlohmann::json JobRecord::to_json() const {
+    nlohmann::json j;
+    j["id"] = id;
+    j["type"] = type;
+    j["status"] = status;
+    j["progress"] = progress;
+    j["message"] = message;
+    j["params"] = params;
+    if (!result.is_null()) {
+        j["result"] = result;
+    }
+    if (!error.empty()) {
+        j["error"] = error;
+    }
+    j["created_at"] = created_at;
+    j["updated_at"] = updated_at;
+    return j;
+}
+
+void FileInfo::from_json(const nlohmann::json& j) {
+    id = j.value("id", "");
+    filename = j.value("filename", "");
+    original_name = j.value("original_name", "");
+    file_path = j.value("file_path", "");
+    mime_type = j.value("mime_type", "");
+    file_size = j.value("file_size", 0);
+    upload_time = j.value("upload_time", "");
+    description = j.value("description", "");
+    tags = j.value("tags", std::vector<std::string>{});
+    content_hash = j.value("content_hash", "");
+}
+
+// PooledConnection实现
+namespace {
+
+// 当前线程已持有的连接，用于同一线程内的嵌套获取
+struct ThreadCheckout {
+    const ConnectionPool* pool = nullptr;
+    Connection* writer = nullptr;
+    Connection* reader = nullptr;
+};
+
+thread_local std::vector<ThreadCheckout> t_checkouts;
+
+ThreadCheckout* find_checkout(const ConnectionPool* pool) {
+    for (auto& checkout : t_checkouts) {
+        if (checkout.pool == pool) {
+            return &checkout;
+        }
+    }
+    return nullptr;
+}
+
+ThreadCheckout& get_checkout(const ConnectionPool* pool) {
+    if (auto* checkout = find_checkout(pool)) {
+        return *checkout;
+    }
+    t_checkouts.push_back(ThreadCheckout{pool, nullptr, nullptr});
+    return t_checkouts.back();
+}
+
+void clear_checkout(const ConnectionPool* pool, bool writer) {
+    auto* checkout = find_checkout(pool);
+    if (!checkout) {
+        return;
+    }
+    (writer ? checkout->writer : checkout->reader) = nullptr;
+    if (!checkout->writer && !checkout->reader) {
+        t_checkouts.erase(t_checkouts.begin() + (checkout - t_checkouts.data()));
+    }
+}
+
+// 当前schema版本，记录在PRAGMA user_version中
+constexpr int kSchemaVersion = 3;
+
+// 将逗号分隔的标签拆分为去空格、去重后的列表（保持原顺序）
+std::vector<std::string> split_tags(const std::string& tags_str) {
+    std::vector<std::string> tags;
+    std::stringstream ss(tags_str);
+    std::string tag;
+    while (std::getline(ss, tag, ',')) {
+        tag.erase(0, tag.find_first_not_of(" \t"));
+        tag.erase(tag.find_last_not_of(" \t") + 1);
+        if (!tag.empty() && std::find(tags.begin(), tags.end(), tag) == tags.end()) {
+            tags.push_back(tag);
+        }
+    }
+    return tags;
+}
+
+// 预览截取的字符数（SQLite的substr按字符计数，不会截断UTF-8多字节字符）
+constexpr int kPreviewChars = 200;
+
+// 搜索结果的预览使用FTS5匹配片段（content为fts表第1列）
+const std::string kSearchSnippet = "snippet(content_fts, 1, '', '', '...', 32)";
+
+// 生成与row_to_content_item列顺序一致的SELECT列表，第9列为预览。
+// 未选中的正文和元数据以常量代替，SQLite不会读取其溢出页；
+// preview_expr为空时预览取正文开头
+std::string content_select_list(uint32_t fields, const std::string& alias,
+                                const std::string& preview_expr = "") {
+    const std::string p = alias.empty() ? "" : alias + ".";
+    std::string sql = p + "id, " + p + "title, ";
+    sql += (fields & content_fields::kContent) ? p + "content" : std::string("''");
+    sql += ", " + p + "content_type, " + p + "tags, ";
+    sql += (fields & content_fields::kMetadata) ? p + "metadata" : std::string("'{}'");
+    sql += ", " + p + "created_at, " + p + "updated_at, ";
+    if (!(fields & content_fields::kPreview)) {
+        sql += "''";
+    } else if (!preview_expr.empty()) {
+        sql += preview_expr;
+    } else {
+        sql += "substr(" + p + "content, 1, " + std::to_string(kPreviewChars) + ")";
+    }
+    return sql;
+}
+
+std::string column_text(sqlite3_stmt* stmt, int col) {
+    const char* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, col));
+    return text ? text : "";
+}
+
+bool exec_simple(sqlite3* db, const char* sql) {
+    char* err_msg = nullptr;
+    if (sqlite3_exec(db, sql, nullptr, nullptr, &err_msg) != SQLITE_OK) {
+        spdlog::error("SQL error: {} ({})", err_msg ? err_msg : "Unknown error", sql);
+        sqlite3_free(err_msg);
+        return false;
+    }
+    return true;
+}
+
+constexpr const char* kJobColumns =
+    "id, type, status, progress, message, params, result, error, created_at, updated_at";
+
+JobRecord job_from_row(sqlite3_stmt* stmt) {
+    JobRecord job;
+    job.id = column_text(stmt, 0);
+    job.type = column_text(stmt, 1);
+    job.status = column_text(stmt, 2);
+    job.progress = sqlite3_column_double(stmt, 3);
+    job.message = column_text(stmt, 4);
+    job.params = nlohmann::json::parse(column_text(stmt, 5), nullptr, false);
+    if (job.params.is_discarded()) {
+        job.params = nlohmann::json::object();
+    }
+    if (sqlite3_column_type(stmt, 6) != SQLITE_NULL) {
+        job.result = nlohmann::json::parse(column_text(stmt, 6), nullptr, false);
+        if (job.result.is_discarded()) {
+            job.result = nullptr;
+        }
+    }
+    job.error = column_text(stmt, 7);
+    job.created_at = sqlite3_column_int64(stmt, 8);
+    job.updated_at = sqlite3_column_int64(stmt, 9);
+    return job;
+}
+
+} // namespace
+
+// Transaction实现
+Transaction::Transaction(sqlite3* db) : db_(db) {
+    if (!db_) {
+        return;
+    }
+    nested_ = sqlite3_get_autocommit(db_) == 0;
+    active_ = exec_simple(db_, nested_ ? "SAVEPOINT nested_tx" : "BEGIN IMMEDIATE");
+}
+
+Transaction::~Transaction() {
+    if (active_) {
+        rollback();
+    }
+}
+
+bool Transaction::commit() {
+    if (!active_) {
+        return false;
+    }
+    active_ = false;
+    if (exec_simple(db_, nested_ ? "RELEASE nested_tx" : "COMMIT")) {
+        return true;
+    }
+    // 提交失败时事务可能仍然打开，需要回滚
+    if (nested_) {
+        exec_simple(db_, "ROLLBACK TO nested_tx");
+        exec_simple(db_, "RELEASE nested_tx");
+    } else if (sqlite3_get_autocommit(db_) == 0) {
+        exec_simple(db_, "ROLLBACK");
+    }
+    return false;
+}
+
+void Transaction::rollback() {
+    if (!active_) {
+        return;
+    }
+    active_ = false;
+    if (nested_) {
+        exec_simple(db_, "ROLLBACK TO nested_tx");
+        exec_simple(db_, "RELEASE nested_tx");
+    } else if (sqlite3_get_autocommit(db_) == 0) {
+        exec_simple(db_, "ROLLBACK");
+    }
+}
+
+PooledConnection::PooledConnection(ConnectionPool* pool, Connection* conn, bool writer, bool owned)
+    : pool_(pool), conn_(conn), writer_(writer), owned_(owned) {
+}
+
+PooledConnection::~PooledConnection() {
+    release();
+}
+
+PooledConnection::PooledConnection(PooledConnection&& other) noexcept
+    : pool_(other.pool_), conn_(other.conn_), writer_(other.writer_), owned_(other.owned_) {
+    other.pool_ = nullptr;
+    other.conn_ = nullptr;
+    other.owned_ = false;
+}
+
+PooledConnection& PooledConnection::operator=(PooledConnection&& other) noexcept {
+    if (this != &other) {
+        release();
+        pool_ = other.pool_;
+        conn_ = other.conn_;
+        writer_ = other.writer_;
+        owned_ = other.owned_;
+        other.pool_ = nullptr;
+        other.conn_ = nullptr;
+        other.owned_ = false;
+    }
+    return *this;
+}
+
+Statement PooledConnection::prepare(const std::string& sql) {
+    if (!conn_) {
+        return Statement();
+    }
+    return conn_->statements->prepare(sql);
+}
+
+void PooledConnection::release() {
+    if (pool_ && conn_ && owned_) {
+        pool_->release(conn_, writer_);
+    }
+    pool_ = nullptr;
+    conn_ = nullptr;
+    owned_ = false;
+}
+
+// Statement实现
+Statement::Statement(StatementCache* cache, sqlite3_stmt* stmt, bool cached)
+    : cache_(cache), stmt_(stmt), cached_(cached) {
+}
+
+Statement::~Statement() {
+    release();
+}
+
+Statement::Statement(Statement&& other) noexcept
+    : cache_(other.cache_), stmt_(other.stmt_), cached_(other.cached_) {
+    other.cache_ = nullptr;
+    other.stmt_ = nullptr;
+}
+
+Statement& Statement::operator=(Statement&& other) noexcept {
+    if (this != &other) {
+        release();
+        cache_ = other.cache_;
+        stmt_ = other.stmt_;
+        cached_ = other.cached_;
+        other.cache_ = nullptr;
+        other.stmt_ = nullptr;
+    }
+    return *this;
+}
+
+void Statement::release() {
+    if (cache_ && stmt_) {
+        cache_->release(stmt_, cached_);
+    }
+    cache_ = nullptr;
+    stmt_ = nullptr;
+}
+
+// StatementCache实现
+StatementCache::StatementCache(sqlite3* db, size_t capacity) : db_(db), capacity_(capacity) {
+}
+
+StatementCache::~StatementCache() {
+    finalize_all();
+}
+
+Statement StatementCache::prepare(const std::string& sql) {
+    auto it = entries_.find(sql);
+    if (it != entries_.end() && !it->second.in_use) {
+        it->second.in_use = true;
+        hits_.fetch_add(1, std::memory_order_relaxed);
+        return Statement(this, it->second.stmt, true);
+    }
+    
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    
+    sqlite3_stmt* stmt = nullptr;
+    int rc = sqlite3_prepare_v3(db_, sql.c_str(), -1, SQLITE_PREPARE_PERSISTENT, &stmt, nullptr);
+    if (rc != SQLITE_OK) {
+        sqlite3_finalize(stmt);
+        return Statement();
+    }
+    
+    // 同一SQL正在被嵌套使用，或缓存已满时，使用一次性语句
+    if (it != entries_.end() || entries_.size() >= capacity_) {
+        return Statement(this, stmt, false);
+    }
+    
+    auto& entry = entries_[sql];
+    entry.stmt = stmt;
+    entry.in_use = true;
+    by_stmt_[stmt] = &entry;
+    size_.store(entries_.size(), std::memory_order_relaxed);
+    return Statement(this, stmt, true);
+}
+
+void StatementCache::release(sqlite3_stmt* stmt, bool cached) {
+    if (!cached) {
+        sqlite3_finalize(stmt);
+        return;
+    }
+    
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+    
+    auto it = by_stmt_.find(stmt);
+    if (it != by_stmt_.end()) {
+        it->second->in_use = false;
+    }
+}
+
+void StatementCache::finalize_all() {
+    for (auto& [sql, entry] : entries_) {
+        sqlite3_finalize(entry.stmt);
+    }
+    entries_.clear();
+    by_stmt_.clear();
+    size_.store(0, std::memory_order_relaxed);
+}
+
+// ConnectionPool实现
+ConnectionPool::ConnectionPool(const std::string& db_path, const DatabaseOptions& options)
+    : db_path_(db_path), options_(options) {
+    if (options_.reader_connections == 0) {
+        options_.reader_connections = 1;
+    }
+}
+
+ConnectionPool::~ConnectionPool() {
+    close();
+}
+
+std::unique_ptr<Connection> ConnectionPool::open_connection(bool read_only) {
+    sqlite3* db = nullptr;
+    int flags = SQLITE_OPEN_NOMUTEX;
+    flags |= read_only ? SQLITE_OPEN_READONLY : (SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE);
+    
+    int rc = sqlite3_open_v2(db_path_.c_str(), &db, flags, nullptr);
+    if (rc != SQLITE_OK) {
+        spdlog::error("Cannot open database: {}", db ? sqlite3_errmsg(db) : "out of memory");
+        sqlite3_close(db);
+        return nullptr;
+    }
+    
+    if (!apply_pragmas(db, read_only)) {
+        sqlite3_close(db);
+        return nullptr;
+    }
+    
+    auto conn = std::make_unique<Connection>();
+    conn->db = db;
+    conn->statements = std::make_unique<StatementCache>(db);
+    return conn;
+}
+
+bool ConnectionPool::apply_pragmas(sqlite3* db, bool read_only) {
+    sqlite3_busy_timeout(db, options_.busy_timeout_ms);
+    
+    std::vector<std::string> pragmas;
+    if (!read_only) {
+        pragmas.push_back("PRAGMA journal_mode = WAL;");
+        pragmas.push_back("PRAGMA synchronous = NORMAL;");
+        pragmas.push_back("PRAGMA foreign_keys = ON;");
+    } else {
+        pragmas.push_back("PRAGMA query_only = ON;");
+    }
+    pragmas.push_back("PRAGMA temp_store = MEMORY;");
+    pragmas.push_back("PRAGMA mmap_size = " + std::to_string(options_.mmap_size) + ";");
+    
+    for (const auto& pragma : pragmas) {
+        char* err_msg = nullptr;
+        int rc = sqlite3_exec(db, pragma.c_str(), nullptr, nullptr, &err_msg);
+        if (rc != SQLITE_OK) {
+            spdlog::error("Failed to apply '{}': {}", pragma, err_msg ? err_msg : "Unknown error");
+            if (err_msg) {
+                sqlite3_free(err_msg);
+            }
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+bool ConnectionPool::open_writer() {
+    writer_ = open_connection(false);
+    return writer_ != nullptr;
+}
+
+bool ConnectionPool::open_readers() {
+    std::lock_guard<std::mutex> lock(reader_mutex_);
+    for (size_t i = 0; i < options_.reader_connections; ++i) {
+        auto conn = open_connection(true);
+        if (!conn) {
+            return false;
+        }
+        idle_readers_.push_back(conn.get());
+        readers_.push_back(std::move(conn));
+    }
+    
+    spdlog::info("Database pool opened: 1 writer, {} readers", readers_.size());
+    return true;
+}
+
+void ConnectionPool::close() {
+    {
+        std::lock_guard<std::mutex> lock(reader_mutex_);
+        for (auto& conn : readers_) {
+            conn->statements->finalize_all();
+            sqlite3_close(conn->db);
+        }
+        readers_.clear();
+        idle_readers_.clear();
+    }
+    
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    if (writer_) {
+        writer_->statements->finalize_all();
+        sqlite3_close(writer_->db);
+        writer_.reset();
+    }
+}
+
+PooledConnection ConnectionPool::acquire_writer() {
+    auto* checkout = find_checkout(this);
+    if (checkout && checkout->writer) {
+        return PooledConnection(this, checkout->writer, true, false);
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    writer_mutex_.lock();
+    static auto& wait_histogram = Metrics::instance().histogram("mcp_db_pool_wait_seconds", {{"connection", "writer"}});
+    wait_histogram.observe(std::chrono::steady_clock::now() - start);
+    auto waited = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    total_wait_us_ += static_cast<uint64_t>(waited);
+    writer_acquisitions_++;
+    
+    get_checkout(this).writer = writer_.get();
+    return PooledConnection(this, writer_.get(), true, true);
+}
+
+PooledConnection ConnectionPool::acquire_reader() {
+    // 已持有写连接时读取必须走写连接，才能看到未提交的事务
+    auto* checkout = find_checkout(this);
+    if (checkout && checkout->writer) {
+        return PooledConnection(this, checkout->writer, true, false);
+    }
+    if (checkout && checkout->reader) {
+        return PooledConnection(this, checkout->reader, false, false);
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(reader_mutex_);
+    if (readers_.empty()) {
+        // 只读连接尚未打开（例如初始化阶段），退回写连接
+        lock.unlock();
+        return acquire_writer();
+    }
+    if (idle_readers_.empty()) {
+        reader_waits_++;
+        reader_cv_.wait(lock, [this] { return !idle_readers_.empty(); });
+    }
+    static auto& wait_histogram = Metrics::instance().histogram("mcp_db_pool_wait_seconds", {{"connection", "reader"}});
+    wait_histogram.observe(std::chrono::steady_clock::now() - start);
+    auto waited = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    total_wait_us_ += static_cast<uint64_t>(waited);
+    reader_acquisitions_++;
+    
+    Connection* conn = idle_readers_.back();
+    idle_readers_.pop_back();
+    lock.unlock();
+    
+    get_checkout(this).reader = conn;
+    return PooledConnection(this, conn, false, true);
+}
+
+void ConnectionPool::release(Connection* conn, bool writer) {
+    clear_checkout(this, writer);
+    
+    if (writer) {
+        writer_mutex_.unlock();
+        return;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(reader_mutex_);
+        idle_readers_.push_back(conn);
+    }
+    reader_cv_.notify_one();
+}
+
+nlohmann::json ConnectionPool::get_statistics() const {
+    nlohmann::json j;
+    j["reader_connections"] = options_.reader_connections;
+    j["writer_acquisitions"] = writer_acquisitions_.load();
+    j["reader_acquisitions"] = reader_acquisitions_.load();
+    j["reader_waits"] = reader_waits_.load();
+    
+    auto acquisitions = writer_acquisitions_.load() + reader_acquisitions_.load();
+    j["total_wait_us"] = total_wait_us_.load();
+    j["average_wait_us"] = acquisitions > 0
+        ? static_cast<double>(total_wait_us_.load()) / acquisitions : 0.0;
+    return j;
+}
+
+nlohmann::json ConnectionPool::get_statement_cache_statistics() const {
+    // 汇总各连接的语句缓存统计；连接集合在打开后不再变化
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    size_t cached = 0;
+    auto collect = [&](const Connection& conn) {
+        hits += conn.statements->hits();
+        misses += conn.statements->misses();
+        cached += conn.statements->size();
+    };
+    if (writer_) {
+        collect(*writer_);
+    }
+    for (const auto& conn : readers_) {
+        collect(*conn);
+    }
+    
+    nlohmann::json j;
+    j["hits"] = hits;
+    j["misses"] = misses;
+    j["cached_statements"] = cached;
+    j["hit_rate"] = (hits + misses) > 0 ? static_cast<double>(hits) / (hits + misses) : 0.0;
+    return j;
+}
+
+// SearchCountCache实现
+SearchCountCache::SearchCountCache(size_t capacity) : capacity_(capacity) {}
+
+std::optional<int64_t> SearchCountCache::get(const std::string& query, uint64_t generation) {
+    if (capacity_ == 0) {
+        return std::nullopt;
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(query);
+    if (it == index_.end() || it->second->generation != generation) {
+        misses_++;
+        return std::nullopt;
+    }
+    
+    lru_.splice(lru_.begin(), lru_, it->second);
+    hits_++;
+    return it->second->count;
+}
+
+void SearchCountCache::put(const std::string& query, uint64_t generation, int64_t count) {
+    if (capacity_ == 0) {
+        return;
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(query);
+    if (it != index_.end()) {
+        // 只用更新的代数覆盖，避免慢查询写回过期结果
+        if (it->second->generation <= generation) {
+            it->second->generation = generation;
+            it->second->count = count;
+        }
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return;
+    }
+    
+    lru_.push_front(Entry{query, generation, count});
+    index_[query] = lru_.begin();
+    if (lru_.size() > capacity_) {
+        index_.erase(lru_.back().query);
+        lru_.pop_back();
+    }
+}
+
+nlohmann::json SearchCountCache::get_statistics() const {
+    uint64_t hits = hits_.load();
+    uint64_t misses = misses_.load();
+    
+    nlohmann::json j;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        j["entries"] = lru_.size();
+    }
+    j["capacity"] = capacity_;
+    j["hits"] = hits;
+    j["misses"] = misses;
+    j["hit_rate"] = (hits + misses) > 0 ? static_cast<double>(hits) / (hits + misses) : 0.0;
+    return j;
+}
+
+// Database实现
+Database::Database(const std::string& db_path, const DatabaseOptions& options)
+    : db_path_(db_path), pool_(std::make_unique<ConnectionPool>(db_path, options)),
+      search_count_cache_(options.search_count_cache_size),
+      write_batch_size_(std::max<size_t>(1, options.write_batch_size)) {
+}
+
+Database::~Database() {
+    pool_->close();
+}
+
+bool Database::initialize() {
+    // 确保数据库目录存在
+    std::filesystem::path db_file(db_path_);
+    if (db_file.has_parent_path()) {
+        std::filesystem::create_directories(db_file.parent_path());
+    }
+    
+    // 打开写连接
+    if (!pool_->open_writer()) {
+        return false;
+    }
+    
+    // 创建表
+    {
+        auto conn = pool_->acquire_writer();
+        if (!create_tables(conn.get()) || !migrate_schema(conn)) {
+            return false;
+        }
+    }
+    
+    // 表创建完成后再打开只读连接
+    return pool_->open_readers();
+}
+
+bool Database::create_tables(sqlite3* db) {
+    const std::string create_content_table = R"(
+        CREATE TABLE IF NOT EXISTS content (
+            id INTEGER PRIMARY KEY AUTOINCREMENT,
+            title TEXT NOT NULL,
+            content TEXT NOT NULL,
+            content_type TEXT DEFAULT 'text',
+            tags TEXT DEFAULT '',
+            metadata TEXT DEFAULT '{}',
+            created_at INTEGER NOT NULL,
+            updated_at INTEGER NOT NULL
+        );
+    )";
+    
+    const std::string create_indexes = R"(
+        CREATE INDEX IF NOT EXISTS idx_content_title ON content(title);
+        CREATE INDEX IF NOT EXISTS idx_content_type ON content(content_type);
+        CREATE INDEX IF NOT EXISTS idx_content_created_at ON content(created_at);
+        CREATE INDEX IF NOT EXISTS idx_content_updated_at ON content(updated_at);
+        CREATE VIRTUAL TABLE IF NOT EXISTS content_fts USING fts5(
+            title, content, tags, content=content, content_rowid=id
+        );
+    )";
+    
+    // 规范化的标签表，(tag, content_id)主键同时覆盖按标签查询和标签计数
+    const std::string create_tags_table = R"(
+        CREATE TABLE IF NOT EXISTS content_tags (
+            tag TEXT NOT NULL,
+            content_id INTEGER NOT NULL,
+            PRIMARY KEY (tag, content_id)
+        ) WITHOUT ROWID;
+        CREATE INDEX IF NOT EXISTS idx_content_tags_content_id ON content_tags(content_id);
+    )";
+    
+    // 预计算的统计计数：kind为total(key为空)、type(按content_type)或tag(按标签)，
+    // bytes为content字段的字节数。由触发器在写入所在的事务内增量维护，
+    // 统计接口只需读取与标签数量成正比的行数
+    const std::string create_stats_table = R"(
+        CREATE TABLE IF NOT EXISTS content_stats (
+            kind TEXT NOT NULL,
+            key TEXT NOT NULL,
+            count INTEGER NOT NULL DEFAULT 0,
+            bytes INTEGER NOT NULL DEFAULT 0,
+            PRIMARY KEY (kind, key)
+        ) WITHOUT ROWID;
+        CREATE TRIGGER IF NOT EXISTS content_stats_insert AFTER INSERT ON content BEGIN
+            INSERT INTO content_stats(kind, key, count, bytes)
+                VALUES ('total', '', 1, length(CAST(NEW.content AS BLOB)))
+                ON CONFLICT(kind, key) DO UPDATE SET count = count + 1, bytes = bytes + excluded.bytes;
+            INSERT INTO content_stats(kind, key, count, bytes)
+                VALUES ('type', COALESCE(NEW.content_type, 'text'), 1, length(CAST(NEW.content AS BLOB)))
+                ON CONFLICT(kind, key) DO UPDATE SET count = count + 1, bytes = bytes + excluded.bytes;
+        END;
+        CREATE TRIGGER IF NOT EXISTS content_stats_delete AFTER DELETE ON content BEGIN
+            UPDATE content_stats SET count = count - 1, bytes = bytes - length(CAST(OLD.content AS BLOB))
+                WHERE (kind = 'total' AND key = '') OR (kind = 'type' AND key = COALESCE(OLD.content_type, 'text'));
+            DELETE FROM content_stats WHERE kind = 'type' AND key = COALESCE(OLD.content_type, 'text') AND count <= 0;
+        END;
+        CREATE TRIGGER IF NOT EXISTS content_stats_update AFTER UPDATE OF content, content_type ON content BEGIN
+            UPDATE content_stats
+                SET bytes = bytes - length(CAST(OLD.content AS BLOB)) + length(CAST(NEW.content AS BLOB))
+                WHERE kind = 'total' AND key = '';
+            UPDATE content_stats SET count = count - 1, bytes = bytes - length(CAST(OLD.content AS BLOB))
+                WHERE kind = 'type' AND key = COALESCE(OLD.content_type, 'text');
+            DELETE FROM content_stats WHERE kind = 'type' AND key = COALESCE(OLD.content_type, 'text') AND count <= 0;
+            INSERT INTO content_stats(kind, key, count, bytes)
+                VALUES ('type', COALESCE(NEW.content_type, 'text'), 1, length(CAST(NEW.content AS BLOB)))
+                ON CONFLICT(kind, key) DO UPDATE SET count = count + 1, bytes = bytes + excluded.bytes;
+        END;
+        CREATE TRIGGER IF NOT EXISTS content_tags_stats_insert AFTER INSERT ON content_tags BEGIN
+            INSERT INTO content_stats(kind, key, count) VALUES ('tag', NEW.tag, 1)
+                ON CONFLICT(kind, key) DO UPDATE SET count = count + 1;
+        END;
+        CREATE TRIGGER IF NOT EXISTS content_tags_stats_delete AFTER DELETE ON content_tags BEGIN
+            UPDATE content_stats SET count = count - 1 WHERE kind = 'tag' AND key = OLD.tag;
+            DELETE FROM content_stats WHERE kind = 'tag' AND key = OLD.tag AND count <= 0;
+        END;
+    )";
+    
+    // 上传文件元数据；seq作为FTS外部内容表的rowid，trigram分词支持不区分大小写的子串匹配
+    const std::string create_files_tables = R"(
+        CREATE TABLE IF NOT EXISTS files (
+            seq INTEGER PRIMARY KEY AUTOINCREMENT,
+            id TEXT NOT NULL UNIQUE,
+            filename TEXT NOT NULL,
+            original_name TEXT NOT NULL,
+            file_path TEXT NOT NULL,
+            mime_type TEXT NOT NULL,
+            file_size INTEGER NOT NULL DEFAULT 0,
+            extension TEXT NOT NULL DEFAULT '',
+            upload_time TEXT NOT NULL,
+            description TEXT NOT NULL DEFAULT '',
+            tags TEXT NOT NULL DEFAULT '[]',
+            content_hash TEXT NOT NULL DEFAULT ''
+        );
+        CREATE INDEX IF NOT EXISTS idx_files_extension ON files(extension);
+        CREATE TABLE IF NOT EXISTS file_tags (
+            tag TEXT NOT NULL,
+            file_id TEXT NOT NULL,
+            PRIMARY KEY (tag, file_id)
+        ) WITHOUT ROWID;
+        CREATE INDEX IF NOT EXISTS idx_file_tags_file_id ON file_tags(file_id);
+        CREATE VIRTUAL TABLE IF NOT EXISTS files_fts USING fts5(
+            filename, description, content=files, content_rowid=seq, tokenize='trigram'
+        );
+        CREATE TABLE IF NOT EXISTS parse_cache (
+            key TEXT PRIMARY KEY,
+            result TEXT NOT NULL,
+            created_at DATETIME DEFAULT CURRENT_TIMESTAMP
+        ) WITHOUT ROWID;
+        CREATE TABLE IF NOT EXISTS content_embeddings (
+            content_id INTEGER PRIMARY KEY REFERENCES content(id) ON DELETE CASCADE,
+            model TEXT NOT NULL,
+            format TEXT NOT NULL,
+            dimensions INTEGER NOT NULL,
+            scale REAL NOT NULL DEFAULT 1,
+            vector BLOB NOT NULL,
+            updated_at INTEGER NOT NULL
+        );
+        CREATE TABLE IF NOT EXISTS jobs (
+            id TEXT PRIMARY KEY,
+            type TEXT NOT NULL,
+            status TEXT NOT NULL,
+            progress REAL NOT NULL DEFAULT 0,
+            message TEXT NOT NULL DEFAULT '',
+            params TEXT NOT NULL DEFAULT '{}',
+            result TEXT,
+            error TEXT NOT NULL DEFAULT '',
+            created_at INTEGER NOT NULL,
+            updated_at INTEGER NOT NULL
+        ) WITHOUT ROWID;
+        CREATE INDEX IF NOT EXISTS idx_jobs_created_at ON jobs(created_at DESC);
+        CREATE TABLE IF NOT EXISTS blobs (
+            hash TEXT PRIMARY KEY,
+            path TEXT NOT NULL,
+            size INTEGER NOT NULL DEFAULT 0,
+            ref_count INTEGER NOT NULL DEFAULT 0
+        ) WITHOUT ROWID;
+    )";
+    
+    return execute_sql(db, create_content_table) && execute_sql(db, create_indexes) &&
+           execute_sql(db, create_tags_table) && execute_sql(db, create_stats_table) &&
+           execute_sql(db, create_files_tables);
+}
+
+bool Database::migrate_schema(PooledConnection& conn) {
+    int version = 0;
+    {
+        auto stmt = conn.prepare("PRAGMA user_version");
+        if (stmt && sqlite3_step(stmt.get()) == SQLITE_ROW) {
+            version = sqlite3_column_int(stmt.get(), 0);
+        }
+    }
+    
+    if (version >= kSchemaVersion) {
+        return true;
+    }
+    
+    Transaction tx(conn.get());
+    if (!tx.active()) {
+        return false;
+    }
+    
+    if (version < 1) {
+        spdlog::info("Migrating database schema to version 1 (content_tags)");
+        
+        // 从已有内容回填标签表
+        auto select_stmt = conn.prepare("SELECT id, tags FROM content WHERE tags != ''");
+        if (!select_stmt) {
+            spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
+            return false;
+        }
+        int64_t migrated = 0;
+        while (sqlite3_step(select_stmt.get()) == SQLITE_ROW) {
+            int64_t id = sqlite3_column_int64(select_stmt.get(), 0);
+            if (!replace_tags(conn, id, column_text(select_stmt.get(), 1))) {
+                return false;
+            }
+            ++migrated;
+        }
+        
+        // 旧的tags索引无法服务LIKE '%x%'查询；旧版本对外部内容FTS表的UPDATE/DELETE
+        // 不会正确移除词条，这里顺便重建一次FTS索引
+        if (!execute_sql(conn.get(), "DROP INDEX IF EXISTS idx_content_tags;") ||
+            !execute_sql(conn.get(), "INSERT INTO content_fts(content_fts) VALUES('rebuild');")) {
+            return false;
+        }
+        spdlog::info("Migrated tags for {} content items", migrated);
+    }
+    
+    if (version < 2) {
+        // files表在version 1之后新增了content_hash列
+        bool has_column = false;
+        {
+            auto stmt = conn.prepare("SELECT COUNT(*) FROM pragma_table_info('files') WHERE name = 'content_hash'");
+            if (stmt && sqlite3_step(stmt.get()) == SQLITE_ROW) {
+                has_column = sqlite3_column_int(stmt.get(), 0) > 0;
+            }
+        }
+        if (!has_column &&
+            !execute_sql(conn.get(), "ALTER TABLE files ADD COLUMN content_hash TEXT NOT NULL DEFAULT '';")) {
+            return false;
+        }
+        if (!execute_sql(conn.get(), "CREATE INDEX IF NOT EXISTS idx_files_content_hash ON files(content_hash);")) {
+            return false;
+        }
+    }
+    
+    if (version < 3) {
+        // 从现有数据回填统计表，此后由触发器增量维护
+        spdlog::info("Migrating database schema to version 3 (content_stats)");
+        const std::string backfill = R"(
+            DELETE FROM content_stats;
+            INSERT INTO content_stats(kind, key, count, bytes)
+                SELECT 'total', '', COUNT(*), COALESCE(SUM(length(CAST(content AS BLOB))), 0) FROM content;
+            INSERT INTO content_stats(kind, key, count, bytes)
+                SELECT 'type', COALESCE(content_type, 'text'), COUNT(*), SUM(length(CAST(content AS BLOB)))
+                FROM content GROUP BY 2;
+            INSERT INTO content_stats(kind, key, count, bytes)
+                SELECT 'tag', tag, COUNT(*), 0 FROM content_tags GROUP BY tag;
+        )";
+        if (!execute_sql(conn.get(), backfill)) {
+            return false;
+        }
+    }
+    
+    if (!execute_sql(conn.get(), "PRAGMA user_version = " + std::to_string(kSchemaVersion) + ";")) {
+        return false;
+    }
+    
+    return tx.commit();
+}
+
+bool Database::fts_insert(PooledConnection& conn, int64_t id, const std::string& title,
+                          const std::string& content, const std::string& tags) {
+    auto stmt = conn.prepare("INSERT INTO content_fts(rowid, title, content, tags) VALUES (?, ?, ?, ?)");
+    if (!stmt) {
+        spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
+        return false;
+    }
+    sqlite3_bind_int64(stmt.get(), 1, id);
+    sqlite3_bind_text(stmt.get(), 2, title.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt.get(), 3, content.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt.get(), 4, tags.c_str(), -1, SQLITE_STATIC);
+    if (sqlite3_step(stmt.get()) != SQLITE_DONE) {
+        spdlog::error("Failed to update FTS index: {}", sqlite3_errmsg(conn.get()));
+        return false;
+    }
+    return true;
+}
+
+bool Database::fts_delete(PooledConnection& conn, int64_t id, const std::string& title,
+                          const std::string& content, const std::string& tags) {
+    // 外部内容表必须用'delete'命令并提供旧值才能移除词条
+    auto stmt = conn.prepare(
+        "INSERT INTO content_fts(content_fts, rowid, title, content, tags) VALUES ('delete', ?, ?, ?, ?)");
+    if (!stmt) {
+        spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
+        return false;
+    }
+    sqlite3_bind_int64(stmt.get(), 1, id);
+    sqlite3_bind_text(stmt.get(), 2, title.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt.get(), 3, content.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt.get(), 4, tags.c_str(), -1, SQLITE_STATIC);
+    if (sqlite3_step(stmt.get()) != SQLITE_DONE) {
+        spdlog::error("Failed to update FTS index: {}", sqlite3_errmsg(conn.get()));
+        return false;
+    }
+    return true;
+}
+
+bool Database::replace_tags(PooledConnection& conn, int64_t id, const std::string& tags) {
+    {
+        auto stmt = conn.prepare("DELETE FROM content_tags WHERE content_id = ?");
+        if (!stmt) {
+            spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
+            return false;
+        }
+        sqlite3_bind_int64(stmt.get(), 1, id);
+        if (sqlite3_step(stmt.get()) != SQLITE_DONE) {
+            spdlog::error("Failed to delete tags: {}", sqlite3_errmsg(conn.get()));
+            return false;
+        }
+    }
+    
+    auto tag_list = split_tags(tags);
+    if (tag_list.empty()) {
+        return true;
+    }
+    
+    auto stmt = conn.prepare("INSERT OR IGNORE INTO content_tags(tag, content_id) VALUES (?, ?)");
+    if (!stmt) {
+        spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
+        return false;
+    }
+    for (const auto& tag : tag_list) {
+        sqlite3_bind_text(stmt.get(), 1, tag.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_int64(stmt.get(), 2, id);
+        if (sqlite3_step(stmt.get()) != SQLITE_DONE) {
+            spdlog::error("Failed to insert tag: {}", sqlite3_errmsg(conn.get()));
+            return false;
+        }
+        sqlite3_reset(stmt.get());
+    }
+    return true;
+}
+
+bool Database::execute_sql(sqlite3* db, const std::string& sql) {
+    char* err_msg = nullptr;
+    int rc = sqlite3_exec(db, sql.c_str(), nullptr, nullptr, &err_msg);
+    
+    if (rc != SQLITE_OK) {
+        spdlog::error("SQL error: {}", err_msg ? err_msg : "Unknown error");
+        if (err_msg) {
+            sqlite3_free(err_msg);
+        }
+        return false;
+    }
+    
+    return true;
+}
+
+std::optional<int64_t> Database::create_content(const ContentItem& item) {
+    MCP_SCOPED_LATENCY("mcp_db_query_duration_seconds");
+    auto conn = pool_->acquire_writer();
+    
+    // 主表、FTS索引和标签表在同一事务内写入
+    Transaction tx(conn.get());
+    if (!tx.active()) {
+        return std::nullopt;
+    }
+    
+    auto id = insert_content(conn, item);
+    if (!id || !tx.commit()) {
+        return std::nullopt;
+    }
+    
+    bump_write_generation();
+    return id;
+}
+
+std::vector<std::optional<int64_t>> Database::create_content_batch(const std::vector<ContentItem>& items) {
+    MCP_SCOPED_LATENCY("mcp_db_query_duration_seconds");
+    std::vector<std::optional<int64_t>> ids(items.size());
+    
+    for (size_t begin = 0; begin < items.size(); begin += write_batch_size_) {
+        size_t end = std::min(items.size(), begin + write_batch_size_);
+        
+        // 每块重新获取写连接，块之间允许其他写请求插入
+        auto conn = pool_->acquire_writer();
+        Transaction tx(conn.get());
+        if (!tx.active()) {
+            return ids;
+        }
+        
+        for (size_t i = begin; i < end; ++i) {
+            // 单条失败只回滚到该条的保存点，不影响同一块内的其他条目
+            Transaction item_tx(conn.get());
+            if (!item_tx.active()) {
+                continue;
+            }
+            auto id = insert_content(conn, items[i]);
+            if (id && item_tx.commit()) {
+                ids[i] = id;
+            }
+        }
+        
+        if (!tx.commit()) {
+            spdlog::error("Failed to commit batch [{}, {})", begin, end);
+            std::fill(ids.begin() + begin, ids.begin() + end, std::nullopt);
+            return ids;
+        }
+        bump_write_generation();
+    }
+    
+    return ids;
+}
+
+std::optional<int64_t> Database::insert_content(PooledConnection& conn, const ContentItem& item) {
+    const std::string sql = R"(
+        INSERT INTO content (title, content, content_type, tags, metadata, created_at, updated_at)
+        VALUES (?, ?, ?, ?, ?, ?, ?);
+    )";
+    
+    int64_t id = 0;
+    {
+        auto stmt = conn.prepare(sql);
+        if (!stmt) {
+            spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
+            return std::nullopt;
+        }
+        
+        auto now = std::time(nullptr);
+        sqlite3_bind_text(stmt.get(), 1, item.title.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt.get(), 2, item.content.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt.get(), 3, item.content_type.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt.get(), 4, item.tags.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt.get(), 5, item.metadata.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_int64(stmt.get(), 6, now);
+        sqlite3_bind_int64(stmt.get(), 7, now);
+        
+        if (sqlite3_step(stmt.get()) != SQLITE_DONE) {
+            spdlog::error("Failed to insert content: {}", sqlite3_errmsg(conn.get()));
+            return std::nullopt;
+        }
+        id = sqlite3_last_insert_rowid(conn.get());
+    }
+    
+    if (!fts_insert(conn, id, item.title, item.content, item.tags) ||
+        !replace_tags(conn, id, item.tags)) {
+        return std::nullopt;
+    }
+    
+    return id;
+}
+
+std::optional<ContentItem> Database::get_content(int64_t id) {
+    MCP_SCOPED_LATENCY("mcp_db_query_duration_seconds");
+    auto conn = pool_->acquire_reader();
+    
+    const std::string sql = "SELECT * FROM content WHERE id = ?";
+    
+    auto stmt = conn.prepare(sql);
+    if (!stmt) {
+        spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
+        return std::nullopt;
+    }
+    
+    sqlite3_bind_int64(stmt.get(), 1, id);
+    
+    std::optional<ContentItem> result;
+    if (sqlite3_step(stmt.get()) == SQLITE_ROW) {
+        result = row_to_content_item(stmt.get());
+    }
+    
+    return result;
+}
+
+bool Database::update_content(const ContentItem& item) {
+    MCP_SCOPED_LATENCY("mcp_db_query_duration_seconds");
+    auto conn = pool_->acquire_writer();
+    
+    Transaction tx(conn.get());
+    if (!tx.active()) {
+        return false;
+    }
+    
+    // FTS外部内容表删除词条时需要旧值
+    std::string old_title, old_content, old_tags;
+    {
+        auto stmt = conn.prepare("SELECT title, content, tags FROM content WHERE id = ?");
+        if (!stmt) {
+            spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
+            return false;
+        }
+        sqlite3_bind_int64(stmt.get(), 1, item.id);
+        if (sqlite3_step(stmt.get()) != SQLITE_ROW) {
+            return false;
+        }
+        old_title = column_text(stmt.get(), 0);
+        old_content = column_text(stmt.get(), 1);
+        old_tags = column_text(stmt.get(), 2);
+    }
+    
+    const std::string sql = R"(
+        UPDATE content 
+        SET title = ?, content = ?, content_type = ?, tags = ?, metadata = ?, updated_at = ?
+        WHERE id = ?;
+    )";
+    
+    {
+        auto stmt = conn.prepare(sql);
+        if (!stmt) {
+            spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
+            return false;
+        }
+        
+        auto now = std::time(nullptr);
+        sqlite3_bind_text(stmt.get(), 1, item.title.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt.get(), 2, item.content.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt.get(), 3, item.content_type.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt.get(), 4, item.tags.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt.get(), 5, item.metadata.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_int64(stmt.get(), 6, now);
+        sqlite3_bind_int64(stmt.get(), 7, item.id);
+        
+        if (sqlite3_step(stmt.get()) != SQLITE_DONE) {
+            spdlog::error("Failed to update content: {}", sqlite3_errmsg(conn.get()));
+            return false;
+        }
+    }
+    
+    if (!fts_delete(conn, item.id, old_title, old_content, old_tags) ||
+        !fts_insert(conn, item.id, item.title, item.content, item.tags)) {
+        return false;
+    }
+    
+    if (old_tags != item.tags && !replace_tags(conn, item.id, item.tags)) {
+        return false;
+    }
+    
+    if (!tx.commit()) {
+        return false;
+    }
+    
+    bump_write_generation();
+    return true;
+}
+
+bool Database::delete_content(int64_t id) {
+    MCP_SCOPED_LATENCY("mcp_db_query_duration_seconds");
+    auto conn = pool_->acquire_writer();
+    
+    Transaction tx(conn.get());
+    if (!tx.active()) {
+        return false;
+    }
+    
+    std::string old_title, old_content, old_tags;
+    {
+        auto stmt = conn.prepare("SELECT title, content, tags FROM content WHERE id = ?");
+        if (!stmt) {
+            spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
+            return false;
+        }
+        sqlite3_bind_int64(stmt.get(), 1, id);
+        if (sqlite3_step(stmt.get()) != SQLITE_ROW) {
+            // 记录不存在，与原先DELETE无匹配行的行为保持一致
+            return tx.commit();
+        }
+        old_title = column_text(stmt.get(), 0);
+        old_content = column_text(stmt.get(), 1);
+        old_tags = column_text(stmt.get(), 2);
+    }
+    
+    // 先删除FTS索引
+    if (!fts_delete(conn, id, old_title, old_content, old_tags)) {
+        return false;
+    }
+    
+    // 删除主记录和标签
+    const std::string sql = "DELETE FROM content WHERE id = ?";
+    {
+        auto stmt = conn.prepare(sql);
+        if (!stmt) {
+            spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
+            return false;
+        }
+        
+        sqlite3_bind_int64(stmt.get(), 1, id);
+        
+        if (sqlite3_step(stmt.get()) != SQLITE_DONE) {
+            spdlog::error("Failed to delete content: {}", sqlite3_errmsg(conn.get()));
+            return false;
+        }
+    }
+    
+    if (!replace_tags(conn, id, "")) {
+        return false;
+    }
+    
+    if (!tx.commit()) {
+        return false;
+    }
+    
+    bump_write_generation();
+    return true;
+}
+
+std::vector<ContentItem> Database::search_content(const std::string& query, int limit, int offset,
+                                                  uint32_t fields) {
+    MCP_SCOPED_LATENCY("mcp_db_query_duration_seconds");
+    auto conn = pool_->acquire_reader();
+    
+    std::vector<ContentItem> results;
+    
+    const std::string sql = "SELECT " + content_select_list(fields, "c", kSearchSnippet) + R"(
+        FROM content c
+        JOIN content_fts fts ON c.id = fts.rowid
+        WHERE content_fts MATCH ?
+        ORDER BY fts.rank, fts.rowid
+        LIMIT ? OFFSET ?;
+    )";
+    
+    auto stmt = conn.prepare(sql);
+    if (!stmt) {
+        spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
+        return results;
+    }
+    
+    sqlite3_bind_text(stmt.get(), 1, query.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt.get(), 2, limit);
+    sqlite3_bind_int(stmt.get(), 3, offset);
+    
+    while (sqlite3_step(stmt.get()) == SQLITE_ROW) {
+        results.push_back(row_to_projected_item(stmt.get(), fields));
+    }
+    
+    return results;
+}
+
+std::vector<ContentItem> Database::get_content_by_tag(const std::string& tag, int limit, int offset,
+                                                      uint32_t fields) {
+    MCP_SCOPED_LATENCY("mcp_db_query_duration_seconds");
+    auto conn = pool_->acquire_reader();
+    
+    std::vector<ContentItem> results;
+    
+    const std::string sql = "SELECT " + content_select_list(fields, "c") + R"(
+        FROM content_tags t
+        JOIN content c ON c.id = t.content_id
+        WHERE t.tag = ?
+        ORDER BY c.updated_at DESC, c.id DESC
+        LIMIT ? OFFSET ?;
+    )";
+    
+    auto stmt = conn.prepare(sql);
+    if (!stmt) {
+        spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
+        return results;
+    }
+    
+    sqlite3_bind_text(stmt.get(), 1, tag.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt.get(), 2, limit);
+    sqlite3_bind_int(stmt.get(), 3, offset);
+    
+    while (sqlite3_step(stmt.get()) == SQLITE_ROW) {
+        results.push_back(row_to_projected_item(stmt.get(), fields));
+    }
+    
+    return results;
+}
+
+std::vector<ContentItem> Database::get_recent_content(int limit, uint32_t fields) {
+    MCP_SCOPED_LATENCY("mcp_db_query_duration_seconds");
+    auto conn = pool_->acquire_reader();
+    
+    std::vector<ContentItem> results;
+    
+    const std::string sql = "SELECT " + content_select_list(fields, "") + R"(
+        FROM content
+        ORDER BY updated_at DESC, id DESC
+        LIMIT ?;
+    )";
+    
+    auto stmt = conn.prepare(sql);
+    if (!stmt) {
+        spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
+        return results;
+    }
+    
+    sqlite3_bind_int(stmt.get(), 1, limit);
+    
+    while (sqlite3_step(stmt.get()) == SQLITE_ROW) {
+        results.push_back(row_to_projected_item(stmt.get(), fields));
+    }
+    
+    return results;
+}
+
+std::vector<ContentItem> Database::list_all_content(int offset, int limit, uint32_t fields) {
+    MCP_SCOPED_LATENCY("mcp_db_query_duration_seconds");
+    auto conn = pool_->acquire_reader();
+    
+    std::vector<ContentItem> results;
+    
+    const std::string sql = "SELECT " + content_select_list(fields, "") + R"(
+        FROM content
+        ORDER BY updated_at DESC, id DESC
+        LIMIT ? OFFSET ?;
+    )";
+    
+    auto stmt = conn.prepare(sql);
+    if (!stmt) {
+        spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
+        return results;
+    }
+    
+    sqlite3_bind_int(stmt.get(), 1, limit);
+    sqlite3_bind_int(stmt.get(), 2, offset);
+    
+    while (sqlite3_step(stmt.get()) == SQLITE_ROW) {
+        results.push_back(row_to_projected_item(stmt.get(), fields));
+    }
+    
+    return results;
+}
+
+std::vector<ContentItem> Database::search_content_page(const std::string& query,
+                                                     const std::optional<PageCursor>& after,
+                                                     int limit, std::optional<PageCursor>& next,
+                                                     uint32_t fields, int offset) {
+    MCP_SCOPED_LATENCY("mcp_db_query_duration_seconds");
+    auto conn = pool_->acquire_reader();
+    
+    std::vector<ContentItem> results;
+    next.reset();
+    
+    // rank列位于投影的9列之后
+    const std::string sql = "SELECT " + content_select_list(fields, "c", kSearchSnippet) + (after ? R"(,
+        fts.rank FROM content_fts fts
+        JOIN content c ON c.id = fts.rowid
+        WHERE content_fts MATCH ? AND (fts.rank, fts.rowid) > (?, ?)
+        ORDER BY fts.rank, fts.rowid
+        LIMIT ?;
+    )" : R"(,
+        fts.rank FROM content_fts fts
+        JOIN content c ON c.id = fts.rowid
+        WHERE content_fts MATCH ?
+        ORDER BY fts.rank, fts.rowid
+        LIMIT ? OFFSET ?;
+    )");
+    
+    auto stmt = conn.prepare(sql);
+    if (!stmt) {
+        spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
+        return results;
+    }
+    
+    int index = 1;
+    sqlite3_bind_text(stmt.get(), index++, query.c_str(), -1, SQLITE_STATIC);
+    if (after) {
+        sqlite3_bind_double(stmt.get(), index++, after->rank);
+        sqlite3_bind_int64(stmt.get(), index++, after->id);
+    }
+    // 多取一条用于判断是否还有下一页
+    sqlite3_bind_int(stmt.get(), index++, limit + 1);
+    if (!after) {
+        sqlite3_bind_int(stmt.get(), index++, std::max(offset, 0));
+    }
+    
+    double last_rank = 0.0;
+    while (sqlite3_step(stmt.get()) == SQLITE_ROW) {
+        if (static_cast<int>(results.size()) == limit) {
+            next = PageCursor{0, last_rank, results.back().id};
+            break;
+        }
+        results.push_back(row_to_projected_item(stmt.get(), fields));
+        last_rank = sqlite3_column_double(stmt.get(), 9);
+    }
+    
+    return results;
+}
+
+std::vector<ContentItem> Database::get_content_by_tag_page(const std::string& tag,
+                                                         const std::optional<PageCursor>& after,
+                                                         int limit, std::optional<PageCursor>& next,
+                                                         uint32_t fields, int offset) {
+    MCP_SCOPED_LATENCY("mcp_db_query_duration_seconds");
+    auto conn = pool_->acquire_reader();
+    
+    std::vector<ContentItem> results;
+    next.reset();
+    
+    const std::string sql = "SELECT " + content_select_list(fields, "c") + (after ? R"(
+        FROM content_tags t
+        JOIN content c ON c.id = t.content_id
+        WHERE t.tag = ? AND (c.updated_at, c.id) < (?, ?)
+        ORDER BY c.updated_at DESC, c.id DESC
+        LIMIT ?;
+    )" : R"(
+        FROM content_tags t
+        JOIN content c ON c.id = t.content_id
+        WHERE t.tag = ?
+        ORDER BY c.updated_at DESC, c.id DESC
+        LIMIT ? OFFSET ?;
+    )");
+    
+    auto stmt = conn.prepare(sql);
+    if (!stmt) {
+        spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
+        return results;
+    }
+    
+    int index = 1;
+    sqlite3_bind_text(stmt.get(), index++, tag.c_str(), -1, SQLITE_STATIC);
+    if (after) {
+        sqlite3_bind_int64(stmt.get(), index++, after->updated_at);
+        sqlite3_bind_int64(stmt.get(), index++, after->id);
+    }
+    sqlite3_bind_int(stmt.get(), index++, limit + 1);
+    if (!after) {
+        sqlite3_bind_int(stmt.get(), index++, std::max(offset, 0));
+    }
+    
+    while (sqlite3_step(stmt.get()) == SQLITE_ROW) {
+        if (static_cast<int>(results.size()) == limit) {
+            next = PageCursor{results.back().updated_at, 0.0, results.back().id};
+            break;
+        }
+        results.push_back(row_to_projected_item(stmt.get(), fields));
+    }
+    
+    return results;
+}
+
+std::vector<ContentItem> Database::list_content_page(const std::optional<PageCursor>& after,
+                                                   int limit, std::optional<PageCursor>& next,
+                                                   uint32_t fields, int offset) {
+    MCP_SCOPED_LATENCY("mcp_db_query_duration_seconds");
+    auto conn = pool_->acquire_reader();
+    
+    std::vector<ContentItem> results;
+    next.reset();
+    
+    // (updated_at, id)行值比较可以直接使用idx_content_updated_at索引（索引隐含rowid）
+    const std::string sql = "SELECT " + content_select_list(fields, "") + (after ? R"(
+        FROM content
+        WHERE (updated_at, id) < (?, ?)
+        ORDER BY updated_at DESC, id DESC
+        LIMIT ?;
+    )" : R"(
+        FROM content
+        ORDER BY updated_at DESC, id DESC
+        LIMIT ? OFFSET ?;
+    )");
+    
+    auto stmt = conn.prepare(sql);
+    if (!stmt) {
+        spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
+        return results;
+    }
+    
+    int index = 1;
+    if (after) {
+        sqlite3_bind_int64(stmt.get(), index++, after->updated_at);
+        sqlite3_bind_int64(stmt.get(), index++, after->id);
+    }
+    sqlite3_bind_int(stmt.get(), index++, limit + 1);
+    if (!after) {
+        sqlite3_bind_int(stmt.get(), index++, std::max(offset, 0));
+    }
+    
+    while (sqlite3_step(stmt.get()) == SQLITE_ROW) {
+        if (static_cast<int>(results.size()) == limit) {
+            next = PageCursor{results.back().updated_at, 0.0, results.back().id};
+            break;
+        }
+        results.push_back(row_to_projected_item(stmt.get(), fields));
+    }
+    
+    return results;
+}
+
+bool Database::insert_file(const FileInfo& info) {
+    MCP_SCOPED_LATENCY("mcp_db_query_duration_seconds");
+    auto conn = pool_->acquire_writer();
+    
+    Transaction tx(conn.get());
+    if (!tx.active()) {
+        return false;
+    }
+    
+    return write_file(conn, info) && tx.commit();
+}
+
+bool Database::insert_files(const std::vector<FileInfo>& files) {
+    MCP_SCOPED_LATENCY("mcp_db_query_duration_seconds");
+    auto conn = pool_->acquire_writer();
+    
+    Transaction tx(conn.get());
+    if (!tx.active()) {
+        return false;
+    }
+    
+    for (const auto& info : files) {
+        if (!write_file(conn, info)) {
+            return false;
+        }
+    }
+    
+    return tx.commit();
+}
+
+std::optional<FileInfo> Database::get_file(const std::string& id) {
+    MCP_SCOPED_LATENCY("mcp_db_query_duration_seconds");
+    auto conn = pool_->acquire_reader();
+    
+    auto stmt = conn.prepare("SELECT * FROM files WHERE id = ?");
+    if (!stmt) {
+        spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
+        return std::nullopt;
+    }
+    
+    sqlite3_bind_text(stmt.get(), 1, id.c_str(), -1, SQLITE_STATIC);
+    
+    std::optional<FileInfo> result;
+    if (sqlite3_step(stmt.get()) == SQLITE_ROW) {
+        result = row_to_file_info(stmt.get());
+    }
+    
+    return result;
+}
+
+bool Database::update_file(const FileInfo& info) {
+    MCP_SCOPED_LATENCY("mcp_db_query_duration_seconds");
+    auto conn = pool_->acquire_writer();
+    
+    Transaction tx(conn.get());
+    if (!tx.active()) {
+        return false;
+    }
+    
+    int64_t seq = 0;
+    std::string old_filename, old_description;
+    {
+        auto stmt = conn.prepare("SELECT seq, filename, description FROM files WHERE id = ?");
+        if (!stmt) {
+            spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
+            return false;
+        }
+        sqlite3_bind_text(stmt.get(), 1, info.id.c_str(), -1, SQLITE_STATIC);
+        if (sqlite3_step(stmt.get()) != SQLITE_ROW) {
+            return false;
+        }
+        seq = sqlite3_column_int64(stmt.get(), 0);
+        old_filename = column_text(stmt.get(), 1);
+        old_description = column_text(stmt.get(), 2);
+    }
+    
+    // 只允许更新描述和标签
+    const std::string tags_json = nlohmann::json(info.tags).dump();
+    {
+        auto stmt = conn.prepare("UPDATE files SET description = ?, tags = ? WHERE seq = ?");
+        if (!stmt) {
+            spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
+            return false;
+        }
+        sqlite3_bind_text(stmt.get(), 1, info.description.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt.get(), 2, tags_json.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_int64(stmt.get(), 3, seq);
+        if (sqlite3_step(stmt.get()) != SQLITE_DONE) {
+            spdlog::error("Failed to update file: {}", sqlite3_errmsg(conn.get()));
+            return false;
+        }
+    }
+    
+    if (!delete_file_index(conn, seq, info.id, old_filename, old_description) ||
+        !write_file_index(conn, seq, info.id, old_filename, info.description, info.tags)) {
+        return false;
+    }
+    
+    return tx.commit();
+}
+
+bool Database::delete_file(const std::string& id, std::string* orphaned_path) {
+    MCP_SCOPED_LATENCY("mcp_db_query_duration_seconds");
+    auto conn = pool_->acquire_writer();
+    
+    Transaction tx(conn.get());
+    if (!tx.active()) {
+        return false;
+    }
+    
+    std::string path;
+    if (!remove_file(conn, id, path) || !tx.commit()) {
+        return false;
+    }
+    
+    if (orphaned_path) {
+        *orphaned_path = std::move(path);
+    }
+    return true;
+}
+
+std::optional<nlohmann::json> Database::get_parse_result(const std::string& key) {
+    MCP_SCOPED_LATENCY("mcp_db_query_duration_seconds");
+    auto conn = pool_->acquire_reader();
+    
+    auto stmt = conn.prepare("SELECT result FROM parse_cache WHERE key = ?");
+    if (!stmt) {
+        spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
+        return std::nullopt;
+    }
+    sqlite3_bind_text(stmt.get(), 1, key.c_str(), -1, SQLITE_STATIC);
+    if (sqlite3_step(stmt.get()) != SQLITE_ROW) {
+        return std::nullopt;
+    }
+    
+    auto result = nlohmann::json::parse(column_text(stmt.get(), 0), nullptr, false);
+    if (result.is_discarded()) {
+        return std::nullopt;
+    }
+    return result;
+}
+
+bool Database::put_parse_result(const std::string& key, const nlohmann::json& result) {
+    MCP_SCOPED_LATENCY("mcp_db_query_duration_seconds");
+    auto conn = pool_->acquire_writer();
+    
+    auto stmt = conn.prepare("INSERT OR REPLACE INTO parse_cache (key, result) VALUES (?, ?)");
+    if (!stmt) {
+        spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
+        return false;
+    }
+    const std::string result_json = result.dump();
+    sqlite3_bind_text(stmt.get(), 1, key.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt.get(), 2, result_json.c_str(), -1, SQLITE_STATIC);
+    if (sqlite3_step(stmt.get()) != SQLITE_DONE) {
+        spdlog::error("Failed to save parse result: {}", sqlite3_errmsg(conn.get()));
+        return false;
+    }
+    return true;
+}
+
+bool Database::put_embedding(const ContentEmbedding& embedding) {
+    MCP_SCOPED_LATENCY("mcp_db_query_duration_seconds");
+    auto conn = pool_->acquire_writer();
+    
+    // 内容在计算期间被删除时外键约束使插入失败，忽略即可
+    auto stmt = conn.prepare(
+        "INSERT OR REPLACE INTO content_embeddings "
+        "(content_id, model, format, dimensions, scale, vector, updated_at) "
+        "SELECT ?, ?, ?, ?, ?, ?, ? WHERE EXISTS (SELECT 1 FROM content WHERE id = ?1)");
+    if (!stmt) {
+        spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
+        return false;
+    }
+    sqlite3_bind_int64(stmt.get(), 1, embedding.content_id);
+    sqlite3_bind_text(stmt.get(), 2, embedding.model.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt.get(), 3, embedding.format.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt.get(), 4, embedding.dimensions);
+    sqlite3_bind_double(stmt.get(), 5, embedding.scale);
+    sqlite3_bind_blob(stmt.get(), 6, embedding.data.data(), static_cast<int>(embedding.data.size()), SQLITE_STATIC);
+    sqlite3_bind_int64(stmt.get(), 7, embedding.updated_at);
+    
+    if (sqlite3_step(stmt.get()) != SQLITE_DONE) {
+        spdlog::error("Failed to save embedding for {}: {}", embedding.content_id, sqlite3_errmsg(conn.get()));
+        return false;
+    }
+    return true;
+}
+
+std::vector<ContentEmbedding> Database::load_embeddings(const std::string& model) {
+    MCP_SCOPED_LATENCY("mcp_db_query_duration_seconds");
+    std::vector<ContentEmbedding> embeddings;
+    auto conn = pool_->acquire_reader();
+    
+    auto stmt = conn.prepare(
+        "SELECT content_id, format, dimensions, scale, vector, updated_at "
+        "FROM content_embeddings WHERE model = ?");
+    if (!stmt) {
+        spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
+        return embeddings;
+    }
+    sqlite3_bind_text(stmt.get(), 1, model.c_str(), -1, SQLITE_STATIC);
+    while (sqlite3_step(stmt.get()) == SQLITE_ROW) {
+        ContentEmbedding embedding;
+        embedding.content_id = sqlite3_column_int64(stmt.get(), 0);
+        embedding.model = model;
+        embedding.format = column_text(stmt.get(), 1);
+        embedding.dimensions = sqlite3_column_int(stmt.get(), 2);
+        embedding.scale = static_cast<float>(sqlite3_column_double(stmt.get(), 3));
+        const auto* blob = static_cast<const uint8_t*>(sqlite3_column_blob(stmt.get(), 4));
+        embedding.data.assign(blob, blob + sqlite3_column_bytes(stmt.get(), 4));
+        embedding.updated_at = sqlite3_column_int64(stmt.get(), 5);
+        embeddings.push_back(std::move(embedding));
+    }
+    return embeddings;
+}
+
+std::vector<int64_t> Database::list_stale_embeddings(const std::string& model, int limit) {
+    MCP_SCOPED_LATENCY("mcp_db_query_duration_seconds");
+    std::vector<int64_t> ids;
+    auto conn = pool_->acquire_reader();
+    
+    auto stmt = conn.prepare(
+        "SELECT c.id FROM content c LEFT JOIN content_embeddings e ON e.content_id = c.id "
+        "WHERE e.content_id IS NULL OR e.model != ? OR e.updated_at < c.updated_at "
+        "ORDER BY c.id LIMIT ?");
+    if (!stmt) {
+        spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
+        return ids;
+    }
+    sqlite3_bind_text(stmt.get(), 1, model.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt.get(), 2, limit);
+    while (sqlite3_step(stmt.get()) == SQLITE_ROW) {
+        ids.push_back(sqlite3_column_int64(stmt.get(), 0));
+    }
+    return ids;
 }
 
-ContentItem ContentItem::from_json(const nlohmann::json& j) {
-    ContentItem item;
-    item.id = j.value("id", 0);
-    item.title = j.value("title", "");
-    item.content = j.value("content", "");
-    item.content_type = j.value("content_type", "text");
-    if (item.content_type == "document") {
-        item.content_type = "text";
+bool Database::save_job(const JobRecord& job) {
+    MCP_SCOPED_LATENCY("mcp_db_query_duration_seconds");
+    auto conn = pool_->acquire_writer();
+    
+    auto stmt = conn.prepare(
+        "INSERT INTO jobs (id, type, status, progress, message, params, result, error, created_at, updated_at) "
+        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?) "
+        "ON CONFLICT(id) DO UPDATE SET status = excluded.status, progress = excluded.progress, "
+        "message = excluded.message, result = excluded.result, error = excluded.error, "
+        "updated_at = excluded.updated_at");
+    if (!stmt) {
+        spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
+        return false;
     }
-    item.tags = j.value("tags", "");
     
-    // 处理metadata
-    if (j.contains("metadata") && j["metadata"].is_object()) {
-        item.metadata = j["metadata"].dump();
+    const std::string params_json = job.params.dump();
+    const std::string result_json = job.result.is_null() ? "" : job.result.dump();
+    sqlite3_bind_text(stmt.get(), 1, job.id.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt.get(), 2, job.type.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt.get(), 3, job.status.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_double(stmt.get(), 4, job.progress);
+    sqlite3_bind_text(stmt.get(), 5, job.message.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt.get(), 6, params_json.c_str(), -1, SQLITE_STATIC);
+    if (job.result.is_null()) {
+        sqlite3_bind_null(stmt.get(), 7);
     } else {
-        item.metadata = "{}";
+        sqlite3_bind_text(stmt.get(), 7, result_json.c_str(), -1, SQLITE_STATIC);
     }
+    sqlite3_bind_text(stmt.get(), 8, job.error.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int64(stmt.get(), 9, job.created_at);
+    sqlite3_bind_int64(stmt.get(), 10, job.updated_at);
     
-    auto now = std::time(nullptr);
-    item.created_at = j.value("created_at", now);
-    item.updated_at = j.value("updated_at", now);
+    if (sqlite3_step(stmt.get()) != SQLITE_DONE) {
+        spdlog::error("Failed to save job {}: {}", job.id, sqlite3_errmsg(conn.get()));
+        return false;
+    }
+    return true;
+}
+
+std::optional<JobRecord> Database::get_job(const std::string& id) {
+    MCP_SCOPED_LATENCY("mcp_db_query_duration_seconds");
+    auto conn = pool_->acquire_reader();
     
-    return item;
+    auto stmt = conn.prepare(std::string("SELECT ") + kJobColumns + " FROM jobs WHERE id = ?");
+    if (!stmt) {
+        spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
+        return std::nullopt;
+    }
+    sqlite3_bind_text(stmt.get(), 1, id.c_str(), -1, SQLITE_STATIC);
+    if (sqlite3_step(stmt.get()) != SQLITE_ROW) {
+        return std::nullopt;
+    }
+    return job_from_row(stmt.get());
 }
 
-// Database实现
-Database::Database(const std::string& db_path) : db_(nullptr), db_path_(db_path) {
+std::vector<JobRecord> Database::list_jobs(const std::string& status, int limit) {
+    MCP_SCOPED_LATENCY("mcp_db_query_duration_seconds");
+    std::vector<JobRecord> jobs;
+    auto conn = pool_->acquire_reader();
+    
+    auto stmt = conn.prepare(std::string("SELECT ") + kJobColumns +
+                             " FROM jobs WHERE (?1 = '' OR status = ?1) ORDER BY created_at DESC LIMIT ?2");
+    if (!stmt) {
+        spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
+        return jobs;
+    }
+    sqlite3_bind_text(stmt.get(), 1, status.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt.get(), 2, limit);
+    while (sqlite3_step(stmt.get()) == SQLITE_ROW) {
+        jobs.push_back(job_from_row(stmt.get()));
+    }
+    return jobs;
 }
 
-Database::~Database() {
-    if (db_) {
-        sqlite3_close(db_);
+int Database::fail_interrupted_jobs() {
+    MCP_SCOPED_LATENCY("mcp_db_query_duration_seconds");
+    auto conn = pool_->acquire_writer();
+    
+    auto stmt = conn.prepare(
+        "UPDATE jobs SET status = 'failed', error = 'Interrupted by server restart', "
+        "updated_at = CAST(strftime('%s', 'now') AS INTEGER) WHERE status IN ('queued', 'running')");
+    if (!stmt) {
+        spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
+        return 0;
     }
+    if (sqlite3_step(stmt.get()) != SQLITE_DONE) {
+        spdlog::error("Failed to update interrupted jobs: {}", sqlite3_errmsg(conn.get()));
+        return 0;
+    }
+    return sqlite3_changes(conn.get());
 }
 
-bool Database::initialize() {
-    // 确保数据库目录存在
-    std::filesystem::path db_file(db_path_);
-    std::filesystem::create_directories(db_file.parent_path());
+std::optional<std::string> Database::find_blob(const std::string& hash) {
+    MCP_SCOPED_LATENCY("mcp_db_query_duration_seconds");
+    auto conn = pool_->acquire_reader();
     
-    // 打开数据库
-    int rc = sqlite3_open(db_path_.c_str(), &db_);
-    if (rc != SQLITE_OK) {
-        spdlog::error("Cannot open database: {}", sqlite3_errmsg(db_));
-        return false;
+    auto stmt = conn.prepare("SELECT path FROM blobs WHERE hash = ?");
+    if (!stmt) {
+        spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
+        return std::nullopt;
+    }
+    sqlite3_bind_text(stmt.get(), 1, hash.c_str(), -1, SQLITE_STATIC);
+    if (sqlite3_step(stmt.get()) != SQLITE_ROW) {
+        return std::nullopt;
+    }
+    return column_text(stmt.get(), 0);
+}
+
+std::vector<FileInfo> Database::list_files(int offset, int limit) {
+    MCP_SCOPED_LATENCY("mcp_db_query_duration_seconds");
+    auto conn = pool_->acquire_reader();
+    
+    std::vector<FileInfo> results;
+    
+    auto stmt = conn.prepare("SELECT * FROM files ORDER BY seq LIMIT ? OFFSET ?");
+    if (!stmt) {
+        spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
+        return results;
     }
     
-    // 启用外键约束
-    execute_sql("PRAGMA foreign_keys = ON;");
+    sqlite3_bind_int(stmt.get(), 1, limit);
+    sqlite3_bind_int(stmt.get(), 2, offset);
     
-    // 创建表
-    return create_tables();
+    while (sqlite3_step(stmt.get()) == SQLITE_ROW) {
+        results.push_back(row_to_file_info(stmt.get()));
+    }
+    
+    return results;
 }
 
-bool Database::create_tables() {
-    const std::string create_content_table = R"(
-        CREATE TABLE IF NOT EXISTS content (
-            id INTEGER PRIMARY KEY AUTOINCREMENT,
-            title TEXT NOT NULL,
-            content TEXT NOT NULL,
-            content_type TEXT DEFAULT 'text',
-            tags TEXT DEFAULT '',
-            metadata TEXT DEFAULT '{}',
-            created_at INTEGER NOT NULL,
-            updated_at INTEGER NOT NULL
-        );
-    )";
+std::vector<FileInfo> Database::search_files(const std::string& query, const std::vector<std::string>& tags,
+                                             int limit) {
+    MCP_SCOPED_LATENCY("mcp_db_query_duration_seconds");
+    auto conn = pool_->acquire_reader();
+    
+    std::vector<FileInfo> results;
+    
+    // trigram索引要求至少3个字符，更短的查询回退到LIKE
+    const bool use_fts = query.size() >= 3;
+    std::string sql = "SELECT f.* FROM files f";
+    if (!query.empty() && use_fts) {
+        sql += " JOIN files_fts ON files_fts.rowid = f.seq AND files_fts MATCH ?";
+    }
+    sql += " WHERE 1 = 1";
+    if (!query.empty() && !use_fts) {
+        sql += " AND (f.filename LIKE ? ESCAPE '\\' OR f.description LIKE ? ESCAPE '\\')";
+    }
+    if (!tags.empty()) {
+        sql += " AND f.id IN (SELECT file_id FROM file_tags WHERE tag IN (?";
+        for (size_t i = 1; i < tags.size(); ++i) {
+            sql += ", ?";
+        }
+        sql += ") GROUP BY file_id HAVING COUNT(*) = ?)";
+    }
+    sql += " ORDER BY f.seq LIMIT ?";
     
-    const std::string create_indexes = R"(
-        CREATE INDEX IF NOT EXISTS idx_content_title ON content(title);
-        CREATE INDEX IF NOT EXISTS idx_content_tags ON content(tags);
-        CREATE INDEX IF NOT EXISTS idx_content_type ON content(content_type);
-        CREATE INDEX IF NOT EXISTS idx_content_created_at ON content(created_at);
-        CREATE INDEX IF NOT EXISTS idx_content_updated_at ON content(updated_at);
-        CREATE VIRTUAL TABLE IF NOT EXISTS content_fts USING fts5(
-            title, content, tags, content=content, content_rowid=id
-        );
-    )";
+    auto stmt = conn.prepare(sql);
+    if (!stmt) {
+        spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
+        return results;
+    }
+    
+    int index = 1;
+    std::string pattern;
+    if (!query.empty()) {
+        if (use_fts) {
+            // 整体作为短语匹配，避免查询中的FTS语法字符被解释
+            pattern = "\"";
+            for (char c : query) {
+                pattern += c;
+                if (c == '"') {
+                    pattern += '"';
+                }
+            }
+            pattern += "\"";
+            sqlite3_bind_text(stmt.get(), index++, pattern.c_str(), -1, SQLITE_STATIC);
+        } else {
+            pattern = "%";
+            for (char c : query) {
+                if (c == '%' || c == '_' || c == '\\') {
+                    pattern += '\\';
+                }
+                pattern += c;
+            }
+            pattern += "%";
+            sqlite3_bind_text(stmt.get(), index++, pattern.c_str(), -1, SQLITE_STATIC);
+            sqlite3_bind_text(stmt.get(), index++, pattern.c_str(), -1, SQLITE_STATIC);
+        }
+    }
+    
+    // 标签去重后计数，保证HAVING COUNT(*)与匹配数一致
+    std::vector<std::string> unique_tags;
+    for (const auto& tag : tags) {
+        if (std::find(unique_tags.begin(), unique_tags.end(), tag) == unique_tags.end()) {
+            unique_tags.push_back(tag);
+        }
+    }
+    for (const auto& tag : tags) {
+        sqlite3_bind_text(stmt.get(), index++, tag.c_str(), -1, SQLITE_STATIC);
+    }
+    if (!tags.empty()) {
+        sqlite3_bind_int64(stmt.get(), index++, static_cast<int64_t>(unique_tags.size()));
+    }
+    sqlite3_bind_int(stmt.get(), index++, limit);
+    
+    while (sqlite3_step(stmt.get()) == SQLITE_ROW) {
+        results.push_back(row_to_file_info(stmt.get()));
+    }
     
-    return execute_sql(create_content_table) && execute_sql(create_indexes);
+    return results;
 }
 
-bool Database::execute_sql(const std::string& sql) {
-    char* err_msg = nullptr;
-    int rc = sqlite3_exec(db_, sql.c_str(), nullptr, nullptr, &err_msg);
+nlohmann::json Database::get_file_statistics() {
+    MCP_SCOPED_LATENCY("mcp_db_query_duration_seconds");
+    auto conn = pool_->acquire_reader();
+    
+    nlohmann::json stats;
+    stats["total_files"] = 0;
+    stats["total_size"] = 0;
+    stats["file_types"] = nlohmann::json::object();
+    
+    {
+        auto stmt = conn.prepare("SELECT COUNT(*), COALESCE(SUM(file_size), 0) FROM files");
+        if (!stmt) {
+            spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
+            return stats;
+        }
+        if (sqlite3_step(stmt.get()) == SQLITE_ROW) {
+            stats["total_files"] = sqlite3_column_int64(stmt.get(), 0);
+            stats["total_size"] = sqlite3_column_int64(stmt.get(), 1);
+        }
+    }
     
-    if (rc != SQLITE_OK) {
-        spdlog::error("SQL error: {}", err_msg ? err_msg : "Unknown error");
-        if (err_msg) {
-            sqlite3_free(err_msg);
+    // 去重后实际占用的磁盘空间：blob各算一次，再加上未纳入blob管理的旧文件
+    {
+        auto stmt = conn.prepare(R"(
+            SELECT (SELECT COUNT(*) FROM blobs),
+                   (SELECT COALESCE(SUM(size), 0) FROM blobs) +
+                   (SELECT COALESCE(SUM(f.file_size), 0) FROM files f
+                    WHERE NOT EXISTS (SELECT 1 FROM blobs b
+                                      WHERE b.hash = f.content_hash AND b.path = f.file_path))
+        )");
+        if (!stmt) {
+            spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
+            return stats;
+        }
+        if (sqlite3_step(stmt.get()) == SQLITE_ROW) {
+            stats["unique_blobs"] = sqlite3_column_int64(stmt.get(), 0);
+            stats["stored_size"] = sqlite3_column_int64(stmt.get(), 1);
         }
-        return false;
     }
     
-    return true;
+    auto stmt = conn.prepare("SELECT extension, COUNT(*) FROM files GROUP BY extension");
+    if (!stmt) {
+        spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
+        return stats;
+    }
+    while (sqlite3_step(stmt.get()) == SQLITE_ROW) {
+        stats["file_types"][column_text(stmt.get(), 0)] = sqlite3_column_int64(stmt.get(), 1);
+    }
+    
+    return stats;
 }
 
-std::optional<int64_t> Database::create_content(const ContentItem& item) {
+bool Database::write_file(PooledConnection& conn, const FileInfo& info) {
     const std::string sql = R"(
-        INSERT INTO content (title, content, content_type, tags, metadata, created_at, updated_at)
-        VALUES (?, ?, ?, ?, ?, ?, ?);
+        INSERT INTO files (id, filename, original_name, file_path, mime_type, file_size,
+                           extension, upload_time, description, tags, content_hash)
+        VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);
     )";
     
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
-    
-    if (rc != SQLITE_OK) {
-        spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(db_));
-        return std::nullopt;
-    }
-    
-    auto now = std::time(nullptr);
-    sqlite3_bind_text(stmt, 1, item.title.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, item.content.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 3, item.content_type.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 4, item.tags.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 5, item.metadata.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_int64(stmt, 6, now);
-    sqlite3_bind_int64(stmt, 7, now);
-    
-    rc = sqlite3_step(stmt);
-    int64_t id = 0;
+    auto pos = info.filename.find_last_of('.');
+    const std::string extension = pos != std::string::npos ? info.filename.substr(pos) : "";
+    const std::string tags_json = nlohmann::json(info.tags).dump();
     
-    if (rc == SQLITE_DONE) {
-        id = sqlite3_last_insert_rowid(db_);
-    } else {
-        spdlog::error("Failed to insert content: {}", sqlite3_errmsg(db_));
+    int64_t seq = 0;
+    {
+        auto stmt = conn.prepare(sql);
+        if (!stmt) {
+            spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
+            return false;
+        }
+        
+        sqlite3_bind_text(stmt.get(), 1, info.id.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt.get(), 2, info.filename.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt.get(), 3, info.original_name.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt.get(), 4, info.file_path.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt.get(), 5, info.mime_type.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_int64(stmt.get(), 6, static_cast<int64_t>(info.file_size));
+        sqlite3_bind_text(stmt.get(), 7, extension.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt.get(), 8, info.upload_time.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt.get(), 9, info.description.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt.get(), 10, tags_json.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt.get(), 11, info.content_hash.c_str(), -1, SQLITE_STATIC);
+        
+        if (sqlite3_step(stmt.get()) != SQLITE_DONE) {
+            spdlog::error("Failed to insert file: {}", sqlite3_errmsg(conn.get()));
+            return false;
+        }
+        seq = sqlite3_last_insert_rowid(conn.get());
     }
     
-    sqlite3_finalize(stmt);
-    
-    if (id > 0) {
-        // 更新FTS索引
-        const std::string fts_sql = "INSERT INTO content_fts(rowid, title, content, tags) VALUES (?, ?, ?, ?)";
-        sqlite3_prepare_v2(db_, fts_sql.c_str(), -1, &stmt, nullptr);
-        sqlite3_bind_int64(stmt, 1, id);
-        sqlite3_bind_text(stmt, 2, item.title.c_str(), -1, SQLITE_STATIC);
-        sqlite3_bind_text(stmt, 3, item.content.c_str(), -1, SQLITE_STATIC);
-        sqlite3_bind_text(stmt, 4, item.tags.c_str(), -1, SQLITE_STATIC);
-        sqlite3_step(stmt);
-        sqlite3_finalize(stmt);
-        
-        return id;
+    // 有内容哈希的文件按blob引用计数；已存在但路径不同的blob（旧版按id存放的文件）不计入
+    if (!info.content_hash.empty()) {
+        auto stmt = conn.prepare(R"(
+            INSERT INTO blobs (hash, path, size, ref_count) VALUES (?, ?, ?, 1)
+            ON CONFLICT(hash) DO UPDATE SET ref_count = ref_count + 1 WHERE path = excluded.path
+        )");
+        if (!stmt) {
+            spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
+            return false;
+        }
+        sqlite3_bind_text(stmt.get(), 1, info.content_hash.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt.get(), 2, info.file_path.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_int64(stmt.get(), 3, static_cast<int64_t>(info.file_size));
+        if (sqlite3_step(stmt.get()) != SQLITE_DONE) {
+            spdlog::error("Failed to update blob reference: {}", sqlite3_errmsg(conn.get()));
+            return false;
+        }
     }
     
-    return std::nullopt;
+    return write_file_index(conn, seq, info.id, info.filename, info.description, info.tags);
 }
 
-std::optional<ContentItem> Database::get_content(int64_t id) {
-    const std::string sql = "SELECT * FROM content WHERE id = ?";
+bool Database::remove_file(PooledConnection& conn, const std::string& id, std::string& orphaned_path) {
+    int64_t seq = 0;
+    std::string filename, description, file_path, content_hash;
+    {
+        auto stmt = conn.prepare("SELECT seq, filename, description, file_path, content_hash FROM files WHERE id = ?");
+        if (!stmt) {
+            spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
+            return false;
+        }
+        sqlite3_bind_text(stmt.get(), 1, id.c_str(), -1, SQLITE_STATIC);
+        if (sqlite3_step(stmt.get()) != SQLITE_ROW) {
+            return false;
+        }
+        seq = sqlite3_column_int64(stmt.get(), 0);
+        filename = column_text(stmt.get(), 1);
+        description = column_text(stmt.get(), 2);
+        file_path = column_text(stmt.get(), 3);
+        content_hash = column_text(stmt.get(), 4);
+    }
     
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
+    if (!delete_file_index(conn, seq, id, filename, description)) {
+        return false;
+    }
     
-    if (rc != SQLITE_OK) {
-        spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(db_));
-        return std::nullopt;
+    {
+        auto stmt = conn.prepare("DELETE FROM files WHERE seq = ?");
+        if (!stmt) {
+            spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
+            return false;
+        }
+        sqlite3_bind_int64(stmt.get(), 1, seq);
+        if (sqlite3_step(stmt.get()) != SQLITE_DONE) {
+            spdlog::error("Failed to delete file: {}", sqlite3_errmsg(conn.get()));
+            return false;
+        }
     }
     
-    sqlite3_bind_int64(stmt, 1, id);
+    // 不属于blob的文件直接删除；blob只在最后一个引用消失时删除
+    orphaned_path = file_path;
+    if (content_hash.empty()) {
+        return true;
+    }
     
-    rc = sqlite3_step(stmt);
-    std::optional<ContentItem> result;
+    int64_t ref_count = 0;
+    {
+        auto stmt = conn.prepare("SELECT ref_count FROM blobs WHERE hash = ? AND path = ?");
+        if (!stmt) {
+            spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
+            return false;
+        }
+        sqlite3_bind_text(stmt.get(), 1, content_hash.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt.get(), 2, file_path.c_str(), -1, SQLITE_STATIC);
+        if (sqlite3_step(stmt.get()) != SQLITE_ROW) {
+            return true;
+        }
+        ref_count = sqlite3_column_int64(stmt.get(), 0);
+    }
     
-    if (rc == SQLITE_ROW) {
-        result = row_to_content_item(stmt);
+    auto stmt = conn.prepare(ref_count > 1 ? "UPDATE blobs SET ref_count = ref_count - 1 WHERE hash = ?"
+                                           : "DELETE FROM blobs WHERE hash = ?");
+    if (!stmt) {
+        spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
+        return false;
+    }
+    sqlite3_bind_text(stmt.get(), 1, content_hash.c_str(), -1, SQLITE_STATIC);
+    if (sqlite3_step(stmt.get()) != SQLITE_DONE) {
+        spdlog::error("Failed to update blob reference: {}", sqlite3_errmsg(conn.get()));
+        return false;
     }
     
-    sqlite3_finalize(stmt);
-    return result;
+    if (ref_count > 1) {
+        orphaned_path.clear();
+    }
+    return true;
 }
 
-bool Database::update_content(const ContentItem& item) {
-    const std::string sql = R"(
-        UPDATE content 
-        SET title = ?, content = ?, content_type = ?, tags = ?, metadata = ?, updated_at = ?
-        WHERE id = ?;
-    )";
-    
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
+bool Database::write_file_index(PooledConnection& conn, int64_t seq, const std::string& id,
+                                const std::string& filename, const std::string& description,
+                                const std::vector<std::string>& tags) {
+    {
+        auto stmt = conn.prepare("INSERT INTO files_fts(rowid, filename, description) VALUES (?, ?, ?)");
+        if (!stmt) {
+            spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
+            return false;
+        }
+        sqlite3_bind_int64(stmt.get(), 1, seq);
+        sqlite3_bind_text(stmt.get(), 2, filename.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt.get(), 3, description.c_str(), -1, SQLITE_STATIC);
+        if (sqlite3_step(stmt.get()) != SQLITE_DONE) {
+            spdlog::error("Failed to update FTS index: {}", sqlite3_errmsg(conn.get()));
+            return false;
+        }
+    }
     
-    if (rc != SQLITE_OK) {
-        spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(db_));
+    auto stmt = conn.prepare("INSERT OR IGNORE INTO file_tags(tag, file_id) VALUES (?, ?)");
+    if (!stmt) {
+        spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
         return false;
     }
-    
-    auto now = std::time(nullptr);
-    sqlite3_bind_text(stmt, 1, item.title.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, item.content.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 3, item.content_type.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 4, item.tags.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 5, item.metadata.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_int64(stmt, 6, now);
-    sqlite3_bind_int64(stmt, 7, item.id);
-    
-    rc = sqlite3_step(stmt);
-    bool success = (rc == SQLITE_DONE);
-    
-    if (!success) {
-        spdlog::error("Failed to update content: {}", sqlite3_errmsg(db_));
-    }
-    
-    sqlite3_finalize(stmt);
-    
-    if (success) {
-        // 更新FTS索引
-        const std::string fts_sql = "UPDATE content_fts SET title = ?, content = ?, tags = ? WHERE rowid = ?";
-        sqlite3_prepare_v2(db_, fts_sql.c_str(), -1, &stmt, nullptr);
-        sqlite3_bind_text(stmt, 1, item.title.c_str(), -1, SQLITE_STATIC);
-        sqlite3_bind_text(stmt, 2, item.content.c_str(), -1, SQLITE_STATIC);
-        sqlite3_bind_text(stmt, 3, item.tags.c_str(), -1, SQLITE_STATIC);
-        sqlite3_bind_int64(stmt, 4, item.id);
-        sqlite3_step(stmt);
-        sqlite3_finalize(stmt);
+    for (const auto& tag : tags) {
+        sqlite3_bind_text(stmt.get(), 1, tag.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt.get(), 2, id.c_str(), -1, SQLITE_STATIC);
+        if (sqlite3_step(stmt.get()) != SQLITE_DONE) {
+            spdlog::error("Failed to insert file tag: {}", sqlite3_errmsg(conn.get()));
+            return false;
+        }
+        sqlite3_reset(stmt.get());
     }
     
-    return success;
+    return true;
 }
 
-bool Database::delete_content(int64_t id) {
-    // 先删除FTS索引
-    const std::string fts_sql = "DELETE FROM content_fts WHERE rowid = ?";
-    sqlite3_stmt* stmt;
-    sqlite3_prepare_v2(db_, fts_sql.c_str(), -1, &stmt, nullptr);
-    sqlite3_bind_int64(stmt, 1, id);
-    sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
-    
-    // 删除主记录
-    const std::string sql = "DELETE FROM content WHERE id = ?";
-    
-    int rc = sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
+bool Database::delete_file_index(PooledConnection& conn, int64_t seq, const std::string& id,
+                                 const std::string& filename, const std::string& description) {
+    {
+        auto stmt = conn.prepare(
+            "INSERT INTO files_fts(files_fts, rowid, filename, description) VALUES ('delete', ?, ?, ?)");
+        if (!stmt) {
+            spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
+            return false;
+        }
+        sqlite3_bind_int64(stmt.get(), 1, seq);
+        sqlite3_bind_text(stmt.get(), 2, filename.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt.get(), 3, description.c_str(), -1, SQLITE_STATIC);
+        if (sqlite3_step(stmt.get()) != SQLITE_DONE) {
+            spdlog::error("Failed to update FTS index: {}", sqlite3_errmsg(conn.get()));
+            return false;
+        }
+    }
     
-    if (rc != SQLITE_OK) {
-        spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(db_));
+    auto stmt = conn.prepare("DELETE FROM file_tags WHERE file_id = ?");
+    if (!stmt) {
+        spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
+        return false;
+    }
+    sqlite3_bind_text(stmt.get(), 1, id.c_str(), -1, SQLITE_STATIC);
+    if (sqlite3_step(stmt.get()) != SQLITE_DONE) {
+        spdlog::error("Failed to delete file tags: {}", sqlite3_errmsg(conn.get()));
         return false;
     }
     
-    sqlite3_bind_int64(stmt, 1, id);
-    
-    rc = sqlite3_step(stmt);
-    bool success = (rc == SQLITE_DONE);
-    
-    if (!success) {
-        spdlog::error("Failed to delete content: {}", sqlite3_errmsg(db_));
+    return true;
+}
+
+FileInfo Database::row_to_file_info(sqlite3_stmt* stmt) {
+    // 列顺序: seq, id, filename, original_name, file_path, mime_type, file_size,
+    //         extension, upload_time, description, tags, content_hash
+    FileInfo info;
+    info.id = column_text(stmt, 1);
+    info.filename = column_text(stmt, 2);
+    info.original_name = column_text(stmt, 3);
+    info.file_path = column_text(stmt, 4);
+    info.mime_type = column_text(stmt, 5);
+    info.file_size = static_cast<size_t>(sqlite3_column_int64(stmt, 6));
+    info.upload_time = column_text(stmt, 8);
+    info.description = column_text(stmt, 9);
+    info.content_hash = column_text(stmt, 11);
+    
+    auto tags = nlohmann::json::parse(column_text(stmt, 10), nullptr, false);
+    if (tags.is_array()) {
+        for (const auto& tag : tags) {
+            if (tag.is_string()) {
+                info.tags.push_back(tag.get<std::string>());
+            }
+        }
     }
     
-    sqlite3_finalize(stmt);
-    return success;
+    return info;
 }
 
-std::vector<ContentItem> Database::search_content(const std::string& query, int limit) {
-    std::vector<ContentItem> results;
+std::vector<ContentItem> Database::list_content_after_id(int64_t after_id, int limit) {
+    MCP_SCOPED_LATENCY("mcp_db_query_duration_seconds");
+    auto conn = pool_->acquire_reader();
     
-    const std::string sql = R"(
-        SELECT c.* FROM content c
-        JOIN content_fts fts ON c.id = fts.rowid
-        WHERE content_fts MATCH ?
-        ORDER BY rank
-        LIMIT ?;
-    )";
+    std::vector<ContentItem> results;
     
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
+    const std::string sql = "SELECT * FROM content WHERE id > ? ORDER BY id LIMIT ?";
     
-    if (rc != SQLITE_OK) {
-        spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(db_));
+    auto stmt = conn.prepare(sql);
+    if (!stmt) {
+        spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
         return results;
     }
     
-    sqlite3_bind_text(stmt, 1, query.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_int(stmt, 2, limit);
+    sqlite3_bind_int64(stmt.get(), 1, after_id);
+    sqlite3_bind_int(stmt.get(), 2, limit);
     
-    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
-        results.push_back(row_to_content_item(stmt));
+    while (sqlite3_step(stmt.get()) == SQLITE_ROW) {
+        results.push_back(row_to_content_item(stmt.get()));
     }
     
-    sqlite3_finalize(stmt);
     return results;
 }
 
-std::vector<ContentItem> Database::get_content_by_tag(const std::string& tag, int limit) {
-    std::vector<ContentItem> results;
+std::vector<ContentSummary> Database::list_content_summaries(int64_t after_id, int limit) {
+    MCP_SCOPED_LATENCY("mcp_db_query_duration_seconds");
+    auto conn = pool_->acquire_reader();
     
-    const std::string sql = R"(
-        SELECT * FROM content 
-        WHERE tags LIKE ?
-        ORDER BY updated_at DESC
-        LIMIT ?;
-    )";
+    std::vector<ContentSummary> results;
     
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
+    const std::string sql = "SELECT id, title, updated_at FROM content WHERE id > ? ORDER BY id LIMIT ?";
     
-    if (rc != SQLITE_OK) {
-        spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(db_));
+    auto stmt = conn.prepare(sql);
+    if (!stmt) {
+        spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
         return results;
     }
     
-    std::string tag_pattern = "%" + tag + "%";
-    sqlite3_bind_text(stmt, 1, tag_pattern.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_int(stmt, 2, limit);
+    sqlite3_bind_int64(stmt.get(), 1, after_id);
+    sqlite3_bind_int(stmt.get(), 2, limit);
     
-    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
-        results.push_back(row_to_content_item(stmt));
+    while (sqlite3_step(stmt.get()) == SQLITE_ROW) {
+        ContentSummary summary;
+        summary.id = sqlite3_column_int64(stmt.get(), 0);
+        summary.title = column_text(stmt.get(), 1);
+        summary.updated_at = sqlite3_column_int64(stmt.get(), 2);
+        results.push_back(std::move(summary));
     }
     
-    sqlite3_finalize(stmt);
     return results;
 }
 
-std::vector<ContentItem> Database::get_recent_content(int limit) {
-    std::vector<ContentItem> results;
+int64_t Database::count_search_results(const std::string& query) {
+    MCP_SCOPED_LATENCY("mcp_db_query_duration_seconds");
+    // 规范化：去除首尾空白并合并连续空白。FTS5的AND/OR/NOT区分大小写，因此不转换大小写
+    std::string normalized;
+    {
+        std::istringstream iss(query);
+        std::string word;
+        while (iss >> word) {
+            if (!normalized.empty()) {
+                normalized += ' ';
+            }
+            normalized += word;
+        }
+    }
     
-    const std::string sql = R"(
-        SELECT * FROM content 
-        ORDER BY updated_at DESC
-        LIMIT ?;
-    )";
+    // 先读取代数再计数，计数期间发生的写入会使该条目在下次读取时失效
+    uint64_t generation = get_write_generation();
+    if (auto cached = search_count_cache_.get(normalized, generation)) {
+        return *cached;
+    }
     
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
+    auto conn = pool_->acquire_reader();
     
-    if (rc != SQLITE_OK) {
-        spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(db_));
-        return results;
+    const std::string sql = "SELECT COUNT(*) FROM content_fts WHERE content_fts MATCH ?";
+    
+    auto stmt = conn.prepare(sql);
+    if (!stmt) {
+        spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
+        return 0;
     }
     
-    sqlite3_bind_int(stmt, 1, limit);
+    sqlite3_bind_text(stmt.get(), 1, normalized.c_str(), -1, SQLITE_STATIC);
     
-    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
-        results.push_back(row_to_content_item(stmt));
+    if (sqlite3_step(stmt.get()) != SQLITE_ROW) {
+        // 查询语法错误等情况不缓存
+        spdlog::warn("Failed to count search results: {}", sqlite3_errmsg(conn.get()));
+        return 0;
     }
     
-    sqlite3_finalize(stmt);
-    return results;
+    int64_t count = sqlite3_column_int64(stmt.get(), 0);
+    search_count_cache_.put(normalized, generation, count);
+    return count;
 }
 
-std::vector<ContentItem> Database::list_all_content(int offset, int limit) {
-    std::vector<ContentItem> results;
+int64_t Database::count_content_by_tag(const std::string& tag) {
+    MCP_SCOPED_LATENCY("mcp_db_query_duration_seconds");
+    auto conn = pool_->acquire_reader();
     
-    const std::string sql = R"(
-        SELECT * FROM content 
-        ORDER BY updated_at DESC
-        LIMIT ? OFFSET ?;
-    )";
+    const std::string sql = "SELECT count FROM content_stats WHERE kind = 'tag' AND key = ?";
+    
+    auto stmt = conn.prepare(sql);
+    if (!stmt) {
+        spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
+        return 0;
+    }
     
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
+    sqlite3_bind_text(stmt.get(), 1, tag.c_str(), -1, SQLITE_STATIC);
     
-    if (rc != SQLITE_OK) {
-        spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(db_));
-        return results;
+    int64_t count = 0;
+    if (sqlite3_step(stmt.get()) == SQLITE_ROW) {
+        count = sqlite3_column_int64(stmt.get(), 0);
     }
     
-    sqlite3_bind_int(stmt, 1, limit);
-    sqlite3_bind_int(stmt, 2, offset);
+    return count;
+}
+
+ContentStats Database::get_content_stats() {
+    MCP_SCOPED_LATENCY("mcp_db_query_duration_seconds");
+    auto conn = pool_->acquire_reader();
+    
+    ContentStats stats;
+    
+    // 一次读取保证总数、类型和标签计数来自同一快照
+    const std::string sql = "SELECT kind, key, count, bytes FROM content_stats ORDER BY kind, key";
     
-    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
-        results.push_back(row_to_content_item(stmt));
+    auto stmt = conn.prepare(sql);
+    if (!stmt) {
+        spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
+        return stats;
     }
     
-    sqlite3_finalize(stmt);
-    return results;
+    while (sqlite3_step(stmt.get()) == SQLITE_ROW) {
+        const std::string kind = column_text(stmt.get(), 0);
+        int64_t count = sqlite3_column_int64(stmt.get(), 2);
+        if (kind == "total") {
+            stats.total_count = count;
+            stats.total_bytes = sqlite3_column_int64(stmt.get(), 3);
+        } else if (kind == "type") {
+            stats.type_counts.emplace_back(column_text(stmt.get(), 1), count);
+        } else if (kind == "tag") {
+            stats.tag_counts.emplace_back(column_text(stmt.get(), 1), count);
+        }
+    }
+    
+    return stats;
 }
 
 int64_t Database::get_content_count() {
-    const std::string sql = "SELECT COUNT(*) FROM content";
+    MCP_SCOPED_LATENCY("mcp_db_query_duration_seconds");
+    auto conn = pool_->acquire_reader();
     
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
+    const std::string sql = "SELECT count FROM content_stats WHERE kind = 'total' AND key = ''";
     
-    if (rc != SQLITE_OK) {
-        spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(db_));
+    auto stmt = conn.prepare(sql);
+    if (!stmt) {
+        spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
         return 0;
     }
     
     int64_t count = 0;
-    if (sqlite3_step(stmt) == SQLITE_ROW) {
-        count = sqlite3_column_int64(stmt, 0);
+    if (sqlite3_step(stmt.get()) == SQLITE_ROW) {
+        count = sqlite3_column_int64(stmt.get(), 0);
     }
     
-    sqlite3_finalize(stmt);
     return count;
 }
 
 std::vector<std::string> Database::get_all_tags() {
-    std::vector<std::string> tags;
+    MCP_SCOPED_LATENCY("mcp_db_query_duration_seconds");
+    auto conn = pool_->acquire_reader();
     
-    const std::string sql = "SELECT DISTINCT tags FROM content WHERE tags != ''";
+    std::vector<std::string> tags;
     
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
+    // 主键(kind, key)有序，每个标签只有一行
+    const std::string sql = "SELECT key FROM content_stats WHERE kind = 'tag' ORDER BY key";
     
-    if (rc != SQLITE_OK) {
-        spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(db_));
+    auto stmt = conn.prepare(sql);
+    if (!stmt) {
+        spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
         return tags;
     }
     
-    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
-        const char* tags_str = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
-        if (tags_str) {
-            // 简单的标签分割（假设用逗号分隔）
-            std::string tag_line(tags_str);
-            std::stringstream ss(tag_line);
-            std::string tag;
-            while (std::getline(ss, tag, ',')) {
-                // 去除前后空格
-                tag.erase(0, tag.find_first_not_of(" \t"));
-                tag.erase(tag.find_last_not_of(" \t") + 1);
-                if (!tag.empty()) {
-                    tags.push_back(tag);
-                }
-            }
-        }
+    while (sqlite3_step(stmt.get()) == SQLITE_ROW) {
+        tags.push_back(column_text(stmt.get(), 0));
     }
     
-    sqlite3_finalize(stmt);
+    return tags;
+}
+
+std::vector<std::pair<std::string, int64_t>> Database::get_tag_counts() {
+    MCP_SCOPED_LATENCY("mcp_db_query_duration_seconds");
+    auto conn = pool_->acquire_reader();
+    
+    std::vector<std::pair<std::string, int64_t>> counts;
     
-    // 去重
-    std::sort(tags.begin(), tags.end());
-    tags.erase(std::unique(tags.begin(), tags.end()), tags.end());
+    const std::string sql = "SELECT key, count FROM content_stats WHERE kind = 'tag' ORDER BY key";
     
-    return tags;
+    auto stmt = conn.prepare(sql);
+    if (!stmt) {
+        spdlog::error("Failed to prepare statement: {}", sqlite3_errmsg(conn.get()));
+        return counts;
+    }
+    
+    while (sqlite3_step(stmt.get()) == SQLITE_ROW) {
+        counts.emplace_back(column_text(stmt.get(), 0), sqlite3_column_int64(stmt.get(), 1));
+    }
+    
+    return counts;
+}
+
+nlohmann::json Database::get_database_statistics() const {
+    nlohmann::json stats;
+    stats["pool"] = pool_->get_statistics();
+    stats["statement_cache"] = pool_->get_statement_cache_statistics();
+    stats["search_count_cache"] = search_count_cache_.get_statistics();
+    stats["write_generation"] = get_write_generation();
+    return stats;
 }
 
 ContentItem Database::row_to_content_item(sqlite3_stmt* stmt) {
@@ -484,4 +2620,12 @@ ContentItem Database::row_to_content_item(sqlite3_stmt* stmt) {
     return item;
 }
 
+ContentItem Database::row_to_projected_item(sqlite3_stmt* stmt, uint32_t fields) {
+    ContentItem item = row_to_content_item(stmt);
+    if (fields & content_fields::kPreview) {
+        item.preview = column_text(stmt, 8);
+    }
+    return item;
+}
+
 } // namespace mcp
\ No newline at end of file
@@ -0,0 +1,287 @@
+#include "document_parser.hpp"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+namespace mcp {
+
+namespace {
+
+constexpr int kChunkMaxTokens = 384;
+constexpr int kReduceMaxTokens = 384;
+constexpr size_t kMaxTags = 10;
+
+// 提示词和输出预留的token数
+constexpr int kReservedTokens = 512 + 256;
+
+const char* const kReducePrompt =
+    "Combine the following section summaries of one document into a single concise summary "
+    "of at most 5 sentences. Reply with the summary text only.\n\n";
+
+std::string trim(const std::string& str) {
+    const auto start = str.find_first_not_of(" \t\r\n\"'");
+    if (start == std::string::npos) {
+        return "";
+    }
+    const auto end = str.find_last_not_of(" \t\r\n\"'");
+    return str.substr(start, end - start + 1);
+}
+
+std::string to_lower(std::string str) {
+    std::transform(str.begin(), str.end(), str.begin(), [](unsigned char c) { return std::tolower(c); });
+    return str;
+}
+
+std::string build_chunk_prompt(const std::string& chunk, size_t index, size_t total) {
+    std::ostringstream prompt;
+    prompt << "You are analyzing part " << index + 1 << " of " << total << " of a document. ";
+    prompt << "Return only a JSON object with the following fields: ";
+    prompt << "title (string, the document title if this part shows one, otherwise empty), ";
+    prompt << "summary (string, at most 3 sentences), ";
+    prompt << "content_type (string, one of: article, note, document, reference, tutorial, or other), ";
+    prompt << "tags (comma-separated string of up to 5 keywords).\n\n";
+    prompt << "Document part:\n\n" << chunk;
+    return prompt.str();
+}
+
+// 最多parallelism个线程并行执行fn(0..count-1)，当前线程也参与
+void parallel_for(size_t count, size_t parallelism, const std::function<void(size_t)>& fn) {
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t i; (i = next++) < count;) {
+            try {
+                fn(i);
+            } catch (const std::exception& e) {
+                spdlog::warn("Document chunk {} failed: {}", i, e.what());
+            }
+        }
+    };
+    
+    const size_t thread_count = std::min(std::max<size_t>(parallelism, 1), count);
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < thread_count; ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+} // namespace
+
+DocumentParser::DocumentParser(Generator generator, size_t chunk_size, size_t parallelism)
+    : generator_(std::move(generator)), chunk_size_(std::max<size_t>(chunk_size, 256)),
+      parallelism_(std::max<size_t>(parallelism, 1)) {}
+
+size_t DocumentParser::chunk_size_for_context(int context_tokens) {
+    // 按每token约3字节保守估算，中文等多字节文本也不会超出上下文
+    const int tokens = std::max(256, context_tokens - kReservedTokens);
+    return static_cast<size_t>(tokens) * 3;
+}
+
+std::vector<std::string> DocumentParser::split_chunks(const std::string& content, size_t chunk_size) {
+    std::vector<std::string> chunks;
+    const size_t n = content.size();
+    size_t pos = 0;
+    
+    while (pos < n) {
+        size_t cut = n;
+        if (n - pos > chunk_size) {
+            size_t end = pos + chunk_size;
+            // 退到UTF-8字符起始字节
+            while (end > pos && (static_cast<unsigned char>(content[end]) & 0xC0) == 0x80) {
+                --end;
+            }
+            
+            // 优先在后半段内的段落、行、空白处切分；分隔符必须完整落在[min_cut, end)内
+            const size_t min_cut = pos + chunk_size / 2;
+            auto boundary = [&](const char* separator, size_t length) -> size_t {
+                if (end < min_cut + length) {
+                    return std::string::npos;
+                }
+                const size_t found = content.rfind(separator, end - length, length);
+                return found != std::string::npos && found >= min_cut ? found + length : std::string::npos;
+            };
+            
+            cut = end;
+            size_t found = std::string::npos;
+            if ((found = boundary("\n\n", 2)) != std::string::npos ||
+                (found = boundary("\n", 1)) != std::string::npos ||
+                (found = boundary(" ", 1)) != std::string::npos) {
+                cut = found;
+            }
+            // 非法UTF-8或二进制内容可能一直退到pos，此时按字节硬切
+            if (cut <= pos) {
+                cut = pos + chunk_size;
+            }
+        }
+        
+        std::string chunk = content.substr(pos, cut - pos);
+        if (chunk.find_first_not_of(" \t\r\n") != std::string::npos) {
+            chunks.push_back(std::move(chunk));
+        }
+        pos = cut;
+    }
+    
+    return chunks;
+}
+
+std::optional<nlohmann::json> DocumentParser::extract_json(const std::string& text) {
+    // 模型可能在JSON前后附加说明文字
+    const size_t start = text.find('{');
+    const size_t end = text.rfind('}');
+    if (start == std::string::npos || end == std::string::npos || end <= start) {
+        return std::nullopt;
+    }
+    
+    auto json = nlohmann::json::parse(text.substr(start, end - start + 1), nullptr, false);
+    if (json.is_discarded() || !json.is_object()) {
+        return std::nullopt;
+    }
+    return json;
+}
+
+nlohmann::json DocumentParser::parse(const std::string& content, const nlohmann::json& fallback,
+                                     const Progress& progress) const {
+    const auto chunks = split_chunks(content, chunk_size_);
+    std::vector<std::optional<nlohmann::json>> partials(chunks.size());
+    // 进度回调在锁内递增并上报，多个工作线程上报的值不会倒退
+    std::mutex progress_mutex;
+    size_t done = 0;
+    
+    // map：各分块独立提取，并发数受LLM槽位限制
+    parallel_for(chunks.size(), parallelism_, [&](size_t i) {
+        auto text = generator_(build_chunk_prompt(chunks[i], i, chunks.size()), kChunkMaxTokens);
+        if (text) {
+            partials[i] = extract_json(*text);
+        }
+        if (progress) {
+            std::lock_guard<std::mutex> lock(progress_mutex);
+            progress(++done, chunks.size());
+        }
+    });
+    
+    return merge(partials, fallback);
+}
+
+nlohmann::json DocumentParser::merge(const std::vector<std::optional<nlohmann::json>>& partials,
+                                     const nlohmann::json& fallback) const {
+    nlohmann::json result = fallback;
+    result["chunks"] = partials.size();
+    
+    std::string title;
+    std::map<std::string, size_t> type_votes;
+    std::vector<std::pair<std::string, size_t>> tags; // 按首次出现顺序
+    std::unordered_map<std::string, size_t> tag_index;
+    std::vector<std::string> summaries;
+    size_t parsed = 0;
+    
+    for (const auto& partial : partials) {
+        if (!partial) {
+            continue;
+        }
+        parsed++;
+        const auto& part = *partial;
+        
+        // 标题通常出现在文档开头，取第一个非空的
+        if (title.empty() && part.contains("title") && part["title"].is_string()) {
+            title = trim(part["title"].get<std::string>());
+        }
+        if (part.contains("content_type") && part["content_type"].is_string()) {
+            const std::string type = to_lower(trim(part["content_type"].get<std::string>()));
+            if (!type.empty()) {
+                type_votes[type]++;
+            }
+        }
+        if (part.contains("summary") && part["summary"].is_string()) {
+            const std::string summary = trim(part["summary"].get<std::string>());
+            if (!summary.empty()) {
+                summaries.push_back(summary);
+            }
+        }
+        
+        std::vector<std::string> part_tags;
+        if (part.contains("tags") && part["tags"].is_string()) {
+            std::istringstream iss(part["tags"].get<std::string>());
+            std::string tag;
+            while (std::getline(iss, tag, ',')) {
+                part_tags.push_back(tag);
+            }
+        } else if (part.contains("tags") && part["tags"].is_array()) {
+            for (const auto& tag : part["tags"]) {
+                if (tag.is_string()) {
+                    part_tags.push_back(tag.get<std::string>());
+                }
+            }
+        }
+        for (const auto& raw : part_tags) {
+            const std::string tag = trim(raw);
+            if (tag.empty()) {
+                continue;
+            }
+            auto [it, inserted] = tag_index.emplace(to_lower(tag), tags.size());
+            if (inserted) {
+                tags.emplace_back(tag, 1);
+            } else {
+                tags[it->second].second++;
+            }
+        }
+    }
+    
+    result["parsed_chunks"] = parsed;
+    if (parsed == 0) {
+        return result;
+    }
+    
+    if (!title.empty()) {
+        result["title"] = title;
+    }
+    if (!type_votes.empty()) {
+        result["content_type"] = std::max_element(type_votes.begin(), type_votes.end(),
+            [](const auto& a, const auto& b) { return a.second < b.second; })->first;
+    }
+    
+    // 出现在更多分块中的标签优先，次数相同保持首次出现顺序
+    std::stable_sort(tags.begin(), tags.end(), [](const auto& a, const auto& b) { return a.second > b.second; });
+    if (!tags.empty()) {
+        std::string joined;
+        for (size_t i = 0; i < tags.size() && i < kMaxTags; ++i) {
+            joined += (i > 0 ? "," : "") + tags[i].first;
+        }
+        result["tags"] = joined;
+    }
+    
+    // reduce：分块摘要超过一个分块大小时逐层合并，最多三轮
+    for (int round = 0; round < 3 && summaries.size() > 1; ++round) {
+        std::string joined;
+        for (const auto& summary : summaries) {
+            joined += summary + "\n";
+        }
+        const auto groups = split_chunks(joined, chunk_size_);
+        std::vector<std::string> reduced(groups.size());
+        parallel_for(groups.size(), parallelism_, [&](size_t i) {
+            auto text = generator_(kReducePrompt + groups[i], kReduceMaxTokens);
+            reduced[i] = text && !trim(*text).empty() ? trim(*text) : trim(groups[i]);
+        });
+        summaries = std::move(reduced);
+    }
+    
+    if (!summaries.empty()) {
+        std::string summary;
+        for (const auto& part : summaries) {
+            summary += (summary.empty() ? "" : " ") + part;
+        }
+        result["summary"] = summary;
+    }
+    
+    return result;
+}
+
+} // namespace mcp
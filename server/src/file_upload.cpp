@@ -1,5 +1,7 @@
 #include "file_upload.hpp"
 #include "config.hpp"
+#include "sha256.hpp"
+#include "metrics.hpp"
 #include <fstream>
 #include <filesystem>
 #include <random>
@@ -7,38 +9,70 @@
 #include <iomanip>
 #include <sstream>
 #include <algorithm>
+#include <cctype>
+#include <cstring>
 #include <string>
+#include <mutex>
+#include <map>
 #include <spdlog/spdlog.h>
 
 namespace mcp {
 
-// FileInfo 实现
-nlohmann::json FileInfo::to_json() const {
-    nlohmann::json j;
-    j["id"] = id;
-    j["filename"] = filename;
-    j["original_name"] = original_name;
-    j["file_path"] = file_path;
-    j["mime_type"] = mime_type;
-    j["file_size"] = file_size;
-    j["upload_time"] = upload_time;
-    j["description"] = description;
-    j["tags"] = tags;
-    return j;
+namespace {
+
+// 逗号分隔的标签字符串转为列表
+std::vector<std::string> split_tags(const std::string& tags_str) {
+    std::vector<std::string> tags;
+    std::istringstream iss(tags_str);
+    std::string tag;
+    while (std::getline(iss, tag, ',')) {
+        tag.erase(0, tag.find_first_not_of(" \t"));
+        tag.erase(tag.find_last_not_of(" \t") + 1);
+        if (!tag.empty()) {
+            tags.push_back(tag);
+        }
+    }
+    return tags;
 }
 
-void FileInfo::from_json(const nlohmann::json& j) {
-    id = j.value("id", "");
-    filename = j.value("filename", "");
-    original_name = j.value("original_name", "");
-    file_path = j.value("file_path", "");
-    mime_type = j.value("mime_type", "");
-    file_size = j.value("file_size", 0);
-    upload_time = j.value("upload_time", "");
-    description = j.value("description", "");
-    tags = j.value("tags", std::vector<std::string>{});
+// 构造下载用的Content-Disposition：filename为去掉引号、反斜杠、控制字符并把非ASCII字符替换为_的回退名，
+// filename*按RFC 5987给出百分号编码的UTF-8原名
+std::string content_disposition(const std::string& original_name) {
+    static const char kHex[] = "0123456789ABCDEF";
+    std::string fallback;
+    std::string encoded;
+    for (unsigned char ch : original_name) {
+        if (ch < 0x20 || ch == 0x7F) {
+            continue; // CR/LF等控制字符直接丢弃，避免头部注入
+        }
+        if (ch >= 0x80) {
+            // 每个UTF-8字符在回退名中只占一个_
+            if ((ch & 0xC0) != 0x80) {
+                fallback += '_';
+            }
+        } else if (ch == '"' || ch == '\\') {
+            fallback += '_';
+        } else {
+            fallback += static_cast<char>(ch);
+        }
+        
+        if (std::isalnum(ch) || std::strchr("!#$&+-.^_`|~", ch) != nullptr) {
+            encoded += static_cast<char>(ch);
+        } else {
+            encoded += '%';
+            encoded += kHex[ch >> 4];
+            encoded += kHex[ch & 0x0F];
+        }
+    }
+    if (fallback.empty()) {
+        fallback = "download";
+        encoded = fallback;
+    }
+    return "attachment; filename=\"" + fallback + "\"; filename*=UTF-8''" + encoded;
 }
 
+} // namespace
+
 // UploadResult 实现
 nlohmann::json UploadResult::to_json() const {
     nlohmann::json j;
@@ -46,6 +80,7 @@ nlohmann::json UploadResult::to_json() const {
     j["message"] = message;
     if (success) {
         j["file_info"] = file_info.to_json();
+        j["deduplicated"] = deduplicated;
     }
     return j;
 }
@@ -54,61 +89,57 @@ nlohmann::json UploadResult::to_json() const {
 class FileUploadManager::Impl {
 public:
     std::string upload_path_;
-    std::string metadata_file_;
-    std::vector<FileInfo> files_;
+    std::shared_ptr<Database> db_;
+    std::mutex gen_mutex_;
+    // 串行化blob的查找/落盘/引用计数，避免并发上传与删除同一内容时互相覆盖
+    std::mutex blob_mutex_;
     std::random_device rd_;
     std::mt19937 gen_;
     
     Impl() : gen_(rd_()) {}
     
-    bool load_metadata() {
+    // 内容寻址存储路径：blobs/<哈希前两位>/<哈希>
+    std::string blob_path(const std::string& hash) const {
+        return upload_path_ + "/blobs/" + hash.substr(0, 2) + "/" + hash;
+    }
+    
+    // 旧版本把元数据保存在uploads/metadata.json，首次启动时导入数据库并改名保留
+    bool migrate_legacy_metadata() {
+        const std::string metadata_file = upload_path_ + "/metadata.json";
         try {
-            if (!std::filesystem::exists(metadata_file_)) {
-                return true; // 文件不存在是正常的
+            if (!std::filesystem::exists(metadata_file)) {
+                return true;
             }
             
-            std::ifstream file(metadata_file_);
+            std::ifstream file(metadata_file);
             if (!file.is_open()) {
-                spdlog::error("Failed to open metadata file: {}", metadata_file_);
+                spdlog::error("Failed to open metadata file: {}", metadata_file);
                 return false;
             }
             
             nlohmann::json j;
             file >> j;
+            file.close();
             
-            files_.clear();
-            for (const auto& item : j["files"]) {
+            std::vector<FileInfo> files;
+            for (const auto& item : j.value("files", nlohmann::json::array())) {
                 FileInfo info;
                 info.from_json(item);
-                files_.push_back(info);
-            }
-            
-            return true;
-        } catch (const std::exception& e) {
-            spdlog::error("Failed to load metadata: {}", e.what());
-            return false;
-        }
-    }
-    
-    bool save_metadata() {
-        try {
-            nlohmann::json j;
-            j["files"] = nlohmann::json::array();
-            
-            for (const auto& file : files_) {
-                j["files"].push_back(file.to_json());
+                if (!info.id.empty() && !db_->get_file(info.id)) {
+                    files.push_back(std::move(info));
+                }
             }
             
-            std::ofstream file(metadata_file_);
-            if (!file.is_open()) {
-                spdlog::error("Failed to open metadata file for writing: {}", metadata_file_);
+            if (!db_->insert_files(files)) {
+                spdlog::error("Failed to migrate file metadata into database");
                 return false;
             }
             
-            file << j.dump(4);
+            std::filesystem::rename(metadata_file, metadata_file + ".migrated");
+            spdlog::info("Migrated {} file records from {}", files.size(), metadata_file);
             return true;
         } catch (const std::exception& e) {
-            spdlog::error("Failed to save metadata: {}", e.what());
+            spdlog::error("Failed to migrate metadata: {}", e.what());
             return false;
         }
     }
@@ -119,17 +150,21 @@ FileUploadManager::FileUploadManager() : pimpl_(std::make_unique<Impl>()) {}
 
 FileUploadManager::~FileUploadManager() = default;
 
-bool FileUploadManager::initialize(const std::string& upload_path) {
+bool FileUploadManager::initialize(const std::string& upload_path, std::shared_ptr<Database> db) {
     pimpl_->upload_path_ = upload_path;
-    pimpl_->metadata_file_ = upload_path + "/metadata.json";
+    pimpl_->db_ = std::move(db);
+    
+    if (!pimpl_->db_) {
+        spdlog::error("File upload manager requires a database");
+        return false;
+    }
     
     // 创建上传目录
     if (!create_upload_directory(upload_path)) {
         return false;
     }
     
-    // 加载元数据
-    return pimpl_->load_metadata();
+    return pimpl_->migrate_legacy_metadata();
 }
 
 UploadResult FileUploadManager::handle_upload(const httplib::Request& req, const std::string& field_name) {
@@ -148,128 +183,311 @@ UploadResult FileUploadManager::handle_upload(const httplib::Request& req, const
             // 验证文件大小
             if (!is_valid_file_size(file_item.content.size())) {
                 result.message = "File size exceeds limit";
+                result.status = 413;
                 return result;
             }
             
-            // 生成文件信息
-            FileInfo file_info;
-            file_info.id = generate_file_id();
-            file_info.original_name = file_item.filename;
-            file_info.filename = sanitize_filename(file_item.filename);
-            file_info.mime_type = get_mime_type(file_item.filename);
-            file_info.file_size = file_item.content.size();
-            
-            // 生成时间戳
-            auto now = std::chrono::system_clock::now();
-            auto time_t = std::chrono::system_clock::to_time_t(now);
-            std::stringstream ss;
-            ss << std::put_time(std::gmtime(&time_t), "%Y-%m-%dT%H:%M:%SZ");
-            file_info.upload_time = ss.str();
-            
-            // 构建文件路径
-            std::string file_extension = get_file_extension(file_item.filename);
-            file_info.file_path = pimpl_->upload_path_ + "/" + file_info.id + file_extension;
-            
-            // 保存文件
-            std::ofstream outfile(file_info.file_path, std::ios::binary);
+            // 写入临时文件后统一走store_upload
+            std::string temp_path = pimpl_->upload_path_ + "/.upload-" + generate_file_id() + ".tmp";
+            std::ofstream outfile(temp_path, std::ios::binary);
             if (!outfile.is_open()) {
                 result.message = "Failed to save file";
+                result.status = 500;
                 return result;
             }
-            outfile.write(file_item.content.data(), file_item.content.size());
+            outfile.write(file_item.content.data(), static_cast<std::streamsize>(file_item.content.size()));
+            const bool written = static_cast<bool>(outfile);
             outfile.close();
-            
-            // 添加到文件列表
-            pimpl_->files_.push_back(file_info);
-            
-            // 保存元数据
-            if (!pimpl_->save_metadata()) {
-                result.message = "Failed to save metadata";
+            if (!written || !outfile) {
+                std::error_code ec;
+                std::filesystem::remove(temp_path, ec);
+                spdlog::error("Failed to write upload temp file: {}", temp_path);
+                result.message = "Failed to save file";
+                result.status = 500;
                 return result;
             }
             
-            result.success = true;
-            result.message = "File uploaded successfully";
-            result.file_info = file_info;
+            Sha256 hasher;
+            hasher.update(file_item.content.data(), file_item.content.size());
+            
+            std::string description = req.has_file("description") ? req.get_file_value("description").content
+                                                                   : req.get_param_value("description");
+            std::string tags = req.has_file("tags") ? req.get_file_value("tags").content : req.get_param_value("tags");
+            
+            return store_upload(temp_path, file_item.filename, file_item.content.size(), hasher.hex_digest(),
+                                description, split_tags(tags));
         } else {
             result.message = "No file provided";
         }
     } catch (const std::exception& e) {
         result.message = "Upload failed: " + std::string(e.what());
+        result.status = 500;
         spdlog::error("Upload error: {}", e.what());
     }
     
     return result;
 }
 
-std::vector<FileInfo> FileUploadManager::list_files(int page, int page_size) {
-    std::vector<FileInfo> result;
+UploadResult FileUploadManager::handle_upload_stream(const httplib::Request& req,
+                                                     const httplib::ContentReader& content_reader,
+                                                     const std::string& field_name) {
+    UploadResult result;
+    result.success = false;
     
-    int start = (page - 1) * page_size;
-    int end = std::min(start + page_size, static_cast<int>(pimpl_->files_.size()));
+    if (!req.is_multipart_form_data()) {
+        result.message = "Multipart form data required";
+        return result;
+    }
     
-    for (int i = start; i < end; ++i) {
-        result.push_back(pimpl_->files_[i]);
+    // 普通表单字段只保留很小的缓冲，避免被当作第二个上传通道
+    constexpr size_t kMaxFieldSize = 64 * 1024;
+    
+    struct StreamState {
+        std::string part_name;
+        bool in_file_part = false;
+        bool file_seen = false;
+        std::string original_name;
+        std::string temp_path;
+        std::ofstream out;
+        Sha256 hasher;
+        size_t file_size = 0;
+        std::map<std::string, std::string> fields;
+        std::string error;
+        int error_status = 400;
+    } state;
+    
+    auto fail = [&state](const std::string& message, int status) {
+        state.error = message;
+        state.error_status = status;
+        return false;
+    };
+    
+    try {
+        bool read_ok = content_reader(
+            [&](const httplib::MultipartFormData& part) {
+                state.in_file_part = false;
+                state.part_name = part.name;
+                if (state.out.is_open()) {
+                    state.out.close();
+                }
+                
+                if (part.name != field_name || part.filename.empty()) {
+                    return true;
+                }
+                if (state.file_seen) {
+                    return fail("Only one file per upload is supported", 400);
+                }
+                if (!is_allowed_file_type(part.filename)) {
+                    return fail("File type not allowed", 400);
+                }
+                
+                state.file_seen = true;
+                state.in_file_part = true;
+                state.original_name = part.filename;
+                state.temp_path = pimpl_->upload_path_ + "/.upload-" + generate_file_id() + ".tmp";
+                state.out.open(state.temp_path, std::ios::binary);
+                if (!state.out.is_open()) {
+                    return fail("Failed to save file", 500);
+                }
+                return true;
+            },
+            [&](const char* data, size_t length) {
+                if (!state.in_file_part) {
+                    auto& field = state.fields[state.part_name];
+                    if (field.size() + length > kMaxFieldSize) {
+                        return fail("Form field too large: " + state.part_name, 400);
+                    }
+                    field.append(data, length);
+                    return true;
+                }
+                
+                // 超过大小限制时立即中止，不再继续接收剩余数据
+                state.file_size += length;
+                if (!is_valid_file_size(state.file_size)) {
+                    return fail("File size exceeds limit", 413);
+                }
+                state.out.write(data, static_cast<std::streamsize>(length));
+                if (!state.out) {
+                    return fail("Failed to save file", 500);
+                }
+                state.hasher.update(data, length);
+                return true;
+            });
+        
+        if (state.out.is_open()) {
+            state.out.close();
+            // 缓冲区在close时才落盘，写满磁盘等错误可能到这里才出现
+            if (!state.out && state.error.empty()) {
+                state.error = "Failed to save file";
+                state.error_status = 500;
+            }
+        }
+        
+        if (!read_ok || !state.error.empty() || !state.file_seen) {
+            if (!state.temp_path.empty()) {
+                std::error_code ec;
+                std::filesystem::remove(state.temp_path, ec);
+            }
+            if (!state.error.empty()) {
+                result.message = state.error;
+                result.status = state.error_status;
+            } else if (!read_ok) {
+                result.message = "Upload interrupted";
+            } else {
+                result.message = "No file provided";
+            }
+            return result;
+        }
+        
+        auto field_or_param = [&](const std::string& name) {
+            auto it = state.fields.find(name);
+            return it != state.fields.end() ? it->second : req.get_param_value(name);
+        };
+        
+        return store_upload(state.temp_path, state.original_name, state.file_size, state.hasher.hex_digest(),
+                            field_or_param("description"), split_tags(field_or_param("tags")));
+        
+    } catch (const std::exception& e) {
+        if (!state.temp_path.empty()) {
+            std::error_code ec;
+            std::filesystem::remove(state.temp_path, ec);
+        }
+        result.message = "Upload failed: " + std::string(e.what());
+        result.status = 500;
+        spdlog::error("Upload error: {}", e.what());
     }
     
     return result;
 }
 
-FileInfo FileUploadManager::get_file_info(const std::string& file_id) {
-    auto it = std::find_if(pimpl_->files_.begin(), pimpl_->files_.end(),
-                          [&file_id](const FileInfo& info) {
-                              return info.id == file_id;
-                          });
+UploadResult FileUploadManager::store_upload(const std::string& temp_path, const std::string& original_name,
+                                             size_t file_size, const std::string& content_hash,
+                                             const std::string& description, const std::vector<std::string>& tags) {
+    UploadResult result;
+    result.success = false;
     
-    if (it != pimpl_->files_.end()) {
-        return *it;
+    // 生成文件信息
+    FileInfo file_info;
+    file_info.id = generate_file_id();
+    file_info.original_name = original_name;
+    file_info.filename = sanitize_filename(original_name);
+    file_info.mime_type = get_mime_type(original_name);
+    file_info.file_size = file_size;
+    file_info.description = description;
+    file_info.tags = tags;
+    file_info.content_hash = content_hash;
+    
+    // 生成时间戳
+    auto now = std::chrono::system_clock::now();
+    auto time_t = std::chrono::system_clock::to_time_t(now);
+    std::stringstream ss;
+    ss << std::put_time(std::gmtime(&time_t), "%Y-%m-%dT%H:%M:%SZ");
+    file_info.upload_time = ss.str();
+    
+    std::lock_guard<std::mutex> lock(pimpl_->blob_mutex_);
+    std::error_code ec;
+    
+    // 相同内容已存在时丢弃临时文件，新记录直接引用已有blob
+    bool created_blob = false;
+    auto existing = pimpl_->db_->find_blob(content_hash);
+    if (existing && std::filesystem::exists(*existing, ec)) {
+        std::filesystem::remove(temp_path, ec);
+        file_info.file_path = *existing;
+        result.deduplicated = true;
+    } else {
+        // 临时文件与blob位于同一文件系统，rename是原子的，读者不会看到写了一半的文件
+        file_info.file_path = pimpl_->blob_path(content_hash);
+        std::filesystem::create_directories(std::filesystem::path(file_info.file_path).parent_path(), ec);
+        if (!ec) {
+            std::filesystem::rename(temp_path, file_info.file_path, ec);
+        }
+        if (ec) {
+            spdlog::error("Failed to move upload into place: {}", ec.message());
+            std::filesystem::remove(temp_path, ec);
+            result.message = "Failed to save file";
+            result.status = 500;
+            return result;
+        }
+        created_blob = true;
+    }
+    
+    // 保存元数据并增加blob引用计数
+    if (!pimpl_->db_->insert_file(file_info)) {
+        if (created_blob) {
+            std::filesystem::remove(file_info.file_path, ec);
+        }
+        result.message = "Failed to save metadata";
+        result.status = 500;
+        return result;
+    }
+    
+    // 上传字节数按接收量统计，去重命中的上传同样计入
+    static auto& upload_bytes = Metrics::instance().counter("mcp_upload_bytes_total");
+    static auto& stored_uploads = Metrics::instance().counter("mcp_uploads_total", {{"result", "stored"}});
+    static auto& deduplicated_uploads = Metrics::instance().counter("mcp_uploads_total", {{"result", "deduplicated"}});
+    upload_bytes.add(file_size);
+    (result.deduplicated ? deduplicated_uploads : stored_uploads).add();
+    
+    result.success = true;
+    result.message = result.deduplicated ? "File already stored, reusing existing content"
+                                         : "File uploaded successfully";
+    result.file_info = file_info;
+    return result;
+}
+
+std::vector<FileInfo> FileUploadManager::list_files(int page, int page_size) {
+    if (page < 1) {
+        page = 1;
+    }
+    if (page_size < 1) {
+        return {};
+    }
+    return pimpl_->db_->list_files((page - 1) * page_size, page_size);
+}
+
+FileInfo FileUploadManager::get_file_info(const std::string& file_id) {
+    auto info = pimpl_->db_->get_file(file_id);
+    if (info) {
+        return *info;
     }
     
     return FileInfo{}; // 返回空的FileInfo
 }
 
 bool FileUploadManager::delete_file(const std::string& file_id) {
-    auto it = std::find_if(pimpl_->files_.begin(), pimpl_->files_.end(),
-                          [&file_id](const FileInfo& info) {
-                              return info.id == file_id;
-                          });
+    std::lock_guard<std::mutex> lock(pimpl_->blob_mutex_);
     
-    if (it != pimpl_->files_.end()) {
-        // 删除物理文件
-        try {
-            std::filesystem::remove(it->file_path);
-        } catch (const std::exception& e) {
-            spdlog::warn("Failed to delete physical file: {}", e.what());
+    // 先删除元数据，只有最后一个引用消失时才删除物理文件
+    std::string orphaned_path;
+    if (!pimpl_->db_->delete_file(file_id, &orphaned_path)) {
+        return false;
+    }
+    
+    if (!orphaned_path.empty()) {
+        std::error_code ec;
+        std::filesystem::remove(orphaned_path, ec);
+        if (ec) {
+            spdlog::warn("Failed to delete physical file: {}", ec.message());
         }
-        
-        // 从列表中移除
-        pimpl_->files_.erase(it);
-        
-        // 保存元数据
-        return pimpl_->save_metadata();
     }
     
-    return false;
+    return true;
 }
 
 bool FileUploadManager::update_file_info(const std::string& file_id, const nlohmann::json& update_data) {
-    auto it = std::find_if(pimpl_->files_.begin(), pimpl_->files_.end(),
-                          [&file_id](const FileInfo& info) {
-                              return info.id == file_id;
-                          });
-    
-    if (it != pimpl_->files_.end()) {
-        if (update_data.contains("description")) {
-            it->description = update_data["description"].get<std::string>();
-        }
-        if (update_data.contains("tags")) {
-            it->tags = update_data["tags"].get<std::vector<std::string>>();
-        }
-        
-        return pimpl_->save_metadata();
+    auto info = pimpl_->db_->get_file(file_id);
+    if (!info) {
+        return false;
     }
     
-    return false;
+    if (update_data.contains("description")) {
+        info->description = update_data["description"].get<std::string>();
+    }
+    if (update_data.contains("tags")) {
+        info->tags = update_data["tags"].get<std::vector<std::string>>();
+    }
+    
+    return pimpl_->db_->update_file(*info);
 }
 
 bool FileUploadManager::is_allowed_file_type(const std::string& filename) const {
@@ -303,92 +521,119 @@ std::string FileUploadManager::get_file_content(const std::string& file_id) {
     return content;
 }
 
-bool FileUploadManager::serve_file(const std::string& file_id, httplib::Response& res) {
+bool FileUploadManager::serve_file(const std::string& file_id, const httplib::Request& req, httplib::Response& res) {
     FileInfo info = get_file_info(file_id);
     if (info.id.empty()) {
         return false;
     }
     
-    std::ifstream file(info.file_path, std::ios::binary);
-    if (!file.is_open()) {
+    std::error_code ec;
+    const auto file_size = std::filesystem::file_size(info.file_path, ec);
+    if (ec) {
+        return false;
+    }
+    const auto mtime = std::filesystem::last_write_time(info.file_path, ec);
+    if (ec) {
         return false;
     }
     
-    std::string content((std::istreambuf_iterator<char>(file)),
-                       std::istreambuf_iterator<char>());
-    
-    res.set_content(content, info.mime_type);
-    res.set_header("Content-Disposition", "attachment; filename=\"" + info.original_name + "\"");
-    
-    return true;
-}
-
-std::vector<FileInfo> FileUploadManager::search_files(const std::string& query, const std::vector<std::string>& tags) {
-    std::vector<FileInfo> result;
-    
-    for (const auto& file : pimpl_->files_) {
-        bool matches = true;
-        
-        // 检查查询字符串
-        if (!query.empty()) {
-            std::string lower_query = query;
-            std::transform(lower_query.begin(), lower_query.end(), lower_query.begin(), ::tolower);
-            
-            std::string lower_filename = file.filename;
-            std::transform(lower_filename.begin(), lower_filename.end(), lower_filename.begin(), ::tolower);
-            
-            std::string lower_description = file.description;
-            std::transform(lower_description.begin(), lower_description.end(), lower_description.begin(), ::tolower);
-            
-            if (lower_filename.find(lower_query) == std::string::npos &&
-                lower_description.find(lower_query) == std::string::npos) {
-                matches = false;
+    // 优先使用内容哈希作为ETag；旧数据没有哈希时用大小加修改时间（文件内容不会原地修改）
+    std::stringstream etag_ss;
+    if (!info.content_hash.empty()) {
+        etag_ss << '"' << info.content_hash << '"';
+    } else {
+        etag_ss << '"' << std::hex << file_size << '-' << mtime.time_since_epoch().count() << '"';
+    }
+    const std::string etag = etag_ss.str();
+    
+    auto modified = std::chrono::system_clock::to_time_t(
+        std::chrono::time_point_cast<std::chrono::system_clock::duration>(std::chrono::file_clock::to_sys(mtime)));
+    std::stringstream date_ss;
+    date_ss << std::put_time(std::gmtime(&modified), "%a, %d %b %Y %H:%M:%S GMT");
+    
+    res.set_header("ETag", etag);
+    res.set_header("Last-Modified", date_ss.str());
+    res.set_header("Accept-Ranges", "bytes");
+    res.set_header("Cache-Control", "private, no-cache");
+    
+    // If-None-Match命中时直接返回304，不打开文件
+    const std::string if_none_match = req.get_header_value("If-None-Match");
+    if (!if_none_match.empty()) {
+        std::stringstream tags(if_none_match);
+        std::string tag;
+        while (std::getline(tags, tag, ',')) {
+            tag.erase(0, tag.find_first_not_of(" \t"));
+            tag.erase(tag.find_last_not_of(" \t") + 1);
+            if (tag.rfind("W/", 0) == 0) {
+                tag = tag.substr(2);
+            }
+            if (tag == "*" || tag == etag) {
+                res.status = 304;
+                return true;
             }
         }
-        
-        // 检查标签
-        if (matches && !tags.empty()) {
-            for (const auto& tag : tags) {
-                if (std::find(file.tags.begin(), file.tags.end(), tag) == file.tags.end()) {
-                    matches = false;
-                    break;
-                }
+    }
+    
+    // Range切片由httplib按content provider完成，这里只拒绝无法满足的范围
+    if (!req.ranges.empty()) {
+        bool satisfiable = false;
+        for (const auto& range : req.ranges) {
+            if (range.first >= 0 ? static_cast<uintmax_t>(range.first) < file_size
+                                 : (range.second > 0 && file_size > 0)) {
+                satisfiable = true;
+                break;
             }
         }
-        
-        if (matches) {
-            result.push_back(file);
+        if (!satisfiable) {
+            res.status = 416;
+            res.set_header("Content-Range", "bytes */" + std::to_string(file_size));
+            return true;
         }
     }
     
-    return result;
+    struct FileStream {
+        std::ifstream file;
+        std::vector<char> buffer;
+    };
+    auto stream = std::make_shared<FileStream>();
+    stream->file.open(info.file_path, std::ios::binary);
+    if (!stream->file.is_open()) {
+        return false;
+    }
+    stream->buffer.resize(64 * 1024);
+    
+    res.set_content_provider(
+        static_cast<size_t>(file_size), info.mime_type,
+        [stream](size_t offset, size_t length, httplib::DataSink& sink) {
+            // 每次回调只写一个缓冲块，单个请求的内存占用与文件大小无关
+            size_t to_read = std::min(length, stream->buffer.size());
+            stream->file.clear();
+            stream->file.seekg(static_cast<std::streamoff>(offset));
+            stream->file.read(stream->buffer.data(), static_cast<std::streamsize>(to_read));
+            auto got = stream->file.gcount();
+            if (got <= 0) {
+                return false;
+            }
+            return sink.write(stream->buffer.data(), static_cast<size_t>(got));
+        });
+    res.set_header("Content-Disposition", content_disposition(info.original_name));
+    
+    return true;
+}
+
+std::vector<FileInfo> FileUploadManager::search_files(const std::string& query, const std::vector<std::string>& tags) {
+    return pimpl_->db_->search_files(query, tags);
 }
 
 nlohmann::json FileUploadManager::get_upload_statistics() {
-    nlohmann::json stats;
-    
-    stats["total_files"] = pimpl_->files_.size();
-    
-    size_t total_size = 0;
-    std::map<std::string, int> type_counts;
-    
-    for (const auto& file : pimpl_->files_) {
-        total_size += file.file_size;
-        
-        std::string extension = get_file_extension(file.filename);
-        type_counts[extension]++;
-    }
-    
-    stats["total_size"] = total_size;
-    stats["file_types"] = type_counts;
-    
-    return stats;
+    return pimpl_->db_->get_file_statistics();
 }
 
 std::string FileUploadManager::generate_file_id() {
     std::uniform_int_distribution<> dis(0, 15);
     std::string id;
     
+    std::lock_guard<std::mutex> lock(pimpl_->gen_mutex_);
     for (int i = 0; i < 32; ++i) {
         int val = dis(pimpl_->gen_);
         if (val < 10) {
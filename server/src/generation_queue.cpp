@@ -0,0 +1,123 @@
+#include "generation_queue.hpp"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+
+namespace mcp {
+
+GenerationQueue::GenerationQueue(size_t slots, size_t capacity)
+    : slots_(slots > 0 ? slots : 1), capacity_(capacity > 0 ? capacity : 1) {
+    workers_.reserve(slots_);
+    for (size_t i = 0; i < slots_; ++i) {
+        workers_.emplace_back([this]() { worker_loop(); });
+    }
+}
+
+GenerationQueue::~GenerationQueue() {
+    shutdown();
+}
+
+bool GenerationQueue::submit(GenerationPriority priority, Job job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_ || pending_.size() >= capacity_) {
+            rejected_++;
+            return false;
+        }
+        
+        pending_.push(Entry{priority, next_sequence_++, std::chrono::steady_clock::now(), std::move(job)});
+        pending_by_priority_[static_cast<int>(priority)]++;
+        submitted_++;
+        max_queue_depth_ = std::max(max_queue_depth_, pending_.size());
+    }
+    cv_.notify_one();
+    return true;
+}
+
+void GenerationQueue::shutdown() {
+    std::vector<Entry> cancelled;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) {
+            return;
+        }
+        stopping_ = true;
+        while (!pending_.empty()) {
+            cancelled.push_back(std::move(const_cast<Entry&>(pending_.top())));
+            pending_.pop();
+        }
+        for (auto& count : pending_by_priority_) {
+            count = 0;
+        }
+    }
+    cv_.notify_all();
+    
+    for (auto& entry : cancelled) {
+        entry.job(false);
+    }
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+void GenerationQueue::worker_loop() {
+    while (true) {
+        Entry entry;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this]() { return stopping_ || !pending_.empty(); });
+            if (pending_.empty()) {
+                return;
+            }
+            
+            // top()返回const引用，出队前移走job
+            entry = std::move(const_cast<Entry&>(pending_.top()));
+            pending_.pop();
+            pending_by_priority_[static_cast<int>(entry.priority)]--;
+            active_++;
+            
+            const double wait_ms = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - entry.enqueued).count();
+            total_wait_ms_ += wait_ms;
+            max_wait_ms_ = std::max(max_wait_ms_, wait_ms);
+        }
+        
+        try {
+            entry.job(true);
+        } catch (const std::exception& e) {
+            spdlog::error("Generation job failed: {}", e.what());
+        }
+        
+        std::lock_guard<std::mutex> lock(mutex_);
+        active_--;
+        completed_++;
+    }
+}
+
+nlohmann::json GenerationQueue::get_statistics() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    nlohmann::json j;
+    j["slots"] = slots_;
+    j["capacity"] = capacity_;
+    j["active"] = active_;
+    j["queue_depth"] = pending_.size();
+    j["max_queue_depth"] = max_queue_depth_;
+    j["pending_by_priority"] = {
+        {"interactive", pending_by_priority_[0]},
+        {"normal", pending_by_priority_[1]},
+        {"bulk", pending_by_priority_[2]}
+    };
+    j["submitted"] = submitted_;
+    j["completed"] = completed_;
+    j["rejected"] = rejected_;
+    
+    // 只统计已出队的任务
+    const uint64_t started = completed_ + active_;
+    j["average_wait_ms"] = started > 0 ? total_wait_ms_ / started : 0.0;
+    j["max_wait_ms"] = max_wait_ms_;
+    return j;
+}
+
+} // namespace mcp
@@ -1,13 +1,25 @@
 #include "http_handler.hpp"
 #include "config.hpp"
+#include "compression.hpp"
+#include "document_parser.hpp"
+#include "metrics.hpp"
+#include "sha256.hpp"
 #include <spdlog/spdlog.h>
 #include <thread>
 #include <fstream>
 #include <filesystem>
 #include <string>
+#include <string_view>
 #include <algorithm>
+#include <array>
 #include <cctype>
 #include <ctime>
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <optional>
+#include <random>
+#include <stdexcept>
 
 namespace mcp {
 
@@ -50,10 +62,164 @@ std::string guess_mime(const std::string& format, const std::string& content_typ
     return "text/plain; charset=utf-8";
 }
 
+// 单条NDJSON记录上限：内容大小限制加上JSON转义和其他字段的余量
+size_t max_import_record_size() {
+    return static_cast<size_t>(Config::instance().get_max_content_size()) * 2 + 64 * 1024;
+}
+
+// 逐块接收NDJSON数据写入导入会话，只缓存未结束的最后一行
+class NdjsonImportReader {
+public:
+    NdjsonImportReader(ContentImportSession& session, size_t max_record_size)
+        : session_(session), max_record_size_(max_record_size) {}
+
+    // 返回false表示当前记录超过大小限制
+    bool feed(const char* data, size_t length) {
+        buffer_.append(data, length);
+        size_t start = 0;
+        for (size_t newline; (newline = buffer_.find('\n', start)) != std::string::npos; start = newline + 1) {
+            process_line(buffer_.data() + start, newline - start);
+        }
+        buffer_.erase(0, start);
+        return buffer_.size() <= max_record_size_;
+    }
+
+    void finish() {
+        if (!buffer_.empty()) {
+            process_line(buffer_.data(), buffer_.size());
+            buffer_.clear();
+        }
+        session_.flush();
+    }
+
+    size_t line_no() const { return line_no_; }
+
+private:
+    void process_line(const char* data, size_t length) {
+        ++line_no_;
+        if (length > 0 && data[length - 1] == '\r') {
+            --length;
+        }
+        std::string_view line(data, length);
+        if (line.find_first_not_of(" \t") == std::string_view::npos) {
+            return;
+        }
+
+        auto record = nlohmann::json::parse(line.begin(), line.end(), nullptr, false);
+        if (record.is_discarded() || !record.is_object()) {
+            session_.add_error(line_no_, "Invalid JSON object");
+        } else {
+            session_.add(line_no_, std::move(record));
+        }
+    }
+
+    ContentImportSession& session_;
+    size_t max_record_size_;
+    std::string buffer_;
+    size_t line_no_ = 0;
+};
+
+// 异步导入的请求体暂存在上传目录，文件名由服务端生成，任务参数只引用文件名
+constexpr std::string_view kImportSpoolPrefix = ".import-";
+constexpr std::string_view kImportSpoolSuffix = ".ndjson";
+
+std::string make_import_spool_name() {
+    static thread_local std::mt19937_64 gen{std::random_device{}()};
+    char id[17];
+    std::snprintf(id, sizeof(id), "%016llx", static_cast<unsigned long long>(gen()));
+    return std::string(kImportSpoolPrefix) + id + std::string(kImportSpoolSuffix);
+}
+
+bool is_import_spool_name(std::string_view name) {
+    if (name.size() != kImportSpoolPrefix.size() + 16 + kImportSpoolSuffix.size() ||
+        name.substr(0, kImportSpoolPrefix.size()) != kImportSpoolPrefix ||
+        name.substr(name.size() - kImportSpoolSuffix.size()) != kImportSpoolSuffix) {
+        return false;
+    }
+    auto id = name.substr(kImportSpoolPrefix.size(), 16);
+    return std::all_of(id.begin(), id.end(), [](unsigned char ch) { return std::isxdigit(ch) != 0; });
+}
+
+std::filesystem::path import_spool_path(std::string_view name) {
+    return std::filesystem::path(Config::instance().get_upload_path()) / std::string(name);
+}
+
+// 每条路由在注册时解析好的指标，请求路径上只做原子累加
+struct RouteMetrics {
+    LatencyHistogram* duration;
+    std::array<Counter*, 5> status_classes; // 1xx..5xx
+};
+
+std::shared_ptr<RouteMetrics> make_route_metrics(const std::string& method, const std::string& pattern) {
+    // 路径参数的正则替换为占位符，避免标签值里出现转义字符
+    std::string route = pattern;
+    for (const auto& [regex, placeholder] : {std::pair<std::string, std::string>{"(\\d+)", ":id"},
+                                             {"([^/]+)", ":id"}, {"(.*)", "*"}}) {
+        for (size_t pos = route.find(regex); pos != std::string::npos; pos = route.find(regex, pos)) {
+            route.replace(pos, regex.size(), placeholder);
+        }
+    }
+    route = method + " " + route;
+
+    auto& metrics = Metrics::instance();
+    auto route_metrics = std::make_shared<RouteMetrics>();
+    route_metrics->duration = &metrics.histogram("mcp_http_request_duration_seconds", {{"route", route}});
+    for (int i = 0; i < 5; ++i) {
+        route_metrics->status_classes[i] = &metrics.counter(
+            "mcp_http_requests_total", {{"route", route}, {"status", std::to_string(i + 1) + "xx"}});
+    }
+    return route_metrics;
+}
+
+// httplib在同一线程内依次调用pre-routing、路由处理函数和post-routing，用线程局部变量传递本次请求的状态
+thread_local std::chrono::steady_clock::time_point t_request_start;
+thread_local RouteMetrics* t_request_route = nullptr;
+
+void begin_request() {
+    t_request_start = std::chrono::steady_clock::now();
+    t_request_route = nullptr;
+}
+
+// 在响应头写出前调用；流式响应（SSE、导出、生成流）只统计到开始发送为止
+void finish_request(int status) {
+    if (t_request_start == std::chrono::steady_clock::time_point{}) {
+        return;
+    }
+    static const auto unmatched = make_route_metrics("ANY", "unmatched");
+    RouteMetrics* route = t_request_route ? t_request_route : unmatched.get();
+    route->duration->observe(std::chrono::steady_clock::now() - t_request_start);
+    if (status >= 100 && status < 600) {
+        route->status_classes[status / 100 - 1]->add();
+    }
+    t_request_start = {};
+    t_request_route = nullptr;
+}
+
+// httplib 0.14不向post-routing暴露匹配到的路由，因此在注册时包装处理函数记下路由
+httplib::Server::Handler timed_route(const std::string& method, const std::string& pattern,
+                                     httplib::Server::Handler handler) {
+    auto route = make_route_metrics(method, pattern);
+    return [route, handler = std::move(handler)](const httplib::Request& req, httplib::Response& res) {
+        t_request_route = route.get();
+        handler(req, res);
+    };
+}
+
+httplib::Server::HandlerWithContentReader timed_reader_route(const std::string& method, const std::string& pattern,
+                                                             httplib::Server::HandlerWithContentReader handler) {
+    auto route = make_route_metrics(method, pattern);
+    return [route, handler = std::move(handler)](const httplib::Request& req, httplib::Response& res,
+                                                 const httplib::ContentReader& content_reader) {
+        t_request_route = route.get();
+        handler(req, res, content_reader);
+    };
+}
+
 }
 
 HttpHandler::HttpHandler(std::shared_ptr<MCPServer> mcp_server)
-    : mcp_server_(mcp_server), server_(std::make_unique<httplib::Server>()), llama_service_(nullptr) {
+    : mcp_server_(mcp_server), server_(std::make_unique<httplib::Server>()), llama_service_(nullptr),
+      ollama_client_(std::make_unique<OllamaClient>()) {
     setup_routes();
 }
 
@@ -63,7 +229,8 @@ bool HttpHandler::initialize() {
     // 初始化文件上传管理器
     if (config.is_file_upload_enabled()) {
         file_upload_manager_ = std::make_unique<FileUploadManager>();
-        if (!file_upload_manager_->initialize(config.get_upload_path())) {
+        auto database = mcp_server_->get_content_manager()->get_database();
+        if (!file_upload_manager_->initialize(config.get_upload_path(), database)) {
             spdlog::error("Failed to initialize file upload manager");
             return false;
         }
@@ -80,12 +247,82 @@ bool HttpHandler::initialize() {
         spdlog::info("LLaMA service started");
     }
     
+    // 后台任务使用独立的工作线程，不占用HTTP线程池
+    job_manager_ = std::make_shared<JobManager>(mcp_server_->get_content_manager()->get_database(),
+                                                static_cast<size_t>(config.get_jobs_worker_threads()),
+                                                static_cast<size_t>(config.get_jobs_queue_capacity()));
+    register_job_handlers();
+    mcp_server_->set_job_manager(job_manager_);
+    
+    if (config.is_static_files_enabled()) {
+        static_assets_ = std::make_unique<StaticAssetCache>();
+        const size_t max_bytes = static_cast<size_t>(config.get_static_files_cache_mb()) * 1024 * 1024;
+        if (!static_assets_->load(config.get_static_files_path(), max_bytes)) {
+            spdlog::info("Static files directory {} not found, serving built-in index page",
+                         config.get_static_files_path());
+            static_assets_.reset();
+        }
+    }
+    
+    if (!config.get_embedding_provider().empty() && !initialize_semantic_index()) {
+        spdlog::error("Failed to initialize semantic index");
+        return false;
+    }
+    
+    return true;
+}
+
+bool HttpHandler::initialize_semantic_index() {
+    auto& config = Config::instance();
+    const std::string provider = config.get_embedding_provider();
+    
+    SemanticIndex::Embedder embedder;
+    SemanticIndexOptions options;
+    options.storage_format = config.get_embedding_format();
+    options.max_chars = static_cast<size_t>(config.get_embedding_max_chars());
+    
+    if (provider == "ollama") {
+        if (!config.is_ollama_enabled()) {
+            spdlog::error("Embedding provider 'ollama' requires Ollama to be enabled");
+            return false;
+        }
+        const std::string model = config.get_embedding_model();
+        options.model = "ollama:" + model;
+        embedder = [this, model](const std::string& text) -> std::optional<std::vector<float>> {
+            auto result = ollama_client_->embeddings({{"model", model}, {"prompt", text}});
+            if (!result.success || !result.body.contains("embedding") || !result.body["embedding"].is_array()) {
+                spdlog::warn("Ollama embedding request failed: {}", result.error);
+                return std::nullopt;
+            }
+            return result.body["embedding"].get<std::vector<float>>();
+        };
+    } else {
+        if (!llama_service_) {
+            spdlog::error("Embedding provider 'llama' requires LLaMA to be enabled");
+            return false;
+        }
+        // 向量与模型文件绑定，更换模型后旧向量会被重新计算
+        options.model = "llama:" + std::filesystem::path(config.get_llama_model_path()).filename().string();
+        embedder = [this](const std::string& text) {
+            return llama_service_->embed(text);
+        };
+    }
+    
+    semantic_index_ = std::make_shared<SemanticIndex>(
+        mcp_server_->get_content_manager()->get_database(), std::move(embedder), options);
+    semantic_index_->start();
+    mcp_server_->get_content_manager()->set_semantic_index(semantic_index_);
+    spdlog::info("Semantic search enabled with {}", options.model);
     return true;
 }
 
 bool HttpHandler::start(const std::string& host, int port) {
     spdlog::info("Starting HTTP server on {}:{}", host, port);
     
+    // 长连接复用：客户端可在同一连接上连续发送MCP请求
+    server_->set_keep_alive_max_count(1000);
+    server_->set_keep_alive_timeout(30);
+    
     // 在新线程中启动服务器
     std::thread server_thread([this, host, port]() {
         if (!server_->listen(host.c_str(), port)) {
@@ -106,189 +343,248 @@ void HttpHandler::stop() {
         server_->stop();
         spdlog::info("HTTP server stopped");
     }
+    if (job_manager_) {
+        job_manager_->shutdown();
+    }
+    if (semantic_index_) {
+        semantic_index_->stop();
+    }
 }
 
 void HttpHandler::setup_routes() {
     // 设置CORS中间件
-    server_->set_pre_routing_handler([this](const httplib::Request& req, httplib::Response& res) {
+    server_->set_pre_routing_handler([this](const httplib::Request& /*req*/, httplib::Response& res) {
+        begin_request();
         set_cors_headers(res);
         return httplib::Server::HandlerResponse::Unhandled;
     });
     
+    auto& metrics = Metrics::instance();
+    metrics.describe("mcp_http_request_duration_seconds", "HTTP request latency until response headers are sent");
+    metrics.describe("mcp_http_requests_total", "HTTP requests by route and status class");
+    metrics.describe("mcp_db_query_duration_seconds", "Database method latency");
+    metrics.describe("mcp_db_pool_wait_seconds", "Time spent waiting to check out a pooled SQLite connection");
+    metrics.describe("mcp_upload_bytes_total", "Bytes received by successful file uploads");
+    metrics.describe("mcp_uploads_total", "Successful file uploads");
+    metrics.describe("mcp_ollama_request_duration_seconds", "Ollama request latency by operation");
+    metrics.describe("mcp_ollama_failures_total", "Failed Ollama requests by operation");
+    
+    // 按路由统计请求数和耗时，由/metrics输出
+    server_->set_post_routing_handler([](const httplib::Request& /*req*/, httplib::Response& res) {
+        finish_request(res.status);
+    });
+    
     // 处理OPTIONS请求（CORS预检）
-    server_->Options(".*", [this](const httplib::Request& req, httplib::Response& res) {
+    server_->Options(".*", timed_route("OPTIONS", ".*", [this](const httplib::Request& req, httplib::Response& res) {
         set_cors_headers(res);
         res.status = 200;
-    });
+    }));
     
     // MCP协议端点
-    server_->Post("/mcp", [this](const httplib::Request& req, httplib::Response& res) {
+    server_->Post("/mcp", timed_route("POST", "/mcp", [this](const httplib::Request& req, httplib::Response& res) {
         handle_mcp_request(req, res);
-    });
+    }));
     
     // MCP API端点（为大语言模型提供）
-    server_->Post("/api/mcp", [this](const httplib::Request& req, httplib::Response& res) {
+    // 服务端推送通道：以SSE发送notifications/resources/list_changed
+    server_->Get("/mcp", timed_route("GET", "/mcp", [this](const httplib::Request& req, httplib::Response& res) {
+        handle_mcp_events(req, res);
+    }));
+    
+    server_->Post("/api/mcp", timed_route("POST", "/api/mcp", [this](const httplib::Request& req, httplib::Response& res) {
         handle_mcp_api(req, res);
-    });
+    }));
     
     // RESTful API端点
-    server_->Get("/api/content/(\\d+)", [this](const httplib::Request& req, httplib::Response& res) {
+    server_->Get("/api/content/(\\d+)", timed_route("GET", "/api/content/(\\d+)", [this](const httplib::Request& req, httplib::Response& res) {
         handle_get_content(req, res);
-    });
+    }));
 
-    server_->Get("/api/content/(\\d+)/export", [this](const httplib::Request& req, httplib::Response& res) {
+    server_->Get("/api/content/(\\d+)/export", timed_route("GET", "/api/content/(\\d+)/export", [this](const httplib::Request& req, httplib::Response& res) {
         handle_export_content(req, res);
-    });
+    }));
     
-    server_->Get("/api/content/export", [this](const httplib::Request& req, httplib::Response& res) {
+    server_->Get("/api/content/export", timed_route("GET", "/api/content/export", [this](const httplib::Request& req, httplib::Response& res) {
         handle_export_all_content(req, res);
-    });
+    }));
     
-    server_->Post("/api/content", [this](const httplib::Request& req, httplib::Response& res) {
+    server_->Post("/api/content/import", timed_reader_route("POST", "/api/content/import", [this](const httplib::Request& req, httplib::Response& res,
+                                                                                                  const httplib::ContentReader& content_reader) {
+        handle_import_content(req, res, content_reader);
+    }));
+    
+    server_->Post("/api/content", timed_route("POST", "/api/content", [this](const httplib::Request& req, httplib::Response& res) {
         handle_create_content(req, res);
-    });
+    }));
     
-    server_->Put("/api/content/(\\d+)", [this](const httplib::Request& req, httplib::Response& res) {
+    server_->Put("/api/content/(\\d+)", timed_route("PUT", "/api/content/(\\d+)", [this](const httplib::Request& req, httplib::Response& res) {
         handle_update_content(req, res);
-    });
+    }));
     
-    server_->Delete("/api/content/(\\d+)", [this](const httplib::Request& req, httplib::Response& res) {
+    server_->Delete("/api/content/(\\d+)", timed_route("DELETE", "/api/content/(\\d+)", [this](const httplib::Request& req, httplib::Response& res) {
         handle_delete_content(req, res);
-    });
+    }));
     
-    server_->Get("/api/content/search", [this](const httplib::Request& req, httplib::Response& res) {
+    server_->Get("/api/content/search", timed_route("GET", "/api/content/search", [this](const httplib::Request& req, httplib::Response& res) {
         handle_search_content(req, res);
-    });
+    }));
+    
+    server_->Get("/api/content/semantic", timed_route("GET", "/api/content/semantic", [this](const httplib::Request& req, httplib::Response& res) {
+        handle_semantic_search(req, res);
+    }));
     
-    server_->Get("/api/content", [this](const httplib::Request& req, httplib::Response& res) {
+    server_->Get("/api/content", timed_route("GET", "/api/content", [this](const httplib::Request& req, httplib::Response& res) {
         handle_list_content(req, res);
-    });
+    }));
     
-    server_->Get("/api/tags", [this](const httplib::Request& req, httplib::Response& res) {
+    server_->Get("/api/tags", timed_route("GET", "/api/tags", [this](const httplib::Request& req, httplib::Response& res) {
         handle_get_tags(req, res);
-    });
+    }));
     
-    server_->Get("/api/statistics", [this](const httplib::Request& req, httplib::Response& res) {
+    server_->Get("/api/statistics", timed_route("GET", "/api/statistics", [this](const httplib::Request& req, httplib::Response& res) {
         handle_get_statistics(req, res);
-    });
+    }));
     
     // 健康检查和信息端点
-    server_->Get("/health", [this](const httplib::Request& req, httplib::Response& res) {
+    server_->Get("/health", timed_route("GET", "/health", [this](const httplib::Request& req, httplib::Response& res) {
         handle_health_check(req, res);
-    });
+    }));
     
-    server_->Get("/info", [this](const httplib::Request& req, httplib::Response& res) {
+    server_->Get("/info", timed_route("GET", "/info", [this](const httplib::Request& req, httplib::Response& res) {
         handle_server_info(req, res);
-    });
+    }));
     
     // 配置管理端点
-    server_->Get("/api/config", [this](const httplib::Request& req, httplib::Response& res) {
+    server_->Get("/api/config", timed_route("GET", "/api/config", [this](const httplib::Request& req, httplib::Response& res) {
         handle_get_config(req, res);
-    });
+    }));
     
-    server_->Put("/api/config", [this](const httplib::Request& req, httplib::Response& res) {
+    server_->Put("/api/config", timed_route("PUT", "/api/config", [this](const httplib::Request& req, httplib::Response& res) {
         handle_update_config(req, res);
-    });
+    }));
     
-    server_->Post("/api/config/save", [this](const httplib::Request& req, httplib::Response& res) {
+    server_->Post("/api/config/save", timed_route("POST", "/api/config/save", [this](const httplib::Request& req, httplib::Response& res) {
         handle_save_config(req, res);
-    });
+    }));
     
     // 文件上传端点
-    server_->Post("/api/files/upload", [this](const httplib::Request& req, httplib::Response& res) {
-        handle_upload_file(req, res);
-    });
+    server_->Post("/api/files/upload", timed_reader_route("POST", "/api/files/upload", [this](const httplib::Request& req, httplib::Response& res,
+                                                                                              const httplib::ContentReader& content_reader) {
+        handle_upload_file(req, res, content_reader);
+    }));
     
-    server_->Get("/api/files", [this](const httplib::Request& req, httplib::Response& res) {
+    server_->Get("/api/files", timed_route("GET", "/api/files", [this](const httplib::Request& req, httplib::Response& res) {
         handle_list_files(req, res);
-    });
+    }));
     
-    server_->Get("/api/files/([^/]+)", [this](const httplib::Request& req, httplib::Response& res) {
+    server_->Get("/api/files/([^/]+)", timed_route("GET", "/api/files/([^/]+)", [this](const httplib::Request& req, httplib::Response& res) {
         handle_get_file(req, res);
-    });
+    }));
     
-    server_->Delete("/api/files/([^/]+)", [this](const httplib::Request& req, httplib::Response& res) {
+    server_->Delete("/api/files/([^/]+)", timed_route("DELETE", "/api/files/([^/]+)", [this](const httplib::Request& req, httplib::Response& res) {
         handle_delete_file(req, res);
-    });
+    }));
     
-    server_->Put("/api/files/([^/]+)", [this](const httplib::Request& req, httplib::Response& res) {
+    server_->Put("/api/files/([^/]+)", timed_route("PUT", "/api/files/([^/]+)", [this](const httplib::Request& req, httplib::Response& res) {
         handle_update_file_info(req, res);
-    });
+    }));
     
-    server_->Get("/api/files/search", [this](const httplib::Request& req, httplib::Response& res) {
+    server_->Get("/api/files/search", timed_route("GET", "/api/files/search", [this](const httplib::Request& req, httplib::Response& res) {
         handle_search_files(req, res);
-    });
+    }));
     
-    server_->Get("/api/files/([^/]+)/content", [this](const httplib::Request& req, httplib::Response& res) {
+    server_->Get("/api/files/([^/]+)/content", timed_route("GET", "/api/files/([^/]+)/content", [this](const httplib::Request& req, httplib::Response& res) {
         handle_get_file_content(req, res);
-    });
+    }));
     
-    server_->Get("/files/([^/]+)", [this](const httplib::Request& req, httplib::Response& res) {
+    server_->Get("/files/([^/]+)", timed_route("GET", "/files/([^/]+)", [this](const httplib::Request& req, httplib::Response& res) {
         handle_serve_file(req, res);
-    });
+    }));
     
-    server_->Get("/api/files/stats", [this](const httplib::Request& req, httplib::Response& res) {
+    server_->Get("/api/files/stats", timed_route("GET", "/api/files/stats", [this](const httplib::Request& req, httplib::Response& res) {
         handle_get_upload_stats(req, res);
-    });
+    }));
     
-    server_->Post("/api/files/parse", [this](const httplib::Request& req, httplib::Response& res) {
+    server_->Post("/api/files/parse", timed_route("POST", "/api/files/parse", [this](const httplib::Request& req, httplib::Response& res) {
         handle_parse_document(req, res);
-    });
+    }));
+    
+    // 后台任务API
+    server_->Post("/api/jobs", timed_route("POST", "/api/jobs", [this](const httplib::Request& req, httplib::Response& res) {
+        handle_submit_job(req, res);
+    }));
+    
+    server_->Get("/api/jobs", timed_route("GET", "/api/jobs", [this](const httplib::Request& req, httplib::Response& res) {
+        handle_list_jobs(req, res);
+    }));
+    
+    server_->Get("/api/jobs/([^/]+)", timed_route("GET", "/api/jobs/([^/]+)", [this](const httplib::Request& req, httplib::Response& res) {
+        handle_get_job(req, res);
+    }));
+    
+    server_->Get("/api/jobs/([^/]+)/events", timed_route("GET", "/api/jobs/([^/]+)/events", [this](const httplib::Request& req, httplib::Response& res) {
+        handle_job_events(req, res);
+    }));
     
     // LLaMA端点
-    server_->Post("/api/llama/generate", [this](const httplib::Request& req, httplib::Response& res) {
+    server_->Post("/api/llama/generate", timed_route("POST", "/api/llama/generate", [this](const httplib::Request& req, httplib::Response& res) {
         handle_llama_generate(req, res);
-    });
+    }));
     
-    server_->Post("/api/llama/generate/stream", [this](const httplib::Request& req, httplib::Response& res) {
+    server_->Post("/api/llama/generate/stream", timed_route("POST", "/api/llama/generate/stream", [this](const httplib::Request& req, httplib::Response& res) {
         handle_llama_generate_stream(req, res);
-    });
+    }));
     
-    server_->Post("/api/llama/model/load", [this](const httplib::Request& req, httplib::Response& res) {
+    server_->Post("/api/llama/model/load", timed_route("POST", "/api/llama/model/load", [this](const httplib::Request& req, httplib::Response& res) {
         handle_llama_load_model(req, res);
-    });
+    }));
     
-    server_->Post("/api/llama/model/unload", [this](const httplib::Request& req, httplib::Response& res) {
+    server_->Post("/api/llama/model/unload", timed_route("POST", "/api/llama/model/unload", [this](const httplib::Request& req, httplib::Response& res) {
         handle_llama_unload_model(req, res);
-    });
+    }));
     
-    server_->Get("/api/llama/model/info", [this](const httplib::Request& req, httplib::Response& res) {
+    server_->Get("/api/llama/model/info", timed_route("GET", "/api/llama/model/info", [this](const httplib::Request& req, httplib::Response& res) {
         handle_llama_model_info(req, res);
-    });
+    }));
     
-    server_->Get("/api/llama/status", [this](const httplib::Request& req, httplib::Response& res) {
+    server_->Get("/api/llama/status", timed_route("GET", "/api/llama/status", [this](const httplib::Request& req, httplib::Response& res) {
         handle_llama_status(req, res);
-    });
+    }));
     
-    server_->Get("/api/llama/config", [this](const httplib::Request& req, httplib::Response& res) {
+    server_->Get("/api/llama/config", timed_route("GET", "/api/llama/config", [this](const httplib::Request& req, httplib::Response& res) {
         handle_llama_config(req, res);
-    });
+    }));
     
-    server_->Get("/api/llama/stats", [this](const httplib::Request& req, httplib::Response& res) {
+    server_->Get("/api/llama/stats", timed_route("GET", "/api/llama/stats", [this](const httplib::Request& req, httplib::Response& res) {
         handle_llama_stats(req, res);
-    });
+    }));
     
     // Ollama端点
-    server_->Get("/api/ollama/models", [this](const httplib::Request& req, httplib::Response& res) {
+    server_->Get("/api/ollama/models", timed_route("GET", "/api/ollama/models", [this](const httplib::Request& req, httplib::Response& res) {
         handle_ollama_models(req, res);
-    });
+    }));
     
-    server_->Post("/api/ollama/generate", [this](const httplib::Request& req, httplib::Response& res) {
+    server_->Post("/api/ollama/generate", timed_route("POST", "/api/ollama/generate", [this](const httplib::Request& req, httplib::Response& res) {
         handle_ollama_generate(req, res);
-    });
+    }));
     
-    server_->Get("/api/ollama/status", [this](const httplib::Request& req, httplib::Response& res) {
+    server_->Get("/api/ollama/status", timed_route("GET", "/api/ollama/status", [this](const httplib::Request& req, httplib::Response& res) {
         handle_ollama_status(req, res);
-    });
+    }));
+    
+    // Prometheus指标
+    server_->Get("/metrics", timed_route("GET", "/metrics", [this](const httplib::Request& req, httplib::Response& res) {
+        handle_metrics(req, res);
+    }));
     
     // 静态文件服务
-    server_->Get("/", [this](const httplib::Request& req, httplib::Response& res) {
+    server_->Get("/", timed_route("GET", "/", [this](const httplib::Request& req, httplib::Response& res) {
         handle_static_files(req, res);
-    });
+    }));
     
-    server_->Get("/(.*)", [this](const httplib::Request& req, httplib::Response& res) {
+    server_->Get("/(.*)", timed_route("GET", "/(.*)", [this](const httplib::Request& req, httplib::Response& res) {
         handle_static_files(req, res);
-    });
+    }));
     
     // 错误处理
     server_->set_error_handler([](const httplib::Request& req, httplib::Response& res) {
@@ -313,8 +609,39 @@ void HttpHandler::handle_mcp_request(const httplib::Request& req, httplib::Respo
             return;
         }
         
+        // 可流式应答的客户端：每个调用完成后立即作为一个SSE事件写出
+        if (req.get_header_value("Accept").find("text/event-stream") != std::string::npos) {
+            res.set_header("Cache-Control", "no-cache");
+            auto mcp_server = mcp_server_;
+            res.set_chunked_content_provider(
+                "text/event-stream",
+                [mcp_server, request_json](size_t /*offset*/, httplib::DataSink& sink) {
+                    mcp_server->dispatch_message(request_json, [&sink](const nlohmann::json& response) {
+                        const std::string data = "event: message\ndata: " + response.dump() + "\n\n";
+                        if (sink.is_writable()) {
+                            sink.write(data.data(), data.size());
+                        }
+                    });
+                    sink.done();
+                    return true;
+                }
+            );
+            return;
+        }
+        
+        // 批量请求返回JSON-RPC应答数组；单个请求保持原有的应答格式
+        if (request_json.is_array()) {
+            auto response = mcp_server_->handle_message(request_json);
+            if (response.is_null()) {
+                res.status = 202;
+                return;
+            }
+            send_json_response(req, res, response);
+            return;
+        }
+        
         auto response = mcp_server_->handle_request(request_json);
-        send_json_response(res, response);
+        send_json_response(req, res, response);
         
     } catch (const std::exception& e) {
         spdlog::error("Error handling MCP request: {}", e.what());
@@ -326,8 +653,21 @@ void HttpHandler::handle_get_content(const httplib::Request& req, httplib::Respo
     try {
         int64_t id = std::stoll(req.matches[1]);
         
+        // 缓存中保存的就是序列化好的响应体，直接写出；指定字段投影时不走缓存
+        const std::string fields = get_param(req, "fields", "");
+        if (fields.empty()) {
+            auto cached = mcp_server_->get_content_manager()->get_cached_content(id);
+            if (cached) {
+                send_json_body(req, res, cached->response);
+                return;
+            }
+        }
+        
         nlohmann::json tool_args;
         tool_args["id"] = id;
+        if (!fields.empty()) {
+            tool_args["fields"] = fields;
+        }
         
         auto response = mcp_server_->handle_call_tool("get_content", tool_args);
         
@@ -335,9 +675,9 @@ void HttpHandler::handle_get_content(const httplib::Request& req, httplib::Respo
         if (response.contains("content") && response["content"].is_array() && !response["content"].empty()) {
             auto content_text = response["content"][0]["text"].get<std::string>();
             auto content_json = nlohmann::json::parse(content_text);
-            send_json_response(res, content_json);
+            send_json_response(req, res, content_json);
         } else {
-            send_json_response(res, response);
+            send_json_response(req, res, response);
         }
         
     } catch (const std::exception& e) {
@@ -369,7 +709,7 @@ void HttpHandler::handle_export_content(const httplib::Request& req, httplib::Re
             if (content_json.contains("error") && content_json["error"].is_object()) {
                 code = content_json["error"].value("code", 500);
             }
-            send_json_response(res, content_json, code);
+            send_json_response(req, res, content_json, code);
             return;
         }
         
@@ -417,50 +757,262 @@ void HttpHandler::handle_export_content(const httplib::Request& req, httplib::Re
 void HttpHandler::handle_export_all_content(const httplib::Request& req, httplib::Response& res) {
     try {
         std::string format = get_param(req, "format", "json");
-        if (format != "json") {
-            send_error_response(res, "Only JSON format is supported", 400);
+        if (format != "json" && format != "ndjson") {
+            send_error_response(res, "Only json and ndjson formats are supported", 400);
             return;
         }
         
-        nlohmann::json tool_args;
-        tool_args["format"] = format;
-        
-        auto response = mcp_server_->handle_call_tool("export_content", tool_args);
+        // 流式导出状态：按id分批读取，内存占用与数据量无关
+        struct ExportState {
+            std::shared_ptr<ContentManager> content_manager;
+            bool ndjson = false;
+            int64_t after_id = 0;
+            bool started = false;
+            bool first_item = true;
+            std::unique_ptr<GzipCompressor> gzip;
+        };
         
-        if (!(response.contains("content") && response["content"].is_array() && !response["content"].empty())) {
-            send_error_response(res, "Failed to export content", 500);
-            return;
+        auto state = std::make_shared<ExportState>();
+        state->content_manager = mcp_server_->get_content_manager();
+        state->ndjson = (format == "ndjson");
+        
+        // 两种导出类型都不在httplib的自动压缩列表中，按Accept-Encoding自行gzip
+        if (GzipCompressor::available()) {
+            const std::string compress = get_param(req, "compress", "");
+            const std::string accept_encoding = req.get_header_value("Accept-Encoding");
+            const bool negotiated = Config::instance().is_compression_enabled() &&
+                accept_encoding.find("gzip") != std::string::npos;
+            if (compress == "gzip" || (compress.empty() && negotiated)) {
+                state->gzip = std::make_unique<GzipCompressor>();
+                res.set_header("Content-Encoding", "gzip");
+            }
         }
         
-        auto content_text = response["content"][0]["text"].get<std::string>();
-        auto content_json = nlohmann::json::parse(content_text);
+        const auto now = std::time(nullptr);
+        const std::string filename = "content_export_" + std::to_string(now) + (state->ndjson ? ".ndjson" : ".json");
+        const std::string content_type = state->ndjson ? "application/x-ndjson" : "application/json; charset=utf-8";
         
-        if (!content_json.value("success", false)) {
-            int code = 500;
-            if (content_json.contains("error") && content_json["error"].is_object()) {
-                code = content_json["error"].value("code", 500);
+        res.set_header("Content-Disposition", "attachment; filename=\"" + filename + "\"");
+        res.set_chunked_content_provider(content_type, [state, now](size_t /* offset */, httplib::DataSink& sink) {
+            std::string chunk;
+            if (!state->started) {
+                state->started = true;
+                if (!state->ndjson) {
+                    chunk = "{\"version\":\"1.0\",\"exported_at\":" + std::to_string(now) + ",\"content\":[";
+                }
             }
-            send_json_response(res, content_json, code);
-            return;
+            
+            auto items = state->content_manager->export_content_chunk(state->after_id);
+            for (const auto& item : items) {
+                if (!state->ndjson && !state->first_item) {
+                    chunk += ',';
+                }
+                state->first_item = false;
+                chunk += item.to_json().dump();
+                if (state->ndjson) {
+                    chunk += '\n';
+                }
+            }
+            
+            const bool finished = items.empty();
+            if (!finished) {
+                state->after_id = items.back().id;
+            } else if (!state->ndjson) {
+                chunk += "]}";
+            }
+            
+            if (state->gzip) {
+                std::string compressed;
+                if (!state->gzip->compress(chunk.data(), chunk.size(), finished, compressed)) {
+                    spdlog::error("Failed to compress export stream");
+                    return false;
+                }
+                chunk.swap(compressed);
+            }
+            
+            if (!chunk.empty() && !sink.write(chunk.data(), chunk.size())) {
+                return false;
+            }
+            if (finished) {
+                sink.done();
+            }
+            return true;
+        });
+        
+    } catch (const std::exception& e) {
+        spdlog::error("Error exporting all content: {}", e.what());
+        send_error_response(res, "Failed to export content", 500);
+    }
+}
+
+void HttpHandler::handle_import_content(const httplib::Request& req, httplib::Response& res,
+                                        const httplib::ContentReader& content_reader) {
+    if (req.get_param_value("async") == "true") {
+        submit_import_job(req, res, content_reader);
+        return;
+    }
+    
+    try {
+        auto& config = Config::instance();
+        const size_t progress_interval = 10000;
+        
+        ContentImportSession session(*mcp_server_->get_content_manager(),
+                                     static_cast<size_t>(config.get_database_write_batch_size()));
+        NdjsonImportReader reader(session, max_import_record_size());
+        
+        // 同步导入的进度只写日志，需要查询进度时使用async=true
+        size_t next_progress = progress_interval;
+        bool record_too_large = false;
+        bool read_ok = content_reader([&](const char* data, size_t length) {
+            if (!reader.feed(data, length)) {
+                record_too_large = true;
+                return false;
+            }
+            if (session.processed() >= next_progress) {
+                spdlog::info("Import progress: {} records processed, {} created",
+                             session.processed(), session.created());
+                next_progress = session.processed() + progress_interval;
+            }
+            return true;
+        });
+        
+        if (read_ok) {
+            reader.finish();
+        } else {
+            session.flush();
         }
         
-        if (!content_json.contains("data")) {
-            send_error_response(res, "Invalid export data", 500);
+        spdlog::info("Import finished: {} records processed, {} created",
+                     session.processed(), session.created());
+        
+        if (record_too_large) {
+            nlohmann::json error;
+            error["success"] = false;
+            error["error"] = {
+                {"code", 413},
+                {"message", "Record at line " + std::to_string(reader.line_no() + 1) + " exceeds size limit"}
+            };
+            error["data"] = session.summary();
+            send_json_response(req, res, error, 413);
             return;
         }
         
-        const auto now = std::time(nullptr);
-        const std::string filename = "content_export_" + std::to_string(now) + ".json";
+        if (!read_ok) {
+            send_error_response(res, "Failed to read request body", 400);
+            return;
+        }
         
-        res.set_header("Content-Disposition", "attachment; filename=\"" + filename + "\"");
-        res.set_content(content_json["data"].dump(2), "application/json; charset=utf-8");
+        nlohmann::json response;
+        response["success"] = true;
+        response["data"] = session.summary();
+        send_json_response(req, res, response);
         
     } catch (const std::exception& e) {
-        spdlog::error("Error exporting all content: {}", e.what());
-        send_error_response(res, "Failed to export content", 500);
+        spdlog::error("Error importing content: {}", e.what());
+        send_error_response(res, "Failed to import content", 500);
     }
 }
 
+void HttpHandler::submit_import_job(const httplib::Request& req, httplib::Response& res,
+                                    const httplib::ContentReader& content_reader) {
+    if (!job_manager_) {
+        send_error_response(res, "Background jobs are not available", 503);
+        return;
+    }
+    
+    const std::string spool_name = make_import_spool_name();
+    const auto spool_path = import_spool_path(spool_name);
+    std::error_code ec;
+    
+    // 请求体原样写入暂存文件，由bulk_import任务逐行导入并通过/api/jobs汇报进度
+    std::ofstream spool(spool_path, std::ios::binary);
+    bool read_ok = spool && content_reader([&spool](const char* data, size_t length) {
+        spool.write(data, static_cast<std::streamsize>(length));
+        return static_cast<bool>(spool);
+    });
+    const bool written = spool.good();
+    spool.close();
+    
+    if (!read_ok || !written || spool.fail()) {
+        std::filesystem::remove(spool_path, ec);
+        if (written && !spool.fail()) {
+            send_error_response(res, "Failed to read request body", 400);
+        } else {
+            spdlog::error("Failed to write import spool file: {}", spool_path.string());
+            send_error_response(res, "Failed to store import data", 500);
+        }
+        return;
+    }
+    
+    std::string error;
+    auto job = job_manager_->submit("bulk_import", {{"spool", spool_name}}, error);
+    if (!job) {
+        std::filesystem::remove(spool_path, ec);
+        send_error_response(res, error, 503);
+        return;
+    }
+    
+    res.set_header("Location", "/api/jobs/" + job->id);
+    send_json_response(req, res, job->to_json(), 202);
+}
+
+nlohmann::json HttpHandler::import_spooled_content(const std::string& spool_name,
+                                                   const JobManager::ProgressCallback& progress) {
+    if (!is_import_spool_name(spool_name)) {
+        throw std::invalid_argument("Invalid import spool name");
+    }
+    
+    const auto spool_path = import_spool_path(spool_name);
+    // 无论成功与否都删除暂存文件
+    struct SpoolGuard {
+        std::filesystem::path path;
+        ~SpoolGuard() {
+            std::error_code ec;
+            std::filesystem::remove(path, ec);
+        }
+    } guard{spool_path};
+    
+    std::ifstream input(spool_path, std::ios::binary);
+    std::error_code ec;
+    const auto total_bytes = std::filesystem::file_size(spool_path, ec);
+    if (!input || ec) {
+        throw std::runtime_error("Import data is no longer available");
+    }
+    
+    ContentImportSession session(*mcp_server_->get_content_manager(),
+                                 static_cast<size_t>(Config::instance().get_database_write_batch_size()));
+    NdjsonImportReader reader(session, max_import_record_size());
+    
+    std::vector<char> block(256 * 1024);
+    uint64_t read_bytes = 0;
+    while (input) {
+        input.read(block.data(), static_cast<std::streamsize>(block.size()));
+        const auto count = static_cast<size_t>(input.gcount());
+        if (count == 0) {
+            break;
+        }
+        read_bytes += count;
+        if (!reader.feed(block.data(), count)) {
+            session.flush();
+            throw std::runtime_error("Record at line " + std::to_string(reader.line_no() + 1) +
+                                     " exceeds size limit (" + std::to_string(session.created()) +
+                                     " records created before it)");
+        }
+        progress(total_bytes > 0 ? static_cast<double>(read_bytes) / total_bytes : 1.0,
+                 "Processed " + std::to_string(session.processed()) + " records, " +
+                 std::to_string(session.created()) + " created");
+    }
+    if (input.bad()) {
+        session.flush();
+        throw std::runtime_error("Failed to read import data");
+    }
+    reader.finish();
+    
+    spdlog::info("Import job finished: {} records processed, {} created",
+                 session.processed(), session.created());
+    return session.summary();
+}
+
 void HttpHandler::handle_create_content(const httplib::Request& req, httplib::Response& res) {
     try {
         nlohmann::json request_json;
@@ -477,9 +1029,9 @@ void HttpHandler::handle_create_content(const httplib::Request& req, httplib::Re
         if (response.contains("content") && response["content"].is_array() && !response["content"].empty()) {
             auto content_text = response["content"][0]["text"].get<std::string>();
             auto content_json = nlohmann::json::parse(content_text);
-            send_json_response(res, content_json, 201);
+            send_json_response(req, res, content_json, 201);
         } else {
-            send_json_response(res, response, 201);
+            send_json_response(req, res, response, 201);
         }
         
     } catch (const std::exception& e) {
@@ -508,9 +1060,9 @@ void HttpHandler::handle_update_content(const httplib::Request& req, httplib::Re
         if (response.contains("content") && response["content"].is_array() && !response["content"].empty()) {
             auto content_text = response["content"][0]["text"].get<std::string>();
             auto content_json = nlohmann::json::parse(content_text);
-            send_json_response(res, content_json);
+            send_json_response(req, res, content_json);
         } else {
-            send_json_response(res, response);
+            send_json_response(req, res, response);
         }
         
     } catch (const std::exception& e) {
@@ -532,9 +1084,9 @@ void HttpHandler::handle_delete_content(const httplib::Request& req, httplib::Re
         if (response.contains("content") && response["content"].is_array() && !response["content"].empty()) {
             auto content_text = response["content"][0]["text"].get<std::string>();
             auto content_json = nlohmann::json::parse(content_text);
-            send_json_response(res, content_json);
+            send_json_response(req, res, content_json);
         } else {
-            send_json_response(res, response);
+            send_json_response(req, res, response);
         }
         
     } catch (const std::exception& e) {
@@ -554,21 +1106,11 @@ void HttpHandler::handle_search_content(const httplib::Request& req, httplib::Re
         int page = parse_int_param(req, "page", 1);
         int page_size = parse_int_param(req, "page_size", 20);
         
-        nlohmann::json tool_args;
-        tool_args["query"] = query;
-        tool_args["page"] = page;
-        tool_args["page_size"] = page_size;
-        
-        auto response = mcp_server_->handle_call_tool("search_content", tool_args);
-        
-        // 从MCP响应中提取实际数据
-        if (response.contains("content") && response["content"].is_array() && !response["content"].empty()) {
-            auto content_text = response["content"][0]["text"].get<std::string>();
-            auto content_json = nlohmann::json::parse(content_text);
-            send_json_response(res, content_json);
-        } else {
-            send_json_response(res, response);
-        }
+        // 结果直接序列化为响应体，不经过MCP工具结果的文本封装和重新解析
+        std::string body;
+        const int status = mcp_server_->get_content_manager()->search_content_serialized(
+            query, page, page_size, get_param(req, "cursor", ""), get_param(req, "fields", ""), body);
+        send_json_body(req, res, std::move(body), status);
         
     } catch (const std::exception& e) {
         spdlog::error("Error searching content: {}", e.what());
@@ -576,25 +1118,41 @@ void HttpHandler::handle_search_content(const httplib::Request& req, httplib::Re
     }
 }
 
+void HttpHandler::handle_semantic_search(const httplib::Request& req, httplib::Response& res) {
+    try {
+        std::string query = get_param(req, "q", "");
+        if (query.empty()) {
+            send_error_response(res, "Query parameter 'q' is required", 400);
+            return;
+        }
+        
+        auto response = mcp_server_->get_content_manager()->semantic_search(
+            query, parse_int_param(req, "limit", 10), get_param(req, "mode", "hybrid"));
+        
+        const int status = response.value("success", false)
+            ? 200 : response["error"].value("code", 500);
+        send_json_response(req, res, response, status);
+        
+    } catch (const std::exception& e) {
+        spdlog::error("Error in semantic search: {}", e.what());
+        send_error_response(res, "Semantic search failed", 500);
+    }
+}
+
 void HttpHandler::handle_list_content(const httplib::Request& req, httplib::Response& res) {
     try {
         int page = parse_int_param(req, "page", 1);
         int page_size = parse_int_param(req, "page_size", 20);
+        const std::string cursor = get_param(req, "cursor", "");
+        const std::string tag = get_param(req, "tag", "");
+        const std::string fields = get_param(req, "fields", "");
         
-        nlohmann::json tool_args;
-        tool_args["page"] = page;
-        tool_args["page_size"] = page_size;
-        
-        auto response = mcp_server_->handle_call_tool("list_content", tool_args);
-        
-        // 从MCP响应中提取实际数据
-        if (response.contains("content") && response["content"].is_array() && !response["content"].empty()) {
-            auto content_text = response["content"][0]["text"].get<std::string>();
-            auto content_json = nlohmann::json::parse(content_text);
-            send_json_response(res, content_json);
-        } else {
-            send_json_response(res, response);
-        }
+        auto content_manager = mcp_server_->get_content_manager();
+        std::string body;
+        const int status = tag.empty()
+            ? content_manager->list_content_serialized(page, page_size, cursor, fields, body)
+            : content_manager->get_content_by_tag_serialized(tag, page, page_size, cursor, fields, body);
+        send_json_body(req, res, std::move(body), status);
         
     } catch (const std::exception& e) {
         spdlog::error("Error listing content: {}", e.what());
@@ -612,9 +1170,9 @@ void HttpHandler::handle_get_tags(const httplib::Request& req, httplib::Response
         if (response.contains("content") && response["content"].is_array() && !response["content"].empty()) {
             auto content_text = response["content"][0]["text"].get<std::string>();
             auto content_json = nlohmann::json::parse(content_text);
-            send_json_response(res, content_json);
+            send_json_response(req, res, content_json);
         } else {
-            send_json_response(res, response);
+            send_json_response(req, res, response);
         }
         
     } catch (const std::exception& e) {
@@ -633,9 +1191,9 @@ void HttpHandler::handle_get_statistics(const httplib::Request& req, httplib::Re
         if (response.contains("content") && response["content"].is_array() && !response["content"].empty()) {
             auto content_text = response["content"][0]["text"].get<std::string>();
             auto content_json = nlohmann::json::parse(content_text);
-            send_json_response(res, content_json);
+            send_json_response(req, res, content_json);
         } else {
-            send_json_response(res, response);
+            send_json_response(req, res, response);
         }
         
     } catch (const std::exception& e) {
@@ -650,12 +1208,79 @@ void HttpHandler::handle_health_check(const httplib::Request& req, httplib::Resp
     health["timestamp"] = std::time(nullptr);
     health["server"] = "Local Content MCP Server";
     
-    send_json_response(res, health);
+    send_json_response(req, res, health);
 }
 
 void HttpHandler::handle_server_info(const httplib::Request& req, httplib::Response& res) {
     auto info = mcp_server_->get_server_info();
-    send_json_response(res, info);
+    send_json_response(req, res, info);
+}
+
+void HttpHandler::handle_metrics(const httplib::Request& /*req*/, httplib::Response& res) {
+    MetricsWriter writer;
+    Metrics::instance().render(writer);
+    
+    // 各模块已有的统计在抓取时转换为gauge/counter，不在请求路径上重复计数
+    auto emit = [&writer](const std::string& name, const char* type, const std::string& help,
+                          const nlohmann::json& stats, const char* key, double scale = 1.0) {
+        if (stats.is_object() && stats.contains(key) && stats[key].is_number()) {
+            writer.family(name, type, help);
+            writer.sample(name, stats[key].get<double>() * scale);
+        }
+    };
+    auto emit_cache = [&](const std::string& cache, const nlohmann::json& stats, const char* hits_key = "hits") {
+        emit("mcp_" + cache + "_hits_total", "counter", "Cache hits", stats, hits_key);
+        emit("mcp_" + cache + "_misses_total", "counter", "Cache misses", stats, "misses");
+        emit("mcp_" + cache + "_hit_ratio", "gauge", "Cache hit ratio since start", stats, "hit_rate");
+    };
+    
+    auto content_manager = mcp_server_->get_content_manager();
+    auto database = content_manager->get_database()->get_database_statistics();
+    const auto& pool = database["pool"];
+    emit("mcp_db_pool_reader_acquisitions_total", "counter", "Reader connection checkouts", pool, "reader_acquisitions");
+    emit("mcp_db_pool_writer_acquisitions_total", "counter", "Writer connection checkouts", pool, "writer_acquisitions");
+    emit("mcp_db_pool_reader_waits_total", "counter", "Reader checkouts that had to wait for an idle connection",
+         pool, "reader_waits");
+    emit("mcp_db_pool_wait_seconds_total", "counter", "Total time spent waiting for pooled connections",
+         pool, "total_wait_us", 1e-6);
+    emit_cache("db_statement_cache", database["statement_cache"]);
+    emit_cache("db_search_count_cache", database["search_count_cache"]);
+    emit_cache("content_cache", content_manager->get_cache_statistics());
+    
+    if (job_manager_) {
+        auto jobs = job_manager_->get_statistics();
+        emit("mcp_jobs_queue_depth", "gauge", "Background jobs waiting to run", jobs["queue"], "queue_depth");
+        emit("mcp_jobs_active", "gauge", "Background jobs running", jobs["queue"], "active");
+        emit("mcp_jobs_rejected_total", "counter", "Background jobs rejected because the queue was full", jobs, "rejected");
+    }
+    
+    if (llama_service_) {
+        auto llama = llama_service_->get_statistics();
+        emit("mcp_llama_queue_depth", "gauge", "Generation requests waiting for a slot", llama["queue"], "queue_depth");
+        emit("mcp_llama_active", "gauge", "Generation requests running", llama["queue"], "active");
+        emit("mcp_llama_rejected_total", "counter", "Generation requests rejected because the queue was full",
+             llama["queue"], "rejected");
+        emit("mcp_llama_queue_wait_seconds_max", "gauge", "Longest time a request waited for a slot",
+             llama["queue"], "max_wait_ms", 1e-3);
+        emit_cache("llama_response_cache", llama["cache"], "memory_hits");
+        emit("mcp_llama_response_cache_disk_hits_total", "counter", "Response cache hits served from disk",
+             llama["cache"], "disk_hits");
+    }
+    
+    if (semantic_index_) {
+        auto semantic = semantic_index_->get_statistics();
+        emit("mcp_semantic_index_vectors", "gauge", "Vectors held by the semantic index", semantic, "vectors");
+        emit("mcp_semantic_index_pending", "gauge", "Content items waiting to be embedded", semantic, "pending");
+        emit("mcp_semantic_index_queries_total", "counter", "Semantic search queries", semantic, "queries");
+    }
+    
+    if (static_assets_) {
+        emit("mcp_static_assets_bytes", "gauge", "Bytes of static files held in memory",
+             static_assets_->get_statistics(), "bytes");
+    }
+    
+    res.status = 200;
+    res.set_content(writer.text(), "text/plain; version=0.0.4; charset=utf-8");
 }
 
 void HttpHandler::handle_static_files(const httplib::Request& req, httplib::Response& res) {
@@ -665,8 +1290,21 @@ void HttpHandler::handle_static_files(const httplib::Request& req, httplib::Resp
         path = "/index.html";
     }
     
-    // 这里可以实现静态文件服务
-    // 目前返回一个简单的HTML页面
+    if (static_assets_) {
+        auto asset = static_assets_->find(path);
+        // 单页应用的前端路由：没有扩展名且不属于API的路径回退到index.html
+        if (!asset && path.rfind("/api/", 0) != 0 && std::filesystem::path(path).extension().empty()) {
+            asset = static_assets_->find("/index.html");
+        }
+        if (asset) {
+            send_static_asset(req, res, asset);
+        } else {
+            send_error_response(res, "File not found", 404);
+        }
+        return;
+    }
+    
+    // 未找到静态目录时返回一个简单的HTML说明页
     if (path == "/index.html") {
         std::string html = R"(
 <!DOCTYPE html>
@@ -696,6 +1334,9 @@ void HttpHandler::handle_static_files(const httplib::Request& req, httplib::Resp
         <div class="api-endpoint">
             <span class="method">POST</span> /mcp - MCP protocol endpoint
         </div>
+        <div class="api-endpoint">
+            <span class="method">GET</span> /mcp - MCP server notifications (SSE)
+        </div>
         <div class="api-endpoint">
             <span class="method">GET</span> /api/content - List content
         </div>
@@ -744,9 +1385,72 @@ void HttpHandler::set_cors_headers(httplib::Response& res) {
     res.set_header("Access-Control-Max-Age", "86400");
 }
 
-void HttpHandler::send_json_response(httplib::Response& res, const nlohmann::json& json, int status) {
+void HttpHandler::send_json_response(const httplib::Request& req, httplib::Response& res,
+                                     const nlohmann::json& json, int status) {
+    send_json_body(req, res, json.dump(), status);
+}
+
+void HttpHandler::send_json_body(const httplib::Request& req, httplib::Response& res, std::string body,
+                                 int status) {
     res.status = status;
-    res.set_content(json.dump(2), "application/json");
+    
+    // 带charset的类型不在httplib的自动压缩列表中，是否压缩完全由这里按阈值和Accept-Encoding决定
+    const char* content_type = "application/json; charset=utf-8";
+    auto& config = Config::instance();
+    if (!config.is_compression_enabled()) {
+        res.set_content(std::move(body), content_type);
+        return;
+    }
+    
+    res.set_header("Vary", "Accept-Encoding");
+    if (body.size() >= static_cast<size_t>(config.get_compression_min_bytes())) {
+        const ContentEncoding encoding = negotiate_encoding(req.get_header_value("Accept-Encoding"));
+        std::string compressed;
+        if (encoding != ContentEncoding::Identity && compress_body(encoding, body, compressed) &&
+            compressed.size() < body.size()) {
+            res.set_header("Content-Encoding", encoding_name(encoding));
+            res.set_content(std::move(compressed), content_type);
+            return;
+        }
+    }
+    res.set_content(std::move(body), content_type);
+}
+
+void HttpHandler::send_static_asset(const httplib::Request& req, httplib::Response& res,
+                                    std::shared_ptr<const StaticAsset> asset) {
+    ContentEncoding encoding = ContentEncoding::Identity;
+    if (Config::instance().is_compression_enabled()) {
+        encoding = negotiate_encoding(req.get_header_value("Accept-Encoding"));
+    }
+    const std::string* body = asset->variant(encoding);
+    if (!body) {
+        encoding = ContentEncoding::Identity;
+        body = &asset->identity;
+    }
+    
+    // 带哈希的文件内容不会变化；其余文件（如index.html）每次用ETag协商
+    res.set_header("ETag", asset->variant_etag(encoding));
+    res.set_header("Vary", "Accept-Encoding");
+    res.set_header("Cache-Control", asset->immutable ? "public, max-age=31536000, immutable" : "no-cache");
+    
+    if (asset->matches(req.get_header_value("If-None-Match"))) {
+        res.status = 304;
+        return;
+    }
+    
+    res.status = 200;
+    if (encoding != ContentEncoding::Identity) {
+        res.set_header("Content-Encoding", encoding_name(encoding));
+    }
+    if (body->empty()) {
+        res.set_content("", asset->mime_type);
+        return;
+    }
+    // 直接从缓存中的字符串写出，不复制到res.body；httplib也不会再对定长的provider压缩
+    res.set_content_provider(body->size(), asset->mime_type,
+                             [asset, body](size_t offset, size_t length, httplib::DataSink& sink) {
+                                 return sink.write(body->data() + offset, length);
+                             });
 }
 
 void HttpHandler::send_error_response(httplib::Response& res, const std::string& message, int status) {
@@ -796,7 +1500,7 @@ void HttpHandler::handle_get_config(const httplib::Request& req, httplib::Respon
     try {
         auto& config = Config::instance();
         nlohmann::json config_json = config.to_json();
-        send_json_response(res, config_json);
+        send_json_response(req, res, config_json);
     } catch (const std::exception& e) {
         spdlog::error("Error getting config: {}", e.what());
         send_error_response(res, "Failed to get configuration", 500);
@@ -824,7 +1528,7 @@ void HttpHandler::handle_update_config(const httplib::Request& req, httplib::Res
         response["message"] = "Configuration updated successfully";
         response["config"] = config.to_json();
         
-        send_json_response(res, response);
+        send_json_response(req, res, response);
         
         spdlog::info("Configuration updated");
     } catch (const std::exception& e) {
@@ -848,7 +1552,7 @@ void HttpHandler::handle_save_config(const httplib::Request& req, httplib::Respo
         response["message"] = "Configuration saved successfully";
         response["path"] = config_path.empty() ? "default" : config_path;
         
-        send_json_response(res, response);
+        send_json_response(req, res, response);
         
         spdlog::info("Configuration saved to file: {}", config_path.empty() ? "default" : config_path);
     } catch (const std::exception& e) {
@@ -858,37 +1562,26 @@ void HttpHandler::handle_save_config(const httplib::Request& req, httplib::Respo
 }
 
 // 文件上传端点实现
-void HttpHandler::handle_upload_file(const httplib::Request& req, httplib::Response& res) {
+void HttpHandler::handle_upload_file(const httplib::Request& req, httplib::Response& res,
+                                     const httplib::ContentReader& content_reader) {
     try {
         if (!file_upload_manager_) {
             send_error_response(res, "File upload is not enabled", 503);
             return;
         }
         
-        auto file = req.get_file_value("file");
-        if (file.filename.empty()) {
-            send_error_response(res, "No file provided", 400);
-            return;
-        }
-        
-        std::string description = get_param(req, "description", "");
-        std::vector<std::string> tags;
-        
-        // 解析标签
-        std::string tags_str = get_param(req, "tags", "");
-        if (!tags_str.empty()) {
-            std::istringstream iss(tags_str);
-            std::string tag;
-            while (std::getline(iss, tag, ',')) {
-                tag.erase(0, tag.find_first_not_of(" \t"));
-                tag.erase(tag.find_last_not_of(" \t") + 1);
-                if (!tag.empty()) {
-                    tags.push_back(tag);
-                }
+        // 声明的请求体明显超限时不读取直接拒绝（留出multipart边界和表单字段的余量）
+        auto& config = Config::instance();
+        const std::string content_length = req.get_header_value("Content-Length");
+        if (!content_length.empty()) {
+            const uint64_t limit = static_cast<uint64_t>(config.get_max_file_size()) + 256 * 1024;
+            if (std::strtoull(content_length.c_str(), nullptr, 10) > limit) {
+                send_error_response(res, "File size exceeds limit", 413);
+                return;
             }
         }
         
-        auto result = file_upload_manager_->handle_upload(req, "file");
+        auto result = file_upload_manager_->handle_upload_stream(req, content_reader, "file");
         
         if (result.success) {
             nlohmann::json response;
@@ -897,10 +1590,10 @@ void HttpHandler::handle_upload_file(const httplib::Request& req, httplib::Respo
             response["file_id"] = result.file_info.id;
             response["file_info"] = result.file_info.to_json();
             
-            send_json_response(res, response, 201);
-            spdlog::info("File uploaded successfully: {}", file.filename);
+            send_json_response(req, res, response, 201);
+            spdlog::info("File uploaded successfully: {}", result.file_info.original_name);
         } else {
-            send_error_response(res, result.message, 400);
+            send_error_response(res, result.message, result.status);
         }
     } catch (const std::exception& e) {
         spdlog::error("Error uploading file: {}", e.what());
@@ -933,7 +1626,7 @@ void HttpHandler::handle_list_files(const httplib::Request& req, httplib::Respon
         response["limit"] = limit;
         response["total"] = files.size();
         
-        send_json_response(res, response);
+        send_json_response(req, res, response);
     } catch (const std::exception& e) {
         spdlog::error("Error listing files: {}", e.what());
         send_error_response(res, "Failed to list files", 500);
@@ -955,7 +1648,7 @@ void HttpHandler::handle_get_file(const httplib::Request& req, httplib::Response
             return;
         }
         
-        send_json_response(res, file_info.to_json());
+        send_json_response(req, res, file_info.to_json());
     } catch (const std::exception& e) {
         spdlog::error("Error getting file info: {}", e.what());
         send_error_response(res, "Failed to get file information", 500);
@@ -976,7 +1669,7 @@ void HttpHandler::handle_delete_file(const httplib::Request& req, httplib::Respo
             response["success"] = true;
             response["message"] = "File deleted successfully";
             
-            send_json_response(res, response);
+            send_json_response(req, res, response);
             spdlog::info("File deleted: {}", file_id);
         } else {
             send_error_response(res, "File not found or failed to delete", 404);
@@ -1019,7 +1712,7 @@ void HttpHandler::handle_update_file_info(const httplib::Request& req, httplib::
             response["message"] = "File information updated successfully";
             response["file_info"] = updated_info.to_json();
             
-            send_json_response(res, response);
+            send_json_response(req, res, response);
             spdlog::info("File info updated: {}", file_id);
         } else {
             send_error_response(res, "File not found or failed to update", 404);
@@ -1060,7 +1753,7 @@ void HttpHandler::handle_search_files(const httplib::Request& req, httplib::Resp
         response["limit"] = limit;
         response["total"] = files.size();
         
-        send_json_response(res, response);
+        send_json_response(req, res, response);
     } catch (const std::exception& e) {
         spdlog::error("Error searching files: {}", e.what());
         send_error_response(res, "Failed to search files", 500);
@@ -1090,7 +1783,7 @@ void HttpHandler::handle_get_file_content(const httplib::Request& req, httplib::
         response["content"] = content;
         response["size"] = content.size();
         
-        send_json_response(res, response);
+        send_json_response(req, res, response);
     } catch (const std::exception& e) {
         spdlog::error("Error getting file content: {}", e.what());
         send_error_response(res, "Failed to get file content", 500);
@@ -1106,7 +1799,7 @@ void HttpHandler::handle_serve_file(const httplib::Request& req, httplib::Respon
         
         std::string file_id = req.matches[1];
         
-        if (file_upload_manager_->serve_file(file_id, res)) {
+        if (file_upload_manager_->serve_file(file_id, req, res)) {
             // 文件已经被serve_file方法处理
             return;
         } else {
@@ -1126,7 +1819,7 @@ void HttpHandler::handle_get_upload_stats(const httplib::Request& req, httplib::
         }
         
         auto stats = file_upload_manager_->get_upload_statistics();
-        send_json_response(res, stats);
+        send_json_response(req, res, stats);
     } catch (const std::exception& e) {
         spdlog::error("Error getting upload stats: {}", e.what());
         send_error_response(res, "Failed to get upload statistics", 500);
@@ -1153,7 +1846,7 @@ void HttpHandler::handle_llama_generate(const httplib::Request& req, httplib::Re
         llama_request.from_json(request_json);
         
         auto response_data = llama_service_->process_request(llama_request);
-        send_json_response(res, response_data.to_json());
+        send_json_response(req, res, response_data.to_json());
         
     } catch (const std::exception& e) {
         spdlog::error("Error in LLaMA generation: {}", e.what());
@@ -1186,18 +1879,32 @@ void HttpHandler::handle_llama_generate_stream(const httplib::Request& req, http
         res.set_header("Connection", "keep-alive");
         set_cors_headers(res);
         
-        // 流式响应处理
-        res.set_content_provider(
+        // 逐token转发为SSE事件；写入失败说明客户端已断开，回调返回false取消后端生成
+        res.set_chunked_content_provider(
             "text/event-stream",
             [this, llama_request](size_t offset, httplib::DataSink& sink) {
-                // 这里应该实现真正的流式生成
-                // 目前作为示例，我们发送一个完整的响应
-                auto response_data = llama_service_->process_request(llama_request);
+                auto response_data = llama_service_->process_stream_request(
+                    llama_request, [&sink](const std::string& token) {
+                        nlohmann::json event;
+                        event["token"] = token;
+                        event["done"] = false;
+                        const std::string data = "data: " + event.dump() + "\n\n";
+                        return sink.is_writable() && sink.write(data.data(), data.size());
+                    });
                 
-                std::string event_data = "data: " + response_data.to_json().dump() + "\n\n";
-                sink.write(event_data.c_str(), event_data.size());
+                if (response_data.success) {
+                    spdlog::debug("LLaMA stream finished: {} tokens, first token after {:.3f}s",
+                                  response_data.tokens_generated, response_data.time_to_first_token);
+                }
                 
-                return true; // 完成
+                auto final_event = response_data.to_json();
+                final_event["done"] = true;
+                const std::string data = "data: " + final_event.dump() + "\n\n";
+                if (!sink.is_writable() || !sink.write(data.data(), data.size())) {
+                    return false;
+                }
+                sink.done();
+                return true;
             }
         );
         
@@ -1228,14 +1935,19 @@ void HttpHandler::handle_llama_load_model(const httplib::Request& req, httplib::
             return;
         }
         
-        // 这里需要实现模型加载逻辑
-        // 目前作为占位符
+        // 启动llama-server并等待模型加载完成
+        if (!llama_service_->load_model(model_path)) {
+            send_error_response(res, "Failed to load model: " + model_path, 500);
+            return;
+        }
+        
         nlohmann::json response;
         response["success"] = true;
-        response["message"] = "Model loading initiated";
+        response["message"] = "Model loaded successfully";
         response["model_path"] = model_path;
+        response["model_info"] = llama_service_->get_status().value("model_info", nlohmann::json{});
         
-        send_json_response(res, response);
+        send_json_response(req, res, response);
         
     } catch (const std::exception& e) {
         spdlog::error("Error loading LLaMA model: {}", e.what());
@@ -1250,12 +1962,16 @@ void HttpHandler::handle_llama_unload_model(const httplib::Request& req, httplib
             return;
         }
         
-        // 这里需要实现模型卸载逻辑
+        if (!llama_service_->unload_model()) {
+            send_error_response(res, "Failed to unload model", 500);
+            return;
+        }
+        
         nlohmann::json response;
         response["success"] = true;
         response["message"] = "Model unloaded successfully";
         
-        send_json_response(res, response);
+        send_json_response(req, res, response);
         
     } catch (const std::exception& e) {
         spdlog::error("Error unloading LLaMA model: {}", e.what());
@@ -1273,7 +1989,7 @@ void HttpHandler::handle_llama_model_info(const httplib::Request& req, httplib::
         auto status = llama_service_->get_status();
         auto model_info = status.value("model_info", nlohmann::json{});
         
-        send_json_response(res, model_info);
+        send_json_response(req, res, model_info);
         
     } catch (const std::exception& e) {
         spdlog::error("Error getting LLaMA model info: {}", e.what());
@@ -1289,12 +2005,12 @@ void HttpHandler::handle_llama_status(const httplib::Request& req, httplib::Resp
             status["available"] = false;
             status["message"] = "LLaMA service is not initialized";
             
-            send_json_response(res, status);
+            send_json_response(req, res, status);
             return;
         }
         
         auto status = llama_service_->get_status();
-        send_json_response(res, status);
+        send_json_response(req, res, status);
         
     } catch (const std::exception& e) {
         spdlog::error("Error getting LLaMA status: {}", e.what());
@@ -1312,7 +2028,7 @@ void HttpHandler::handle_llama_config(const httplib::Request& req, httplib::Resp
         auto status = llama_service_->get_status();
         auto config = status.value("config", nlohmann::json{});
         
-        send_json_response(res, config);
+        send_json_response(req, res, config);
         
     } catch (const std::exception& e) {
         spdlog::error("Error getting LLaMA config: {}", e.what());
@@ -1330,7 +2046,7 @@ void HttpHandler::handle_llama_stats(const httplib::Request& req, httplib::Respo
         auto status = llama_service_->get_status();
         auto stats = status.value("statistics", nlohmann::json{});
         
-        send_json_response(res, stats);
+        send_json_response(req, res, stats);
         
     } catch (const std::exception& e) {
         spdlog::error("Error getting LLaMA stats: {}", e.what());
@@ -1348,50 +2064,27 @@ void HttpHandler::handle_ollama_models(const httplib::Request& req, httplib::Res
     }
     
     try {
-        // 构建Ollama API URL
-        std::string ollama_host = config.get_ollama_host();
-        int ollama_port = config.get_ollama_port();
-        std::string url = "http://" + ollama_host + ":" + std::to_string(ollama_port) + "/api/tags";
+        // 模型列表在缓存有效期内不访问Ollama，refresh参数强制刷新
+        auto result = ollama_client_->list_models(req.has_param("refresh"));
         
-        // 创建HTTP客户端
-        httplib::Client client(ollama_host, ollama_port);
-        client.set_connection_timeout(5, 0); // 5秒超时
-        client.set_read_timeout(10, 0); // 10秒读取超时
-        
-        // 发送请求
-        auto result = client.Get("/api/tags");
-        
-        if (result && result->status == 200) {
-            // 解析响应
-            nlohmann::json ollama_response;
-            try {
-                ollama_response = nlohmann::json::parse(result->body);
-                
-                // 提取模型列表
-                nlohmann::json models_list = nlohmann::json::array();
-                if (ollama_response.contains("models") && ollama_response["models"].is_array()) {
-                    for (const auto& model : ollama_response["models"]) {
-                        if (model.contains("name")) {
-                            models_list.push_back(model["name"]);
-                        }
+        if (result.success) {
+            // 提取模型列表
+            nlohmann::json models_list = nlohmann::json::array();
+            if (result.body.contains("models") && result.body["models"].is_array()) {
+                for (const auto& model : result.body["models"]) {
+                    if (model.contains("name")) {
+                        models_list.push_back(model["name"]);
                     }
                 }
-                
-                nlohmann::json response;
-                response["models"] = models_list;
-                response["status"] = "success";
-                send_json_response(res, response);
-            } catch (const std::exception& e) {
-                spdlog::error("Failed to parse Ollama response: {}", e.what());
-                send_error_response(res, "Failed to parse Ollama response", 500);
             }
+            
+            nlohmann::json response;
+            response["models"] = models_list;
+            response["status"] = "success";
+            send_json_response(req, res, response);
         } else {
-            std::string error_msg = "Failed to connect to Ollama service";
-            if (result) {
-                error_msg += " (HTTP " + std::to_string(result->status) + ")";
-            }
-            spdlog::error(error_msg);
-            send_error_response(res, error_msg, 503);
+            spdlog::error("Failed to get Ollama models: {}", result.error);
+            send_error_response(res, result.error, result.status == 0 ? 503 : 500);
         }
     } catch (const std::exception& e) {
         spdlog::error("Failed to get Ollama models: {}", e.what());
@@ -1415,15 +2108,6 @@ void HttpHandler::handle_ollama_generate(const httplib::Request& req, httplib::R
     }
     
     try {
-        // 构建Ollama API URL
-        std::string ollama_host = config.get_ollama_host();
-        int ollama_port = config.get_ollama_port();
-        
-        // 创建HTTP客户端
-        httplib::Client client(ollama_host, ollama_port);
-        client.set_connection_timeout(5, 0);
-        client.set_read_timeout(30, 0); // 生成可能需要更长时间
-        
         // 准备请求体
         nlohmann::json ollama_request;
         ollama_request["model"] = json_body.value("model", config.get_ollama_model());
@@ -1437,22 +2121,43 @@ void HttpHandler::handle_ollama_generate(const httplib::Request& req, httplib::R
             ollama_request["options"]["num_predict"] = json_body["max_tokens"];
         }
         
+        // stream=true时原样转发Ollama的NDJSON，每行一个增量响应
+        if (json_body.value("stream", false)) {
+            ollama_request["stream"] = true;
+            res.set_header("Cache-Control", "no-cache");
+            res.set_chunked_content_provider(
+                "application/x-ndjson",
+                [this, ollama_request](size_t /*offset*/, httplib::DataSink& sink) {
+                    // 客户端断开时写入失败，返回false中止请求，Ollama随之停止生成
+                    auto result = ollama_client_->generate_stream(
+                        ollama_request, [&sink](const char* data, size_t length) {
+                            return sink.is_writable() && sink.write(data, length);
+                        });
+                    
+                    if (!sink.is_writable()) {
+                        return false;
+                    }
+                    if (!result.success) {
+                        nlohmann::json error;
+                        error["error"] = "Failed to generate with Ollama: " + result.error;
+                        error["details"] = result.body;
+                        error["done"] = true;
+                        const std::string line = error.dump() + "\n";
+                        sink.write(line.data(), line.size());
+                    }
+                    sink.done();
+                    return true;
+                });
+            return;
+        }
+        
         // 发送请求
-        auto result = client.Post("/api/generate", ollama_request.dump(), "application/json");
-        
-        if (result && result->status == 200) {
-            try {
-                nlohmann::json ollama_response = nlohmann::json::parse(result->body);
-                send_json_response(res, ollama_response);
-            } catch (const std::exception& e) {
-                spdlog::error("Failed to parse Ollama generate response: {}", e.what());
-                send_error_response(res, "Failed to parse Ollama response", 500);
-            }
+        auto result = ollama_client_->generate(ollama_request);
+        
+        if (result.success) {
+            send_json_response(req, res, result.body);
         } else {
-            std::string error_msg = "Failed to generate with Ollama";
-            if (result) {
-                error_msg += " (HTTP " + std::to_string(result->status) + ")";
-            }
+            std::string error_msg = "Failed to generate with Ollama: " + result.error;
             spdlog::error(error_msg);
             send_error_response(res, error_msg, 503);
         }
@@ -1473,14 +2178,11 @@ void HttpHandler::handle_ollama_status(const httplib::Request& req, httplib::Res
     
     if (config.is_ollama_enabled()) {
         try {
-            // 尝试连接Ollama服务检查状态
-            httplib::Client client(config.get_ollama_host(), config.get_ollama_port());
-            client.set_connection_timeout(2, 0);
-            client.set_read_timeout(5, 0);
-            
-            auto result = client.Get("/api/tags");
-            response["connected"] = (result && result->status == 200);
-            response["status"] = response["connected"] ? "running" : "disconnected";
+            // 复用模型列表缓存，前端轮询状态时不必每次访问Ollama
+            auto result = ollama_client_->list_models();
+            response["connected"] = result.success;
+            response["status"] = result.success ? "running" : "disconnected";
+            response["statistics"] = ollama_client_->get_statistics();
         } catch (const std::exception& e) {
             response["connected"] = false;
             response["status"] = "error";
@@ -1491,7 +2193,7 @@ void HttpHandler::handle_ollama_status(const httplib::Request& req, httplib::Res
         response["status"] = "disabled";
     }
     
-    send_json_response(res, response);
+    send_json_response(req, res, response);
 }
 
 void HttpHandler::handle_parse_document(const httplib::Request& req, httplib::Response& res) {
@@ -1509,231 +2211,428 @@ void HttpHandler::handle_parse_document(const httplib::Request& req, httplib::Re
             return;
         }
         
-        if (!request_json.contains("file_path") || !request_json["file_path"].is_string()) {
-            send_error_response(res, "file_path parameter is required", 400);
+        // async=true时作为后台任务执行，立即返回任务信息
+        if (request_json.value("async", false)) {
+            request_json.erase("async");
+            submit_job(req, res, "parse_document", request_json);
             return;
         }
         
-        std::string file_path = request_json["file_path"];
-        std::string ai_service = request_json.value("ai_service", "llama");
+        nlohmann::json parse_result;
+        int status = 200;
+        if (!parse_document(request_json, parse_result, error_msg, status)) {
+            send_error_response(res, error_msg, status);
+            return;
+        }
+        send_json_response(req, res, parse_result);
         
-        // 验证AI服务选择
-        if (ai_service != "llama" && ai_service != "ollama") {
-            send_error_response(res, "Invalid ai_service. Must be 'llama' or 'ollama'", 400);
+    } catch (const std::exception& e) {
+        spdlog::error("Error parsing document: {}", e.what());
+        send_error_response(res, "Failed to parse document", 500);
+    }
+}
+
+bool HttpHandler::parse_document(const nlohmann::json& request_json, nlohmann::json& parse_result,
+                                 std::string& error_msg, int& status, const DocumentParser::Progress& progress) {
+    auto fail = [&error_msg, &status](const std::string& message, int code) {
+        error_msg = message;
+        status = code;
+        return false;
+    };
+    
+    if (!file_upload_manager_) {
+        return fail("File upload is not enabled", 503);
+    }
+    
+    auto database = mcp_server_->get_content_manager()->get_database();
+    
+    // file_id优先：从数据库取存储路径、原始文件名和内容哈希
+    std::optional<FileInfo> file_info;
+    std::string file_path;
+    if (request_json.contains("file_id") && request_json["file_id"].is_string()) {
+        file_info = database->get_file(request_json["file_id"].get<std::string>());
+        if (!file_info) {
+            return fail("File not found", 404);
+        }
+        file_path = file_info->file_path;
+    } else if (request_json.contains("file_path") && request_json["file_path"].is_string()) {
+        file_path = request_json["file_path"].get<std::string>();
+    } else {
+        return fail("file_path or file_id parameter is required", 400);
+    }
+    
+    std::string ai_service = request_json.value("ai_service", "llama");
+    
+    // 验证AI服务选择
+    if (ai_service != "llama" && ai_service != "ollama") {
+        return fail("Invalid ai_service. Must be 'llama' or 'ollama'", 400);
+    }
+    
+    auto& config = Config::instance();
+    if (ai_service == "ollama" && !config.is_ollama_enabled()) {
+        return fail("Ollama service is not enabled", 503);
+    }
+    
+    // 检查文件是否存在
+    if (!std::filesystem::exists(file_path)) {
+        return fail("File not found: " + file_path, 404);
+    }
+    
+    // 读取文件内容
+    std::ifstream file(file_path, std::ios::binary);
+    if (!file.is_open()) {
+        return fail("Failed to open file: " + file_path, 500);
+    }
+    
+    std::string content((std::istreambuf_iterator<char>(file)),
+                       std::istreambuf_iterator<char>());
+    file.close();
+    
+    if (content.empty()) {
+        return fail("File is empty or could not be read", 400);
+    }
+    
+    nlohmann::json fallback = create_default_parse_result(content, file_path, file_info);
+    
+    const size_t chunk_size = config.get_parse_chunk_size() > 0
+        ? static_cast<size_t>(config.get_parse_chunk_size())
+        : DocumentParser::chunk_size_for_context(config.get_llama_context_size());
+    
+    // 按内容哈希缓存，文件未变化时重复解析不再调用LLM
+    std::string content_hash = file_info ? file_info->content_hash : "";
+    if (content_hash.empty()) {
+        Sha256 hasher;
+        hasher.update(content.data(), content.size());
+        content_hash = hasher.hex_digest();
+    }
+    const std::string model = ai_service == "ollama" ? config.get_ollama_model() : config.get_llama_model_path();
+    const std::string cache_key = content_hash + ":" + ai_service + ":" + model + ":" + std::to_string(chunk_size);
+    
+    if (auto cached = database->get_parse_result(cache_key)) {
+        parse_result = std::move(*cached);
+        parse_result["content"] = content;
+        parse_result["cached"] = true;
+        return true;
+    }
+    
+    // 每个分块调用一次LLM；文档解析是批量任务，排在交互式生成请求之后
+    DocumentParser::Generator generator;
+    if (ai_service == "llama" && llama_service_) {
+        generator = [this](const std::string& prompt, int max_tokens) -> std::optional<std::string> {
+            LlamaRequest llama_request;
+            llama_request.prompt = prompt;
+            llama_request.max_tokens = max_tokens;
+            llama_request.temperature = 0.3f;
+            llama_request.priority = GenerationPriority::Bulk;
+            // 重复解析同一文档时各分块可以直接复用之前的生成结果
+            llama_request.cache = true;
+            
+            auto llama_response = llama_service_->process_request(llama_request);
+            if (!llama_response.success || llama_response.text.empty()) {
+                spdlog::warn("LLaMA parsing request failed: {}", llama_response.error_message);
+                return std::nullopt;
+            }
+            return llama_response.text;
+        };
+    } else if (ai_service == "ollama") {
+        generator = [this, model](const std::string& prompt, int max_tokens) -> std::optional<std::string> {
+            nlohmann::json ollama_request;
+            ollama_request["model"] = model;
+            ollama_request["prompt"] = prompt;
+            ollama_request["stream"] = false;
+            ollama_request["options"] = {
+                {"temperature", Config::instance().get_ollama_temperature()},
+                {"num_predict", max_tokens}
+            };
+            
+            auto result = ollama_client_->generate(ollama_request);
+            if (!result.success || !result.body.contains("response") || !result.body["response"].is_string()) {
+                spdlog::warn("Ollama parsing request failed: {}", result.error);
+                return std::nullopt;
+            }
+            return result.body["response"].get<std::string>();
+        };
+    }
+    
+    if (generator) {
+        DocumentParser parser(generator, chunk_size, static_cast<size_t>(config.get_llama_parallel_slots()));
+        parse_result = parser.parse(content, fallback, progress);
+        
+        // 只缓存至少有一个分块解析成功的结果；content可以从文件重新读取，不入库
+        if (parse_result.value("parsed_chunks", 0) > 0) {
+            auto stored = parse_result;
+            stored.erase("content");
+            database->put_parse_result(cache_key, stored);
+        }
+    } else {
+        // 默认解析（不使用AI）
+        parse_result = fallback;
+    }
+    parse_result["cached"] = false;
+    return true;
+}
+
+void HttpHandler::register_job_handlers() {
+    job_manager_->register_handler("parse_document",
+        [this](const nlohmann::json& params, const JobManager::ProgressCallback& progress) {
+            nlohmann::json parse_result;
+            std::string error_msg;
+            int status = 200;
+            auto on_chunk = [&progress](size_t done, size_t total) {
+                progress(static_cast<double>(done) / total,
+                         "Parsed " + std::to_string(done) + "/" + std::to_string(total) + " chunks");
+            };
+            if (!parse_document(params, parse_result, error_msg, status, on_chunk)) {
+                throw std::runtime_error(error_msg);
+            }
+            return parse_result;
+        });
+    
+    // 上次退出时未完成的异步导入已被标记为失败，清理遗留的暂存文件
+    std::error_code ec;
+    for (std::filesystem::directory_iterator it(Config::instance().get_upload_path(), ec), end;
+         !ec && it != end; it.increment(ec)) {
+        if (is_import_spool_name(it->path().filename().string())) {
+            std::error_code remove_ec;
+            std::filesystem::remove(it->path(), remove_ec);
+        }
+    }
+    
+    // 与/api/content/import相同的格式，分批写入以便汇报进度；
+    // spool参数引用/api/content/import?async=true暂存的NDJSON请求体
+    job_manager_->register_handler("bulk_import",
+        [this](const nlohmann::json& params, const JobManager::ProgressCallback& progress) {
+            if (params.contains("spool") && params["spool"].is_string()) {
+                return import_spooled_content(params["spool"].get<std::string>(), progress);
+            }
+            if (!params.contains("content") || !params["content"].is_array()) {
+                throw std::invalid_argument("Invalid import data format");
+            }
+            
+            const auto& items = params["content"];
+            const size_t batch_size = 500;
+            auto content_manager = mcp_server_->get_content_manager();
+            
+            nlohmann::json created_ids = nlohmann::json::array();
+            nlohmann::json errors = nlohmann::json::array();
+            for (size_t offset = 0; offset < items.size(); offset += batch_size) {
+                const size_t end = std::min(items.size(), offset + batch_size);
+                nlohmann::json batch(items.begin() + offset, items.begin() + end);
+                
+                auto response = content_manager->bulk_create(batch, offset);
+                if (!response.value("success", false)) {
+                    throw std::runtime_error(response["error"].value("message", "Import failed"));
+                }
+                for (const auto& id : response["data"]["created_ids"]) {
+                    created_ids.push_back(id);
+                }
+                if (response["data"].contains("errors")) {
+                    for (const auto& error : response["data"]["errors"]) {
+                        errors.push_back(error);
+                    }
+                }
+                progress(static_cast<double>(end) / items.size(),
+                         "Imported " + std::to_string(end) + "/" + std::to_string(items.size()) + " items");
+            }
+            
+            nlohmann::json result;
+            result["created_ids"] = created_ids;
+            result["created_count"] = created_ids.size();
+            result["total_count"] = items.size();
+            if (!errors.empty()) {
+                result["errors"] = errors;
+            }
+            return result;
+        }, GenerationPriority::Bulk);
+}
+
+void HttpHandler::submit_job(const httplib::Request& req, httplib::Response& res, const std::string& type,
+                             const nlohmann::json& params) {
+    if (!job_manager_) {
+        send_error_response(res, "Background jobs are not available", 503);
+        return;
+    }
+    
+    std::string error;
+    auto job = job_manager_->submit(type, params, error);
+    if (!job) {
+        send_error_response(res, error, job_manager_->has_handler(type) ? 503 : 400);
+        return;
+    }
+    
+    res.set_header("Location", "/api/jobs/" + job->id);
+    send_json_response(req, res, job->to_json(), 202);
+}
+
+void HttpHandler::handle_submit_job(const httplib::Request& req, httplib::Response& res) {
+    try {
+        nlohmann::json request_json;
+        std::string error_msg;
+        
+        if (!parse_json_body(req.body, request_json, error_msg)) {
+            send_error_response(res, "Invalid JSON: " + error_msg, 400);
             return;
         }
         
-        // 检查文件是否存在
-        if (!std::filesystem::exists(file_path)) {
-            send_error_response(res, "File not found: " + file_path, 404);
+        if (!request_json.contains("type") || !request_json["type"].is_string()) {
+            send_error_response(res, "type parameter is required", 400);
             return;
         }
         
-        // 读取文件内容
-        std::ifstream file(file_path);
-        if (!file.is_open()) {
-            send_error_response(res, "Failed to open file: " + file_path, 500);
+        submit_job(req, res, request_json["type"].get<std::string>(),
+                   request_json.value("params", nlohmann::json::object()));
+    } catch (const std::exception& e) {
+        spdlog::error("Error submitting job: {}", e.what());
+        send_error_response(res, "Failed to submit job", 500);
+    }
+}
+
+void HttpHandler::handle_list_jobs(const httplib::Request& req, httplib::Response& res) {
+    try {
+        if (!job_manager_) {
+            send_error_response(res, "Background jobs are not available", 503);
             return;
         }
         
-        std::string content((std::istreambuf_iterator<char>(file)),
-                           std::istreambuf_iterator<char>());
-        file.close();
+        const std::string status = get_param(req, "status");
+        const int limit = std::clamp(parse_int_param(req, "limit", 50), 1, 500);
         
-        if (content.empty()) {
-            send_error_response(res, "File is empty or could not be read", 400);
-            return;
+        nlohmann::json jobs = nlohmann::json::array();
+        for (const auto& job : job_manager_->list_jobs(status, limit)) {
+            // 列表不返回结果，完整结果通过/api/jobs/{id}获取
+            auto j = job.to_json();
+            j.erase("result");
+            jobs.push_back(std::move(j));
         }
         
-        // 构建解析提示
-        std::string prompt = "Please analyze the following document and extract structured information. ";
-        prompt += "Return a JSON object with the following fields: title (string), content (string), content_type (string), tags (comma-separated string). ";
-        prompt += "The content_type should be one of: article, note, document, reference, tutorial, or other. ";
-        prompt += "Generate relevant tags based on the document content. ";
-        prompt += "Document content:\n\n" + content;
+        nlohmann::json response;
+        response["jobs"] = jobs;
+        response["count"] = jobs.size();
+        response["statistics"] = job_manager_->get_statistics();
+        send_json_response(req, res, response);
+    } catch (const std::exception& e) {
+        spdlog::error("Error listing jobs: {}", e.what());
+        send_error_response(res, "Failed to list jobs", 500);
+    }
+}
+
+void HttpHandler::handle_get_job(const httplib::Request& req, httplib::Response& res) {
+    try {
+        if (!job_manager_) {
+            send_error_response(res, "Background jobs are not available", 503);
+            return;
+        }
         
-        nlohmann::json parse_result;
+        auto job = job_manager_->get_job(req.matches[1]);
+        if (!job) {
+            send_error_response(res, "Job not found", 404);
+            return;
+        }
         
-        if (ai_service == "llama" && llama_service_) {
-            // 使用LLaMA服务解析
-            try {
-                LlamaRequest llama_request;
-                llama_request.prompt = prompt;
-                llama_request.max_tokens = 1000;
-                llama_request.temperature = 0.3;
-                
-                auto llama_response = llama_service_->process_request(llama_request);
-                if (llama_response.success && !llama_response.text.empty()) {
-                    // 尝试解析LLaMA返回的JSON
-                    try {
-                        parse_result = nlohmann::json::parse(llama_response.text);
-                    } catch (const std::exception&) {
-                        // 如果解析失败，创建默认结果
-                        parse_result = create_default_parse_result(content, file_path);
-                    }
-                } else {
-                    parse_result = create_default_parse_result(content, file_path);
+        send_json_response(req, res, job->to_json());
+    } catch (const std::exception& e) {
+        spdlog::error("Error getting job: {}", e.what());
+        send_error_response(res, "Failed to get job", 500);
+    }
+}
+
+void HttpHandler::handle_mcp_events(const httplib::Request& /*req*/, httplib::Response& res) {
+    res.set_header("Cache-Control", "no-cache");
+    res.set_header("Connection", "keep-alive");
+    set_cors_headers(res);
+    
+    // 连接建立之前的变更不推送；空闲时发送注释行保活，客户端断开后结束
+    auto mcp_server = mcp_server_;
+    const uint64_t start_version = mcp_server_->get_content_manager()->get_change_version();
+    res.set_chunked_content_provider(
+        "text/event-stream",
+        [mcp_server, start_version](size_t /*offset*/, httplib::DataSink& sink) {
+            uint64_t version = start_version;
+            while (sink.is_writable()) {
+                auto notification = mcp_server->wait_for_notification(version, std::chrono::seconds(15));
+                const std::string data = notification
+                    ? "event: message\ndata: " + notification->dump() + "\n\n"
+                    : ": keep-alive\n\n";
+                if (!sink.write(data.data(), data.size())) {
+                    return false;
                 }
-            } catch (const std::exception& e) {
-                spdlog::warn("LLaMA parsing failed: {}", e.what());
-                parse_result = create_default_parse_result(content, file_path);
-            }
-        } else if (ai_service == "ollama") {
-            // 使用Ollama服务解析
-            auto& config = Config::instance();
-            if (!config.is_ollama_enabled()) {
-                send_error_response(res, "Ollama service is not enabled", 503);
-                return;
             }
-            
-            try {
-                // 调用Ollama API进行文档解析
-                std::string ollama_host = config.get_ollama_host();
-                int ollama_port = config.get_ollama_port();
-                std::string ollama_model = config.get_ollama_model();
-                
-                // 创建HTTP客户端
-                httplib::Client client(ollama_host, ollama_port);
-                client.set_connection_timeout(5, 0);
-                client.set_read_timeout(60, 0); // 文档解析可能需要更长时间
-                
-                // 准备Ollama请求
-                nlohmann::json ollama_request;
-                ollama_request["model"] = ollama_model;
-                ollama_request["prompt"] = prompt;
-                ollama_request["stream"] = false;
-                ollama_request["options"] = {
-                    {"temperature", config.get_ollama_temperature()},
-                    {"num_predict", config.get_ollama_max_tokens()}
+            return false;
+        }
+    );
+}
+
+void HttpHandler::handle_job_events(const httplib::Request& req, httplib::Response& res) {
+    try {
+        if (!job_manager_) {
+            send_error_response(res, "Background jobs are not available", 503);
+            return;
+        }
+        
+        const std::string job_id = req.matches[1];
+        if (!job_manager_->get_job(job_id)) {
+            send_error_response(res, "Job not found", 404);
+            return;
+        }
+        
+        res.set_header("Cache-Control", "no-cache");
+        res.set_header("Connection", "keep-alive");
+        set_cors_headers(res);
+        
+        // 每次状态或进度变化推送一个事件，任务结束后关闭连接；空闲时发送注释行保活
+        auto job_manager = job_manager_;
+        res.set_chunked_content_provider(
+            "text/event-stream",
+            [job_manager, job_id](size_t /*offset*/, httplib::DataSink& sink) {
+                auto send = [&sink](const std::string& data) {
+                    return sink.is_writable() && sink.write(data.data(), data.size());
                 };
                 
-                // 发送请求到Ollama
-                auto result = client.Post("/api/generate", ollama_request.dump(), "application/json");
-                
-                if (result && result->status == 200) {
-                    // 解析Ollama响应
-                    nlohmann::json ollama_response = nlohmann::json::parse(result->body);
+                uint64_t version = 0;
+                auto job = job_manager->get_job(job_id);
+                while (job) {
+                    if (!send("data: " + job->to_json().dump() + "\n\n")) {
+                        return false;
+                    }
+                    if (JobManager::is_terminal(job->status)) {
+                        break;
+                    }
                     
-                    if (ollama_response.contains("response") && !ollama_response["response"].get<std::string>().empty()) {
-                        std::string ollama_text = ollama_response["response"];
-                        
-                        // 尝试解析Ollama返回的JSON
-                        try {
-                            // 查找JSON内容（可能被其他文本包围）
-                            size_t json_start = ollama_text.find("{");
-                            size_t json_end = ollama_text.rfind("}");
-                            
-                            if (json_start != std::string::npos && json_end != std::string::npos && json_end > json_start) {
-                                std::string json_str = ollama_text.substr(json_start, json_end - json_start + 1);
-                                parse_result = nlohmann::json::parse(json_str);
-                                
-                                // 验证必要字段
-                                if (!parse_result.contains("title") || !parse_result.contains("content") || 
-                                    !parse_result.contains("content_type") || !parse_result.contains("tags")) {
-                                    throw std::runtime_error("Missing required fields in Ollama response");
-                                }
-                            } else {
-                                throw std::runtime_error("No valid JSON found in Ollama response");
-                            }
-                        } catch (const std::exception& e) {
-                            spdlog::warn("Failed to parse Ollama JSON response: {}", e.what());
-                            // 如果JSON解析失败，尝试从响应中提取标题
-                            parse_result = create_default_parse_result(content, file_path);
-                            
-                            // 尝试从Ollama响应中提取更好的标题
-                            std::string lower_text = ollama_text;
-                            std::transform(lower_text.begin(), lower_text.end(), lower_text.begin(), ::tolower);
-                            
-                            size_t title_pos = lower_text.find("title");
-                            if (title_pos != std::string::npos) {
-                                // 简单的标题提取逻辑
-                                size_t start = ollama_text.find(":", title_pos);
-                                if (start != std::string::npos) {
-                                    start++;
-                                    size_t end = ollama_text.find("\n", start);
-                                    if (end == std::string::npos) end = ollama_text.length();
-                                    
-                                    std::string extracted_title = ollama_text.substr(start, end - start);
-                                    // 清理标题
-                                    extracted_title.erase(0, extracted_title.find_first_not_of(" \t\"'"));
-                                    extracted_title.erase(extracted_title.find_last_not_of(" \t\"',") + 1);
-                                    
-                                    if (!extracted_title.empty() && extracted_title.length() > 3) {
-                                        parse_result["title"] = extracted_title;
-                                    }
-                                }
-                            }
+                    const uint64_t seen = version;
+                    job = job_manager->wait_for_update(job_id, version, std::chrono::seconds(15));
+                    while (job && version == seen) {
+                        if (!send(": keep-alive\n\n")) {
+                            return false;
                         }
-                    } else {
-                        spdlog::warn("Empty response from Ollama");
-                        parse_result = create_default_parse_result(content, file_path);
+                        job = job_manager->wait_for_update(job_id, version, std::chrono::seconds(15));
                     }
-                } else {
-                    std::string error_msg = "Failed to connect to Ollama service";
-                    if (result) {
-                        error_msg += " (HTTP " + std::to_string(result->status) + ")";
-                    }
-                    spdlog::warn(error_msg);
-                    parse_result = create_default_parse_result(content, file_path);
                 }
-            } catch (const std::exception& e) {
-                spdlog::warn("Ollama parsing failed: {}", e.what());
-                parse_result = create_default_parse_result(content, file_path);
+                sink.done();
+                return true;
             }
-        } else {
-            // 默认解析（不使用AI）
-            parse_result = create_default_parse_result(content, file_path);
-        }
-        
-        send_json_response(res, parse_result);
-        
+        );
     } catch (const std::exception& e) {
-        spdlog::error("Error parsing document: {}", e.what());
-        send_error_response(res, "Failed to parse document", 500);
+        spdlog::error("Error streaming job events: {}", e.what());
+        send_error_response(res, "Failed to stream job events", 500);
     }
 }
 
-nlohmann::json HttpHandler::create_default_parse_result(const std::string& content, const std::string& file_path) {
+nlohmann::json HttpHandler::create_default_parse_result(const std::string& content, const std::string& file_path,
+                                                        const std::optional<FileInfo>& file_info) {
     nlohmann::json result;
     
-    // 尝试从metadata.json中获取原始文件名
+    // 优先使用数据库中记录的原始文件名（去掉扩展名）作为标题
     std::string title;
     std::filesystem::path path(file_path);
     std::string filename = path.stem().string();
     
-    // 检查是否是uploads目录中的hash命名文件
-    if (file_path.find("/uploads/") != std::string::npos || file_path.find("\\uploads\\") != std::string::npos) {
-        // 尝试从metadata.json读取原始文件名
-        std::string metadata_path = path.parent_path().string() + "/metadata.json";
-        if (std::filesystem::exists(metadata_path)) {
-            try {
-                std::ifstream metadata_file(metadata_path);
-                if (metadata_file.is_open()) {
-                    nlohmann::json metadata;
-                    metadata_file >> metadata;
-                    metadata_file.close();
-                    
-                    // 查找匹配的文件ID
-                    if (metadata.contains("files") && metadata["files"].is_array()) {
-                        for (const auto& file_info : metadata["files"]) {
-                            if (file_info.contains("id") && file_info["id"].get<std::string>() == filename) {
-                                if (file_info.contains("original_name")) {
-                                    title = file_info["original_name"].get<std::string>();
-                                    // 移除文件扩展名作为标题
-                                    size_t dot_pos = title.find_last_of(".");
-                                    if (dot_pos != std::string::npos) {
-                                        title = title.substr(0, dot_pos);
-                                    }
-                                    break;
-                                }
-                            }
-                        }
-                    }
-                }
-            } catch (const std::exception& e) {
-                spdlog::warn("Failed to read metadata.json: {}", e.what());
-            }
-        }
+    std::optional<FileInfo> info = file_info;
+    if (!info && (file_path.find("/uploads/") != std::string::npos || file_path.find("\\uploads\\") != std::string::npos)) {
+        // 旧版本的上传文件以文件ID命名
+        info = mcp_server_->get_content_manager()->get_database()->get_file(filename);
+    }
+    if (info && !info->original_name.empty()) {
+        title = std::filesystem::path(info->original_name).stem().string();
     }
     
     // 如果没有找到原始文件名，使用文件名或生成默认标题
@@ -1807,7 +2706,7 @@ void HttpHandler::handle_mcp_api(const httplib::Request& req, httplib::Response&
         api_response["method"] = method;
         api_response["timestamp"] = std::time(nullptr);
         
-        send_json_response(res, api_response);
+        send_json_response(req, res, api_response);
         
     } catch (const std::exception& e) {
         spdlog::error("Error handling MCP API request: {}", e.what());
@@ -0,0 +1,353 @@
+#include "job_manager.hpp"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <condition_variable>
+#include <ctime>
+#include <map>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace mcp {
+
+namespace {
+
+// 进度更新的最小落库间隔，状态变化总是立即写入
+constexpr auto kProgressPersistInterval = std::chrono::seconds(1);
+
+int64_t now_seconds() {
+    return static_cast<int64_t>(std::time(nullptr));
+}
+
+} // namespace
+
+class JobManager::Impl {
+public:
+    struct Registration {
+        Handler handler;
+        GenerationPriority priority;
+    };
+
+    // 未结束的任务保存在内存中，结束后只保留数据库记录
+    struct ActiveJob {
+        JobRecord record;
+        uint64_t version = 0;
+        std::chrono::steady_clock::time_point last_persist;
+    };
+
+    std::shared_ptr<Database> db_;
+    std::unique_ptr<GenerationQueue> queue_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::map<std::string, Registration> handlers_;
+    std::unordered_map<std::string, ActiveJob> active_;
+    bool stopping_ = false;
+    std::mt19937_64 gen_{std::random_device{}()};
+
+    // 统计信息
+    uint64_t submitted_ = 0;
+    uint64_t succeeded_ = 0;
+    uint64_t failed_ = 0;
+    uint64_t cancelled_ = 0;
+    uint64_t rejected_ = 0;
+
+    std::string generate_id() {
+        static const char hex[] = "0123456789abcdef";
+        std::uniform_int_distribution<int> dis(0, 15);
+        std::string id(32, '0');
+        for (auto& ch : id) {
+            ch = hex[dis(gen_)];
+        }
+        return id;
+    }
+
+    // 修改内存中的任务记录并唤醒等待者；force为false时进度更新按间隔节流落库
+    void update(const std::string& id, const std::function<void(JobRecord&)>& modify, bool force) {
+        JobRecord snapshot;
+        bool persist = force;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = active_.find(id);
+            if (it == active_.end()) {
+                return;
+            }
+            modify(it->second.record);
+            it->second.record.updated_at = now_seconds();
+            it->second.version++;
+
+            const auto now = std::chrono::steady_clock::now();
+            if (!persist && now - it->second.last_persist >= kProgressPersistInterval) {
+                persist = true;
+            }
+            if (persist) {
+                it->second.last_persist = now;
+                snapshot = it->second.record;
+            }
+        }
+        cv_.notify_all();
+
+        if (persist) {
+            db_->save_job(snapshot);
+        }
+    }
+
+    // 写入最终状态后移出内存，之后的查询直接读数据库
+    void finish(const std::string& id, const std::function<void(JobRecord&)>& modify) {
+        JobRecord snapshot;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = active_.find(id);
+            if (it == active_.end()) {
+                return;
+            }
+            modify(it->second.record);
+            it->second.record.updated_at = now_seconds();
+            snapshot = it->second.record;
+
+            if (snapshot.status == "succeeded") {
+                succeeded_++;
+            } else if (snapshot.status == "cancelled") {
+                cancelled_++;
+            } else {
+                failed_++;
+            }
+        }
+
+        db_->save_job(snapshot);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            active_.erase(id);
+        }
+        cv_.notify_all();
+    }
+
+    void run(const std::string& id, const Handler& handler, bool run) {
+        if (!run) {
+            finish(id, [](JobRecord& job) {
+                job.status = "cancelled";
+                job.error = "Server is shutting down";
+            });
+            return;
+        }
+
+        nlohmann::json params;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = active_.find(id);
+            if (it == active_.end()) {
+                return;
+            }
+            params = it->second.record.params;
+        }
+        update(id, [](JobRecord& job) { job.status = "running"; }, true);
+
+        ProgressCallback progress = [this, &id](double value, const std::string& message) {
+            update(id, [value, &message](JobRecord& job) {
+                job.progress = std::clamp(value, 0.0, 1.0);
+                job.message = message;
+            }, false);
+        };
+
+        try {
+            auto result = handler(params, progress);
+            finish(id, [&result](JobRecord& job) {
+                job.status = "succeeded";
+                job.progress = 1.0;
+                job.result = std::move(result);
+            });
+        } catch (const std::exception& e) {
+            spdlog::error("Job {} failed: {}", id, e.what());
+            const std::string error = e.what();
+            finish(id, [&error](JobRecord& job) {
+                job.status = "failed";
+                job.error = error;
+            });
+        }
+    }
+};
+
+JobManager::JobManager(std::shared_ptr<Database> database, size_t workers, size_t capacity)
+    : pimpl_(std::make_unique<Impl>()) {
+    pimpl_->db_ = std::move(database);
+
+    // 上次退出时仍在排队或执行的任务已无法继续
+    const int interrupted = pimpl_->db_->fail_interrupted_jobs();
+    if (interrupted > 0) {
+        spdlog::warn("Marked {} interrupted jobs as failed", interrupted);
+    }
+
+    pimpl_->queue_ = std::make_unique<GenerationQueue>(workers, capacity);
+    spdlog::info("Job manager started with {} workers", workers);
+}
+
+JobManager::~JobManager() {
+    shutdown();
+}
+
+void JobManager::register_handler(const std::string& type, Handler handler, GenerationPriority priority) {
+    std::lock_guard<std::mutex> lock(pimpl_->mutex_);
+    pimpl_->handlers_[type] = Impl::Registration{std::move(handler), priority};
+}
+
+bool JobManager::has_handler(const std::string& type) const {
+    std::lock_guard<std::mutex> lock(pimpl_->mutex_);
+    return pimpl_->handlers_.count(type) > 0;
+}
+
+std::optional<JobRecord> JobManager::submit(const std::string& type, const nlohmann::json& params,
+                                            std::string& error) {
+    Impl::Registration registration;
+    JobRecord record;
+    {
+        std::lock_guard<std::mutex> lock(pimpl_->mutex_);
+        if (pimpl_->stopping_) {
+            error = "Job manager is shutting down";
+            return std::nullopt;
+        }
+        auto it = pimpl_->handlers_.find(type);
+        if (it == pimpl_->handlers_.end()) {
+            error = "Unknown job type: " + type;
+            return std::nullopt;
+        }
+        registration = it->second;
+
+        record.id = pimpl_->generate_id();
+        record.type = type;
+        record.status = "queued";
+        record.params = params.is_null() ? nlohmann::json::object() : params;
+        record.created_at = record.updated_at = now_seconds();
+
+        auto& active = pimpl_->active_[record.id];
+        active.record = record;
+        active.last_persist = std::chrono::steady_clock::now();
+    }
+
+    // 先落库再入队，保证工作线程的状态更新不会被初始记录覆盖
+    if (!pimpl_->db_->save_job(record)) {
+        std::lock_guard<std::mutex> lock(pimpl_->mutex_);
+        pimpl_->active_.erase(record.id);
+        error = "Failed to persist job";
+        return std::nullopt;
+    }
+
+    Impl* impl = pimpl_.get();
+    const std::string id = record.id;
+    Handler handler = std::move(registration.handler);
+    const bool accepted = pimpl_->queue_->submit(registration.priority, [impl, id, handler](bool run) {
+        impl->run(id, handler, run);
+    });
+
+    if (!accepted) {
+        {
+            std::lock_guard<std::mutex> lock(pimpl_->mutex_);
+            pimpl_->active_.erase(id);
+            pimpl_->rejected_++;
+        }
+        record.status = "failed";
+        record.error = "Job queue is full";
+        record.updated_at = now_seconds();
+        pimpl_->db_->save_job(record);
+        error = record.error;
+        return std::nullopt;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(pimpl_->mutex_);
+        pimpl_->submitted_++;
+    }
+    spdlog::info("Submitted {} job {}", type, id);
+    return record;
+}
+
+std::optional<JobRecord> JobManager::get_job(const std::string& id) {
+    {
+        std::lock_guard<std::mutex> lock(pimpl_->mutex_);
+        auto it = pimpl_->active_.find(id);
+        if (it != pimpl_->active_.end()) {
+            return it->second.record;
+        }
+    }
+    return pimpl_->db_->get_job(id);
+}
+
+std::vector<JobRecord> JobManager::list_jobs(const std::string& status, int limit) {
+    auto jobs = pimpl_->db_->list_jobs(status, limit);
+
+    // 数据库中的进度按间隔落库，用内存中的最新状态替换
+    std::lock_guard<std::mutex> lock(pimpl_->mutex_);
+    for (auto& job : jobs) {
+        auto it = pimpl_->active_.find(job.id);
+        if (it != pimpl_->active_.end()) {
+            job = it->second.record;
+        }
+    }
+    return jobs;
+}
+
+std::optional<JobRecord> JobManager::wait_for_update(const std::string& id, uint64_t& version,
+                                                     std::chrono::milliseconds timeout) {
+    {
+        std::unique_lock<std::mutex> lock(pimpl_->mutex_);
+        auto ready = [&]() {
+            auto it = pimpl_->active_.find(id);
+            return it == pimpl_->active_.end() || it->second.version > version;
+        };
+        pimpl_->cv_.wait_for(lock, timeout, ready);
+
+        auto it = pimpl_->active_.find(id);
+        if (it != pimpl_->active_.end()) {
+            version = it->second.version;
+            return it->second.record;
+        }
+    }
+
+    // 已结束的任务只在数据库中
+    auto record = pimpl_->db_->get_job(id);
+    if (record) {
+        version++;
+    }
+    return record;
+}
+
+void JobManager::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(pimpl_->mutex_);
+        if (pimpl_->stopping_) {
+            return;
+        }
+        pimpl_->stopping_ = true;
+    }
+
+    // 排队中的任务以run=false回调并标记为cancelled
+    pimpl_->queue_->shutdown();
+    spdlog::info("Job manager stopped");
+}
+
+nlohmann::json JobManager::get_statistics() const {
+    nlohmann::json stats;
+    {
+        std::lock_guard<std::mutex> lock(pimpl_->mutex_);
+        stats["active_jobs"] = pimpl_->active_.size();
+        stats["submitted"] = pimpl_->submitted_;
+        stats["succeeded"] = pimpl_->succeeded_;
+        stats["failed"] = pimpl_->failed_;
+        stats["cancelled"] = pimpl_->cancelled_;
+        stats["rejected"] = pimpl_->rejected_;
+
+        nlohmann::json types = nlohmann::json::array();
+        for (const auto& [type, registration] : pimpl_->handlers_) {
+            types.push_back(type);
+        }
+        stats["types"] = types;
+    }
+    stats["queue"] = pimpl_->queue_->get_statistics();
+    return stats;
+}
+
+bool JobManager::is_terminal(const std::string& status) {
+    return status == "succeeded" || status == "failed" || status == "cancelled";
+}
+
+} // namespace mcp
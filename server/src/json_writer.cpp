@@ -0,0 +1,123 @@
+#include "json_writer.hpp"
+#include <nlohmann/json.hpp>
+
+namespace mcp {
+
+namespace {
+
+bool is_continuation(unsigned char ch) {
+    return (ch & 0xC0) == 0x80;
+}
+
+// 返回从pos开始的合法UTF-8多字节序列长度，不合法时返回0
+size_t utf8_sequence_length(std::string_view value, size_t pos) {
+    const auto lead = static_cast<unsigned char>(value[pos]);
+    const size_t remaining = value.size() - pos;
+    auto at = [&](size_t offset) {
+        return static_cast<unsigned char>(value[pos + offset]);
+    };
+
+    if (lead >= 0xC2 && lead <= 0xDF) {
+        return remaining >= 2 && is_continuation(at(1)) ? 2 : 0;
+    }
+    if (lead >= 0xE0 && lead <= 0xEF) {
+        if (remaining < 3 || !is_continuation(at(1)) || !is_continuation(at(2))) {
+            return 0;
+        }
+        // 排除过长编码和UTF-16代理区
+        if ((lead == 0xE0 && at(1) < 0xA0) || (lead == 0xED && at(1) > 0x9F)) {
+            return 0;
+        }
+        return 3;
+    }
+    if (lead >= 0xF0 && lead <= 0xF4) {
+        if (remaining < 4 || !is_continuation(at(1)) || !is_continuation(at(2)) || !is_continuation(at(3))) {
+            return 0;
+        }
+        if ((lead == 0xF0 && at(1) < 0x90) || (lead == 0xF4 && at(1) > 0x8F)) {
+            return 0;
+        }
+        return 4;
+    }
+    return 0;
+}
+
+} // namespace
+
+void append_json_string(std::string& out, std::string_view value) {
+    static const char kHex[] = "0123456789abcdef";
+
+    out.reserve(out.size() + value.size() + 2);
+    out += '"';
+
+    // 无需转义的字节成段拷贝
+    size_t run_start = 0;
+    size_t pos = 0;
+    auto flush_run = [&]() {
+        out.append(value.data() + run_start, pos - run_start);
+    };
+
+    while (pos < value.size()) {
+        const auto ch = static_cast<unsigned char>(value[pos]);
+        if (ch >= 0x80) {
+            const size_t length = utf8_sequence_length(value, pos);
+            if (length > 0) {
+                pos += length;
+                continue;
+            }
+            flush_run();
+            out += "\xEF\xBF\xBD";
+            run_start = ++pos;
+            continue;
+        }
+        if (ch >= 0x20 && ch != '"' && ch != '\\') {
+            ++pos;
+            continue;
+        }
+
+        flush_run();
+        switch (ch) {
+        case '"':
+            out += "\\\"";
+            break;
+        case '\\':
+            out += "\\\\";
+            break;
+        case '\b':
+            out += "\\b";
+            break;
+        case '\f':
+            out += "\\f";
+            break;
+        case '\n':
+            out += "\\n";
+            break;
+        case '\r':
+            out += "\\r";
+            break;
+        case '\t':
+            out += "\\t";
+            break;
+        default:
+            out += "\\u00";
+            out += kHex[ch >> 4];
+            out += kHex[ch & 0x0F];
+            break;
+        }
+        run_start = ++pos;
+    }
+
+    flush_run();
+    out += '"';
+}
+
+void append_json_raw(std::string& out, std::string_view json, std::string_view fallback) {
+    // accept只做语法检查，不构造DOM
+    if (!json.empty() && nlohmann::json::accept(json)) {
+        out.append(json.data(), json.size());
+    } else {
+        out.append(fallback.data(), fallback.size());
+    }
+}
+
+} // namespace mcp
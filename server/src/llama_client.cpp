@@ -1,23 +1,250 @@
 #include "llama_client.hpp"
 #include "config.hpp"
+#include "sha256.hpp"
+#include <httplib.h>
 #include <spdlog/spdlog.h>
 #include <chrono>
 #include <thread>
 #include <sstream>
-#include <regex>
+#include <string_view>
+#include <fstream>
 #include <cstdlib>
+#include <cstdint>
 #ifdef _WIN32
 #include <windows.h>
 #include <io.h>
 #else
+#include <sys/types.h>
 #include <sys/wait.h>
 #include <unistd.h>
+#include <csignal>
+#endif
+#ifdef __linux__
+#include <sys/prctl.h>
 #endif
 #include <fcntl.h>
 #include <mutex>
 
 namespace mcp {
 
+namespace {
+
+// 读取GGUF文件头中的general.architecture，失败时返回空字符串
+std::string read_gguf_architecture(const std::string& model_path) {
+    std::ifstream file(model_path, std::ios::binary);
+    if (!file) {
+        return "";
+    }
+    
+    auto read_u32 = [&file]() { uint32_t v = 0; file.read(reinterpret_cast<char*>(&v), sizeof(v)); return v; };
+    auto read_u64 = [&file]() { uint64_t v = 0; file.read(reinterpret_cast<char*>(&v), sizeof(v)); return v; };
+    auto read_string = [&]() {
+        uint64_t len = read_u64();
+        if (!file || len > 4096) {
+            file.setstate(std::ios::failbit);
+            return std::string();
+        }
+        std::string str(len, '\0');
+        file.read(str.data(), static_cast<std::streamsize>(len));
+        return str;
+    };
+    
+    char magic[4] = {};
+    file.read(magic, sizeof(magic));
+    if (!file || std::string(magic, 4) != "GGUF" || read_u32() < 2) {
+        return "";
+    }
+    read_u64(); // tensor_count
+    const uint64_t kv_count = read_u64();
+    
+    // 各标量类型的字节数，下标为GGUF值类型，8(string)和9(array)单独处理
+    static const size_t scalar_sizes[] = {1, 1, 2, 2, 4, 4, 4, 1, 0, 0, 8, 8, 8};
+    for (uint64_t i = 0; i < kv_count && i < 256 && file; ++i) {
+        const std::string key = read_string();
+        const uint32_t type = read_u32();
+        if (key == "general.architecture") {
+            return type == 8 ? read_string() : "";
+        }
+        
+        if (type == 8) {
+            read_string();
+        } else if (type == 9) {
+            const uint32_t elem_type = read_u32();
+            const uint64_t count = read_u64();
+            if (elem_type == 8) {
+                for (uint64_t n = 0; n < count && file; ++n) {
+                    read_string();
+                }
+            } else if (elem_type < 13 && scalar_sizes[elem_type] > 0) {
+                file.seekg(static_cast<std::streamoff>(count * scalar_sizes[elem_type]), std::ios::cur);
+            } else {
+                return "";
+            }
+        } else if (type < 13) {
+            file.seekg(static_cast<std::streamoff>(scalar_sizes[type]), std::ios::cur);
+        } else {
+            return "";
+        }
+    }
+    
+    return "";
+}
+
+// llama-server /completion 请求体
+nlohmann::json build_completion_body(const LlamaRequest& request, bool stream) {
+    nlohmann::json body;
+    body["prompt"] = request.prompt;
+    body["n_predict"] = request.max_tokens;
+    body["temperature"] = request.temperature;
+    body["top_p"] = request.top_p;
+    body["top_k"] = request.top_k;
+    body["stop"] = request.stop_sequences;
+    body["cache_prompt"] = true;
+    body["stream"] = stream;
+    return body;
+}
+
+// 常驻的llama-server子进程，模型在进程生命周期内保持加载
+class ServerProcess {
+public:
+    ServerProcess() = default;
+    ServerProcess(const ServerProcess&) = delete;
+    ServerProcess& operator=(const ServerProcess&) = delete;
+    ~ServerProcess() { stop(); }
+    
+    bool start(const std::string& executable, const std::vector<std::string>& args) {
+#ifdef _WIN32
+        std::string command_line = "\"" + executable + "\"";
+        for (const auto& arg : args) {
+            command_line += " \"" + arg + "\"";
+        }
+        STARTUPINFOA si{};
+        si.cb = sizeof(si);
+        if (!CreateProcessA(nullptr, command_line.data(), nullptr, nullptr, FALSE, CREATE_NO_WINDOW,
+                            nullptr, nullptr, &si, &pi_)) {
+            spdlog::error("Failed to start llama server: error {}", GetLastError());
+            return false;
+        }
+        started_ = true;
+        return true;
+#else
+        std::vector<char*> argv;
+        argv.push_back(const_cast<char*>(executable.c_str()));
+        for (const auto& arg : args) {
+            argv.push_back(const_cast<char*>(arg.c_str()));
+        }
+        argv.push_back(nullptr);
+        
+        const bool verbose = spdlog::get_level() <= spdlog::level::debug;
+        pid_ = fork();
+        if (pid_ < 0) {
+            spdlog::error("Failed to fork llama server process");
+            return false;
+        }
+        
+        if (pid_ == 0) {
+#ifdef __linux__
+            // 父进程异常退出时子进程随之结束，避免模型常驻内存成为孤儿
+            prctl(PR_SET_PDEATHSIG, SIGTERM);
+#endif
+            int devnull = open("/dev/null", O_RDWR);
+            if (devnull >= 0) {
+                dup2(devnull, STDIN_FILENO);
+                dup2(devnull, STDOUT_FILENO);
+                if (!verbose) {
+                    dup2(devnull, STDERR_FILENO);
+                }
+            }
+            // 不继承父进程的监听socket等描述符
+            for (long fd = STDERR_FILENO + 1, max_fd = sysconf(_SC_OPEN_MAX); fd < max_fd && fd < 65536; ++fd) {
+                close(static_cast<int>(fd));
+            }
+            execv(executable.c_str(), argv.data());
+            _exit(127);
+        }
+        return true;
+#endif
+    }
+    
+    bool running() {
+#ifdef _WIN32
+        return started_ && WaitForSingleObject(pi_.hProcess, 0) == WAIT_TIMEOUT;
+#else
+        if (pid_ <= 0) {
+            return false;
+        }
+        int status = 0;
+        if (waitpid(pid_, &status, WNOHANG) == pid_) {
+            pid_ = -1;
+            return false;
+        }
+        return true;
+#endif
+    }
+    
+    void stop() {
+#ifdef _WIN32
+        if (!started_) {
+            return;
+        }
+        TerminateProcess(pi_.hProcess, 0);
+        WaitForSingleObject(pi_.hProcess, 5000);
+        CloseHandle(pi_.hProcess);
+        CloseHandle(pi_.hThread);
+        started_ = false;
+#else
+        if (pid_ <= 0) {
+            return;
+        }
+        // 先SIGTERM等待正常退出，超时后SIGKILL
+        kill(pid_, SIGTERM);
+        int status = 0;
+        for (int i = 0; i < 50; ++i) {
+            if (waitpid(pid_, &status, WNOHANG) == pid_) {
+                pid_ = -1;
+                return;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        kill(pid_, SIGKILL);
+        waitpid(pid_, &status, 0);
+        pid_ = -1;
+#endif
+    }
+    
+private:
+#ifdef _WIN32
+    PROCESS_INFORMATION pi_{};
+    bool started_ = false;
+#else
+    pid_t pid_ = -1;
+#endif
+};
+
+// 缓存键：模型与全部采样参数的SHA-256；非确定性且未声明cache的请求返回空串
+std::string response_cache_key(const ModelInfo& model, const LlamaRequest& request) {
+    const bool deterministic = request.temperature <= 0.0f || request.top_k == 1;
+    if (!deterministic && !request.cache) {
+        return "";
+    }
+    
+    nlohmann::json key;
+    key["model"] = model.model_path.empty() ? model.model_name : model.model_path;
+    key["prompt"] = request.prompt;
+    key["temperature"] = request.temperature;
+    key["top_p"] = request.top_p;
+    key["top_k"] = request.top_k;
+    key["max_tokens"] = request.max_tokens;
+    key["stop_sequences"] = request.stop_sequences;
+    
+    const std::string canonical = key.dump();
+    Sha256 hasher;
+    hasher.update(canonical.data(), canonical.size());
+    return hasher.hex_digest();
+}
+
+} // namespace
+
 // LlamaRequest 实现
 nlohmann::json LlamaRequest::to_json() const {
     nlohmann::json j;
@@ -28,6 +255,12 @@ nlohmann::json LlamaRequest::to_json() const {
     j["top_k"] = top_k;
     j["stop_sequences"] = stop_sequences;
     j["stream"] = stream;
+    j["cache"] = cache;
+    switch (priority) {
+        case GenerationPriority::Interactive: j["priority"] = "interactive"; break;
+        case GenerationPriority::Normal: j["priority"] = "normal"; break;
+        case GenerationPriority::Bulk: j["priority"] = "bulk"; break;
+    }
     return j;
 }
 
@@ -39,6 +272,16 @@ void LlamaRequest::from_json(const nlohmann::json& j) {
     top_k = j.value("top_k", 40);
     stop_sequences = j.value("stop_sequences", std::vector<std::string>{});
     stream = j.value("stream", false);
+    cache = j.value("cache", false);
+    
+    const std::string priority_name = j.value("priority", "interactive");
+    if (priority_name == "bulk") {
+        priority = GenerationPriority::Bulk;
+    } else if (priority_name == "normal") {
+        priority = GenerationPriority::Normal;
+    } else {
+        priority = GenerationPriority::Interactive;
+    }
 }
 
 // LlamaResponse 实现
@@ -49,6 +292,12 @@ nlohmann::json LlamaResponse::to_json() const {
     j["error_message"] = error_message;
     j["tokens_generated"] = tokens_generated;
     j["generation_time"] = generation_time;
+    if (time_to_first_token > 0.0) {
+        j["time_to_first_token"] = time_to_first_token;
+    }
+    if (cached) {
+        j["cached"] = true;
+    }
     return j;
 }
 
@@ -70,6 +319,10 @@ public:
     std::string model_path_;
     bool model_loaded_ = false;
     ModelInfo model_info_;
+    // llama-server地址，如 http://127.0.0.1:8090
+    std::string base_url_;
+    // 自行启动时持有子进程；连接外部服务时为空
+    std::unique_ptr<ServerProcess> process_;
     
     struct Statistics {
         size_t total_requests = 0;
@@ -112,7 +365,63 @@ public:
         }
     } stats_;
     
-    std::mutex mutex_;
+    // mutex_只保护状态，生成请求不持有；load_mutex_串行化模型加载/卸载
+    mutable std::mutex mutex_;
+    std::mutex load_mutex_;
+    
+    std::string base_url() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return base_url_;
+    }
+    
+    static std::unique_ptr<httplib::Client> make_client(const std::string& base_url, int timeout_sec) {
+        auto client = std::make_unique<httplib::Client>(base_url);
+        client->set_connection_timeout(2);
+        client->set_read_timeout(timeout_sec);
+        client->set_write_timeout(timeout_sec);
+        return client;
+    }
+    
+    // llama-server加载模型期间/health返回503，加载完成后返回200
+    static bool wait_until_ready(const std::string& base_url, ServerProcess* process, int timeout_sec) {
+        auto client = make_client(base_url, 5);
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(timeout_sec);
+        while (std::chrono::steady_clock::now() < deadline) {
+            if (process && !process->running()) {
+                spdlog::error("LLaMA server exited during startup");
+                return false;
+            }
+            auto res = client->Get("/health");
+            if (res && res->status == 200) {
+                return true;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(250));
+        }
+        spdlog::error("Timed out waiting for LLaMA server at {}", base_url);
+        return false;
+    }
+    
+    // 从服务端查询实际的上下文长度和词表大小
+    static void query_model_info(const std::string& base_url, ModelInfo& info) {
+        auto client = make_client(base_url, 5);
+        try {
+            if (auto res = client->Get("/props"); res && res->status == 200) {
+                auto props = nlohmann::json::parse(res->body);
+                const auto& settings = props.value("default_generation_settings", nlohmann::json::object());
+                info.context_size = settings.value("n_ctx", info.context_size);
+            }
+            if (auto res = client->Get("/v1/models"); res && res->status == 200) {
+                auto models = nlohmann::json::parse(res->body);
+                const auto& data = models.value("data", nlohmann::json::array());
+                if (!data.empty()) {
+                    const auto& meta = data[0].value("meta", nlohmann::json::object());
+                    info.vocab_size = meta.value("n_vocab", info.vocab_size);
+                }
+            }
+        } catch (const std::exception& e) {
+            spdlog::warn("Failed to query LLaMA model info: {}", e.what());
+        }
+    }
 };
 
 // LlamaClient 实现
@@ -129,7 +438,7 @@ bool LlamaClient::initialize() {
     }
     
     std::string model_path = config.get_llama_model_path();
-    if (!model_path.empty()) {
+    if (!model_path.empty() || !config.get_llama_server_url().empty()) {
         return load_model(model_path);
     }
     
@@ -138,7 +447,7 @@ bool LlamaClient::initialize() {
 }
 
 bool LlamaClient::load_model(const std::string& model_path) {
-    std::lock_guard<std::mutex> lock(pimpl_->mutex_);
+    std::lock_guard<std::mutex> load_lock(pimpl_->load_mutex_);
     
     auto& config = Config::instance();
     if (!config.is_llama_enabled()) {
@@ -146,50 +455,90 @@ bool LlamaClient::load_model(const std::string& model_path) {
         return false;
     }
     
-    // 检查模型文件是否存在
-    #ifdef _WIN32
-    if (_access(model_path.c_str(), 0) != 0) {
+    // 配置了外部llama-server时直接连接，模型由外部服务加载
+    const std::string external_url = config.get_llama_server_url();
+    std::unique_ptr<ServerProcess> process;
+    std::string base_url = external_url;
+    
+    if (external_url.empty()) {
+        // 检查模型文件是否存在
+#ifdef _WIN32
+        if (_access(model_path.c_str(), 0) != 0) {
 #else
-    if (access(model_path.c_str(), F_OK) != 0) {
+        if (access(model_path.c_str(), F_OK) != 0) {
 #endif
-        spdlog::error("Model file not found: {}", model_path);
-        return false;
-    }
-    
-    // 检查llama.cpp可执行文件是否存在
-    std::string executable_path = config.get_llama_executable_path();
-    #ifdef _WIN32
-    if (_access(executable_path.c_str(), 0) != 0) {
+            spdlog::error("Model file not found: {}", model_path);
+            return false;
+        }
+        
+        // 检查llama-server可执行文件是否存在
+        std::string executable_path = config.get_llama_executable_path();
+#ifdef _WIN32
+        if (_access(executable_path.c_str(), 0) != 0) {
 #else
-    if (access(executable_path.c_str(), X_OK) != 0) {
+        if (access(executable_path.c_str(), X_OK) != 0) {
 #endif
-        spdlog::error("LLaMA executable not found or not executable: {}", executable_path);
+            spdlog::error("LLaMA executable not found or not executable: {}", executable_path);
+            return false;
+        }
+        
+        // 同一端口只能有一个服务进程，先停掉旧的
+        unload_model();
+        
+        process = std::make_unique<ServerProcess>();
+        spdlog::info("Starting LLaMA server: {} (port {})", executable_path, config.get_llama_server_port());
+        if (!process->start(executable_path, build_server_args(model_path))) {
+            return false;
+        }
+        base_url = "http://127.0.0.1:" + std::to_string(config.get_llama_server_port());
+    }
+    
+    if (!Impl::wait_until_ready(base_url, process.get(), config.get_llama_startup_timeout())) {
         return false;
     }
     
-    pimpl_->model_path_ = model_path;
-    pimpl_->model_loaded_ = true;
+    ModelInfo info;
+    info.model_path = model_path;
+    info.model_name = model_path.substr(model_path.find_last_of("/\\") + 1);
+    info.is_loaded = true;
+    info.context_size = config.get_llama_context_size();
+    info.vocab_size = 0;
+    info.architecture = model_path.empty() ? "" : read_gguf_architecture(model_path);
+    if (info.architecture.empty()) {
+        info.architecture = "unknown";
+    }
+    Impl::query_model_info(base_url, info);
     
-    // 更新模型信息
-    pimpl_->model_info_.model_path = model_path;
-    pimpl_->model_info_.model_name = model_path.substr(model_path.find_last_of('/') + 1);
-    pimpl_->model_info_.is_loaded = true;
-    pimpl_->model_info_.context_size = config.get_llama_context_size();
-    pimpl_->model_info_.vocab_size = 0; // 需要从模型文件中读取
-    pimpl_->model_info_.architecture = "unknown";
+    {
+        std::lock_guard<std::mutex> lock(pimpl_->mutex_);
+        pimpl_->process_ = std::move(process);
+        pimpl_->base_url_ = base_url;
+        pimpl_->model_path_ = model_path;
+        pimpl_->model_loaded_ = true;
+        pimpl_->model_info_ = info;
+    }
     
-    spdlog::info("Model loaded successfully: {}", model_path);
+    spdlog::info("Model loaded successfully: {} (n_ctx={}, n_vocab={})", model_path, info.context_size,
+                 info.vocab_size);
     return true;
 }
 
 bool LlamaClient::unload_model() {
-    std::lock_guard<std::mutex> lock(pimpl_->mutex_);
-    
-    pimpl_->model_loaded_ = false;
-    pimpl_->model_path_.clear();
-    pimpl_->model_info_ = ModelInfo{};
+    std::unique_ptr<ServerProcess> process;
+    {
+        std::lock_guard<std::mutex> lock(pimpl_->mutex_);
+        process = std::move(pimpl_->process_);
+        pimpl_->model_loaded_ = false;
+        pimpl_->model_path_.clear();
+        pimpl_->base_url_.clear();
+        pimpl_->model_info_ = ModelInfo{};
+    }
     
-    spdlog::info("Model unloaded");
+    // 在锁外等待子进程退出
+    if (process) {
+        process->stop();
+        spdlog::info("Model unloaded");
+    }
     return true;
 }
 
@@ -201,66 +550,39 @@ bool LlamaClient::is_model_loaded() const {
 LlamaResponse LlamaClient::generate(const LlamaRequest& request) {
     LlamaResponse response;
     response.success = false;
+    response.tokens_generated = 0;
+    response.generation_time = 0.0;
     
     auto start_time = std::chrono::high_resolution_clock::now();
     
     try {
-        std::lock_guard<std::mutex> lock(pimpl_->mutex_);
-        
-        if (!pimpl_->model_loaded_) {
-            response.error_message = "No model loaded";
-            return response;
-        }
-        
         auto& config = Config::instance();
+        const std::string base_url = pimpl_->base_url();
+        
         if (!config.is_llama_enabled()) {
             response.error_message = "LLaMA integration is disabled";
-            return response;
-        }
-        
-        // 构建命令参数
-        std::vector<std::string> args = build_command_args(request);
-        
-        // 执行命令
-        std::string command = config.get_llama_executable_path();
-        for (const auto& arg : args) {
-            command += " " + escape_shell_arg(arg);
-        }
-        
-        spdlog::debug("Executing LLaMA command: {}", command);
-        
-        // 使用popen执行命令并捕获输出
-        #ifdef _WIN32
-        FILE* pipe = _popen(command.c_str(), "r");
-#else
-        FILE* pipe = popen(command.c_str(), "r");
-#endif
-        if (!pipe) {
-            response.error_message = "Failed to execute LLaMA command";
-            return response;
-        }
-        
-        std::string output;
-        char buffer[1024];
-        while (fgets(buffer, sizeof(buffer), pipe) != nullptr) {
-            output += buffer;
-        }
-        
-        #ifdef _WIN32
-        int exit_code = _pclose(pipe);
-#else
-        int exit_code = pclose(pipe);
-#endif
-        
-        auto end_time = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
-        response.generation_time = duration.count() / 1000.0;
-        
-        if (exit_code == 0) {
-            response = parse_output(output, response.generation_time);
+        } else if (base_url.empty()) {
+            response.error_message = "No model loaded";
         } else {
-            response.error_message = "LLaMA execution failed with exit code: " + std::to_string(exit_code);
-            response.error_message += "\nOutput: " + output;
+            const auto body = build_completion_body(request, false);
+            
+            auto client = Impl::make_client(base_url, config.get_llama_request_timeout());
+            auto res = client->Post("/completion", body.dump(), "application/json");
+            
+            auto end_time = std::chrono::high_resolution_clock::now();
+            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+            const double generation_time = duration.count() / 1000.0;
+            
+            if (!res) {
+                response.error_message = "Failed to connect to LLaMA server";
+                response.generation_time = generation_time;
+            } else if (res->status != 200) {
+                response.error_message = "LLaMA server returned status " + std::to_string(res->status) +
+                                         ": " + res->body;
+                response.generation_time = generation_time;
+            } else {
+                response = parse_completion(nlohmann::json::parse(res->body), generation_time);
+            }
         }
         
     } catch (const std::exception& e) {
@@ -269,39 +591,165 @@ LlamaResponse LlamaClient::generate(const LlamaRequest& request) {
     }
     
     // 更新统计信息
-    pimpl_->stats_.update(response);
+    {
+        std::lock_guard<std::mutex> lock(pimpl_->mutex_);
+        pimpl_->stats_.update(response);
+    }
     
     return response;
 }
 
+std::optional<std::vector<float>> LlamaClient::embed(const std::string& text) {
+    const std::string base_url = pimpl_->base_url();
+    if (!Config::instance().is_llama_enabled() || base_url.empty()) {
+        return std::nullopt;
+    }
+    
+    try {
+        nlohmann::json body;
+        body["content"] = text;
+        
+        auto client = Impl::make_client(base_url, Config::instance().get_llama_request_timeout());
+        auto res = client->Post("/embedding", body.dump(), "application/json");
+        if (!res || res->status != 200) {
+            spdlog::warn("LLaMA embedding request failed: {}", res ? res->status : 0);
+            return std::nullopt;
+        }
+        
+        // 旧版本返回{"embedding": [...]}，新版本返回[{"index": 0, "embedding": [[...]]}]
+        auto j = nlohmann::json::parse(res->body);
+        if (j.is_array() && !j.empty()) {
+            j = j[0];
+        }
+        auto embedding = j.value("embedding", nlohmann::json::array());
+        if (!embedding.empty() && embedding[0].is_array()) {
+            embedding = embedding[0];
+        }
+        if (embedding.empty()) {
+            return std::nullopt;
+        }
+        return embedding.get<std::vector<float>>();
+        
+    } catch (const std::exception& e) {
+        spdlog::error("LLaMA embedding error: {}", e.what());
+        return std::nullopt;
+    }
+}
+
 std::future<LlamaResponse> LlamaClient::generate_async(const LlamaRequest& request) {
     return std::async(std::launch::async, [this, request]() {
         return generate(request);
     });
 }
 
-bool LlamaClient::generate_stream(const LlamaRequest& request, 
-                                 std::function<bool(const std::string& token)> callback) {
-    // 流式生成的简单实现
-    // 在实际应用中，这需要与llama.cpp的流式API集成
-    LlamaResponse response = generate(request);
+LlamaResponse LlamaClient::generate_stream(const LlamaRequest& request,
+                                           std::function<bool(const std::string& token)> callback) {
+    LlamaResponse response;
+    response.success = false;
+    response.tokens_generated = 0;
+    response.generation_time = 0.0;
     
-    if (response.success) {
-        // 模拟流式输出，将文本分割成单词
-        std::istringstream iss(response.text);
-        std::string token;
+    auto start_time = std::chrono::steady_clock::now();
+    auto elapsed = [&start_time]() {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    };
+    
+    try {
+        auto& config = Config::instance();
+        const std::string base_url = pimpl_->base_url();
         
-        while (iss >> token) {
-            if (!callback(token + " ")) {
-                return false; // 回调返回false表示停止
+        if (!config.is_llama_enabled()) {
+            response.error_message = "LLaMA integration is disabled";
+        } else if (base_url.empty()) {
+            response.error_message = "No model loaded";
+        } else {
+            httplib::Request req;
+            req.method = "POST";
+            req.path = "/completion";
+            req.headers.emplace("Content-Type", "application/json");
+            req.headers.emplace("Accept", "text/event-stream");
+            req.body = build_completion_body(request, true).dump();
+            
+            int status = 0;
+            bool cancelled = false;
+            std::string buffer, error_body;
+            req.response_handler = [&status](const httplib::Response& r) {
+                status = r.status;
+                return true;
+            };
+            
+            // llama-server以SSE逐token推送：每个事件一行 "data: {...}"
+            req.content_receiver = [&](const char* data, size_t length, uint64_t, uint64_t) {
+                if (status != 200) {
+                    error_body.append(data, length);
+                    return true;
+                }
+                
+                buffer.append(data, length);
+                size_t start = 0, end;
+                while ((end = buffer.find('\n', start)) != std::string::npos) {
+                    std::string_view line(buffer.data() + start, end - start);
+                    start = end + 1;
+                    if (!line.empty() && line.back() == '\r') {
+                        line.remove_suffix(1);
+                    }
+                    if (line.substr(0, 6) != "data: ") {
+                        continue;
+                    }
+                    
+                    auto event = nlohmann::json::parse(line.substr(6), nullptr, false);
+                    if (event.is_discarded()) {
+                        continue;
+                    }
+                    
+                    const std::string token = event.value("content", "");
+                    if (!token.empty()) {
+                        if (response.tokens_generated == 0) {
+                            response.time_to_first_token = elapsed();
+                        }
+                        response.text += token;
+                        response.tokens_generated++;
+                        // 回调返回false（客户端断开）时中止请求，llama-server检测到断开后停止生成
+                        if (!callback(token)) {
+                            cancelled = true;
+                            return false;
+                        }
+                    }
+                    if (event.value("stop", false)) {
+                        response.tokens_generated = event.value("tokens_predicted", response.tokens_generated);
+                    }
+                }
+                buffer.erase(0, start);
+                return true;
+            };
+            
+            auto client = Impl::make_client(base_url, config.get_llama_request_timeout());
+            auto res = client->send(req);
+            
+            if (cancelled) {
+                response.error_message = "Generation cancelled";
+            } else if (!res) {
+                response.error_message = "Failed to connect to LLaMA server";
+            } else if (status != 200) {
+                response.error_message = "LLaMA server returned status " + std::to_string(status) + ": " + error_body;
+            } else {
+                response.success = true;
             }
-            std::this_thread::sleep_for(std::chrono::milliseconds(50)); // 模拟延迟
         }
         
-        return true;
+    } catch (const std::exception& e) {
+        response.error_message = "Exception during generation: " + std::string(e.what());
+        spdlog::error("LLaMA stream generation error: {}", e.what());
     }
     
-    return false;
+    response.generation_time = elapsed();
+    
+    {
+        std::lock_guard<std::mutex> lock(pimpl_->mutex_);
+        pimpl_->stats_.update(response);
+    }
+    
+    return response;
 }
 
 ModelInfo LlamaClient::get_model_info() const {
@@ -322,6 +770,8 @@ nlohmann::json LlamaClient::get_config() const {
     j["enabled"] = config.is_llama_enabled();
     j["model_path"] = config.get_llama_model_path();
     j["executable_path"] = config.get_llama_executable_path();
+    j["server_url"] = config.get_llama_server_url();
+    j["server_port"] = config.get_llama_server_port();
     j["context_size"] = config.get_llama_context_size();
     j["threads"] = config.get_llama_threads();
     j["temperature"] = config.get_llama_temperature();
@@ -337,28 +787,14 @@ bool LlamaClient::health_check() {
         return false;
     }
     
-    // 检查可执行文件
-    std::string executable_path = config.get_llama_executable_path();
-#ifdef _WIN32
-    if (_access(executable_path.c_str(), 0) != 0) {
-#else
-    if (access(executable_path.c_str(), X_OK) != 0) {
-#endif
+    const std::string base_url = pimpl_->base_url();
+    if (base_url.empty()) {
         return false;
     }
     
-    // 检查模型文件（如果已加载）
-    if (pimpl_->model_loaded_) {
-#ifdef _WIN32
-        if (_access(pimpl_->model_path_.c_str(), 0) != 0) {
-#else
-        if (access(pimpl_->model_path_.c_str(), F_OK) != 0) {
-#endif
-            return false;
-        }
-    }
-    
-    return true;
+    auto client = Impl::make_client(base_url, 2);
+    auto res = client->Get("/health");
+    return res && res->status == 200;
 }
 
 nlohmann::json LlamaClient::get_statistics() {
@@ -371,88 +807,50 @@ void LlamaClient::reset_statistics() {
     pimpl_->stats_.reset();
 }
 
-std::string LlamaClient::escape_shell_arg(const std::string& arg) {
-    std::string escaped = "'";
-    for (char c : arg) {
-        if (c == '\'') {
-            escaped += "'\"'\"'";
-        } else {
-            escaped += c;
-        }
-    }
-    escaped += "'";
-    return escaped;
-}
-
-std::vector<std::string> LlamaClient::build_command_args(const LlamaRequest& request) {
+std::vector<std::string> LlamaClient::build_server_args(const std::string& model_path) {
     auto& config = Config::instance();
     std::vector<std::string> args;
     
     // 模型文件
     args.push_back("-m");
-    args.push_back(pimpl_->model_path_);
+    args.push_back(model_path);
     
-    // 上下文大小
+    // llama-server把总上下文平分给各槽位，按槽位数放大使每个请求都有完整的上下文
+    const int slots = config.get_llama_parallel_slots();
     args.push_back("-c");
-    args.push_back(std::to_string(config.get_llama_context_size()));
+    args.push_back(std::to_string(config.get_llama_context_size() * slots));
+    
+    // 并行槽位 + 连续批处理：并发请求在同一批次中解码
+    args.push_back("-np");
+    args.push_back(std::to_string(slots));
+    args.push_back("-cb");
     
     // 线程数
     args.push_back("-t");
     args.push_back(std::to_string(config.get_llama_threads()));
     
-    // 生成参数
-    args.push_back("-n");
-    args.push_back(std::to_string(request.max_tokens));
-    
-    args.push_back("--temp");
-    args.push_back(std::to_string(request.temperature));
+    // 只监听本机回环地址
+    args.push_back("--host");
+    args.push_back("127.0.0.1");
     
-    args.push_back("--top-p");
-    args.push_back(std::to_string(request.top_p));
+    args.push_back("--port");
+    args.push_back(std::to_string(config.get_llama_server_port()));
     
-    args.push_back("--top-k");
-    args.push_back(std::to_string(request.top_k));
-    
-    // 停止序列
-    for (const auto& stop : request.stop_sequences) {
-        args.push_back("--reverse-prompt");
-        args.push_back(stop);
+    // 语义检索使用本地模型计算向量时需要开启/embedding接口
+    if (config.get_embedding_provider() == "llama") {
+        args.push_back("--embedding");
     }
     
-    // 提示词
-    args.push_back("-p");
-    args.push_back(request.prompt);
-    
-    // 其他选项
-    args.push_back("--no-display-prompt");
-    
     return args;
 }
 
-LlamaResponse LlamaClient::parse_output(const std::string& output, double generation_time) {
+LlamaResponse LlamaClient::parse_completion(const nlohmann::json& body, double generation_time) {
     LlamaResponse response;
     response.success = true;
     response.generation_time = generation_time;
-    
-    // 简单的输出解析
-    // 在实际应用中，这需要根据llama.cpp的具体输出格式进行调整
-    response.text = output;
-    
-    // 移除可能的调试信息和提示词
-    std::regex prompt_regex(R"(^.*?\n\n)");
-    response.text = std::regex_replace(response.text, prompt_regex, "");
-    
-    // 估算生成的token数量（简单的单词计数）
-    std::istringstream iss(response.text);
-    std::string word;
-    response.tokens_generated = 0;
-    while (iss >> word) {
-        response.tokens_generated++;
-    }
-    
-    // 清理输出
-    response.text = std::regex_replace(response.text, std::regex("\n+$"), "");
-    
+    response.text = body.value("content", "");
+    response.tokens_generated = body.value("tokens_predicted", 0);
+    response.error_message = "";
     return response;
 }
 
@@ -469,26 +867,49 @@ bool LlamaService::start() {
         return true;
     }
     
-    client_ = std::make_unique<LlamaClient>();
+    client_ = std::make_shared<LlamaClient>();
     if (!client_->initialize()) {
         client_.reset();
         return false;
     }
     
+    auto& config = Config::instance();
+    queue_ = std::make_shared<GenerationQueue>(config.get_llama_parallel_slots(),
+                                               config.get_llama_queue_capacity());
+    
+    if (config.is_llama_cache_enabled()) {
+        ResponseCacheOptions options;
+        options.memory_bytes = static_cast<size_t>(config.get_llama_cache_memory_mb()) * 1024 * 1024;
+        options.disk_path = config.get_llama_cache_disk_path();
+        options.disk_bytes = static_cast<size_t>(config.get_llama_cache_disk_mb()) * 1024 * 1024;
+        options.ttl = std::chrono::seconds(config.get_llama_cache_ttl());
+        cache_ = std::make_shared<ResponseCache>(options);
+    }
+    
     running_ = true;
     spdlog::info("LLaMA service started");
     return true;
 }
 
 bool LlamaService::stop() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    if (!running_) {
-        return true;
+    std::shared_ptr<GenerationQueue> queue;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        
+        if (!running_) {
+            return true;
+        }
+        
+        queue = std::move(queue_);
+        client_.reset();
+        cache_.reset();
+        running_ = false;
     }
     
-    client_.reset();
-    running_ = false;
+    // 在锁外关闭队列：未执行的请求立即返回错误，执行中的请求需要更新统计
+    if (queue) {
+        queue->shutdown();
+    }
     
     spdlog::info("LLaMA service stopped");
     return true;
@@ -504,26 +925,144 @@ bool LlamaService::is_running() const {
     return running_;
 }
 
+bool LlamaService::load_model(const std::string& model_path) {
+    std::shared_ptr<LlamaClient> client;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        client = client_;
+    }
+    return client && client->load_model(model_path);
+}
+
+bool LlamaService::unload_model() {
+    std::shared_ptr<LlamaClient> client;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        client = client_;
+    }
+    return client && client->unload_model();
+}
+
 LlamaResponse LlamaService::process_request(const LlamaRequest& request) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    return submit(request, nullptr).get();
+}
+
+LlamaResponse LlamaService::process_stream_request(const LlamaRequest& request,
+                                                   std::function<bool(const std::string& token)> callback) {
+    return submit(request, std::move(callback)).get();
+}
+
+std::future<LlamaResponse> LlamaService::process_request_async(const LlamaRequest& request) {
+    return submit(request, nullptr);
+}
+
+std::future<LlamaResponse> LlamaService::submit(const LlamaRequest& request,
+                                                std::function<bool(const std::string& token)> callback) {
+    auto promise = std::make_shared<std::promise<LlamaResponse>>();
+    auto future = promise->get_future();
     
-    if (!running_ || !client_) {
+    auto fail = [&promise](const std::string& message) {
         LlamaResponse response;
         response.success = false;
-        response.error_message = "LLaMA service is not running";
-        return response;
+        response.tokens_generated = 0;
+        response.generation_time = 0.0;
+        response.error_message = message;
+        promise->set_value(std::move(response));
+    };
+    
+    std::shared_ptr<LlamaClient> client;
+    std::shared_ptr<GenerationQueue> queue;
+    std::shared_ptr<ResponseCache> cache;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_ || !client_ || !queue_) {
+            fail("LLaMA service is not running");
+            return future;
+        }
+        client = client_;
+        queue = queue_;
+        cache = cache_;
     }
     
-    auto response = client_->generate(request);
-    stats_.update(response);
+    // 命中缓存时不进入队列；流式请求把缓存的全文作为一个token回调
+    const std::string cache_key = cache ? response_cache_key(client->get_model_info(), request) : "";
+    if (!cache_key.empty()) {
+        auto entry = cache->get(cache_key);
+        auto cached = entry ? nlohmann::json::parse(*entry, nullptr, false) : nlohmann::json();
+        const bool hit = cached.is_object() && cached.contains("text");
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (hit) {
+                stats_.cache_hits++;
+            } else {
+                stats_.cache_misses++;
+            }
+        }
+        
+        if (hit) {
+            LlamaResponse response;
+            response.success = true;
+            response.text = cached["text"].get<std::string>();
+            response.tokens_generated = cached.value("tokens_generated", 0);
+            response.generation_time = 0.0;
+            response.cached = true;
+            if (callback && !response.text.empty()) {
+                callback(response.text);
+            }
+            promise->set_value(std::move(response));
+            return future;
+        }
+    }
     
-    return response;
+    // 在锁外提交；stop()之后提交到已关闭的队列会被拒绝
+    const bool accepted = queue->submit(request.priority,
+        [this, client, cache, cache_key, request, callback = std::move(callback), promise](bool run) {
+            if (!run) {
+                LlamaResponse response;
+                response.success = false;
+                response.tokens_generated = 0;
+                response.generation_time = 0.0;
+                response.error_message = "LLaMA service is stopping";
+                promise->set_value(std::move(response));
+                return;
+            }
+            
+            auto response = callback ? client->generate_stream(request, callback) : client->generate(request);
+            if (response.success && !cache_key.empty()) {
+                cache->put(cache_key, nlohmann::json{
+                    {"text", response.text},
+                    {"tokens_generated", response.tokens_generated}
+                }.dump());
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stats_.update(response);
+            }
+            promise->set_value(std::move(response));
+        });
+    
+    if (!accepted) {
+        fail("LLaMA request queue is full");
+    }
+    return future;
 }
 
-std::future<LlamaResponse> LlamaService::process_request_async(const LlamaRequest& request) {
-    return std::async(std::launch::async, [this, request]() {
-        return process_request(request);
-    });
+std::optional<std::vector<float>> LlamaService::embed(const std::string& text) {
+    std::shared_ptr<LlamaClient> client;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        client = client_;
+    }
+    return client ? client->embed(text) : std::nullopt;
+}
+
+std::string LlamaService::get_model_path() const {
+    std::shared_ptr<LlamaClient> client;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        client = client_;
+    }
+    return client ? client->get_model_info().model_path : "";
 }
 
 bool LlamaService::update_config(const nlohmann::json& config) {
@@ -536,17 +1075,33 @@ bool LlamaService::update_config(const nlohmann::json& config) {
     return true;
 }
 
-nlohmann::json LlamaService::get_status() {
+nlohmann::json LlamaService::get_statistics() {
     std::lock_guard<std::mutex> lock(mutex_);
-    
+    nlohmann::json stats = stats_.to_json();
+    if (queue_) {
+        stats["queue"] = queue_->get_statistics();
+    }
+    if (cache_) {
+        stats["cache"] = cache_->get_statistics();
+    }
+    return stats;
+}
+
+nlohmann::json LlamaService::get_status() {
     nlohmann::json status;
-    status["running"] = running_;
-    status["statistics"] = stats_.to_json();
+    status["statistics"] = get_statistics();
+    std::shared_ptr<LlamaClient> client;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        status["running"] = running_;
+        client = client_;
+    }
     
-    if (client_) {
-        status["model_info"] = client_->get_model_info().to_json();
-        status["config"] = client_->get_config();
-        status["health"] = client_->health_check();
+    // 健康检查需要访问llama-server，在锁外进行
+    if (client) {
+        status["model_info"] = client->get_model_info().to_json();
+        status["config"] = client->get_config();
+        status["health"] = client->health_check();
     }
     
     return status;
@@ -570,11 +1125,26 @@ nlohmann::json LlamaService::Statistics::to_json() const {
         j["average_tokens_per_request"] = static_cast<double>(total_tokens_generated) / successful_requests;
     }
     
+    j["streaming_requests"] = streaming_requests;
+    if (streaming_requests > 0) {
+        j["average_time_to_first_token"] = total_time_to_first_token / streaming_requests;
+    }
+    
+    j["cache_hits"] = cache_hits;
+    j["cache_misses"] = cache_misses;
+    if (cache_hits + cache_misses > 0) {
+        j["cache_hit_rate"] = static_cast<double>(cache_hits) / (cache_hits + cache_misses);
+    }
+    
     return j;
 }
 
 void LlamaService::Statistics::update(const LlamaResponse& response) {
     total_requests++;
+    if (response.time_to_first_token > 0.0) {
+        streaming_requests++;
+        total_time_to_first_token += response.time_to_first_token;
+    }
     if (response.success) {
         successful_requests++;
         total_tokens_generated += response.tokens_generated;
@@ -590,6 +1160,10 @@ void LlamaService::Statistics::reset() {
     failed_requests = 0;
     total_generation_time = 0.0;
     total_tokens_generated = 0;
+    streaming_requests = 0;
+    total_time_to_first_token = 0.0;
+    cache_hits = 0;
+    cache_misses = 0;
 }
 
 } // namespace mcp
\ No newline at end of file
@@ -2,6 +2,8 @@
 #include <memory>
 #include <signal.h>
 #include <filesystem>
+#include <thread>
+#include <algorithm>
 #include <spdlog/spdlog.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/sinks/rotating_file_sink.h>
@@ -11,6 +13,7 @@
 #include "content_manager.hpp"
 #include "mcp_server.hpp"
 #include "http_handler.hpp"
+#include "stdio_transport.hpp"
 
 using namespace mcp;
 
@@ -28,12 +31,17 @@ void signal_handler(int signal) {
     }
 }
 
-// 设置日志系统
-void setup_logging(const Config& config) {
+// 设置日志系统；stdio模式下stdout用于协议数据，控制台日志改为输出到stderr
+void setup_logging(const Config& config, bool stdio_mode) {
     std::vector<spdlog::sink_ptr> sinks;
     
     // 控制台输出 (默认启用)
-    auto console_sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
+    spdlog::sink_ptr console_sink;
+    if (stdio_mode) {
+        console_sink = std::make_shared<spdlog::sinks::stderr_color_sink_mt>();
+    } else {
+        console_sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
+    }
     console_sink->set_level(spdlog::level::from_str(config.get_log_level()));
     sinks.push_back(console_sink);
     
@@ -92,10 +100,18 @@ void print_startup_info(const Config& config) {
 
 int main(int argc, char* argv[]) {
     try {
-        // 解析命令行参数
+        // 解析命令行参数：[--stdio] [--config] [config.json]
         std::string config_file = "config.json";
-        if (argc > 1) {
-            config_file = argv[1];
+        bool stdio_mode = false;
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            if (arg == "--stdio") {
+                stdio_mode = true;
+            } else if (arg == "--config" && i + 1 < argc) {
+                config_file = argv[++i];
+            } else {
+                config_file = arg;
+            }
         }
         
         // 加载配置
@@ -106,11 +122,11 @@ int main(int argc, char* argv[]) {
                 return 1;
             }
         } else {
-            std::cout << "Config file not found: " << config_file << ", using defaults" << std::endl;
+            std::cerr << "Config file not found: " << config_file << ", using defaults" << std::endl;
         }
         
         // 设置日志系统
-        setup_logging(config);
+        setup_logging(config, stdio_mode);
         
         // 打印启动信息
         print_startup_info(config);
@@ -120,7 +136,15 @@ int main(int argc, char* argv[]) {
         
         // 初始化数据库
         spdlog::info("Initializing database...");
-        auto database = std::make_shared<Database>(config.get_database_path());
+        DatabaseOptions db_options;
+        db_options.reader_connections = config.get_database_reader_connections() > 0
+            ? static_cast<size_t>(config.get_database_reader_connections())
+            : std::max(2u, std::thread::hardware_concurrency());
+        db_options.busy_timeout_ms = config.get_database_busy_timeout_ms();
+        db_options.mmap_size = config.get_database_mmap_size();
+        db_options.search_count_cache_size = static_cast<size_t>(config.get_database_search_count_cache_size());
+        db_options.write_batch_size = static_cast<size_t>(config.get_database_write_batch_size());
+        auto database = std::make_shared<Database>(config.get_database_path(), db_options);
         if (!database->initialize()) {
             spdlog::error("Failed to initialize database");
             return 1;
@@ -129,12 +153,15 @@ int main(int argc, char* argv[]) {
         
         // 初始化内容管理器
         spdlog::info("Initializing content manager...");
-        auto content_manager = std::make_shared<ContentManager>(database);
+        auto content_manager = std::make_shared<ContentManager>(
+            database, static_cast<size_t>(config.get_content_cache_mb()) * 1024 * 1024,
+            static_cast<size_t>(config.get_content_cache_shards()));
         spdlog::info("Content manager initialized successfully");
         
         // 初始化MCP服务器
         spdlog::info("Initializing MCP server...");
-        auto mcp_server = std::make_shared<MCPServer>(content_manager);
+        auto mcp_server = std::make_shared<MCPServer>(
+            content_manager, static_cast<size_t>(config.get_mcp_batch_workers()));
         spdlog::info("MCP server initialized successfully");
         
         // 初始化HTTP处理器
@@ -152,6 +179,22 @@ int main(int argc, char* argv[]) {
         signal(SIGINT, signal_handler);
         signal(SIGTERM, signal_handler);
         
+        // stdio模式：不监听端口，通过标准输入输出与客户端通信，输入关闭后退出
+        if (stdio_mode) {
+            StdioTransport transport(mcp_server, std::cin, std::cout);
+            transport.start();
+            while (g_running && !transport.finished()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+            
+            spdlog::info("Shutting down server...");
+            transport.stop();
+            g_http_handler->stop();
+            g_http_handler.reset();
+            spdlog::info("Server shutdown complete");
+            return 0;
+        }
+        
         // 启动HTTP服务器
         spdlog::info("Starting HTTP server...");
         if (!g_http_handler->start(config.get_host(), config.get_port())) {
@@ -1,8 +1,24 @@
 #include "mcp_server.hpp"
 #include <spdlog/spdlog.h>
+#include <algorithm>
+#include <condition_variable>
 
 namespace mcp {
 
+namespace {
+
+// resources/list每页返回的文档数
+constexpr size_t kResourcesPageSize = 100;
+
+nlohmann::json jsonrpc_error(const nlohmann::json &id, int code,
+                             const std::string &message) {
+  return {{"jsonrpc", "2.0"},
+          {"id", id},
+          {"error", {{"code", code}, {"message", message}}}};
+}
+
+} // namespace
+
 // MCPTool JSON转换
 nlohmann::json MCPTool::to_json() const {
   nlohmann::json j;
@@ -23,8 +39,10 @@ nlohmann::json MCPResource::to_json() const {
 }
 
 // MCPServer实现
-MCPServer::MCPServer(std::shared_ptr<ContentManager> content_manager)
-    : content_manager_(std::move(content_manager)) {
+MCPServer::MCPServer(std::shared_ptr<ContentManager> content_manager,
+                     size_t batch_workers)
+    : content_manager_(std::move(content_manager)),
+      batch_executor_(std::make_unique<TaskExecutor>(batch_workers)) {
   initialize_tools();
 }
 
@@ -59,7 +77,12 @@ void MCPServer::initialize_tools() {
   get_tool.input_schema = {
       {"type", "object"},
       {"properties",
-       {{"id", {{"type", "integer"}, {"description", "Content ID"}}}}},
+       {{"id", {{"type", "integer"}, {"description", "Content ID"}}},
+        {"fields",
+         {{"type", "string"},
+          {"description", "Comma-separated fields to return (id, title, "
+                          "content, content_type, tags, metadata, "
+                          "created_at, updated_at, preview) or 'summary'"}}}}},
       {"required", {"id"}}};
   tools_[get_tool.name] = get_tool;
   tool_handlers_[get_tool.name] = [this](const nlohmann::json &args) {
@@ -111,18 +134,54 @@ void MCPServer::initialize_tools() {
       {"type", "object"},
       {"properties",
        {{"query", {{"type", "string"}, {"description", "Search query"}}},
+        {"cursor",
+         {{"type", "string"},
+          {"description", "Opaque cursor from a previous next_cursor; "
+                          "overrides page"}}},
         {"page",
          {{"type", "integer"}, {"description", "Page number"}, {"default", 1}}},
         {"page_size",
          {{"type", "integer"},
           {"description", "Items per page"},
-          {"default", 20}}}}},
+          {"default", 20}}},
+        {"fields",
+         {{"type", "string"},
+          {"description", "Comma-separated fields to return (id, title, "
+                          "content, content_type, tags, metadata, "
+                          "created_at, updated_at, preview) or 'summary'"}}}}},
       {"required", {"query"}}};
   tools_[search_tool.name] = search_tool;
   tool_handlers_[search_tool.name] = [this](const nlohmann::json &args) {
     return tool_search_content(args);
   };
 
+  // 语义搜索工具
+  MCPTool semantic_tool;
+  semantic_tool.name = "semantic_search";
+  semantic_tool.description =
+      "Search content by meaning using embeddings, optionally combined with "
+      "keyword ranking";
+  semantic_tool.input_schema = {
+      {"type", "object"},
+      {"properties",
+       {{"query",
+         {{"type", "string"}, {"description", "Natural language query"}}},
+        {"limit",
+         {{"type", "integer"},
+          {"description", "Maximum number of results"},
+          {"default", 10}}},
+        {"mode",
+         {{"type", "string"},
+          {"description", "hybrid fuses vector and keyword rankings, vector "
+                          "uses similarity only"},
+          {"enum", {"hybrid", "vector"}},
+          {"default", "hybrid"}}}}},
+      {"required", {"query"}}};
+  tools_[semantic_tool.name] = semantic_tool;
+  tool_handlers_[semantic_tool.name] = [this](const nlohmann::json &args) {
+    return tool_semantic_search(args);
+  };
+
   // 列出内容工具
   MCPTool list_tool;
   list_tool.name = "list_content";
@@ -130,12 +189,23 @@ void MCPServer::initialize_tools() {
   list_tool.input_schema = {
       {"type", "object"},
       {"properties",
-       {{"page",
+       {{"tag",
+         {{"type", "string"}, {"description", "Only list content with this tag"}}},
+        {"cursor",
+         {{"type", "string"},
+          {"description", "Opaque cursor from a previous next_cursor; "
+                          "overrides page"}}},
+        {"page",
          {{"type", "integer"}, {"description", "Page number"}, {"default", 1}}},
         {"page_size",
          {{"type", "integer"},
           {"description", "Items per page"},
-          {"default", 20}}}}}};
+          {"default", 20}}},
+        {"fields",
+         {{"type", "string"},
+          {"description", "Comma-separated fields to return (id, title, "
+                          "content, content_type, tags, metadata, "
+                          "created_at, updated_at, preview) or 'summary'"}}}}}};
   tools_[list_tool.name] = list_tool;
   tool_handlers_[list_tool.name] = [this](const nlohmann::json &args) {
     return tool_list_content(args);
@@ -175,13 +245,71 @@ void MCPServer::initialize_tools() {
   tool_handlers_[export_tool.name] = [this](const nlohmann::json &args) {
     return tool_export_content(args);
   };
+
+  // 后台任务工具
+  MCPTool submit_job_tool;
+  submit_job_tool.name = "submit_job";
+  submit_job_tool.description =
+      "Submit a background job (parse_document or bulk_import) and return "
+      "its id immediately";
+  submit_job_tool.input_schema = {
+      {"type", "object"},
+      {"properties",
+       {{"type",
+         {{"type", "string"},
+          {"description", "Job type"},
+          {"enum", {"parse_document", "bulk_import"}}}},
+        {"params",
+         {{"type", "object"},
+          {"description",
+           "Job parameters: parse_document takes file_id/file_path and "
+           "ai_service; bulk_import takes a content array"}}}}},
+      {"required", {"type"}}};
+  tools_[submit_job_tool.name] = submit_job_tool;
+  tool_handlers_[submit_job_tool.name] = [this](const nlohmann::json &args) {
+    return tool_submit_job(args);
+  };
+
+  MCPTool get_job_tool;
+  get_job_tool.name = "get_job";
+  get_job_tool.description =
+      "Get the status, progress and result of a background job";
+  get_job_tool.input_schema = {
+      {"type", "object"},
+      {"properties",
+       {{"id", {{"type", "string"}, {"description", "Job ID"}}}}},
+      {"required", {"id"}}};
+  tools_[get_job_tool.name] = get_job_tool;
+  tool_handlers_[get_job_tool.name] = [this](const nlohmann::json &args) {
+    return tool_get_job(args);
+  };
+
+  MCPTool list_jobs_tool;
+  list_jobs_tool.name = "list_jobs";
+  list_jobs_tool.description = "List recent background jobs";
+  list_jobs_tool.input_schema = {
+      {"type", "object"},
+      {"properties",
+       {{"status",
+         {{"type", "string"},
+          {"description",
+           "Only list jobs with this status (queued, running, succeeded, "
+           "failed, cancelled)"}}},
+        {"limit",
+         {{"type", "integer"},
+          {"description", "Maximum number of jobs"},
+          {"default", 20}}}}}};
+  tools_[list_jobs_tool.name] = list_jobs_tool;
+  tool_handlers_[list_jobs_tool.name] = [this](const nlohmann::json &args) {
+    return tool_list_jobs(args);
+  };
 }
 
 nlohmann::json MCPServer::handle_initialize(const nlohmann::json &params) {
   nlohmann::json response;
   response["protocolVersion"] = "2024-11-05";
   response["capabilities"] = {{"tools", nlohmann::json::object()},
-                              {"resources", nlohmann::json::object()}};
+                              {"resources", {{"listChanged", true}}}};
   response["serverInfo"] = {{"name", "Local Content MCP Server"},
                             {"version", "1.0.0"}};
 
@@ -213,6 +341,18 @@ nlohmann::json MCPServer::handle_call_tool(const std::string &tool_name,
   }
 
   try {
+    // get_content直接复用缓存中已序列化的响应，命中时不访问数据库也不构造JSON
+    if (tool_name == "get_content" && arguments.contains("id") &&
+        arguments["id"].is_number_integer() && !arguments.contains("fields")) {
+      auto cached =
+          content_manager_->get_cached_content(arguments["id"].get<int64_t>());
+      if (cached) {
+        nlohmann::json response;
+        response["content"] = {{{"type", "text"}, {"text", cached->response}}};
+        return response;
+      }
+    }
+
     auto result = it->second(arguments);
 
     nlohmann::json response;
@@ -227,61 +367,104 @@ nlohmann::json MCPServer::handle_call_tool(const std::string &tool_name,
   }
 }
 
-nlohmann::json MCPServer::handle_list_resources() {
+nlohmann::json MCPServer::handle_list_resources(const nlohmann::json &params) {
   nlohmann::json resources_array = nlohmann::json::array();
 
-  // 添加内容资源
-  MCPResource content_resource;
-  content_resource.uri = "content://all";
-  content_resource.name = "All Content";
-  content_resource.description = "All content items in the database";
-  content_resource.mime_type = "application/json";
-  resources_array.push_back(content_resource.to_json());
-
-  // 添加统计资源
-  MCPResource stats_resource;
-  stats_resource.uri = "stats://summary";
-  stats_resource.name = "Content Statistics";
-  stats_resource.description = "Summary statistics of the content database";
-  stats_resource.mime_type = "application/json";
-  resources_array.push_back(stats_resource.to_json());
-
-  // 添加文档资源
+  // 游标为上一页最后一个文档的id，不透明地交给客户端原样传回
+  int64_t after_id = 0;
+  const std::string cursor =
+      params.is_object() ? params.value("cursor", "") : std::string();
+  if (!cursor.empty()) {
+    if (cursor.size() > 19 ||
+        !std::all_of(cursor.begin(), cursor.end(),
+                     [](char ch) { return ch >= '0' && ch <= '9'; })) {
+      return create_error_response(-1, "Invalid cursor");
+    }
+    after_id = std::stoll(cursor);
+  } else {
+    // 固定资源只在第一页返回
+    MCPResource content_resource;
+    content_resource.uri = "content://all";
+    content_resource.name = "All Content";
+    content_resource.description = "Index of all content items (id, title, updated_at)";
+    content_resource.mime_type = "application/json";
+    resources_array.push_back(content_resource.to_json());
+
+    MCPResource stats_resource;
+    stats_resource.uri = "stats://summary";
+    stats_resource.name = "Content Statistics";
+    stats_resource.description = "Summary statistics of the content database";
+    stats_resource.mime_type = "application/json";
+    resources_array.push_back(stats_resource.to_json());
+  }
+
+  // 文档资源按id分页，只读取id和标题，多取一条判断是否还有下一页
+  nlohmann::json response;
   try {
-    auto content_list = content_manager_->list_content(1, 1000); // 获取所有内容
-    if (content_list.contains("content") &&
-        content_list["content"].is_array()) {
-      for (const auto &item : content_list["content"]) {
-        if (item.contains("id") && item.contains("title")) {
-          MCPResource doc_resource;
-          doc_resource.uri =
-              "document://" + std::to_string(item["id"].get<int>());
-          doc_resource.name = item["title"].get<std::string>();
-          doc_resource.description =
-              "Document: " + item["title"].get<std::string>();
-          doc_resource.mime_type = "text/plain";
-          resources_array.push_back(doc_resource.to_json());
-        }
-      }
+    auto summaries = content_manager_->list_content_summaries(
+        after_id, static_cast<int>(kResourcesPageSize) + 1);
+    const bool has_more = summaries.size() > kResourcesPageSize;
+    if (has_more) {
+      summaries.resize(kResourcesPageSize);
+    }
+
+    for (const auto &summary : summaries) {
+      MCPResource doc_resource;
+      doc_resource.uri = "document://" + std::to_string(summary.id);
+      doc_resource.name = summary.title;
+      doc_resource.description = "Document: " + summary.title;
+      doc_resource.mime_type = "text/plain";
+      resources_array.push_back(doc_resource.to_json());
+    }
+    if (has_more) {
+      response["nextCursor"] = std::to_string(summaries.back().id);
     }
   } catch (const std::exception &e) {
     spdlog::warn("Failed to load document resources: {}", e.what());
   }
 
-  nlohmann::json response;
   response["resources"] = resources_array;
 
   return response;
 }
 
+std::optional<nlohmann::json>
+MCPServer::wait_for_notification(uint64_t &version,
+                                 std::chrono::milliseconds timeout) {
+  // 多次变更合并为一条通知，客户端收到后重新拉取列表即可
+  const uint64_t latest = content_manager_->wait_for_change(version, timeout);
+  if (latest == version) {
+    return std::nullopt;
+  }
+  version = latest;
+  return nlohmann::json{{"jsonrpc", "2.0"},
+                        {"method", "notifications/resources/list_changed"}};
+}
+
 nlohmann::json MCPServer::handle_read_resource(const std::string &uri) {
   nlohmann::json response;
 
   if (uri == "content://all") {
-    auto result = content_manager_->list_content(1, 100);
+    // 只列出摘要，正文通过document://{id}按需读取
+    nlohmann::json items = nlohmann::json::array();
+    int64_t after_id = 0;
+    while (true) {
+      auto summaries = content_manager_->list_content_summaries(
+          after_id, static_cast<int>(kResourcesPageSize) * 10);
+      if (summaries.empty()) {
+        break;
+      }
+      for (const auto &summary : summaries) {
+        items.push_back({{"id", summary.id},
+                         {"title", summary.title},
+                         {"updated_at", summary.updated_at}});
+      }
+      after_id = summaries.back().id;
+    }
+    nlohmann::json result = {{"items", items}, {"count", items.size()}};
     response["contents"] = {{{"uri", uri},
                              {"mimeType", "application/json"},
-                             {"text", result.dump(2)}}};
+                             {"text", result.dump()}}};
   } else if (uri == "stats://summary") {
     auto result = content_manager_->get_statistics();
     response["contents"] = {{{"uri", uri},
@@ -291,16 +474,13 @@ nlohmann::json MCPServer::handle_read_resource(const std::string &uri) {
     // 处理文档资源
     std::string id_str = uri.substr(11); // 移除 "document://" 前缀
     try {
-      int content_id = std::stoi(id_str);
-      nlohmann::json args;
-      args["id"] = content_id;
-      auto result = content_manager_->get_content(content_id);
-
-      if (result.contains("content")) {
-        response["contents"] = {
-            {{"uri", uri},
-             {"mimeType", "text/plain"},
-             {"text", result["content"].get<std::string>()}}};
+      int64_t content_id = std::stoll(id_str);
+      auto cached = content_manager_->get_cached_content(content_id);
+
+      if (cached) {
+        response["contents"] = {{{"uri", uri},
+                                 {"mimeType", "text/plain"},
+                                 {"text", cached->content}}};
       } else {
         return create_error_response(-1, "Document not found: " + uri);
       }
@@ -315,6 +495,158 @@ nlohmann::json MCPServer::handle_read_resource(const std::string &uri) {
 }
 
 nlohmann::json MCPServer::handle_request(const nlohmann::json &request) {
+  const auto start = std::chrono::steady_clock::now();
+  auto response = route_request(request);
+  const double elapsed_ms = std::chrono::duration<double, std::milli>(
+                                std::chrono::steady_clock::now() - start)
+                                .count();
+
+  std::string method = "invalid";
+  if (request.is_object() && request.contains("method") &&
+      request["method"].is_string()) {
+    method = request["method"].get<std::string>();
+    if (method == "tools/call" && request.contains("params") &&
+        request["params"].is_object() && request["params"].contains("name") &&
+        request["params"]["name"].is_string()) {
+      method += ":" + request["params"]["name"].get<std::string>();
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(stats_mutex_);
+  auto &stats = method_stats_[method];
+  stats.calls++;
+  if (response.contains("error")) {
+    stats.errors++;
+  }
+  stats.total_ms += elapsed_ms;
+  stats.max_ms = std::max(stats.max_ms, elapsed_ms);
+  return response;
+}
+
+nlohmann::json MCPServer::handle_envelope(const nlohmann::json &request) {
+  if (!request.is_object()) {
+    return jsonrpc_error(nullptr, -32600, "Invalid Request");
+  }
+
+  auto response = handle_request(request);
+  if (!request.contains("id")) {
+    return nullptr;
+  }
+
+  nlohmann::json envelope = {{"jsonrpc", "2.0"}, {"id", request["id"]}};
+  if (response.contains("error")) {
+    envelope["error"] = std::move(response["error"]);
+  } else {
+    envelope["result"] = std::move(response);
+  }
+  return envelope;
+}
+
+nlohmann::json MCPServer::handle_message(const nlohmann::json &message) {
+  nlohmann::json responses = nlohmann::json::array();
+  dispatch_message(message, [&responses](const nlohmann::json &response) {
+    responses.push_back(response);
+  });
+
+  if (responses.empty()) {
+    return nullptr;
+  }
+  // 空批量按规范返回单个错误对象
+  if (!message.is_array() || message.empty()) {
+    return responses[0];
+  }
+  return responses;
+}
+
+void MCPServer::dispatch_message(
+    const nlohmann::json &message,
+    const std::function<void(const nlohmann::json &)> &emit) {
+  if (!message.is_array()) {
+    auto response = handle_envelope(message);
+    if (!response.is_null()) {
+      emit(response);
+    }
+    return;
+  }
+  if (message.empty()) {
+    emit(jsonrpc_error(nullptr, -32600, "Invalid Request"));
+    return;
+  }
+
+  struct Pending {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<nlohmann::json> done;
+    size_t remaining = 0;
+  };
+  auto pending = std::make_shared<Pending>();
+  pending->remaining = message.size() - 1;
+
+  // 第一个调用留在当前线程，其余交给工作线程；调用方等待全部完成，message在此期间有效
+  for (size_t i = 1; i < message.size(); ++i) {
+    const nlohmann::json *request = &message[i];
+    batch_executor_->submit([this, pending, request]() {
+      nlohmann::json response;
+      try {
+        response = handle_envelope(*request);
+      } catch (const std::exception &e) {
+        // 异常不能逃出任务，否则调用方永远等不到这一项完成
+        spdlog::error("Batch call failed: {}", e.what());
+        if (request->is_object() && request->contains("id")) {
+          response = jsonrpc_error((*request)["id"], -32603, "Internal error");
+        }
+      }
+      {
+        std::lock_guard<std::mutex> lock(pending->mutex);
+        pending->done.push_back(std::move(response));
+        pending->remaining--;
+      }
+      pending->cv.notify_one();
+    });
+  }
+
+  auto first = handle_envelope(message[0]);
+  if (!first.is_null()) {
+    emit(first);
+  }
+
+  std::unique_lock<std::mutex> lock(pending->mutex);
+  while (true) {
+    pending->cv.wait(lock, [&]() {
+      return !pending->done.empty() || pending->remaining == 0;
+    });
+    std::vector<nlohmann::json> ready;
+    ready.swap(pending->done);
+    const bool finished = pending->remaining == 0;
+
+    lock.unlock();
+    for (const auto &response : ready) {
+      if (!response.is_null()) {
+        emit(response);
+      }
+    }
+    if (finished) {
+      return;
+    }
+    lock.lock();
+  }
+}
+
+nlohmann::json MCPServer::get_method_statistics() const {
+  std::lock_guard<std::mutex> lock(stats_mutex_);
+  nlohmann::json stats = nlohmann::json::object();
+  for (const auto &[method, entry] : method_stats_) {
+    stats[method] = {
+        {"calls", entry.calls},
+        {"errors", entry.errors},
+        {"avg_ms", entry.calls > 0 ? entry.total_ms / entry.calls : 0.0},
+        {"max_ms", entry.max_ms},
+        {"total_ms", entry.total_ms}};
+  }
+  return stats;
+}
+
+nlohmann::json MCPServer::route_request(const nlohmann::json &request) {
   try {
     std::string error_msg;
     if (!validate_request(request, error_msg)) {
@@ -334,10 +666,12 @@ nlohmann::json MCPServer::handle_request(const nlohmann::json &request) {
           params.value("arguments", nlohmann::json::object());
       return handle_call_tool(tool_name, arguments);
     } else if (method == "resources/list") {
-      return handle_list_resources();
+      return handle_list_resources(params);
     } else if (method == "resources/read") {
       const std::string uri = params["uri"];
       return handle_read_resource(uri);
+    } else if (method == "ping" || method.starts_with("notifications/")) {
+      return nlohmann::json::object();
     } else {
       return create_error_response(-1, "Unknown method: " + method);
     }
@@ -362,6 +696,7 @@ nlohmann::json MCPServer::get_server_info() const {
     tools_list.push_back(name);
   }
   info["available_tools"] = tools_list;
+  info["method_statistics"] = get_method_statistics();
 
   return info;
 }
@@ -378,7 +713,7 @@ nlohmann::json MCPServer::tool_get_content(const nlohmann::json &args) {
   }
 
   int64_t id = args["id"];
-  return content_manager_->get_content(id);
+  return content_manager_->get_content(id, args.value("fields", ""));
 }
 
 nlohmann::json MCPServer::tool_update_content(const nlohmann::json &args) {
@@ -410,15 +745,38 @@ nlohmann::json MCPServer::tool_search_content(const nlohmann::json &args) {
   const std::string query = args["query"];
   int page = args.value("page", 1);
   int page_size = args.value("page_size", 20);
+  std::string cursor = args.value("cursor", "");
+  std::string fields = args.value("fields", "");
 
-  return content_manager_->search_content(query, page, page_size);
+  return content_manager_->search_content(query, page, page_size, cursor,
+                                          fields);
+}
+
+nlohmann::json MCPServer::tool_semantic_search(const nlohmann::json &args) {
+  if (!args.contains("query") || !args["query"].is_string()) {
+    return create_error_response(
+        -1, "Query parameter is required and must be a string");
+  }
+
+  const std::string query = args["query"];
+  int limit = args.value("limit", 10);
+  std::string mode = args.value("mode", "hybrid");
+
+  return content_manager_->semantic_search(query, limit, mode);
 }
 
 nlohmann::json MCPServer::tool_list_content(const nlohmann::json &args) {
   int page = args.value("page", 1);
   int page_size = args.value("page_size", 20);
+  std::string cursor = args.value("cursor", "");
+  std::string tag = args.value("tag", "");
+  std::string fields = args.value("fields", "");
 
-  return content_manager_->list_content(page, page_size);
+  if (!tag.empty()) {
+    return content_manager_->get_content_by_tag(tag, page, page_size, cursor,
+                                                fields);
+  }
+  return content_manager_->list_content(page, page_size, cursor, fields);
 }
 
 nlohmann::json MCPServer::tool_get_tags(const nlohmann::json & /* args */) {
@@ -435,6 +793,58 @@ nlohmann::json MCPServer::tool_export_content(const nlohmann::json &args) {
   return content_manager_->export_content(format);
 }
 
+nlohmann::json MCPServer::tool_submit_job(const nlohmann::json &args) {
+  if (!job_manager_) {
+    return create_error_response(-1, "Background jobs are not available");
+  }
+  if (!args.contains("type") || !args["type"].is_string()) {
+    return create_error_response(
+        -1, "Type parameter is required and must be a string");
+  }
+
+  nlohmann::json params = args.value("params", nlohmann::json::object());
+  std::string error;
+  auto job = job_manager_->submit(args["type"].get<std::string>(), params, error);
+  if (!job) {
+    return create_error_response(-1, error);
+  }
+  return {{"success", true}, {"data", job->to_json()}};
+}
+
+nlohmann::json MCPServer::tool_get_job(const nlohmann::json &args) {
+  if (!job_manager_) {
+    return create_error_response(-1, "Background jobs are not available");
+  }
+  if (!args.contains("id") || !args["id"].is_string()) {
+    return create_error_response(
+        -1, "ID parameter is required and must be a string");
+  }
+
+  auto job = job_manager_->get_job(args["id"].get<std::string>());
+  if (!job) {
+    return create_error_response(-1, "Job not found");
+  }
+  return {{"success", true}, {"data", job->to_json()}};
+}
+
+nlohmann::json MCPServer::tool_list_jobs(const nlohmann::json &args) {
+  if (!job_manager_) {
+    return create_error_response(-1, "Background jobs are not available");
+  }
+
+  const std::string status = args.value("status", "");
+  const int limit = std::clamp(args.value("limit", 20), 1, 200);
+
+  nlohmann::json jobs = nlohmann::json::array();
+  for (const auto &job : job_manager_->list_jobs(status, limit)) {
+    // 列表中省略结果以控制响应大小，完整结果通过get_job获取
+    auto j = job.to_json();
+    j.erase("result");
+    jobs.push_back(std::move(j));
+  }
+  return {{"success", true}, {"data", {{"jobs", jobs}, {"count", jobs.size()}}}};
+}
+
 // 辅助方法实现
 nlohmann::json MCPServer::create_error_response(int code,
                                                 const std::string &message) {
@@ -0,0 +1,231 @@
+#include "metrics.hpp"
+#include <cmath>
+#include <cstdio>
+
+namespace mcp {
+
+namespace {
+
+std::atomic<size_t> g_next_shard{0};
+
+std::string format_value(double value) {
+    char buffer[64];
+    if (std::isfinite(value) && value == std::floor(value) && std::fabs(value) < 9007199254740992.0) {
+        std::snprintf(buffer, sizeof(buffer), "%.0f", value);
+    } else if (std::isnan(value)) {
+        return "NaN";
+    } else if (std::isinf(value)) {
+        return value > 0 ? "+Inf" : "-Inf";
+    } else {
+        std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+    }
+    return buffer;
+}
+
+std::string escape_label_value(const std::string& value) {
+    std::string out;
+    out.reserve(value.size());
+    for (char ch : value) {
+        if (ch == '\\' || ch == '"') {
+            out += '\\';
+            out += ch;
+        } else if (ch == '\n') {
+            out += "\\n";
+        } else {
+            out += ch;
+        }
+    }
+    return out;
+}
+
+// 渲染为name="value",...形式（不含花括号），同时用作注册表中的键
+std::string render_labels(const MetricLabels& labels) {
+    std::string out;
+    for (const auto& [name, value] : labels) {
+        if (!out.empty()) {
+            out += ',';
+        }
+        out += name;
+        out += "=\"";
+        out += escape_label_value(value);
+        out += '"';
+    }
+    return out;
+}
+
+std::string with_label(const std::string& labels, const std::string& extra) {
+    return labels.empty() ? extra : labels + "," + extra;
+}
+
+} // namespace
+
+size_t metric_shard_index() {
+    // 线程首次写指标时分配分片，轮流分配使并发线程尽量落在不同缓存行
+    thread_local const size_t index = g_next_shard.fetch_add(1, std::memory_order_relaxed) % kMetricShards;
+    return index;
+}
+
+uint64_t Counter::value() const {
+    uint64_t total = 0;
+    for (const auto& shard : shards_) {
+        total += shard.value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+const std::array<double, LatencyHistogram::kBucketCount - 1> LatencyHistogram::kBounds = {
+    0.000025, 0.00005, 0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01,
+    0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0
+};
+
+void LatencyHistogram::observe(std::chrono::nanoseconds duration) {
+    const int64_t ns = std::max<int64_t>(0, duration.count());
+    const double seconds = static_cast<double>(ns) / 1e9;
+    size_t bucket = 0;
+    while (bucket < kBounds.size() && seconds > kBounds[bucket]) {
+        ++bucket;
+    }
+
+    auto& shard = shards_[metric_shard_index()];
+    shard.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    shard.count.fetch_add(1, std::memory_order_relaxed);
+    shard.sum_ns.fetch_add(static_cast<uint64_t>(ns), std::memory_order_relaxed);
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const {
+    Snapshot snapshot;
+    uint64_t sum_ns = 0;
+    for (const auto& shard : shards_) {
+        for (size_t i = 0; i < kBucketCount; ++i) {
+            snapshot.buckets[i] += shard.buckets[i].load(std::memory_order_relaxed);
+        }
+        sum_ns += shard.sum_ns.load(std::memory_order_relaxed);
+    }
+    // count取桶的合计，保证与各桶一致
+    for (auto value : snapshot.buckets) {
+        snapshot.count += value;
+    }
+    snapshot.sum_seconds = static_cast<double>(sum_ns) / 1e9;
+    return snapshot;
+}
+
+double LatencyHistogram::Snapshot::quantile(double q) const {
+    if (count == 0) {
+        return 0.0;
+    }
+    const double rank = q * static_cast<double>(count);
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        const uint64_t previous = cumulative;
+        cumulative += buckets[i];
+        if (static_cast<double>(cumulative) < rank || buckets[i] == 0) {
+            continue;
+        }
+        // 落在+Inf桶时只能返回最大的有限边界
+        if (i == kBucketCount - 1) {
+            return kBounds.back();
+        }
+        const double lower = i == 0 ? 0.0 : kBounds[i - 1];
+        const double upper = kBounds[i];
+        return lower + (upper - lower) * (rank - static_cast<double>(previous)) / static_cast<double>(buckets[i]);
+    }
+    return kBounds.back();
+}
+
+void MetricsWriter::family(const std::string& name, const std::string& type, const std::string& help) {
+    if (!help.empty()) {
+        out_ += "# HELP " + name + " " + help + "\n";
+    }
+    out_ += "# TYPE " + name + " " + type + "\n";
+}
+
+void MetricsWriter::sample(const std::string& name, const MetricLabels& labels, double value) {
+    out_ += name;
+    if (!labels.empty()) {
+        out_ += '{';
+        out_ += render_labels(labels);
+        out_ += '}';
+    }
+    out_ += ' ';
+    out_ += format_value(value);
+    out_ += '\n';
+}
+
+Metrics& Metrics::instance() {
+    static Metrics metrics;
+    return metrics;
+}
+
+Counter& Metrics::counter(const std::string& family, const MetricLabels& labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& slot = families_[family].counters[render_labels(labels)];
+    if (!slot) {
+        slot = std::make_unique<Counter>();
+    }
+    return *slot;
+}
+
+LatencyHistogram& Metrics::histogram(const std::string& family, const MetricLabels& labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& slot = families_[family].histograms[render_labels(labels)];
+    if (!slot) {
+        slot = std::make_unique<LatencyHistogram>();
+    }
+    return *slot;
+}
+
+void Metrics::describe(const std::string& family, const std::string& help) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    families_[family].help = help;
+}
+
+void Metrics::render(MetricsWriter& writer) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& out = writer.text();
+
+    for (const auto& [name, family] : families_) {
+        if (!family.counters.empty()) {
+            writer.family(name, "counter", family.help);
+            for (const auto& [labels, counter] : family.counters) {
+                out += name;
+                if (!labels.empty()) {
+                    out += "{" + labels + "}";
+                }
+                out += " " + std::to_string(counter->value()) + "\n";
+            }
+        }
+        if (family.histograms.empty()) {
+            continue;
+        }
+
+        std::map<std::string, LatencyHistogram::Snapshot> snapshots;
+        writer.family(name, "histogram", family.help);
+        for (const auto& [labels, histogram] : family.histograms) {
+            const auto snapshot = histogram->snapshot();
+            uint64_t cumulative = 0;
+            for (size_t i = 0; i < LatencyHistogram::kBucketCount; ++i) {
+                cumulative += snapshot.buckets[i];
+                const std::string le = i < LatencyHistogram::kBounds.size()
+                    ? format_value(LatencyHistogram::kBounds[i]) : "+Inf";
+                out += name + "_bucket{" + with_label(labels, "le=\"" + le + "\"") + "} " +
+                       std::to_string(cumulative) + "\n";
+            }
+            const std::string braces = labels.empty() ? "" : "{" + labels + "}";
+            out += name + "_sum" + braces + " " + format_value(snapshot.sum_seconds) + "\n";
+            out += name + "_count" + braces + " " + std::to_string(snapshot.count) + "\n";
+            snapshots.emplace(labels, snapshot);
+        }
+
+        // 预先算好的分位数，便于不经PromQL直接查看
+        const std::string quantile_name = name + "_quantile";
+        writer.family(quantile_name, "gauge", "Estimated quantiles of " + name);
+        for (const auto& [labels, snapshot] : snapshots) {
+            for (double q : {0.5, 0.99}) {
+                out += quantile_name + "{" + with_label(labels, "quantile=\"" + format_value(q) + "\"") + "} " +
+                       format_value(snapshot.quantile(q)) + "\n";
+            }
+        }
+    }
+}
+
+} // namespace mcp
@@ -0,0 +1,294 @@
+#include "ollama_client.hpp"
+#include "config.hpp"
+#include "metrics.hpp"
+#include <httplib.h>
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace mcp {
+
+namespace {
+
+// 空闲连接上限，超出部分用完即关闭
+constexpr size_t kMaxIdleConnections = 8;
+
+constexpr const char* kLatencyFamily = "mcp_ollama_request_duration_seconds";
+constexpr const char* kFailureFamily = "mcp_ollama_failures_total";
+
+// 由共享直方图的快照生成统计JSON，桶计数为累积值（<= le，单位毫秒）
+nlohmann::json latency_to_json(const LatencyHistogram::Snapshot& snapshot) {
+    nlohmann::json j;
+    j["count"] = snapshot.count;
+    j["sum_ms"] = snapshot.sum_seconds * 1000.0;
+    j["average_ms"] = snapshot.count > 0 ? snapshot.sum_seconds * 1000.0 / snapshot.count : 0.0;
+    j["p50_ms"] = snapshot.quantile(0.5) * 1000.0;
+    j["p99_ms"] = snapshot.quantile(0.99) * 1000.0;
+    
+    nlohmann::json buckets = nlohmann::json::array();
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < LatencyHistogram::kBounds.size(); ++i) {
+        cumulative += snapshot.buckets[i];
+        buckets.push_back({{"le", LatencyHistogram::kBounds[i] * 1000.0}, {"count", cumulative}});
+    }
+    buckets.push_back({{"le", "+Inf"}, {"count", snapshot.count}});
+    j["buckets"] = buckets;
+    return j;
+}
+
+std::chrono::nanoseconds elapsed_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::steady_clock::now() - start;
+}
+
+OllamaResult to_result(const httplib::Result& res) {
+    OllamaResult result;
+    if (!res) {
+        result.error = "Failed to connect to Ollama service";
+        return result;
+    }
+    
+    result.status = res->status;
+    if (res->status != 200) {
+        result.error = "Ollama returned HTTP " + std::to_string(res->status);
+        return result;
+    }
+    
+    result.body = nlohmann::json::parse(res->body, nullptr, false);
+    if (result.body.is_discarded()) {
+        result.body = nullptr;
+        result.error = "Failed to parse Ollama response";
+        return result;
+    }
+    
+    result.success = true;
+    return result;
+}
+
+} // namespace
+
+class OllamaClient::Impl {
+public:
+    // 借出的连接，用完后归还到空闲池
+    struct Lease {
+        std::unique_ptr<httplib::Client> client;
+        std::string host;
+        int port = 0;
+    };
+    
+    mutable std::mutex mutex_;
+    std::string host_;
+    int port_ = 0;
+    std::vector<std::unique_ptr<httplib::Client>> idle_;
+    
+    // 模型列表缓存
+    nlohmann::json models_body_;
+    std::chrono::steady_clock::time_point models_fetched_;
+    bool models_valid_ = false;
+    
+    // 统计信息：延迟记入共享指标注册表，由/metrics输出；这里只保留各操作直方图的引用
+    std::map<std::string, LatencyHistogram*> latency_;
+    uint64_t connections_created_ = 0;
+    uint64_t connections_reused_ = 0;
+    uint64_t failures_ = 0;
+    uint64_t model_cache_hits_ = 0;
+    
+    Lease acquire() {
+        auto& config = Config::instance();
+        Lease lease;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            // 地址变更后旧连接和模型缓存都不再有效
+            if (host_ != config.get_ollama_host() || port_ != config.get_ollama_port()) {
+                idle_.clear();
+                host_ = config.get_ollama_host();
+                port_ = config.get_ollama_port();
+                models_valid_ = false;
+            }
+            lease.host = host_;
+            lease.port = port_;
+            if (!idle_.empty()) {
+                lease.client = std::move(idle_.back());
+                idle_.pop_back();
+                connections_reused_++;
+            }
+        }
+        
+        if (!lease.client) {
+            lease.client = std::make_unique<httplib::Client>(lease.host, lease.port);
+            lease.client->set_keep_alive(true);
+            std::lock_guard<std::mutex> lock(mutex_);
+            connections_created_++;
+        }
+        
+        lease.client->set_connection_timeout(5, 0);
+        lease.client->set_read_timeout(config.get_ollama_timeout(), 0);
+        lease.client->set_write_timeout(config.get_ollama_timeout(), 0);
+        return lease;
+    }
+    
+    // reusable为false时关闭连接（连接出错，或响应未读完）
+    void release(Lease lease, bool reusable) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (reusable && lease.host == host_ && lease.port == port_ && idle_.size() < kMaxIdleConnections) {
+            idle_.push_back(std::move(lease.client));
+        }
+    }
+    
+    void record(const std::string& operation, std::chrono::nanoseconds elapsed, bool failed) {
+        LatencyHistogram* histogram = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto& entry = latency_[operation];
+            if (!entry) {
+                entry = &Metrics::instance().histogram(kLatencyFamily, {{"operation", operation}});
+            }
+            histogram = entry;
+            if (failed) {
+                failures_++;
+            }
+        }
+        histogram->observe(elapsed);
+        if (failed) {
+            Metrics::instance().counter(kFailureFamily, {{"operation", operation}}).add();
+        }
+    }
+};
+
+OllamaClient::OllamaClient() : pimpl_(std::make_unique<Impl>()) {}
+
+OllamaClient::~OllamaClient() = default;
+
+OllamaResult OllamaClient::list_models(bool force_refresh) {
+    const auto ttl = std::chrono::seconds(Config::instance().get_ollama_models_cache_ttl());
+    {
+        std::lock_guard<std::mutex> lock(pimpl_->mutex_);
+        if (!force_refresh && pimpl_->models_valid_ &&
+            std::chrono::steady_clock::now() - pimpl_->models_fetched_ < ttl) {
+            pimpl_->model_cache_hits_++;
+            OllamaResult cached;
+            cached.success = true;
+            cached.status = 200;
+            cached.body = pimpl_->models_body_;
+            return cached;
+        }
+    }
+    
+    auto lease = pimpl_->acquire();
+    const auto start = std::chrono::steady_clock::now();
+    auto res = lease.client->Get("/api/tags");
+    const bool connected = static_cast<bool>(res);
+    auto result = to_result(res);
+    pimpl_->record("tags", elapsed_since(start), !result.success);
+    pimpl_->release(std::move(lease), connected);
+    
+    if (result.success) {
+        std::lock_guard<std::mutex> lock(pimpl_->mutex_);
+        pimpl_->models_body_ = result.body;
+        pimpl_->models_fetched_ = std::chrono::steady_clock::now();
+        pimpl_->models_valid_ = true;
+    }
+    return result;
+}
+
+OllamaResult OllamaClient::generate(const nlohmann::json& request) {
+    auto lease = pimpl_->acquire();
+    const auto start = std::chrono::steady_clock::now();
+    auto res = lease.client->Post("/api/generate", request.dump(), "application/json");
+    const bool connected = static_cast<bool>(res);
+    auto result = to_result(res);
+    pimpl_->record("generate", elapsed_since(start), !result.success);
+    pimpl_->release(std::move(lease), connected);
+    return result;
+}
+
+OllamaResult OllamaClient::embeddings(const nlohmann::json& request) {
+    auto lease = pimpl_->acquire();
+    const auto start = std::chrono::steady_clock::now();
+    auto res = lease.client->Post("/api/embeddings", request.dump(), "application/json");
+    const bool connected = static_cast<bool>(res);
+    auto result = to_result(res);
+    pimpl_->record("embeddings", elapsed_since(start), !result.success);
+    pimpl_->release(std::move(lease), connected);
+    return result;
+}
+
+OllamaResult OllamaClient::generate_stream(const nlohmann::json& request,
+                                           std::function<bool(const char* data, size_t length)> on_chunk) {
+    httplib::Request req;
+    req.method = "POST";
+    req.path = "/api/generate";
+    req.headers.emplace("Content-Type", "application/json");
+    req.body = request.dump();
+    
+    int status = 0;
+    bool cancelled = false;
+    bool first_chunk = true;
+    std::string error_body;
+    const auto start = std::chrono::steady_clock::now();
+    
+    req.response_handler = [&status](const httplib::Response& r) {
+        status = r.status;
+        return true;
+    };
+    req.content_receiver = [&](const char* data, size_t length, uint64_t, uint64_t) {
+        if (status != 200) {
+            error_body.append(data, length);
+            return true;
+        }
+        if (first_chunk) {
+            first_chunk = false;
+            pimpl_->record("generate_stream_first_chunk", elapsed_since(start), false);
+        }
+        if (!on_chunk(data, length)) {
+            cancelled = true;
+            return false;
+        }
+        return true;
+    };
+    
+    auto lease = pimpl_->acquire();
+    auto res = lease.client->send(req);
+    
+    OllamaResult result;
+    result.status = status;
+    if (cancelled) {
+        result.error = "Generation cancelled";
+    } else if (!res) {
+        result.error = "Failed to connect to Ollama service";
+    } else if (status != 200) {
+        result.error = "Ollama returned HTTP " + std::to_string(status);
+        result.body = error_body;
+    } else {
+        result.success = true;
+    }
+    
+    pimpl_->record("generate_stream", elapsed_since(start), !result.success && !cancelled);
+    // 取消时响应体没有读完，连接不能复用
+    pimpl_->release(std::move(lease), static_cast<bool>(res) && !cancelled);
+    return result;
+}
+
+nlohmann::json OllamaClient::get_statistics() const {
+    std::lock_guard<std::mutex> lock(pimpl_->mutex_);
+    
+    nlohmann::json j;
+    j["pool"] = {
+        {"idle_connections", pimpl_->idle_.size()},
+        {"connections_created", pimpl_->connections_created_},
+        {"connections_reused", pimpl_->connections_reused_}
+    };
+    j["failures"] = pimpl_->failures_;
+    j["model_cache_hits"] = pimpl_->model_cache_hits_;
+    
+    nlohmann::json latency = nlohmann::json::object();
+    for (const auto& [operation, histogram] : pimpl_->latency_) {
+        latency[operation] = latency_to_json(histogram->snapshot());
+    }
+    j["latency"] = latency;
+    return j;
+}
+
+} // namespace mcp
@@ -0,0 +1,286 @@
+#include "response_cache.hpp"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace mcp {
+
+namespace {
+
+int64_t now_seconds() {
+    return static_cast<int64_t>(std::time(nullptr));
+}
+
+// 键直接用作文件名，只接受十六进制摘要
+bool is_valid_key(const std::string& key) {
+    return !key.empty() && key.size() <= 128 &&
+        std::all_of(key.begin(), key.end(), [](char ch) {
+            return (ch >= '0' && ch <= '9') || (ch >= 'a' && ch <= 'f');
+        });
+}
+
+} // namespace
+
+ResponseCache::ResponseCache(ResponseCacheOptions options) : options_(std::move(options)) {
+    if (!options_.disk_path.empty()) {
+        load_disk_index();
+    }
+}
+
+std::optional<std::string> ResponseCache::get(const std::string& key) {
+    const int64_t now = now_seconds();
+
+    {
+        std::lock_guard<std::mutex> lock(memory_mutex_);
+        auto it = memory_index_.find(key);
+        if (it != memory_index_.end()) {
+            if (it->second->expires_at > now) {
+                memory_lru_.splice(memory_lru_.begin(), memory_lru_, it->second);
+                memory_hits_++;
+                return it->second->value;
+            }
+            memory_used_ -= it->second->key.size() + it->second->value.size();
+            memory_lru_.erase(it->second);
+            memory_index_.erase(it);
+            expired_++;
+        }
+    }
+
+    std::optional<std::string> value;
+    int64_t expires_at = 0;
+    if (!options_.disk_path.empty() && is_valid_key(key)) {
+        std::lock_guard<std::mutex> lock(disk_mutex_);
+        auto it = disk_index_.find(key);
+        if (it != disk_index_.end()) {
+            expires_at = it->second.expires_at;
+            if (expires_at <= now) {
+                erase_disk_locked(key);
+            } else {
+                std::ifstream file(disk_file(key), std::ios::binary);
+                std::string header;
+                if (file && std::getline(file, header)) {
+                    value.emplace((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+                    disk_hits_++;
+                } else {
+                    // 文件被外部删除
+                    erase_disk_locked(key);
+                }
+            }
+        }
+    }
+
+    if (value) {
+        put_memory(key, *value, expires_at);
+        return value;
+    }
+
+    std::lock_guard<std::mutex> lock(memory_mutex_);
+    misses_++;
+    return std::nullopt;
+}
+
+void ResponseCache::put(const std::string& key, const std::string& value) {
+    const int64_t expires_at = now_seconds() + options_.ttl.count();
+    put_memory(key, value, expires_at);
+    if (!options_.disk_path.empty() && is_valid_key(key)) {
+        put_disk(key, value, expires_at);
+    }
+}
+
+void ResponseCache::clear() {
+    {
+        std::lock_guard<std::mutex> lock(memory_mutex_);
+        memory_lru_.clear();
+        memory_index_.clear();
+        memory_used_ = 0;
+    }
+
+    std::lock_guard<std::mutex> lock(disk_mutex_);
+    while (!disk_order_.empty()) {
+        erase_disk_locked(disk_order_.front());
+    }
+}
+
+void ResponseCache::put_memory(const std::string& key, const std::string& value, int64_t expires_at) {
+    const size_t size = key.size() + value.size();
+    if (size > options_.memory_bytes) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(memory_mutex_);
+    auto it = memory_index_.find(key);
+    if (it != memory_index_.end()) {
+        memory_used_ -= it->second->key.size() + it->second->value.size();
+        memory_lru_.erase(it->second);
+        memory_index_.erase(it);
+    }
+
+    while (!memory_lru_.empty() && memory_used_ + size > options_.memory_bytes) {
+        auto& victim = memory_lru_.back();
+        memory_used_ -= victim.key.size() + victim.value.size();
+        memory_index_.erase(victim.key);
+        memory_lru_.pop_back();
+        memory_evictions_++;
+    }
+
+    memory_lru_.push_front(MemoryEntry{key, value, expires_at});
+    memory_index_[key] = memory_lru_.begin();
+    memory_used_ += size;
+}
+
+void ResponseCache::put_disk(const std::string& key, const std::string& value, int64_t expires_at) {
+    const std::string header = std::to_string(expires_at) + "\n";
+    const size_t size = header.size() + value.size();
+    if (size > options_.disk_bytes) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(disk_mutex_);
+    erase_disk_locked(key);
+    while (!disk_order_.empty() && disk_used_ + size > options_.disk_bytes) {
+        erase_disk_locked(disk_order_.front());
+        disk_evictions_++;
+    }
+
+    // 先写临时文件再改名，进程中途退出不会留下半个条目
+    const std::string path = disk_file(key);
+    const std::string temp_path = path + ".tmp";
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            spdlog::warn("Failed to write response cache file: {}", temp_path);
+            return;
+        }
+        file << header;
+        file.write(value.data(), static_cast<std::streamsize>(value.size()));
+        if (!file) {
+            spdlog::warn("Failed to write response cache file: {}", temp_path);
+            return;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(temp_path, path, ec);
+    if (ec) {
+        spdlog::warn("Failed to store response cache file {}: {}", path, ec.message());
+        std::filesystem::remove(temp_path, ec);
+        return;
+    }
+
+    disk_order_.push_back(key);
+    disk_index_[key] = DiskEntry{size, expires_at, std::prev(disk_order_.end())};
+    disk_used_ += size;
+}
+
+void ResponseCache::erase_disk_locked(const std::string& key) {
+    auto it = disk_index_.find(key);
+    if (it == disk_index_.end()) {
+        return;
+    }
+
+    std::error_code ec;
+    std::filesystem::remove(disk_file(key), ec);
+    disk_used_ -= it->second.size;
+    disk_order_.erase(it->second.order);
+    disk_index_.erase(it);
+}
+
+void ResponseCache::load_disk_index() {
+    std::error_code ec;
+    std::filesystem::create_directories(options_.disk_path, ec);
+    if (ec) {
+        spdlog::warn("Failed to create response cache directory {}: {}", options_.disk_path, ec.message());
+        return;
+    }
+
+    // 按文件修改时间恢复写入顺序，顺便清理过期条目和残留的临时文件
+    struct Found {
+        std::string key;
+        size_t size;
+        int64_t expires_at;
+        std::filesystem::file_time_type written;
+    };
+    std::vector<Found> found;
+    const int64_t now = now_seconds();
+
+    for (const auto& entry : std::filesystem::directory_iterator(options_.disk_path, ec)) {
+        if (!entry.is_regular_file()) {
+            continue;
+        }
+        const std::string name = entry.path().filename().string();
+        if (!is_valid_key(name)) {
+            if (entry.path().extension() == ".tmp") {
+                std::filesystem::remove(entry.path(), ec);
+            }
+            continue;
+        }
+
+        std::ifstream file(entry.path(), std::ios::binary);
+        std::string header;
+        int64_t expires_at = 0;
+        if (file && std::getline(file, header)) {
+            expires_at = std::strtoll(header.c_str(), nullptr, 10);
+        }
+        file.close();
+
+        if (expires_at <= now) {
+            std::filesystem::remove(entry.path(), ec);
+            continue;
+        }
+        found.push_back(Found{name, static_cast<size_t>(entry.file_size()), expires_at, entry.last_write_time()});
+    }
+
+    std::sort(found.begin(), found.end(), [](const Found& a, const Found& b) {
+        return a.written < b.written;
+    });
+
+    std::lock_guard<std::mutex> lock(disk_mutex_);
+    for (const auto& item : found) {
+        disk_order_.push_back(item.key);
+        disk_index_[item.key] = DiskEntry{item.size, item.expires_at, std::prev(disk_order_.end())};
+        disk_used_ += item.size;
+    }
+    // 配置的容量可能变小了
+    while (!disk_order_.empty() && disk_used_ > options_.disk_bytes) {
+        erase_disk_locked(disk_order_.front());
+        disk_evictions_++;
+    }
+
+    spdlog::info("Response cache loaded {} entries from {}", disk_index_.size(), options_.disk_path);
+}
+
+std::string ResponseCache::disk_file(const std::string& key) const {
+    return (std::filesystem::path(options_.disk_path) / key).string();
+}
+
+nlohmann::json ResponseCache::get_statistics() const {
+    nlohmann::json stats;
+    {
+        std::lock_guard<std::mutex> lock(memory_mutex_);
+        stats["memory_entries"] = memory_index_.size();
+        stats["memory_bytes"] = memory_used_;
+        stats["memory_capacity"] = options_.memory_bytes;
+        stats["memory_hits"] = memory_hits_;
+        stats["memory_evictions"] = memory_evictions_;
+        stats["misses"] = misses_;
+        stats["expired"] = expired_;
+    }
+    {
+        std::lock_guard<std::mutex> lock(disk_mutex_);
+        stats["disk_enabled"] = !options_.disk_path.empty();
+        stats["disk_entries"] = disk_index_.size();
+        stats["disk_bytes"] = disk_used_;
+        stats["disk_capacity"] = options_.disk_bytes;
+        stats["disk_hits"] = disk_hits_;
+        stats["disk_evictions"] = disk_evictions_;
+    }
+    stats["ttl_seconds"] = options_.ttl.count();
+    return stats;
+}
+
+} // namespace mcp
@@ -0,0 +1,413 @@
+#include "semantic_index.hpp"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <queue>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace mcp {
+
+namespace {
+
+// 单条内容连续失败超过该次数后放弃，下次启动时重新排队
+constexpr int kMaxAttempts = 3;
+
+uint16_t float_to_half(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const uint32_t sign = (bits >> 16) & 0x8000u;
+    const int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xffu) - 127 + 15;
+    uint32_t mantissa = bits & 0x7fffffu;
+
+    if (exponent <= 0) {
+        // 单位向量的分量不会溢出，过小的值直接按非规格化数舍入
+        if (exponent < -10) {
+            return static_cast<uint16_t>(sign);
+        }
+        mantissa |= 0x800000u;
+        const uint32_t shift = static_cast<uint32_t>(14 - exponent);
+        uint32_t half = mantissa >> shift;
+        if ((mantissa >> (shift - 1)) & 1u) {
+            half++;
+        }
+        return static_cast<uint16_t>(sign | half);
+    }
+    if (exponent >= 31) {
+        return static_cast<uint16_t>(sign | 0x7c00u);
+    }
+
+    uint32_t half = sign | (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+    if (mantissa & 0x1000u) {
+        half++; // 进位可能溢出到指数位，结果仍然正确
+    }
+    return static_cast<uint16_t>(half);
+}
+
+float half_to_float(uint16_t half) {
+    const uint32_t sign = static_cast<uint32_t>(half & 0x8000u) << 16;
+    int32_t exponent = (half >> 10) & 0x1f;
+    uint32_t mantissa = half & 0x3ffu;
+    uint32_t bits;
+
+    if (exponent == 0) {
+        if (mantissa == 0) {
+            bits = sign;
+        } else {
+            // 非规格化数：规格化后再转换
+            exponent = 1;
+            while ((mantissa & 0x400u) == 0) {
+                mantissa <<= 1;
+                exponent--;
+            }
+            mantissa &= 0x3ffu;
+            bits = sign | (static_cast<uint32_t>(exponent + 127 - 15) << 23) | (mantissa << 13);
+        }
+    } else if (exponent == 31) {
+        bits = sign | 0x7f800000u | (mantissa << 13);
+    } else {
+        bits = sign | (static_cast<uint32_t>(exponent + 127 - 15) << 23) | (mantissa << 13);
+    }
+
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// 简单的定长循环，编译器在-O2/-O3下会向量化为SIMD乘加
+int32_t dot_int8(const int8_t* a, const int8_t* b, size_t n) {
+    int32_t sum = 0;
+    for (size_t i = 0; i < n; ++i) {
+        sum += static_cast<int32_t>(a[i]) * static_cast<int32_t>(b[i]);
+    }
+    return sum;
+}
+
+// 截断到max_chars字节以内，且不切断UTF-8字符
+std::string truncate_utf8(const std::string& text, size_t max_chars) {
+    if (text.size() <= max_chars) {
+        return text;
+    }
+    size_t end = max_chars;
+    while (end > 0 && (static_cast<unsigned char>(text[end]) & 0xc0u) == 0x80u) {
+        end--;
+    }
+    return text.substr(0, end);
+}
+
+} // namespace
+
+class SemanticIndex::Impl {
+public:
+    std::shared_ptr<Database> db_;
+    Embedder embedder_;
+    SemanticIndexOptions options_;
+
+    // 内存索引：第i行向量为matrix_[i*dims_, (i+1)*dims_)
+    mutable std::shared_mutex index_mutex_;
+    size_t dims_ = 0;
+    std::vector<int8_t> matrix_;
+    std::vector<float> scales_;
+    std::vector<int64_t> ids_;
+    std::unordered_map<int64_t, size_t> slots_;
+
+    // 待计算队列，同一内容只排队一次
+    std::mutex queue_mutex_;
+    std::condition_variable cv_;
+    std::deque<int64_t> pending_;
+    std::unordered_set<int64_t> queued_;
+    std::unordered_map<int64_t, int> attempts_;
+    std::thread worker_;
+    bool stopping_ = false;
+
+    // 统计信息
+    std::atomic<uint64_t> embedded_{0};
+    std::atomic<uint64_t> failed_{0};
+    std::atomic<uint64_t> queries_{0};
+
+    void upsert(int64_t id, const ContentEmbedding& embedding) {
+        // 内存中统一使用int8，f16存储的向量加载时重新量化
+        ContentEmbedding quantized = embedding.format == "int8" ? embedding : encode(decode(embedding), "int8");
+        const size_t dims = static_cast<size_t>(quantized.dimensions);
+        if (dims == 0 || quantized.data.size() != dims) {
+            return;
+        }
+
+        std::unique_lock<std::shared_mutex> lock(index_mutex_);
+        if (dims_ == 0) {
+            dims_ = dims;
+        } else if (dims != dims_) {
+            spdlog::warn("Embedding for content {} has {} dimensions, index uses {}", id, dims, dims_);
+            return;
+        }
+
+        const auto* data = reinterpret_cast<const int8_t*>(quantized.data.data());
+        auto it = slots_.find(id);
+        if (it != slots_.end()) {
+            std::copy(data, data + dims, matrix_.begin() + it->second * dims_);
+            scales_[it->second] = quantized.scale;
+            return;
+        }
+        slots_[id] = ids_.size();
+        ids_.push_back(id);
+        scales_.push_back(quantized.scale);
+        matrix_.insert(matrix_.end(), data, data + dims);
+    }
+
+    void erase(int64_t id) {
+        std::unique_lock<std::shared_mutex> lock(index_mutex_);
+        auto it = slots_.find(id);
+        if (it == slots_.end()) {
+            return;
+        }
+
+        // 与最后一行交换后删除，保持矩阵连续
+        const size_t slot = it->second;
+        const size_t last = ids_.size() - 1;
+        if (slot != last) {
+            std::copy(matrix_.begin() + last * dims_, matrix_.begin() + (last + 1) * dims_,
+                      matrix_.begin() + slot * dims_);
+            scales_[slot] = scales_[last];
+            ids_[slot] = ids_[last];
+            slots_[ids_[slot]] = slot;
+        }
+        matrix_.resize(last * dims_);
+        scales_.pop_back();
+        ids_.pop_back();
+        slots_.erase(it);
+    }
+
+    void process(int64_t id) {
+        auto item = db_->get_content(id);
+        if (!item) {
+            erase(id);
+            return;
+        }
+
+        const std::string text = truncate_utf8(item->title + "\n\n" + item->content, options_.max_chars);
+        auto vector = embedder_(text);
+        if (!vector || vector->empty()) {
+            failed_++;
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            const int attempts = ++attempts_[id];
+            if (attempts >= kMaxAttempts) {
+                spdlog::warn("Giving up embedding content {} after {} attempts", id, attempts);
+                attempts_.erase(id);
+                return;
+            }
+            // 嵌入服务不可用时退避，避免空转
+            cv_.wait_for(lock, std::chrono::seconds(1 << attempts), [this]() { return stopping_; });
+            if (!stopping_ && queued_.insert(id).second) {
+                pending_.push_back(id);
+            }
+            return;
+        }
+
+        auto embedding = encode(*vector, options_.storage_format);
+        embedding.content_id = id;
+        embedding.model = options_.model;
+        embedding.updated_at = item->updated_at;
+        db_->put_embedding(embedding);
+        upsert(id, embedding);
+        embedded_++;
+
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        attempts_.erase(id);
+    }
+
+    void worker_loop() {
+        while (true) {
+            int64_t id;
+            {
+                std::unique_lock<std::mutex> lock(queue_mutex_);
+                cv_.wait(lock, [this]() { return stopping_ || !pending_.empty(); });
+                if (stopping_) {
+                    return;
+                }
+                id = pending_.front();
+                pending_.pop_front();
+                queued_.erase(id);
+            }
+
+            try {
+                process(id);
+            } catch (const std::exception& e) {
+                spdlog::error("Failed to embed content {}: {}", id, e.what());
+            }
+        }
+    }
+};
+
+SemanticIndex::SemanticIndex(std::shared_ptr<Database> db, Embedder embedder, SemanticIndexOptions options)
+    : pimpl_(std::make_unique<Impl>()) {
+    pimpl_->db_ = std::move(db);
+    pimpl_->embedder_ = std::move(embedder);
+    pimpl_->options_ = std::move(options);
+}
+
+SemanticIndex::~SemanticIndex() {
+    stop();
+}
+
+void SemanticIndex::start() {
+    for (const auto& embedding : pimpl_->db_->load_embeddings(pimpl_->options_.model)) {
+        pimpl_->upsert(embedding.content_id, embedding);
+    }
+
+    const auto stale = pimpl_->db_->list_stale_embeddings(pimpl_->options_.model);
+    for (int64_t id : stale) {
+        enqueue(id);
+    }
+
+    spdlog::info("Semantic index loaded {} vectors, {} pending", pimpl_->ids_.size(), stale.size());
+    pimpl_->worker_ = std::thread([this]() { pimpl_->worker_loop(); });
+}
+
+void SemanticIndex::stop() {
+    {
+        std::lock_guard<std::mutex> lock(pimpl_->queue_mutex_);
+        pimpl_->stopping_ = true;
+    }
+    pimpl_->cv_.notify_all();
+    if (pimpl_->worker_.joinable()) {
+        pimpl_->worker_.join();
+    }
+}
+
+void SemanticIndex::enqueue(int64_t content_id) {
+    {
+        std::lock_guard<std::mutex> lock(pimpl_->queue_mutex_);
+        if (pimpl_->stopping_ || !pimpl_->queued_.insert(content_id).second) {
+            return;
+        }
+        pimpl_->pending_.push_back(content_id);
+    }
+    pimpl_->cv_.notify_one();
+}
+
+void SemanticIndex::remove(int64_t content_id) {
+    pimpl_->erase(content_id);
+}
+
+std::optional<std::vector<std::pair<int64_t, float>>> SemanticIndex::search(const std::string& query, size_t k) {
+    auto vector = pimpl_->embedder_(truncate_utf8(query, pimpl_->options_.max_chars));
+    if (!vector || vector->empty() || k == 0) {
+        return std::nullopt;
+    }
+    pimpl_->queries_++;
+
+    const auto encoded = encode(*vector, "int8");
+    const auto* q = reinterpret_cast<const int8_t*>(encoded.data.data());
+
+    // 小顶堆保留得分最高的k个
+    using Scored = std::pair<float, int64_t>;
+    std::priority_queue<Scored, std::vector<Scored>, std::greater<Scored>> top;
+    {
+        std::shared_lock<std::shared_mutex> lock(pimpl_->index_mutex_);
+        if (encoded.data.size() != pimpl_->dims_) {
+            return std::vector<std::pair<int64_t, float>>{};
+        }
+
+        const size_t dims = pimpl_->dims_;
+        const int8_t* row = pimpl_->matrix_.data();
+        for (size_t i = 0; i < pimpl_->ids_.size(); ++i, row += dims) {
+            const float score = static_cast<float>(dot_int8(q, row, dims)) * encoded.scale * pimpl_->scales_[i];
+            if (top.size() < k) {
+                top.emplace(score, pimpl_->ids_[i]);
+            } else if (score > top.top().first) {
+                top.pop();
+                top.emplace(score, pimpl_->ids_[i]);
+            }
+        }
+    }
+
+    std::vector<std::pair<int64_t, float>> results(top.size());
+    for (size_t i = results.size(); i > 0; --i) {
+        results[i - 1] = {top.top().second, top.top().first};
+        top.pop();
+    }
+    return results;
+}
+
+nlohmann::json SemanticIndex::get_statistics() const {
+    nlohmann::json stats;
+    stats["model"] = pimpl_->options_.model;
+    stats["storage_format"] = pimpl_->options_.storage_format;
+    {
+        std::shared_lock<std::shared_mutex> lock(pimpl_->index_mutex_);
+        stats["vectors"] = pimpl_->ids_.size();
+        stats["dimensions"] = pimpl_->dims_;
+        stats["memory_bytes"] = pimpl_->matrix_.size() + pimpl_->scales_.size() * sizeof(float) +
+                                pimpl_->ids_.size() * sizeof(int64_t);
+    }
+    {
+        std::lock_guard<std::mutex> lock(pimpl_->queue_mutex_);
+        stats["pending"] = pimpl_->pending_.size();
+    }
+    stats["embedded"] = pimpl_->embedded_.load();
+    stats["failed"] = pimpl_->failed_.load();
+    stats["queries"] = pimpl_->queries_.load();
+    return stats;
+}
+
+ContentEmbedding SemanticIndex::encode(const std::vector<float>& vector, const std::string& format) {
+    ContentEmbedding embedding;
+    embedding.format = format;
+    embedding.dimensions = static_cast<int>(vector.size());
+
+    double norm = 0.0;
+    for (float v : vector) {
+        norm += static_cast<double>(v) * v;
+    }
+    const float inv_norm = norm > 0.0 ? static_cast<float>(1.0 / std::sqrt(norm)) : 0.0f;
+
+    if (format == "f16") {
+        embedding.scale = 1.0f;
+        embedding.data.resize(vector.size() * 2);
+        for (size_t i = 0; i < vector.size(); ++i) {
+            const uint16_t half = float_to_half(vector[i] * inv_norm);
+            embedding.data[i * 2] = static_cast<uint8_t>(half & 0xffu);
+            embedding.data[i * 2 + 1] = static_cast<uint8_t>(half >> 8);
+        }
+        return embedding;
+    }
+
+    float max_abs = 0.0f;
+    for (float v : vector) {
+        max_abs = std::max(max_abs, std::fabs(v * inv_norm));
+    }
+    embedding.scale = max_abs > 0.0f ? max_abs / 127.0f : 1.0f;
+    embedding.data.resize(vector.size());
+    for (size_t i = 0; i < vector.size(); ++i) {
+        const long q = std::lround(vector[i] * inv_norm / embedding.scale);
+        embedding.data[i] = static_cast<uint8_t>(static_cast<int8_t>(std::clamp(q, -127L, 127L)));
+    }
+    return embedding;
+}
+
+std::vector<float> SemanticIndex::decode(const ContentEmbedding& embedding) {
+    std::vector<float> vector;
+    if (embedding.format == "f16") {
+        vector.resize(embedding.data.size() / 2);
+        for (size_t i = 0; i < vector.size(); ++i) {
+            const uint16_t half = static_cast<uint16_t>(embedding.data[i * 2] | (embedding.data[i * 2 + 1] << 8));
+            vector[i] = half_to_float(half);
+        }
+    } else {
+        vector.resize(embedding.data.size());
+        for (size_t i = 0; i < vector.size(); ++i) {
+            vector[i] = static_cast<int8_t>(embedding.data[i]) * embedding.scale;
+        }
+    }
+    return vector;
+}
+
+} // namespace mcp
@@ -0,0 +1,243 @@
+#include "static_assets.hpp"
+#include "sha256.hpp"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace mcp {
+
+namespace {
+
+struct MimeType {
+    const char* extension;
+    const char* type;
+    bool compressible;
+};
+
+// 文本类型带charset；图片、字体等已压缩格式不再预压缩
+const MimeType kMimeTypes[] = {
+    {".html", "text/html; charset=utf-8", true},
+    {".htm", "text/html; charset=utf-8", true},
+    {".css", "text/css; charset=utf-8", true},
+    {".js", "application/javascript; charset=utf-8", true},
+    {".mjs", "application/javascript; charset=utf-8", true},
+    {".json", "application/json; charset=utf-8", true},
+    {".map", "application/json; charset=utf-8", true},
+    {".webmanifest", "application/manifest+json; charset=utf-8", true},
+    {".txt", "text/plain; charset=utf-8", true},
+    {".xml", "application/xml; charset=utf-8", true},
+    {".svg", "image/svg+xml; charset=utf-8", true},
+    {".ico", "image/x-icon", true},
+    {".wasm", "application/wasm", true},
+    {".ttf", "font/ttf", true},
+    {".otf", "font/otf", true},
+    {".png", "image/png", false},
+    {".jpg", "image/jpeg", false},
+    {".jpeg", "image/jpeg", false},
+    {".gif", "image/gif", false},
+    {".webp", "image/webp", false},
+    {".woff", "font/woff", false},
+    {".woff2", "font/woff2", false},
+};
+
+const MimeType* lookup_mime(const std::filesystem::path& path) {
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char ch) { return static_cast<char>(std::tolower(ch)); });
+    for (const auto& mime : kMimeTypes) {
+        if (extension == mime.extension) {
+            return &mime;
+        }
+    }
+    return nullptr;
+}
+
+bool is_hex(const std::string& value) {
+    return std::all_of(value.begin(), value.end(), [](unsigned char ch) { return std::isxdigit(ch) != 0; });
+}
+
+// 只保留比原文小的压缩结果；静态资源只压缩一次，使用最高级别
+void precompress(ContentEncoding encoding, int level, const std::string& input, std::string& out) {
+    if (!compress_body(encoding, input, out, level) || out.size() >= input.size()) {
+        out.clear();
+    }
+}
+
+} // namespace
+
+const std::string* StaticAsset::variant(ContentEncoding encoding) const {
+    const std::string* body = nullptr;
+    switch (encoding) {
+    case ContentEncoding::Gzip:
+        body = &gzip;
+        break;
+    case ContentEncoding::Brotli:
+        body = &brotli;
+        break;
+    case ContentEncoding::Zstd:
+        body = &zstd;
+        break;
+    default:
+        return &identity;
+    }
+    return body->empty() ? nullptr : body;
+}
+
+std::string StaticAsset::variant_etag(ContentEncoding encoding) const {
+    if (encoding == ContentEncoding::Identity) {
+        return etag;
+    }
+    // 不同编码的表示需要不同的强ETag
+    return etag.substr(0, etag.size() - 1) + "-" + encoding_name(encoding) + "\"";
+}
+
+bool StaticAsset::matches(const std::string& if_none_match) const {
+    size_t pos = 0;
+    while (pos < if_none_match.size()) {
+        size_t end = if_none_match.find(',', pos);
+        if (end == std::string::npos) {
+            end = if_none_match.size();
+        }
+        std::string tag = if_none_match.substr(pos, end - pos);
+        pos = end + 1;
+
+        const size_t first = tag.find_first_not_of(" \t");
+        const size_t last = tag.find_last_not_of(" \t");
+        if (first == std::string::npos) {
+            continue;
+        }
+        tag = tag.substr(first, last - first + 1);
+        if (tag == "*") {
+            return true;
+        }
+        if (tag.rfind("W/", 0) == 0) {
+            tag = tag.substr(2);
+        }
+        for (auto encoding : {ContentEncoding::Identity, ContentEncoding::Gzip, ContentEncoding::Brotli,
+                              ContentEncoding::Zstd}) {
+            if (variant(encoding) && tag == variant_etag(encoding)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool StaticAssetCache::is_hashed_filename(const std::string& filename) {
+    std::vector<std::string> parts;
+    size_t start = 0;
+    while (true) {
+        size_t dot = filename.find('.', start);
+        parts.push_back(filename.substr(start, dot == std::string::npos ? std::string::npos : dot - start));
+        if (dot == std::string::npos) {
+            break;
+        }
+        start = dot + 1;
+    }
+    if (parts.size() < 2) {
+        return false;
+    }
+
+    // webpack/CRA：main.3f9a1b2c.chunk.js，哈希是文件名和扩展名之间的十六进制段
+    for (size_t i = 1; i + 1 < parts.size(); ++i) {
+        if (parts[i].size() >= 8 && is_hex(parts[i])) {
+            return true;
+        }
+    }
+
+    // Vite/Rollup：index-BqR3x9aF.js，哈希为"-"之后的8位base64url字符
+    const std::string& stem = parts.front();
+    const size_t dash = stem.rfind('-');
+    if (dash == std::string::npos || stem.size() - dash - 1 != 8) {
+        return false;
+    }
+    const std::string hash = stem.substr(dash + 1);
+    const bool charset_ok = std::all_of(hash.begin(), hash.end(), [](unsigned char ch) {
+        return std::isalnum(ch) || ch == '_' || ch == '-';
+    });
+    const bool has_digit = std::any_of(hash.begin(), hash.end(), [](unsigned char ch) {
+        return std::isdigit(ch) != 0;
+    });
+    return charset_ok && has_digit;
+}
+
+bool StaticAssetCache::load(const std::string& root, size_t max_bytes) {
+    std::error_code ec;
+    if (!std::filesystem::is_directory(root, ec)) {
+        return false;
+    }
+
+    size_t skipped = 0;
+    for (auto it = std::filesystem::recursive_directory_iterator(root, ec);
+         !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+        if (!it->is_regular_file(ec)) {
+            continue;
+        }
+        const auto& file_path = it->path();
+        const size_t file_size = static_cast<size_t>(it->file_size(ec));
+        if (ec || identity_bytes_ + file_size > max_bytes) {
+            spdlog::warn("Static file not cached (size limit): {}", file_path.string());
+            ec.clear();
+            ++skipped;
+            continue;
+        }
+
+        std::ifstream file(file_path, std::ios::binary);
+        if (!file) {
+            spdlog::warn("Failed to read static file: {}", file_path.string());
+            continue;
+        }
+
+        auto asset = std::make_shared<StaticAsset>();
+        asset->identity.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+        const MimeType* mime = lookup_mime(file_path);
+        asset->mime_type = mime ? mime->type : "application/octet-stream";
+        asset->immutable = is_hashed_filename(file_path.filename().string());
+
+        Sha256 sha;
+        sha.update(asset->identity.data(), asset->identity.size());
+        asset->etag = "\"" + sha.hex_digest().substr(0, 16) + "\"";
+
+        if (mime && mime->compressible) {
+            precompress(ContentEncoding::Gzip, 9, asset->identity, asset->gzip);
+            precompress(ContentEncoding::Brotli, 11, asset->identity, asset->brotli);
+            precompress(ContentEncoding::Zstd, 19, asset->identity, asset->zstd);
+        }
+
+        identity_bytes_ += asset->identity.size();
+        compressed_bytes_ += asset->gzip.size() + asset->brotli.size() + asset->zstd.size();
+
+        const std::string url_path =
+            "/" + std::filesystem::relative(file_path, root, ec).generic_string();
+        assets_[url_path] = std::move(asset);
+    }
+
+    spdlog::info("Loaded {} static files ({} bytes, {} bytes precompressed) from {}{}",
+                 assets_.size(), identity_bytes_, compressed_bytes_, root,
+                 skipped > 0 ? ", " + std::to_string(skipped) + " skipped" : std::string());
+    return true;
+}
+
+std::shared_ptr<const StaticAsset> StaticAssetCache::find(const std::string& path) const {
+    std::string key = path.empty() ? "/" : path;
+    if (key.back() == '/') {
+        key += "index.html";
+    }
+    auto it = assets_.find(key);
+    return it != assets_.end() ? it->second : nullptr;
+}
+
+nlohmann::json StaticAssetCache::get_statistics() const {
+    nlohmann::json stats;
+    stats["files"] = assets_.size();
+    stats["bytes"] = identity_bytes_;
+    stats["precompressed_bytes"] = compressed_bytes_;
+    return stats;
+}
+
+} // namespace mcp
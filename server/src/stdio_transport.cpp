@@ -0,0 +1,97 @@
+#include "stdio_transport.hpp"
+#include <spdlog/spdlog.h>
+#include <atomic>
+#include <istream>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+
+namespace mcp {
+
+struct StdioTransport::State {
+    std::shared_ptr<MCPServer> server;
+    std::istream& in;
+    std::ostream& out;
+
+    std::mutex write_mutex;
+    std::atomic<bool> finished{false};
+    std::atomic<bool> stopping{false};
+    std::thread notifier;
+
+    State(std::shared_ptr<MCPServer> s, std::istream& i, std::ostream& o)
+        : server(std::move(s)), in(i), out(o) {}
+
+    void write_line(const nlohmann::json& message) {
+        const std::string line = message.dump() + "\n";
+        std::lock_guard<std::mutex> lock(write_mutex);
+        out.write(line.data(), static_cast<std::streamsize>(line.size()));
+        out.flush();
+    }
+
+    void read_loop() {
+        std::string line;
+        while (!stopping && std::getline(in, line)) {
+            if (line.find_first_not_of(" \t\r") == std::string::npos) {
+                continue;
+            }
+
+            nlohmann::json message;
+            try {
+                message = nlohmann::json::parse(line);
+            } catch (const nlohmann::json::parse_error& e) {
+                spdlog::warn("Invalid JSON on stdin: {}", e.what());
+                write_line({{"jsonrpc", "2.0"},
+                            {"id", nullptr},
+                            {"error", {{"code", -32700}, {"message", "Parse error"}}}});
+                continue;
+            }
+
+            // 批量应答整体写成一行，与请求一一对应
+            auto response = server->handle_message(message);
+            if (!response.is_null()) {
+                write_line(response);
+            }
+        }
+        finished = true;
+        spdlog::info("Stdio transport input closed");
+    }
+
+    void notify_loop() {
+        uint64_t version = server->get_content_manager()->get_change_version();
+        while (!stopping && !finished) {
+            auto notification = server->wait_for_notification(version, std::chrono::seconds(1));
+            if (notification) {
+                write_line(*notification);
+            }
+        }
+    }
+};
+
+StdioTransport::StdioTransport(std::shared_ptr<MCPServer> server, std::istream& in, std::ostream& out)
+    : state_(std::make_shared<State>(std::move(server), in, out)) {}
+
+StdioTransport::~StdioTransport() {
+    stop();
+}
+
+void StdioTransport::start() {
+    // 读取线程持有State的引用计数，分离后即使Transport先析构也安全
+    auto state = state_;
+    std::thread([state]() { state->read_loop(); }).detach();
+    state_->notifier = std::thread([state]() { state->notify_loop(); });
+    spdlog::info("Stdio transport started");
+}
+
+bool StdioTransport::finished() const {
+    return state_->finished;
+}
+
+void StdioTransport::stop() {
+    state_->stopping = true;
+    if (state_->notifier.joinable()) {
+        state_->notifier.join();
+    }
+}
+
+} // namespace mcp